@@ -13,6 +13,279 @@
 #include "affinity.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+
+/******************************************************************************/
+// CPU topology, read from sysfs once.
+
+namespace {
+
+struct cpu_info
+{
+    int cpu;
+    int socket;     // physical package
+    int core;       // core_id, unique within socket
+    int core_rank;  // index of core within its socket
+    int smt;        // index of cpu among SMT siblings of its core
+    int node;       // NUMA node
+};
+
+struct topology
+{
+    std::vector< cpu_info > cpus;      // allowed cpus
+    std::vector< int >      node_of;   // NUMA node of each cpu id, or -1
+    int nsockets, ncores, nnodes;
+    magma_affinity_t        policy;
+    std::vector< int >      order;     // cpus in placement order for policy
+
+    topology();
+};
+
+
+// -----------------------------------------------------------------------------
+// returns integer in file, or -1 if it can't be read
+int read_int( const char* path )
+{
+    int val = -1;
+    FILE* f = fopen( path, "r" );
+    if ( f != NULL ) {
+        if ( fscanf( f, "%d", &val ) != 1 ) {
+            val = -1;
+        }
+        fclose( f );
+    }
+    return val;
+}
+
+
+// -----------------------------------------------------------------------------
+// sets node_of[cpu] = node for cpus in sysfs list, e.g., "0-3,8-11"
+void read_cpulist( const char* path, int node, std::vector< int >& node_of )
+{
+    char buf[ 4096 ];
+    FILE* f = fopen( path, "r" );
+    if ( f == NULL ) {
+        return;
+    }
+    if ( fgets( buf, sizeof(buf), f ) != NULL ) {
+        char* p = buf;
+        while ( *p != '\0' && *p != '\n' ) {
+            char* end;
+            long first = strtol( p, &end, 10 );
+            if ( end == p ) {
+                break;
+            }
+            long last = first;
+            p = end;
+            if ( *p == '-' ) {
+                last = strtol( p+1, &end, 10 );
+                p = end;
+            }
+            for( long cpu = first; cpu <= last && cpu < (long) node_of.size(); ++cpu ) {
+                node_of[ cpu ] = node;
+            }
+            if ( *p == ',' ) {
+                ++p;
+            }
+        }
+    }
+    fclose( f );
+}
+
+
+// -----------------------------------------------------------------------------
+bool by_socket_core_smt( const cpu_info& a, const cpu_info& b )
+{
+    if ( a.socket != b.socket ) return a.socket < b.socket;
+    if ( a.core   != b.core   ) return a.core   < b.core;
+    return a.cpu < b.cpu;
+}
+
+bool by_smt_socket_core( const cpu_info& a, const cpu_info& b )
+{
+    if ( a.smt    != b.smt    ) return a.smt    < b.smt;
+    if ( a.socket != b.socket ) return a.socket < b.socket;
+    return a.core_rank < b.core_rank;
+}
+
+bool by_smt_core_socket( const cpu_info& a, const cpu_info& b )
+{
+    if ( a.smt       != b.smt       ) return a.smt       < b.smt;
+    if ( a.core_rank != b.core_rank ) return a.core_rank < b.core_rank;
+    return a.socket < b.socket;
+}
+
+
+// -----------------------------------------------------------------------------
+topology::topology():
+    nsockets( 0 ),
+    ncores  ( 0 ),
+    nnodes  ( 0 ),
+    policy  ( MagmaAffinityCores )
+{
+    char path[ 256 ];
+
+    const char* env = getenv( "MAGMA_AFFINITY" );
+    if ( env != NULL && env[0] != '\0' ) {
+        if      ( strcmp( env, "none"    ) == 0 ) policy = MagmaAffinityNone;
+        else if ( strcmp( env, "cores"   ) == 0 ) policy = MagmaAffinityCores;
+        else if ( strcmp( env, "compact" ) == 0 ) policy = MagmaAffinityCompact;
+        else if ( strcmp( env, "scatter" ) == 0 ) policy = MagmaAffinityScatter;
+        else {
+            fprintf( stderr, "$MAGMA_AFFINITY='%s' is invalid; use none, cores, compact, or scatter. Using cores.\n", env );
+        }
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO( &allowed );
+    if ( sched_getaffinity( 0, sizeof(allowed), &allowed ) != 0 ) {
+        policy = MagmaAffinityNone;
+        return;
+    }
+
+    node_of.assign( CPU_SETSIZE, -1 );
+    for( int node = 0; ; ++node ) {
+        snprintf( path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node );
+        FILE* f = fopen( path, "r" );
+        if ( f == NULL ) {
+            break;
+        }
+        fclose( f );
+        read_cpulist( path, node, node_of );
+        nnodes = node + 1;
+    }
+
+    for( int cpu = 0; cpu < CPU_SETSIZE; ++cpu ) {
+        if ( ! CPU_ISSET( cpu, &allowed )) {
+            continue;
+        }
+        cpu_info info;
+        info.cpu = cpu;
+        snprintf( path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu );
+        info.socket = std::max( 0, read_int( path ));
+        snprintf( path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu );
+        info.core = read_int( path );
+        if ( info.core < 0 ) {
+            info.core = cpu;  // no sysfs: each cpu is a core
+        }
+        info.node = std::max( 0, node_of[ cpu ] );
+        info.smt = 0;
+        info.core_rank = 0;
+        cpus.push_back( info );
+    }
+
+    // number SMT siblings within each core, and cores within each socket
+    std::sort( cpus.begin(), cpus.end(), by_socket_core_smt );
+    for( size_t i = 0; i < cpus.size(); ++i ) {
+        if ( i > 0 && cpus[i].socket == cpus[i-1].socket ) {
+            if ( cpus[i].core == cpus[i-1].core ) {
+                cpus[i].smt       = cpus[i-1].smt + 1;
+                cpus[i].core_rank = cpus[i-1].core_rank;
+            }
+            else {
+                cpus[i].core_rank = cpus[i-1].core_rank + 1;
+                ncores += 1;
+            }
+        }
+        else {
+            nsockets += 1;
+            ncores   += 1;
+        }
+    }
+    nnodes = std::max( 1, nnodes );
+
+    std::vector< cpu_info > sorted( cpus );
+    if ( policy == MagmaAffinityCores ) {
+        std::stable_sort( sorted.begin(), sorted.end(), by_smt_socket_core );
+    }
+    else if ( policy == MagmaAffinityScatter ) {
+        std::stable_sort( sorted.begin(), sorted.end(), by_smt_core_socket );
+    }
+    for( size_t i = 0; i < sorted.size(); ++i ) {
+        order.push_back( sorted[i].cpu );
+    }
+    if ( order.empty() ) {
+        policy = MagmaAffinityNone;
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+const topology& get_topology()
+{
+    static const topology topo;  // thread-safe initialization in C++11
+    return topo;
+}
+
+}  // namespace
+
+
+/***************************************************************************//**
+    @return placement policy for threads created by MAGMA,
+    set by the environment variable MAGMA_AFFINITY; MagmaAffinityCores
+    if it is not set.
+    @ingroup magma_thread
+*******************************************************************************/
+magma_affinity_t magma_affinity_policy()
+{
+    return get_topology().policy;
+}
+
+
+/***************************************************************************//**
+    @return CPU for thread index (0, 1, ...) of a group of MAGMA threads,
+    according to the placement policy, or -1 for MagmaAffinityNone.
+    Indices beyond the number of CPUs wrap around.
+    @ingroup magma_thread
+*******************************************************************************/
+int magma_affinity_cpu( int index )
+{
+    const topology& topo = get_topology();
+    if ( topo.policy == MagmaAffinityNone || index < 0 ) {
+        return -1;
+    }
+    return topo.order[ index % topo.order.size() ];
+}
+
+
+/***************************************************************************//**
+    @return NUMA node of cpu, or 0 if unknown.
+    @ingroup magma_thread
+*******************************************************************************/
+int magma_affinity_node( int cpu )
+{
+    const topology& topo = get_topology();
+    if ( cpu < 0 || cpu >= (int) topo.node_of.size() ) {
+        return 0;
+    }
+    return std::max( 0, topo.node_of[ cpu ] );
+}
+
+
+/***************************************************************************//**
+    Gets number of sockets, physical cores, and CPUs (hardware threads)
+    available to the process, and number of NUMA nodes in the machine.
+    Each output may be NULL.
+    @return number of CPUs.
+    @ingroup magma_thread
+*******************************************************************************/
+int magma_topology_info( int* nsockets, int* ncores, int* ncpus, int* nnodes )
+{
+    const topology& topo = get_topology();
+    if ( nsockets != NULL ) *nsockets = topo.nsockets;
+    if ( ncores   != NULL ) *ncores   = topo.ncores;
+    if ( ncpus    != NULL ) *ncpus    = (int) topo.cpus.size();
+    if ( nnodes   != NULL ) *nnodes   = topo.nnodes;
+    return (int) topo.cpus.size();
+}
+
+
+/******************************************************************************/
 
 affinity_set::affinity_set()
 {
@@ -33,6 +306,38 @@ void affinity_set::add(int cpu)
 }
 
 
+// adds cpu for thread index according to the placement policy;
+// returns false if the policy is none.
+bool affinity_set::add_thread(int index)
+{
+    int cpu = magma_affinity_cpu( index );
+    if ( cpu < 0 )
+        return false;
+    CPU_SET(cpu, &set);
+    return true;
+}
+
+
+bool affinity_set::empty()
+{
+    cpu_set_t zero;
+    CPU_ZERO(&zero);
+    return CPU_EQUAL(&set, &zero);
+}
+
+
+// returns number of cpus in the set
+int affinity_set::count()
+{
+    int cnt = 0;
+    for (int icpu=0; icpu < CPU_SETSIZE; ++icpu) {
+        if ( CPU_ISSET( icpu, &set ))
+            ++cnt;
+    }
+    return cnt;
+}
+
+
 int affinity_set::get_affinity()
 {
     return sched_getaffinity( 0, sizeof(set), &set);
@@ -21,6 +21,22 @@
 
 #if __GLIBC_PREREQ(2,3)
 
+// Placement of threads created by MAGMA, set by the environment variable
+// MAGMA_AFFINITY = none, cores (default), compact, or scatter.
+// Only CPUs in the process's affinity mask at first use are used.
+typedef enum {
+    MagmaAffinityNone,     // don't pin threads
+    MagmaAffinityCores,    // one thread per physical core, socket by socket;
+                           // SMT siblings only after all cores are used
+    MagmaAffinityCompact,  // fill all SMT siblings of a core, then next core
+    MagmaAffinityScatter   // round robin over sockets, one thread per core
+} magma_affinity_t;
+
+magma_affinity_t magma_affinity_policy();
+int magma_affinity_cpu( int index );
+int magma_affinity_node( int cpu );
+int magma_topology_info( int* nsockets, int* ncores, int* ncpus, int* nnodes );
+
 class affinity_set
 {
 public:
@@ -31,6 +47,12 @@ public:
 
     void add(int cpu);
 
+    bool add_thread(int index);
+
+    bool empty();
+
+    int count();
+
     int get_affinity();
 
     int set_affinity();
@@ -31,6 +31,16 @@
 
 #define BAQRF_NB         32
 
+// CPU batched routines: kernels specialized on n exist up to BATCHED_CPU_MAX_N,
+// interleaved kernels up to BATCHED_CPU_MAX_INTERLEAVE_N, which factor
+// BATCHED_CPU_LANES matrices at once
+#define BATCHED_CPU_MAX_N             16
+#define BATCHED_CPU_MAX_INTERLEAVE_N   8
+#define BATCHED_CPU_LANES              8
+// CPU vbatched routines group matrices of equal order into tasks of about
+// this many flops; larger matrices get one task each
+#define BATCHED_CPU_TASK_FLOPS     2.0e5
+
 #define BATRI_NB         128        // ztrsm_nb should be >= BATRF_NB
 #define TRI_NB           128        // ztrsm_nb should match the NB in BATRF_NB
 #define TRI_BLOCK_SIZE    16
@@ -10,6 +10,7 @@
 */
 
 #include "magma_internal.h"
+#include "batched_kernel_param.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -451,6 +452,85 @@ magma_int_t magma_get_strsm_batched_stop_nb(magma_side_t side, magma_int_t m, ma
 
 #endif  // MAGMA_HAVE_CUDA
 
+// =============================================================================
+/// @addtogroup magma_tuning
+/// @{
+
+// Crossovers for the CPU batched routines (magma_zgetrf_batched_cpu, etc.).
+// The interleaved kernels vectorize across matrices; they beat the kernels
+// specialized on n only with 256-bit vectors, and for complex with SSE2
+// only for the smallest sizes.
+#if defined(__AVX__)
+#define ZBATCHED_CPU_INTERLEAVE 8
+#define CBATCHED_CPU_INTERLEAVE 8
+#define DBATCHED_CPU_INTERLEAVE 8
+#define SBATCHED_CPU_INTERLEAVE 8
+#else
+#define ZBATCHED_CPU_INTERLEAVE 4
+#define CBATCHED_CPU_INTERLEAVE 4
+#define DBATCHED_CPU_INTERLEAVE 0
+#define SBATCHED_CPU_INTERLEAVE 0
+#endif
+
+/***************************************************************************//**
+    @return the largest n for which the CPU batched routines use the
+    kernels specialized on n; larger matrices use LAPACK.
+*******************************************************************************/
+magma_int_t magma_get_zbatched_cpu_crossover()
+{
+    return BATCHED_CPU_MAX_N;
+}
+
+/// @see magma_get_zbatched_cpu_crossover
+magma_int_t magma_get_cbatched_cpu_crossover()
+{
+    return BATCHED_CPU_MAX_N;
+}
+
+/// @see magma_get_zbatched_cpu_crossover
+magma_int_t magma_get_dbatched_cpu_crossover()
+{
+    return BATCHED_CPU_MAX_N;
+}
+
+/// @see magma_get_zbatched_cpu_crossover
+magma_int_t magma_get_sbatched_cpu_crossover()
+{
+    return BATCHED_CPU_MAX_N;
+}
+
+/***************************************************************************//**
+    @return the largest n for which the CPU batched routines factor
+    BATCHED_CPU_LANES matrices at once with the interleaved kernels;
+    0 disables them.
+*******************************************************************************/
+magma_int_t magma_get_zbatched_cpu_interleave()
+{
+    return min( ZBATCHED_CPU_INTERLEAVE, BATCHED_CPU_MAX_INTERLEAVE_N );
+}
+
+/// @see magma_get_zbatched_cpu_interleave
+magma_int_t magma_get_cbatched_cpu_interleave()
+{
+    return min( CBATCHED_CPU_INTERLEAVE, BATCHED_CPU_MAX_INTERLEAVE_N );
+}
+
+/// @see magma_get_zbatched_cpu_interleave
+magma_int_t magma_get_dbatched_cpu_interleave()
+{
+    return min( DBATCHED_CPU_INTERLEAVE, BATCHED_CPU_MAX_INTERLEAVE_N );
+}
+
+/// @see magma_get_zbatched_cpu_interleave
+magma_int_t magma_get_sbatched_cpu_interleave()
+{
+    return min( SBATCHED_CPU_INTERLEAVE, BATCHED_CPU_MAX_INTERLEAVE_N );
+}
+
+// =============================================================================
+/// @}
+// end group magma_tuning
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
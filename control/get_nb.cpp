@@ -25,6 +25,9 @@ extern "C" {
 /// Optimal block sizes vary with GPU and, to a lesser extent, CPU.
 /// Kepler tuning was on K20c   705 MHz with SandyBridge 2.6 GHz host (bunsen).
 /// Fermi  tuning was on S2050 1147 MHz with AMD Opteron 2.4 GHz host (romulus).
+/// Block sizes tuned on the current machine override these tables for
+/// potrf, geqrf, geqlf, gelqf, getrf, gehrd, gebrd, and getri;
+/// see magma_tuning_get_nb in get_nb_tuning.cpp.
 /// @{
 
 
@@ -47,7 +50,7 @@ magma_int_t magma_get_spotrf_nb( magma_int_t n )
         else if (n <  4256) nb = 224;
         else                nb = 288;
     }
-    return nb;
+    return magma_tuning_get_nb( "spotrf", n, nb );
 }
 
 /// @return nb for dpotrf based on n
@@ -68,7 +71,7 @@ magma_int_t magma_get_dpotrf_nb( magma_int_t n )
         else if (n <  4256) nb = 128;
         else                nb = 256;
     }
-    return nb;
+    return magma_tuning_get_nb( "dpotrf", n, nb );
 }
 
 /// @return nb for cpotrf based on n
@@ -86,7 +89,7 @@ magma_int_t magma_get_cpotrf_nb( magma_int_t n )
     else {                     // 1.x
         nb = 64;
     }
-    return nb;
+    return magma_tuning_get_nb( "cpotrf", n, nb );
 }
 
 /// @return nb for zpotrf based on n
@@ -104,7 +107,7 @@ magma_int_t magma_get_zpotrf_nb( magma_int_t n )
     else {                     // 1.x
         nb = 64;
     }
-    return nb;
+    return magma_tuning_get_nb( "zpotrf", n, nb );
 }
 
 
@@ -183,7 +186,7 @@ magma_int_t magma_get_sgeqrf_nb( magma_int_t m, magma_int_t n )
         else if (minmn <  4096) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "sgeqrf", minmn, nb );
 }
 
 /// @return nb for dgeqrf based on m, n
@@ -202,7 +205,7 @@ magma_int_t magma_get_dgeqrf_nb( magma_int_t m, magma_int_t n )
         if      (minmn <  4096) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "dgeqrf", minmn, nb );
 }
 
 /// @return nb for cgeqrf based on m, n
@@ -220,7 +223,7 @@ magma_int_t magma_get_cgeqrf_nb( magma_int_t m, magma_int_t n )
         else if (minmn <  4096) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "cgeqrf", minmn, nb );
 }
 
 /// @return nb for zgeqrf based on m, n
@@ -242,7 +245,7 @@ magma_int_t magma_get_zgeqrf_nb( magma_int_t m, magma_int_t n )
         if      (minmn <  1024) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "zgeqrf", minmn, nb );
 }
 
 
@@ -261,7 +264,7 @@ magma_int_t magma_get_sgeqlf_nb( magma_int_t m, magma_int_t n )
         else if (minmn <  4032) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "sgeqlf", minmn, nb );
 }
 
 /// @return nb for dgeqlf based on m, n
@@ -278,7 +281,7 @@ magma_int_t magma_get_dgeqlf_nb( magma_int_t m, magma_int_t n )
         else if (minmn <  4032) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "dgeqlf", minmn, nb );
 }
 
 /// @return nb for cgeqlf based on m, n
@@ -289,7 +292,7 @@ magma_int_t magma_get_cgeqlf_nb( magma_int_t m, magma_int_t n )
     if      (minmn <  2048) nb = 32;
     else if (minmn <  4032) nb = 64;
     else                    nb = 128;
-    return nb;
+    return magma_tuning_get_nb( "cgeqlf", minmn, nb );
 }
 
 /// @return nb for zgeqlf based on m, n
@@ -299,7 +302,7 @@ magma_int_t magma_get_zgeqlf_nb( magma_int_t m, magma_int_t n )
     magma_int_t minmn = min( m, n );
     if      (minmn <  1024) nb = 64;
     else                    nb = 128;
-    return nb;
+    return magma_tuning_get_nb( "zgeqlf", minmn, nb );
 }
 
 
@@ -307,7 +310,7 @@ magma_int_t magma_get_zgeqlf_nb( magma_int_t m, magma_int_t n )
 /// @return nb for sgelqf based on m, n
 magma_int_t magma_get_sgelqf_nb( magma_int_t m, magma_int_t n )
 {
-    return magma_get_sgeqrf_nb( m, n );
+    return magma_tuning_get_nb( "sgelqf", min( m, n ), magma_get_sgeqrf_nb( m, n ) );
 }
 
 /// @return nb for dgelqf based on m, n
@@ -324,7 +327,7 @@ magma_int_t magma_get_dgelqf_nb( magma_int_t m, magma_int_t n )
         else if (minmn <  4032) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "dgelqf", minmn, nb );
 }
 
 /// @return nb for cgelqf based on m, n
@@ -335,7 +338,7 @@ magma_int_t magma_get_cgelqf_nb( magma_int_t m, magma_int_t n )
     if      (minmn <  2048) nb = 32;
     else if (minmn <  4032) nb = 64;
     else                    nb = 128;
-    return nb;
+    return magma_tuning_get_nb( "cgelqf", minmn, nb );
 }
 
 /// @return nb for zgelqf based on m, n
@@ -345,7 +348,7 @@ magma_int_t magma_get_zgelqf_nb( magma_int_t m, magma_int_t n )
     magma_int_t minmn = min( m, n );
     if      (minmn <  1024) nb = 64;
     else                    nb = 128;
-    return nb;
+    return magma_tuning_get_nb( "zgelqf", minmn, nb );
 }
 
 /******************************************************************************/
@@ -647,7 +650,7 @@ magma_int_t magma_get_sgetrf_nb( magma_int_t m, magma_int_t n )
         if      (minmn <  2048) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "sgetrf", minmn, nb );
 }
 
 /// @return nb for dgetrf based on m, n
@@ -671,7 +674,7 @@ magma_int_t magma_get_dgetrf_nb( magma_int_t m, magma_int_t n )
         if      (minmn <  2048) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "dgetrf", minmn, nb );
 }
 
 /// @return nb for cgetrf based on m, n
@@ -693,7 +696,7 @@ magma_int_t magma_get_cgetrf_nb( magma_int_t m, magma_int_t n )
         if      (minmn <  2048) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "cgetrf", minmn, nb );
 }
 
 /// @return nb for zgetrf based on m, n
@@ -714,7 +717,7 @@ magma_int_t magma_get_zgetrf_nb( magma_int_t m, magma_int_t n )
     else {                     // 1.x
         nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "zgetrf", minmn, nb );
 }
 
 
@@ -740,7 +743,7 @@ magma_int_t magma_get_sgetrf_native_nb( magma_int_t m, magma_int_t n )
         if      (minmn <  2048) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "sgetrf_native", minmn, nb );
 }
 
 /// @return nb for native dgetrf based on m, n
@@ -764,7 +767,7 @@ magma_int_t magma_get_dgetrf_native_nb( magma_int_t m, magma_int_t n )
         if      (minmn <  2048) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "dgetrf_native", minmn, nb );
 }
 
 /// @return nb for native cgetrf based on m, n
@@ -786,7 +789,7 @@ magma_int_t magma_get_cgetrf_native_nb( magma_int_t m, magma_int_t n )
         if      (minmn <  2048) nb = 64;
         else                    nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "cgetrf_native", minmn, nb );
 }
 
 /// @return nb for native zgetrf based on m, n
@@ -809,7 +812,7 @@ magma_int_t magma_get_zgetrf_native_nb( magma_int_t m, magma_int_t n )
     else {                     // 1.x
         nb = 128;
     }
-    return nb;
+    return magma_tuning_get_nb( "zgetrf_native", minmn, nb );
 }
 
 
@@ -827,7 +830,7 @@ magma_int_t magma_get_sgehrd_nb( magma_int_t n )
         if      (n <  1024) nb = 32;
         else                nb = 64;
     }
-    return nb;
+    return magma_tuning_get_nb( "sgehrd", n, nb );
 }
 
 /// @return nb for dgehrd based on n
@@ -836,7 +839,7 @@ magma_int_t magma_get_dgehrd_nb( magma_int_t n )
     magma_int_t nb;
     if      (n <  2048) nb = 32;
     else                nb = 64;
-    return nb;
+    return magma_tuning_get_nb( "dgehrd", n, nb );
 }
 
 /// @return nb for cgehrd based on n
@@ -845,7 +848,7 @@ magma_int_t magma_get_cgehrd_nb( magma_int_t n )
     magma_int_t nb;
     if      (n <  1024) nb = 32;
     else                nb = 64;
-    return nb;
+    return magma_tuning_get_nb( "cgehrd", n, nb );
 }
 
 /// @return nb for zgehrd based on n
@@ -854,7 +857,7 @@ magma_int_t magma_get_zgehrd_nb( magma_int_t n )
     magma_int_t nb;
     if      (n <  2048) nb = 32;
     else                nb = 64;
-    return nb;
+    return magma_tuning_get_nb( "zgehrd", n, nb );
 }
 
 
@@ -968,25 +971,25 @@ magma_int_t magma_get_ssytrf_nopiv_nb( magma_int_t n )
 /// @return nb for sgebrd based on m, n
 magma_int_t magma_get_sgebrd_nb( magma_int_t m, magma_int_t n )
 {
-    return 32;
+    return magma_tuning_get_nb( "sgebrd", min( m, n ), 32 );
 }
 
 /// @return nb for dgebrd based on m, n
 magma_int_t magma_get_dgebrd_nb( magma_int_t m, magma_int_t n )
 {
-    return 32;
+    return magma_tuning_get_nb( "dgebrd", min( m, n ), 32 );
 }
 
 /// @return nb for cgebrd based on m, n
 magma_int_t magma_get_cgebrd_nb( magma_int_t m, magma_int_t n )
 {
-    return 32;
+    return magma_tuning_get_nb( "cgebrd", min( m, n ), 32 );
 }
 
 /// @return nb for zgebrd based on m, n
 magma_int_t magma_get_zgebrd_nb( magma_int_t m, magma_int_t n )
 {
-    return 32;
+    return magma_tuning_get_nb( "zgebrd", min( m, n ), 32 );
 }
 
 
@@ -1068,25 +1071,25 @@ magma_int_t magma_get_zhegst_nb( magma_int_t n )
 /// @return nb for sgetri based on n
 magma_int_t magma_get_sgetri_nb( magma_int_t n )
 {
-    return 64;
+    return magma_tuning_get_nb( "sgetri", n, 64 );
 }
 
 /// @return nb for dgetri based on n
 magma_int_t magma_get_dgetri_nb( magma_int_t n )
 {
-    return 64;
+    return magma_tuning_get_nb( "dgetri", n, 64 );
 }
 
 /// @return nb for cgetri based on n
 magma_int_t magma_get_cgetri_nb( magma_int_t n )
 {
-    return 64;
+    return magma_tuning_get_nb( "cgetri", n, 64 );
 }
 
 /// @return nb for zgetri based on n
 magma_int_t magma_get_zgetri_nb( magma_int_t n )
 {
-    return 64;
+    return magma_tuning_get_nb( "zgetri", n, 64 );
 }
 
 
@@ -0,0 +1,310 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+*/
+
+#include <stdlib.h>  // getenv
+#include <string.h>
+#include <errno.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "magma_internal.h"
+
+// Version of the tuning file format, written in its first line.
+#define MAGMA_TUNING_VERSION 1
+
+// size_max for a band without upper bound; written as "inf".
+#define MAGMA_TUNING_INF -1
+
+
+/******************************************************************************/
+// Tuned block sizes. For each routine, bands sorted by upper bound;
+// a size uses the first band with size < size_max.
+
+namespace {
+
+struct tuning_band
+{
+    magma_int_t size_max;
+    magma_int_t nb;
+};
+
+typedef std::map< std::string, std::vector< tuning_band > > tuning_table;
+
+tuning_table       g_tuning;
+pthread_mutex_t    g_tuning_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_once_t     g_tuning_once  = PTHREAD_ONCE_INIT;
+std::atomic< int > g_tuning_nbands( 0 );  // lets lookups skip the lock if empty
+
+
+// -----------------------------------------------------------------------------
+bool band_less( const tuning_band& a, const tuning_band& b )
+{
+    if ( a.size_max == MAGMA_TUNING_INF ) return false;
+    if ( b.size_max == MAGMA_TUNING_INF ) return true;
+    return a.size_max < b.size_max;
+}
+
+
+// -----------------------------------------------------------------------------
+// Adds or replaces band. Caller holds g_tuning_mutex.
+void tuning_set( const std::string& routine, magma_int_t size_max, magma_int_t nb )
+{
+    std::vector< tuning_band >& bands = g_tuning[ routine ];
+    tuning_band band = { size_max, nb };
+    for( size_t i = 0; i < bands.size(); ++i ) {
+        if ( bands[i].size_max == size_max ) {
+            bands[i].nb = nb;
+            return;
+        }
+    }
+    std::vector< tuning_band >::iterator it = bands.begin();
+    while ( it != bands.end() && band_less( *it, band )) {
+        ++it;
+    }
+    bands.insert( it, band );
+    g_tuning_nbands += 1;
+}
+
+
+// -----------------------------------------------------------------------------
+void tuning_load_env()
+{
+    const char* filename = getenv( "MAGMA_TUNING_FILE" );
+    if ( filename != NULL && filename[0] != '\0' ) {
+        magma_tuning_load( filename );
+    }
+}
+
+}  // namespace
+
+
+// =============================================================================
+/// @addtogroup magma_tuning
+/// Block sizes tuned on the current machine, e.g., by testing_ztune_nb,
+/// override the tables in get_nb.cpp. They are read from the file named by
+/// the environment variable MAGMA_TUNING_FILE, when the first block size
+/// is queried. The file is text:
+///
+///     # comments start with #
+///     magma_tuning 1          version of the format
+///     arch 800                optional; file is ignored on other GPU architectures
+///     dgetrf  2048   64       routine, size < 2048 uses nb = 64
+///     dgetrf  8192  256
+///     dgetrf  inf   512       all larger sizes
+///
+/// The size is the one the table in get_nb.cpp uses, i.e., n or min(m, n).
+/// Routines not in the file use the tables.
+/// @{
+
+/******************************************************************************/
+/// Reads tuned block sizes from a file, replacing bands with the same
+/// routine and upper bound. Can be called several times.
+/// @return MAGMA_SUCCESS, MAGMA_ERR_NOT_FOUND if file can't be opened,
+///         or MAGMA_ERR if the file is invalid (nothing is loaded then).
+extern "C"
+magma_int_t magma_tuning_load( const char* filename )
+{
+    char line[ 1024 ], routine[ 64 ], size[ 32 ];
+    long long nb, version = -1, arch = -1;
+    std::vector< std::pair< std::string, tuning_band > > bands;
+    magma_int_t info = MAGMA_SUCCESS;
+
+    FILE* file = fopen( filename, "r" );
+    if ( file == NULL ) {
+        fprintf( stderr, "Can't open tuning file '%s': %s (%d)\n",
+                 filename, strerror( errno ), errno );
+        return MAGMA_ERR_NOT_FOUND;
+    }
+    int lineno = 0;
+    while ( fgets( line, sizeof(line), file ) != NULL ) {
+        lineno += 1;
+        char* comment = strchr( line, '#' );
+        if ( comment != NULL ) {
+            *comment = '\0';
+        }
+        int n = sscanf( line, "%63s %31s %lld", routine, size, &nb );
+        if ( n <= 0 ) {
+            continue;  // blank line
+        }
+        if ( version < 0 ) {
+            if ( n != 2 || strcmp( routine, "magma_tuning" ) != 0 ) {
+                info = MAGMA_ERR;
+                break;
+            }
+            version = atoll( size );
+            if ( version != MAGMA_TUNING_VERSION ) {
+                fprintf( stderr, "Tuning file '%s' has version %lld; expected %d\n",
+                         filename, version, MAGMA_TUNING_VERSION );
+                info = MAGMA_ERR;
+                break;
+            }
+        }
+        else if ( n == 2 && strcmp( routine, "arch" ) == 0 ) {
+            arch = atoll( size );
+        }
+        else if ( n == 3 && nb > 0 ) {
+            tuning_band band;
+            band.nb = nb;
+            if ( strcmp( size, "inf" ) == 0 ) {
+                band.size_max = MAGMA_TUNING_INF;
+            }
+            else {
+                char* end;
+                band.size_max = strtoll( size, &end, 10 );
+                if ( *end != '\0' || band.size_max <= 0 ) {
+                    info = MAGMA_ERR;
+                    break;
+                }
+            }
+            bands.push_back( std::make_pair( std::string( routine ), band ));
+        }
+        else {
+            info = MAGMA_ERR;
+            break;
+        }
+    }
+    fclose( file );
+
+    if ( info == MAGMA_SUCCESS && version < 0 ) {
+        info = MAGMA_ERR;  // empty file
+    }
+    if ( info != MAGMA_SUCCESS ) {
+        fprintf( stderr, "Invalid tuning file '%s', line %d; using default block sizes\n",
+                 filename, lineno );
+        return info;
+    }
+    if ( arch >= 0 && arch != magma_getdevice_arch() ) {
+        fprintf( stderr, "Tuning file '%s' is for arch %lld, not %lld; using default block sizes\n",
+                 filename, arch, (long long) magma_getdevice_arch() );
+        return MAGMA_ERR;
+    }
+
+    pthread_mutex_lock( &g_tuning_mutex );
+    for( size_t i = 0; i < bands.size(); ++i ) {
+        tuning_set( bands[i].first, bands[i].second.size_max, bands[i].second.nb );
+    }
+    pthread_mutex_unlock( &g_tuning_mutex );
+    return MAGMA_SUCCESS;
+}
+
+
+/******************************************************************************/
+/// Writes all tuned block sizes, including ones loaded from a file,
+/// in the format read by magma_tuning_load.
+/// @return MAGMA_SUCCESS, or MAGMA_ERR if file can't be written.
+extern "C"
+magma_int_t magma_tuning_save( const char* filename )
+{
+    pthread_once( &g_tuning_once, tuning_load_env );
+
+    FILE* file = fopen( filename, "w" );
+    if ( file == NULL ) {
+        fprintf( stderr, "Can't open tuning file '%s': %s (%d)\n",
+                 filename, strerror( errno ), errno );
+        return MAGMA_ERR;
+    }
+    magma_int_t major, minor, micro;
+    magma_version( &major, &minor, &micro );
+    fprintf( file, "# MAGMA %lld.%lld.%lld block sizes\n",
+             (long long) major, (long long) minor, (long long) micro );
+    fprintf( file, "magma_tuning %d\n", MAGMA_TUNING_VERSION );
+    fprintf( file, "arch %lld\n", (long long) magma_getdevice_arch() );
+    fprintf( file, "%-12s %8s %6s\n", "# routine", "size <", "nb" );
+
+    pthread_mutex_lock( &g_tuning_mutex );
+    for( tuning_table::const_iterator it = g_tuning.begin(); it != g_tuning.end(); ++it ) {
+        const std::vector< tuning_band >& bands = it->second;
+        for( size_t i = 0; i < bands.size(); ++i ) {
+            if ( bands[i].size_max == MAGMA_TUNING_INF ) {
+                fprintf( file, "%-12s %8s %6lld\n", it->first.c_str(), "inf",
+                         (long long) bands[i].nb );
+            }
+            else {
+                fprintf( file, "%-12s %8lld %6lld\n", it->first.c_str(),
+                         (long long) bands[i].size_max, (long long) bands[i].nb );
+            }
+        }
+    }
+    pthread_mutex_unlock( &g_tuning_mutex );
+
+    if ( fclose( file ) != 0 ) {
+        return MAGMA_ERR;
+    }
+    return MAGMA_SUCCESS;
+}
+
+
+/******************************************************************************/
+/// Sets block size nb for routine (e.g., "dgetrf") and sizes below size_max,
+/// or all sizes above the previous band if size_max < 0.
+extern "C"
+void magma_tuning_set_nb( const char* routine, magma_int_t size_max, magma_int_t nb )
+{
+    pthread_once( &g_tuning_once, tuning_load_env );
+
+    pthread_mutex_lock( &g_tuning_mutex );
+    tuning_set( routine, (size_max < 0 ? MAGMA_TUNING_INF : size_max), nb );
+    pthread_mutex_unlock( &g_tuning_mutex );
+}
+
+
+/******************************************************************************/
+/// Removes tuned block sizes for routine, or for all routines if NULL,
+/// so the tables in get_nb.cpp are used again.
+extern "C"
+void magma_tuning_clear( const char* routine )
+{
+    pthread_once( &g_tuning_once, tuning_load_env );
+
+    pthread_mutex_lock( &g_tuning_mutex );
+    if ( routine == NULL ) {
+        g_tuning.clear();
+        g_tuning_nbands = 0;
+    }
+    else {
+        tuning_table::iterator it = g_tuning.find( routine );
+        if ( it != g_tuning.end() ) {
+            g_tuning_nbands -= (int) it->second.size();
+            g_tuning.erase( it );
+        }
+    }
+    pthread_mutex_unlock( &g_tuning_mutex );
+}
+
+
+/******************************************************************************/
+/// @return tuned block size for routine and size, or nb if none is tuned.
+/// Called by the magma_get_*_nb functions with the nb from their tables.
+extern "C"
+magma_int_t magma_tuning_get_nb( const char* routine, magma_int_t size, magma_int_t nb )
+{
+    pthread_once( &g_tuning_once, tuning_load_env );
+    if ( g_tuning_nbands.load() == 0 ) {
+        return nb;
+    }
+
+    pthread_mutex_lock( &g_tuning_mutex );
+    tuning_table::const_iterator it = g_tuning.find( routine );
+    if ( it != g_tuning.end() ) {
+        const std::vector< tuning_band >& bands = it->second;
+        for( size_t i = 0; i < bands.size(); ++i ) {
+            if ( bands[i].size_max == MAGMA_TUNING_INF || size < bands[i].size_max ) {
+                nb = bands[i].nb;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock( &g_tuning_mutex );
+    return nb;
+}
+
+/// @}
+// end group magma_tuning
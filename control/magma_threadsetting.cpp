@@ -22,6 +22,10 @@
 #include <hwloc.h>
 #endif
 
+#ifndef MAGMA_NOAFFINITY
+#include "affinity.h"
+#endif
+
 
 /***************************************************************************//**
     Purpose
@@ -245,3 +249,39 @@ void magma_set_omp_numthreads(magma_int_t threads)
     omp_set_num_threads( threads );
 #endif
 }
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Pins OpenMP threads with the same placement as threads created by MAGMA,
+    i.e., OpenMP thread i runs on the CPU of MAGMA thread i, if the
+    environment variable MAGMA_AFFINITY is set to cores, compact, or scatter.
+    Does nothing if MAGMA_AFFINITY is not set or is none, or if OMP_PROC_BIND
+    is set, so the OpenMP runtime's own binding takes precedence.
+    The calling thread is OpenMP thread 0, so it is pinned, too.
+    Called by magma_init.
+
+    @sa magma_get_parallel_numthreads
+    @ingroup magma_thread
+*******************************************************************************/
+extern "C"
+void magma_set_omp_affinity()
+{
+#if defined(_OPENMP) && ! defined(MAGMA_NOAFFINITY)
+    const char* policy = getenv( "MAGMA_AFFINITY" );
+    if ( policy == NULL || getenv( "OMP_PROC_BIND" ) != NULL ) {
+        return;
+    }
+    if ( magma_affinity_policy() == MagmaAffinityNone ) {
+        return;
+    }
+    #pragma omp parallel
+    {
+        affinity_set set;
+        if ( set.add_thread( omp_get_thread_num() )) {
+            set.set_affinity();
+        }
+    }
+#endif
+}
@@ -23,6 +23,7 @@ void magma_set_lapack_numthreads(magma_int_t numthreads);
 magma_int_t magma_get_lapack_numthreads();
 magma_int_t magma_get_parallel_numthreads();
 magma_int_t magma_get_omp_numthreads();
+void magma_set_omp_affinity();
 
 #ifdef __cplusplus
 }
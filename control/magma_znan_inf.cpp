@@ -15,6 +15,9 @@
 
 #define COMPLEX
 
+// real components of one value
+#define NCOMP ( sizeof(magmaDoubleComplex) / sizeof(double) )
+
 
 const magmaDoubleComplex MAGMA_Z_NAN
     = MAGMA_Z_MAKE( std::numeric_limits<double>::quiet_NaN(),
@@ -75,6 +78,201 @@ int magma_z_isnan_inf( magmaDoubleComplex x )
 }
 
 
+/******************************************************************************/
+// Counts and norms of the finite values of (part of) a matrix.
+// The Frobenius norm is scale*sqrt(sumsq), as in LAPACK's zlassq.
+struct magma_znan_inf_stats
+{
+    magma_int_t c_nan;
+    magma_int_t c_inf;
+    double amax;
+    double scale;
+    double sumsq;
+};
+
+
+/******************************************************************************/
+// Adds scale2^2*sumsq2 to the sum of squares in s.
+static void magma_znan_inf_ssq(
+    magma_znan_inf_stats *s, double scale2, double sumsq2 )
+{
+    if (scale2 == 0 || sumsq2 == 0)
+        return;
+    if (s->scale >= scale2) {
+        double r = scale2 / s->scale;
+        s->sumsq += sumsq2 * r * r;
+    }
+    else {
+        double r = s->scale / scale2;
+        s->sumsq = sumsq2 + s->sumsq * r * r;
+        s->scale = scale2;
+    }
+}
+
+
+/******************************************************************************/
+// Adds the values x[0:len) to s.
+// The column is first screened with a branch-free loop that vectorizes:
+// x*0 is 0 for finite x, and NAN for NAN or INF, so the sum of x*0 is
+// nonzero exactly if the column has a NAN or INF. If norms is true, the same
+// loop accumulates the squares of the values. Only columns with a NAN or INF,
+// or whose squares could over- or underflow (largest square above big2 or
+// below small2, which includes zero columns), are classified and summed
+// value by value, with scaling.
+template< bool norms >
+static void magma_znan_inf_col(
+    magma_int_t len, const magmaDoubleComplex *x,
+    magma_znan_inf_stats *s, double big2, double small2 )
+{
+    const double *r = (const double*) x;
+    double nonfinite = 0, sumsq = 0, amax2 = 0;
+
+    if (norms) {
+        #pragma omp simd reduction(+:nonfinite, sumsq) reduction(max:amax2)
+        for (magma_int_t i = 0; i < len; ++i) {
+            #ifdef COMPLEX
+            double re = r[ 2*i ];
+            double im = r[ 2*i + 1 ];
+            double sq = re*re + im*im;
+            nonfinite += (re + im) * 0.0;  // also if re + im overflows
+            #else
+            double sq = r[i]*r[i];
+            nonfinite += r[i] * 0.0;
+            #endif
+            sumsq += sq;
+            amax2 = max( amax2, sq );
+        }
+    }
+    else {
+        #pragma omp simd reduction(+:nonfinite)
+        for (magma_int_t i = 0; i < (magma_int_t) NCOMP*len; ++i) {
+            nonfinite += r[i] * 0.0;
+        }
+    }
+
+    if (nonfinite == 0
+        && (! norms || (amax2 <= big2 && amax2 >= small2))) {
+        if (norms) {
+            s->amax = max( s->amax, sqrt( amax2 ));
+            magma_znan_inf_ssq( s, 1, sumsq );
+        }
+        return;
+    }
+
+    double scale = 0, ssq = 1;
+    for (magma_int_t i = 0; i < len; ++i) {
+        if (magma_z_isnan( x[i] )) {
+            s->c_nan += 1;
+        }
+        else if (magma_z_isinf( x[i] )) {
+            s->c_inf += 1;
+        }
+        else if (norms) {
+            s->amax = max( s->amax, MAGMA_Z_ABS( x[i] ));
+            for (magma_int_t c = 0; c < (magma_int_t) NCOMP; ++c) {
+                double a = fabs( r[ NCOMP*i + c ] );
+                if (a == 0)
+                    continue;
+                if (scale < a) {
+                    ssq = 1 + ssq * (scale/a) * (scale/a);
+                    scale = a;
+                }
+                else {
+                    ssq += (a/scale) * (a/scale);
+                }
+            }
+        }
+    }
+    if (norms) {
+        magma_znan_inf_ssq( s, scale, ssq );
+    }
+}
+
+
+/******************************************************************************/
+// Scans the uplo part of A in parallel over columns. If any is true, the scan
+// stops early once a NAN or INF is found, so the counts are only a lower bound.
+template< bool norms >
+static void magma_znan_inf_scan(
+    magma_uplo_t uplo, magma_int_t m, magma_int_t n,
+    const magmaDoubleComplex *A, magma_int_t lda,
+    bool any, magma_znan_inf_stats *total )
+{
+    #define A(i_, j_) (A + (i_) + (j_)*lda)
+
+    // bounds on the squares keep the sum of all squares within range
+    double big2   = lapackf77_dlamch("Overflow") / (2.0 * max( 1, m ) * max( 1, n ));
+    double small2 = lapackf77_dlamch("Safe minimum");
+
+    total->c_nan = 0;
+    total->c_inf = 0;
+    total->amax  = 0;
+    total->scale = 0;
+    total->sumsq = 0;
+
+    int found = 0;
+
+    #pragma omp parallel
+    {
+        magma_znan_inf_stats s = { 0, 0, 0, 0, 0 };
+
+        #pragma omp for schedule(dynamic, 16) nowait
+        for (magma_int_t j = 0; j < n; ++j) {
+            if (any) {
+                int f;
+                #pragma omp atomic read
+                f = found;
+                if (f)
+                    continue;
+            }
+            magma_int_t ilo = 0, ihi = m;
+            if (uplo == MagmaLower)
+                ilo = min( j, m );       // i >= j
+            else if (uplo == MagmaUpper)
+                ihi = min( j+1, m );     // i <= j
+            magma_znan_inf_col< norms >( ihi - ilo, A(ilo, j), &s, big2, small2 );
+            if (any && s.c_nan + s.c_inf > 0) {
+                #pragma omp atomic write
+                found = 1;
+            }
+        }
+
+        #pragma omp critical (magma_znan_inf)
+        {
+            total->c_nan += s.c_nan;
+            total->c_inf += s.c_inf;
+            total->amax = max( total->amax, s.amax );
+            magma_znan_inf_ssq( total, s.scale, s.sumsq );
+        }
+    }
+
+    #undef A
+}
+
+
+/******************************************************************************/
+// checks the arguments common to the CPU scanners
+static magma_int_t magma_znan_inf_check(
+    const char* func,
+    magma_uplo_t uplo, magma_int_t m, magma_int_t n, magma_int_t lda )
+{
+    magma_int_t info = 0;
+    if (uplo != MagmaLower && uplo != MagmaUpper && uplo != MagmaFull)
+        info = -1;
+    else if (m < 0)
+        info = -2;
+    else if (n < 0)
+        info = -3;
+    else if (lda < m)
+        info = -5;
+
+    if (info != 0) {
+        magma_xerbla( func, -(info) );
+    }
+    return info;
+}
+
+
 /***************************************************************************//**
     Purpose
     -------
@@ -84,6 +282,9 @@ int magma_z_isnan_inf( magmaDoubleComplex x )
     NAN is created by 0/0 and similar.
     INF is created by x/0 and similar, where x != 0.
 
+    Columns are scanned in parallel; only columns that have a NAN or INF
+    are classified value by value.
+
     Arguments
     ---------
     @param[in]
@@ -131,55 +332,157 @@ magma_int_t magma_znan_inf(
     magma_int_t *cnt_nan,
     magma_int_t *cnt_inf )
 {
-    #define A(i_, j_) (A + (i_) + (j_)*lda)
-    
-    magma_int_t info = 0;
-    if (uplo != MagmaLower && uplo != MagmaUpper && uplo != MagmaFull)
-        info = -1;
-    else if (m < 0)
-        info = -2;
-    else if (n < 0)
-        info = -3;
-    else if (lda < m)
-        info = -5;
-    
+    magma_int_t info = magma_znan_inf_check( __func__, uplo, m, n, lda );
     if (info != 0) {
-        magma_xerbla( __func__, -(info) );
         return info;
     }
-    
-    int c_nan = 0;
-    int c_inf = 0;
-    
-    if (uplo == MagmaLower) {
-        for (int j = 0; j < n; ++j) {
-            for (int i = j; i < m; ++i) {  // i >= j
-                if      (magma_z_isnan( *A(i,j) )) { c_nan++; }
-                else if (magma_z_isinf( *A(i,j) )) { c_inf++; }
-            }
-        }
-    }
-    else if (uplo == MagmaUpper) {
-        for (int j = 0; j < n; ++j) {
-            for (int i = 0; i < m && i <= j; ++i) {  // i <= j
-                if      (magma_z_isnan( *A(i,j) )) { c_nan++; }
-                else if (magma_z_isinf( *A(i,j) )) { c_inf++; }
-            }
-        }
+
+    magma_znan_inf_stats s;
+    magma_znan_inf_scan< false >( uplo, m, n, A, lda, false, &s );
+
+    if (cnt_nan != NULL) { *cnt_nan = s.c_nan; }
+    if (cnt_inf != NULL) { *cnt_inf = s.c_inf; }
+
+    return (s.c_nan + s.c_inf);
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    magma_znan_inf_any checks whether a matrix that is located on the CPU
+    host has any NAN (not-a-number) or INF (infinity) value. The scan stops
+    as soon as one is found.
+
+    Arguments
+    ---------
+    @param[in]
+    uplo    magma_uplo_t
+            Specifies what part of the matrix A to check.
+      -     = MagmaUpper:  Upper triangular part of A
+      -     = MagmaLower:  Lower triangular part of A
+      -     = MagmaFull:   All of A
+
+    @param[in]
+    m       INTEGER
+            The number of rows of the matrix A. m >= 0.
+
+    @param[in]
+    n       INTEGER
+            The number of columns of the matrix A. n >= 0.
+
+    @param[in]
+    A       COMPLEX_16 array, dimension (lda,n), on the CPU host.
+            The m-by-n matrix to be checked.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of the array A. lda >= m.
+
+    @return
+      -     = 1:   A has a NAN or INF value.
+      -     = 0:   All values of A are finite.
+      -     <  0:  If it returns -i, the i-th argument had an illegal value.
+
+    @ingroup magma_nan_inf
+*******************************************************************************/
+extern "C"
+magma_int_t magma_znan_inf_any(
+    magma_uplo_t uplo, magma_int_t m, magma_int_t n,
+    const magmaDoubleComplex *A, magma_int_t lda )
+{
+    magma_int_t info = magma_znan_inf_check( __func__, uplo, m, n, lda );
+    if (info != 0) {
+        return info;
     }
-    else if (uplo == MagmaFull) {
-        for (int j = 0; j < n; ++j) {
-            for (int i = 0; i < m; ++i) {
-                if      (magma_z_isnan( *A(i,j) )) { c_nan++; }
-                else if (magma_z_isinf( *A(i,j) )) { c_inf++; }
-            }
-        }
+
+    magma_znan_inf_stats s;
+    magma_znan_inf_scan< false >( uplo, m, n, A, lda, true, &s );
+
+    return (s.c_nan + s.c_inf > 0);
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    magma_znan_inf_norm checks a matrix that is located on the CPU host
+    for NAN (not-a-number) and INF (infinity) values, as magma_znan_inf,
+    and computes the max-abs and Frobenius norms of its finite values in
+    the same pass over the matrix.
+
+    Arguments
+    ---------
+    @param[in]
+    uplo    magma_uplo_t
+            Specifies what part of the matrix A to check.
+      -     = MagmaUpper:  Upper triangular part of A
+      -     = MagmaLower:  Lower triangular part of A
+      -     = MagmaFull:   All of A
+
+    @param[in]
+    m       INTEGER
+            The number of rows of the matrix A. m >= 0.
+
+    @param[in]
+    n       INTEGER
+            The number of columns of the matrix A. n >= 0.
+
+    @param[in]
+    A       COMPLEX_16 array, dimension (lda,n), on the CPU host.
+            The m-by-n matrix to be checked.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of the array A. lda >= m.
+
+    @param[out]
+    cnt_nan INTEGER*
+            If non-NULL, on exit contains the number of NAN values in A.
+
+    @param[out]
+    cnt_inf INTEGER*
+            If non-NULL, on exit contains the number of INF values in A.
+
+    @param[out]
+    norm_max DOUBLE PRECISION*
+            If non-NULL, on exit contains max( abs( A(i,j) )) over the
+            finite values of A, as zlange( "M" ) for a finite A.
+
+    @param[out]
+    norm_fro DOUBLE PRECISION*
+            If non-NULL, on exit contains the Frobenius norm of the finite
+            values of A, as zlange( "F" ) for a finite A.
+
+    @return
+      -     >= 0:  Returns number of NAN + number of INF values.
+      -     <  0:  If it returns -i, the i-th argument had an illegal value.
+
+    @ingroup magma_nan_inf
+*******************************************************************************/
+extern "C"
+magma_int_t magma_znan_inf_norm(
+    magma_uplo_t uplo, magma_int_t m, magma_int_t n,
+    const magmaDoubleComplex *A, magma_int_t lda,
+    magma_int_t *cnt_nan,
+    magma_int_t *cnt_inf,
+    double *norm_max,
+    double *norm_fro )
+{
+    magma_int_t info = magma_znan_inf_check( __func__, uplo, m, n, lda );
+    if (info != 0) {
+        return info;
     }
-    
-    if (cnt_nan != NULL) { *cnt_nan = c_nan; }
-    if (cnt_inf != NULL) { *cnt_inf = c_inf; }
-    
-    return (c_nan + c_inf);
+
+    magma_znan_inf_stats s;
+    magma_znan_inf_scan< true >( uplo, m, n, A, lda, false, &s );
+
+    if (cnt_nan  != NULL) { *cnt_nan  = s.c_nan; }
+    if (cnt_inf  != NULL) { *cnt_inf  = s.c_inf; }
+    if (norm_max != NULL) { *norm_max = s.amax; }
+    if (norm_fro != NULL) { *norm_fro = s.scale * sqrt( s.sumsq ); }
+
+    return (s.c_nan + s.c_inf);
 }
 
 
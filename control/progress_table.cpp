@@ -0,0 +1,231 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+*/
+
+#include <new>
+
+#include "progress_table.hpp"
+
+#if defined(linux) || defined(__linux) || defined(__linux__)
+    #define MAGMA_HAVE_FUTEX 1
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <climits>
+#endif
+
+#if defined( _WIN32 ) || defined( _WIN64 )
+    #include <intrin.h>
+#endif
+
+// If err, prints error and throws exception.
+static void check( int err )
+{
+    if ( err != 0 ) {
+        fprintf( stderr, "Error: %s (%d)\n", strerror(err), err );
+        throw std::exception();
+    }
+}
+
+
+/******************************************************************************/
+// tells the core that we are spinning, which saves power and lets the
+// other hardware thread on the core run
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ volatile ("yield" ::: "memory");
+#elif defined( _WIN32 ) || defined( _WIN64 )
+    _mm_pause();
+#endif
+}
+
+
+/***************************************************************************//**
+    @class magma_progress_table
+
+    Purpose
+    -------
+    Replaces the volatile progress arrays polled with magma_yield().
+
+    Each entry sits in its own cache line. set() stores with release
+    semantics and wait() loads with acquire semantics, so data written by
+    the task that set an entry is visible to the threads that waited on it.
+
+    A waiting thread spins with exponentially growing pauses for a bounded
+    time, then parks on a futex (Linux) or a condition variable (elsewhere)
+    until the entry changes. set() only makes a system call if a thread is
+    parked on that entry. Thus short waits cost no system calls, and long
+    waits, e.g., with more threads than cores, do not take CPU time from
+    other threads or processes.
+
+    Time spent spinning and parked is accumulated; see get_stats().
+
+    Example
+    -------
+    @code
+    magma_progress_table prog( ntasks );  // all entries are 0
+
+    // in thread computing task m of sweep s:
+    prog.wait( m-1, s );    // task m-1 of sweep s is done
+    do_task( m, s );
+    prog.set( m, s );
+    @endcode
+
+    @ingroup magma_thread
+*******************************************************************************/
+
+
+/***************************************************************************//**
+    Creates table with in_size entries, all 0.
+    @param[in] in_size    Number of entries.
+*******************************************************************************/
+magma_progress_table::magma_progress_table( magma_int_t in_size ):
+    entries( NULL     ),
+    size   ( in_size  ),
+    spin_ns( 0        ),
+    park_ns( 0        ),
+    nparks ( 0        )
+{
+    // magma_malloc_cpu aligns to 64 bytes, i.e., entries to cache lines
+    if ( magma_malloc_cpu( (void**) &entries, size*sizeof(entry) ) != MAGMA_SUCCESS ) {
+        throw std::bad_alloc();
+    }
+    for( magma_int_t m=0; m < size; ++m ) {
+        entries[m].value   = 0;
+        entries[m].waiters = 0;
+    }
+    check( pthread_mutex_init( &mutex, NULL ));
+    check( pthread_cond_init(  &cond,  NULL ));
+}
+
+
+/***************************************************************************//**
+    Deallocates table. No thread may be waiting.
+*******************************************************************************/
+magma_progress_table::~magma_progress_table()
+{
+    magma_free_cpu( entries );
+    check( pthread_mutex_destroy( &mutex ));
+    check( pthread_cond_destroy( &cond ));
+}
+
+
+/***************************************************************************//**
+    Sets entry m to val and wakes threads parked on it.
+    Writes done before set() are visible to threads returning from wait().
+    @param[in] m      Entry, 0 <= m < size.
+    @param[in] val    New value.
+*******************************************************************************/
+void magma_progress_table::set( magma_int_t m, magma_int_t val )
+{
+    assert( 0 <= m && m < size );
+    entry& e = entries[m];
+    // sequentially consistent, so either this sees the waiter registered
+    // in park(), or the waiter sees the new value before it sleeps
+    e.value.store( (int) val );
+    if ( e.waiters.load() > 0 ) {
+        wake( e );
+    }
+}
+
+
+/***************************************************************************//**
+    Blocks until entry m equals val.
+    @param[in] m      Entry, 0 <= m < size.
+    @param[in] val    Value to wait for.
+*******************************************************************************/
+void magma_progress_table::wait( magma_int_t m, magma_int_t val )
+{
+    const int max_round = 12;  // about 2^12 pauses in total before parking
+
+    assert( 0 <= m && m < size );
+    entry& e = entries[m];
+    int cur = e.value.load( std::memory_order_acquire );
+    if ( cur == (int) val ) {
+        return;
+    }
+
+    // bounded exponential spin
+    real_Double_t start = magma_wtime();
+    for( int round=0; round < max_round; ++round ) {
+        for( int i=0; i < (1 << round); ++i ) {
+            cpu_relax();
+        }
+        cur = e.value.load( std::memory_order_acquire );
+        if ( cur == (int) val ) {
+            spin_ns += (long long) ((magma_wtime() - start) * 1e9);
+            return;
+        }
+    }
+    real_Double_t parked = magma_wtime();
+    spin_ns += (long long) ((parked - start) * 1e9);
+
+    // park until the value changes, then check again
+    nparks += 1;
+    while( cur != (int) val ) {
+        park( e, cur );
+        cur = e.value.load( std::memory_order_acquire );
+    }
+    park_ns += (long long) ((magma_wtime() - parked) * 1e9);
+}
+
+
+/***************************************************************************//**
+    Sleeps while entry e still holds cur. May return spuriously.
+*******************************************************************************/
+void magma_progress_table::park( entry& e, int cur )
+{
+    e.waiters += 1;
+#ifdef MAGMA_HAVE_FUTEX
+    // the kernel checks value == cur atomically with going to sleep
+    if ( e.value.load() == cur ) {
+        syscall( SYS_futex, (int*) &e.value, FUTEX_WAIT_PRIVATE, cur, NULL, NULL, 0 );
+    }
+#else
+    check( pthread_mutex_lock( &mutex ));
+    while( e.value.load() == cur ) {
+        check( pthread_cond_wait( &cond, &mutex ));
+    }
+    check( pthread_mutex_unlock( &mutex ));
+#endif
+    e.waiters -= 1;
+}
+
+
+/***************************************************************************//**
+    Wakes all threads parked on entry e.
+*******************************************************************************/
+void magma_progress_table::wake( entry& e )
+{
+#ifdef MAGMA_HAVE_FUTEX
+    syscall( SYS_futex, (int*) &e.value, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+#else
+    // one condition variable for all entries; threads woken for another
+    // entry check their value and sleep again
+    check( pthread_mutex_lock( &mutex ));
+    check( pthread_cond_broadcast( &cond ));
+    check( pthread_mutex_unlock( &mutex ));
+#endif
+}
+
+
+/***************************************************************************//**
+    Returns time spent in wait(), summed over all threads.
+    @param[out] spin_time    Seconds spent spinning.
+    @param[out] park_time    Seconds spent parked.
+    @param[out] nparks       Number of waits that parked.
+*******************************************************************************/
+void magma_progress_table::get_stats(
+    double* spin_time, double* park_time, magma_int_t* nparks ) const
+{
+    *spin_time = spin_ns.load() * 1e-9;
+    *park_time = park_ns.load() * 1e-9;
+    *nparks    = this->nparks.load();
+}
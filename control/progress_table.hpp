@@ -0,0 +1,57 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+*/
+
+#ifndef MAGMA_PROGRESS_TABLE_HPP
+#define MAGMA_PROGRESS_TABLE_HPP
+
+#include <atomic>
+
+#include "magma_internal.h"
+
+
+/***************************************************************************//**
+    Progress table for statically scheduled multithreaded kernels, such as
+    the bulge chasing in hetrd_hb2st. Entry m holds the last step (e.g.,
+    sweep) finished for task m; threads wait for entries set by other
+    threads.
+    @ingroup magma_thread
+*******************************************************************************/
+class magma_progress_table
+{
+public:
+    magma_progress_table( magma_int_t in_size );
+    ~magma_progress_table();
+
+    void set( magma_int_t m, magma_int_t val );
+    void wait( magma_int_t m, magma_int_t val );
+
+    void get_stats( double* spin_time, double* park_time, magma_int_t* nparks ) const;
+
+private:
+    // one cache line per entry, so setting one entry does not invalidate
+    // the lines other threads are polling
+    struct entry
+    {
+        std::atomic< int >  value;    ///<  int to match the futex word
+        std::atomic< int >  waiters;  ///<  number of threads parked on this entry
+        char                pad[ 64 - 2*sizeof(std::atomic< int >) ];
+    };
+
+    void park( entry& e, int cur );
+    void wake( entry& e );
+
+    entry*                      entries;
+    magma_int_t                 size;
+    std::atomic< long long >    spin_ns;    ///<  time spent spinning before the value was set
+    std::atomic< long long >    park_ns;    ///<  time spent parked
+    std::atomic< magma_int_t >  nparks;     ///<  number of times a thread parked
+    pthread_mutex_t             mutex;      ///<  mutex for cond (where there is no futex)
+    pthread_cond_t              cond;       ///<  condition variable for parked threads (where there is no futex)
+};
+
+#endif        //  #ifndef MAGMA_PROGRESS_TABLE_HPP
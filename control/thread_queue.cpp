@@ -8,8 +8,15 @@
        @author Mark Gates
 */
 
+#include <mutex>
+#include <thread>
+
 #include "thread_queue.hpp"
 
+#ifndef MAGMA_NOAFFINITY
+#include "affinity.h"
+#endif
+
 // If err, prints error and throws exception.
 static void check( int err )
 {
@@ -32,13 +39,25 @@ static void check( int err )
     Typical use:
     A main thread creates the queue and tells it to launch worker threads. Then
     the main thread inserts (pushes) tasks into the queue. Threads will execute
-    the tasks. No dependencies are tracked. The main thread can sync the queue,
-    waiting for all current tasks to finish, and then insert more tasks into the
-    queue. When finished, the main thread calls quit or simply destructs the
-    queue, which will exit all worker threads.
+    the tasks. The main thread can sync the queue, waiting for all current tasks
+    to finish, and then insert more tasks into the queue. When finished, the
+    main thread calls quit or simply destructs the queue, which will exit all
+    worker threads.
     
     Tasks are sub-classes of magma_task. They must implement the run() function.
     
+    Each thread has its own deque of tasks, so pushing and popping tasks does
+    not go through a single lock. Tasks pushed by the main thread are dealt
+    round robin to the threads; tasks pushed from inside a running task go to
+    the deque of the thread running it. A thread whose deque is empty steals
+    tasks from the other threads, and sleeps only when there are no queued
+    tasks at all. Within a deque, tasks with higher priority are taken first.
+    
+    Dependencies are optional: task2->depends_on( task1 ) makes task2 wait until
+    task1 has finished. It must be called before task1 is pushed; task2 may be
+    pushed before or after task1 and is started only once all its
+    predecessors are done.
+    
     Example
     -------
     @code
@@ -86,29 +105,224 @@ static void check( int err )
 *******************************************************************************/
 
 
+/***************************************************************************//**
+    Pool for task objects. Tasks are small and short-lived, and are usually
+    allocated by the main thread and deleted by the worker threads. Each
+    thread keeps free lists per size class; a thread with too many free
+    blocks returns a batch to the global lists, and a thread with none takes
+    a batch from there, so steady state does not call malloc.
+*******************************************************************************/
+namespace {
+
+const size_t pool_granularity = 64;
+const int    pool_nclass      = 16;    // blocks up to 1 KiB; larger tasks use new
+const int    pool_batch       = 64;
+
+struct pool_block
+{
+    pool_block* next;
+};
+
+struct pool_global
+{
+    std::mutex  mutex;
+    pool_block* free[ pool_nclass ];
+    
+    pool_global()
+    {
+        for( int c=0; c < pool_nclass; ++c ) {
+            free[c] = NULL;
+        }
+    }
+    
+    ~pool_global()
+    {
+        for( int c=0; c < pool_nclass; ++c ) {
+            while( free[c] != NULL ) {
+                pool_block* block = free[c];
+                free[c] = block->next;
+                std::free( block );
+            }
+        }
+    }
+};
+
+pool_global g_pool;
+
+struct pool_cache
+{
+    pool_block* free [ pool_nclass ];
+    int         count[ pool_nclass ];
+    
+    pool_cache()
+    {
+        for( int c=0; c < pool_nclass; ++c ) {
+            free[c] = NULL;
+            count[c] = 0;
+        }
+    }
+    
+    // give everything back when the thread exits
+    ~pool_cache()
+    {
+        for( int c=0; c < pool_nclass; ++c ) {
+            release( c, count[c] );
+        }
+    }
+    
+    // move n blocks of class c to the global list
+    void release( int c, int n )
+    {
+        if ( n <= 0 ) {
+            return;
+        }
+        pool_block* first = free[c];
+        pool_block* last  = first;
+        for( int i=1; i < n; ++i ) {
+            last = last->next;
+        }
+        free[c] = last->next;
+        count[c] -= n;
+        std::lock_guard< std::mutex > lock( g_pool.mutex );
+        last->next = g_pool.free[c];
+        g_pool.free[c] = first;
+    }
+    
+    // move up to pool_batch blocks of class c from the global list
+    void acquire( int c )
+    {
+        std::lock_guard< std::mutex > lock( g_pool.mutex );
+        while( g_pool.free[c] != NULL && count[c] < pool_batch ) {
+            pool_block* block = g_pool.free[c];
+            g_pool.free[c] = block->next;
+            block->next = free[c];
+            free[c] = block;
+            count[c] += 1;
+        }
+    }
+};
+
+thread_local pool_cache t_pool;
+
+// worker thread that runs the current thread, if any
+thread_local magma_thread_queue* t_queue = NULL;
+thread_local magma_int_t         t_index = -1;
+
+}  // namespace
+
+
+/***************************************************************************//**
+    Allocates a task from the pool.
+*******************************************************************************/
+void* magma_task::operator new( size_t size )
+{
+    int c = (int) ((size + pool_granularity - 1) / pool_granularity) - 1;
+    if ( c >= pool_nclass ) {
+        return ::operator new( size );
+    }
+    if ( t_pool.free[c] == NULL ) {
+        t_pool.acquire( c );
+    }
+    pool_block* block = t_pool.free[c];
+    if ( block == NULL ) {
+        block = (pool_block*) std::malloc( (c+1) * pool_granularity );
+        if ( block == NULL ) {
+            throw std::bad_alloc();
+        }
+        return block;
+    }
+    t_pool.free[c] = block->next;
+    t_pool.count[c] -= 1;
+    return block;
+}
+
+
+/***************************************************************************//**
+    Returns a task to the pool of the calling thread.
+*******************************************************************************/
+void magma_task::operator delete( void* ptr, size_t size )
+{
+    if ( ptr == NULL ) {
+        return;
+    }
+    int c = (int) ((size + pool_granularity - 1) / pool_granularity) - 1;
+    if ( c >= pool_nclass ) {
+        ::operator delete( ptr );
+        return;
+    }
+    pool_block* block = (pool_block*) ptr;
+    block->next = t_pool.free[c];
+    t_pool.free[c] = block;
+    t_pool.count[c] += 1;
+    if ( t_pool.count[c] > 2*pool_batch ) {
+        t_pool.release( c, pool_batch );
+    }
+}
+
+
+/***************************************************************************//**
+    Makes this task wait until task has finished.
+    Must be called before either task is pushed.
+    @param[in,out] task    Predecessor of this task.
+*******************************************************************************/
+void magma_task::depends_on( magma_task* task )
+{
+    assert( ! pushed && ! task->pushed );
+    ndeps += 1;
+    task->successors.push_back( this );
+}
+
+
 /***************************************************************************//**
     Thread's main routine, executed by pthread_create.
     Executes tasks from queue (given as arg), until a NULL task is returned.
     Deletes each task when it is done.
-    @param[in,out] arg    magma_thread_queue to get tasks from.
+    @param[in,out] arg    worker of the magma_thread_queue to get tasks from.
 *******************************************************************************/
 extern "C"
 void* magma_thread_main( void* arg )
 {
-    magma_thread_queue* queue = (magma_thread_queue*) arg;
+    magma_thread_queue::worker* w = (magma_thread_queue::worker*) arg;
+    magma_thread_queue* queue = w->queue;
     magma_task* task;
     
+    t_queue = queue;
+    t_index = w->index;
+    
+#ifndef MAGMA_NOAFFINITY
+    // placed according to $MAGMA_AFFINITY (cores by default). The cpus,
+    // in placement order, are split into nthread+1 shares, leaving the
+    // first to the thread that pushes tasks; worker i gets all cpus of share i+1, so
+    // OpenMP regions and threaded BLAS in a task are not serialized.
+    int ncpus = magma_topology_info( NULL, NULL, NULL, NULL );
+    int nshare = int(queue->nthread) + 1;
+    int first = int(w->index + 1) * ncpus / nshare;
+    int last  = int(w->index + 2) * ncpus / nshare;
+    if ( last <= first ) {
+        last = first + 1;  // more workers than cpus: cpus are shared
+    }
+    affinity_set set;
+    bool pin = true;
+    for( int i = first; i < last && pin; ++i ) {
+        pin = set.add_thread( i );
+    }
+    if ( pin ) {
+        set.set_affinity();
+    }
+#endif
+    
     while( true ) {
-        task = queue->pop_task();
+        task = queue->pop_task( w->index );
         if ( task == NULL ) {
             break;
         }
         
         task->run();
-        queue->task_done();
-        delete task;
+        queue->task_done( task, w->index );
         task = NULL;
     }
+    t_queue = NULL;
+    t_index = -1;
     
     return NULL;  // implicitly does pthread_exit
 }
@@ -118,11 +332,14 @@ void* magma_thread_main( void* arg )
     Creates queue with NO threads. Use launch() to create threads.
 *******************************************************************************/
 magma_thread_queue::magma_thread_queue():
-    q        (),
-    quit_flag( false ),
-    ntask    ( 0     ),
-    threads  ( NULL  ),
-    nthread  ( 0     )
+    workers    ( NULL  ),
+    nthread    ( 0     ),
+    pending    (),
+    quit_flag  ( false ),
+    ntask      ( 0     ),
+    nqueued    ( 0     ),
+    nsleeping  ( 0     ),
+    next_worker( 0     )
 {
     check( pthread_mutex_init( &mutex,      NULL ));
     check( pthread_cond_init(  &cond,       NULL ));
@@ -144,90 +361,212 @@ magma_thread_queue::~magma_thread_queue()
 
 /***************************************************************************//**
     Creates threads.
+    Tasks pushed before launch are distributed to the threads.
     @param[in] in_nthread    Number of threads to launch.
 *******************************************************************************/
 void magma_thread_queue::launch( magma_int_t in_nthread )
 {
-    assert( threads == NULL );  // else launch was called previously
-    nthread = in_nthread;
-    if ( nthread < 1 ) {
-        nthread = 1;
+    assert( workers == NULL );  // else launch was called previously
+    magma_int_t n = in_nthread;
+    if ( n < 1 ) {
+        n = 1;
+    }
+    worker* w = new worker[ n ];
+    for( magma_int_t i=0; i < n; ++i ) {
+        w[i].queue = this;
+        w[i].index = i;
+        check( pthread_mutex_init( &w[i].mutex, NULL ));
+    }
+    check( pthread_mutex_lock( &mutex ));
+    nthread = n;
+    workers = w;
+    while( ! pending.empty() ) {
+        enqueue( pending.front(), -1 );
+        pending.pop_front();
     }
-    threads = new pthread_t[ nthread ];
+    check( pthread_mutex_unlock( &mutex ));
     for( magma_int_t i=0; i < nthread; ++i ) {
-        check( pthread_create( &threads[i], NULL, magma_thread_main, this ));
-        //printf( "launch %d (%lx)\n", i, (long) threads[i] );
+        check( pthread_create( &workers[i].thread, NULL, magma_thread_main, &workers[i] ));
+        //printf( "launch %d (%lx)\n", i, (long) workers[i].thread );
     }
 }
 
 
 /***************************************************************************//**
     Add task to queue. Task must be allocated with C++ new.
-    Increments number of outstanding tasks.
-    Signals threads that are waiting in pop_task().
+    Increments number of outstanding tasks. The task is queued once all
+    tasks it depends on are done.
     @param[in] task    Task to queue.
 *******************************************************************************/
 void magma_thread_queue::push_task( magma_task* task )
 {
-    check( pthread_mutex_lock( &mutex ));
     if ( quit_flag ) {
         fprintf( stderr, "Error: push_task() called after quit()\n" );
         throw std::exception();
     }
-    q.push( task );
+    task->pushed = true;
     ntask += 1;
     //printf( "push; ntask %d\n", ntask );
-    check( pthread_cond_broadcast( &cond ));
-    check( pthread_mutex_unlock( &mutex ));
+    if ( --task->ndeps == 0 ) {
+        enqueue( task, (t_queue == this ? t_index : -1) );
+    }
+}
+
+
+/***************************************************************************//**
+    Inserts a ready task into the deque of thread index, or of the next
+    thread in round robin order if index < 0, and wakes a sleeping thread.
+*******************************************************************************/
+void magma_thread_queue::enqueue( magma_task* task, magma_int_t index )
+{
+    if ( workers == NULL ) {
+        // launch() has not been called; it will queue the pending tasks
+        check( pthread_mutex_lock( &mutex ));
+        if ( workers == NULL ) {
+            pending.push_back( task );
+            check( pthread_mutex_unlock( &mutex ));
+            return;
+        }
+        check( pthread_mutex_unlock( &mutex ));
+    }
+    if ( index < 0 ) {
+        index = next_worker++ % nthread;
+    }
+    worker& w = workers[ index ];
+    check( pthread_mutex_lock( &w.mutex ));
+    w.tasks[ task->priority ].push_back( task );
+    check( pthread_mutex_unlock( &w.mutex ));
+    
+    // a thread going to sleep increments nsleeping before it checks nqueued,
+    // so either it sees this task or we see it sleeping
+    nqueued += 1;
+    if ( nsleeping > 0 ) {
+        check( pthread_mutex_lock( &mutex ));
+        check( pthread_cond_signal( &cond ));
+        check( pthread_mutex_unlock( &mutex ));
+    }
 }
 
 
 /***************************************************************************//**
-    Get next task from queue.
+    Takes the highest priority task from the deque of thread index: from the
+    front for its owner, from the back when stealing.
+    @return task, or NULL if the deque is empty (or busy, when stealing).
+*******************************************************************************/
+magma_task* magma_thread_queue::take_task( magma_int_t index, bool steal )
+{
+    magma_task* task = NULL;
+    worker& w = workers[ index ];
+    if ( steal ) {
+        if ( pthread_mutex_trylock( &w.mutex ) != 0 ) {
+            return NULL;
+        }
+    }
+    else {
+        check( pthread_mutex_lock( &w.mutex ));
+    }
+    for( magma_int_t p = magma_task::max_priority; p >= 0; --p ) {
+        if ( ! w.tasks[p].empty() ) {
+            if ( steal ) {
+                task = w.tasks[p].back();
+                w.tasks[p].pop_back();
+            }
+            else {
+                task = w.tasks[p].front();
+                w.tasks[p].pop_front();
+            }
+            break;
+        }
+    }
+    check( pthread_mutex_unlock( &w.mutex ));
+    if ( task != NULL ) {
+        nqueued -= 1;
+    }
+    return task;
+}
+
+
+/***************************************************************************//**
+    Get next task for thread index, from its own deque or stolen from another.
     @return next task, blocking until a task is inserted if necesary.
-    @return NULL if queue is empty *and* quit() has been called.
+    @return NULL if no tasks are outstanding *and* quit() has been called.
     
     This does *not* decrement number of outstanding tasks;
     thread should call task_done() when task is completed.
 *******************************************************************************/
-magma_task* magma_thread_queue::pop_task()
+magma_task* magma_thread_queue::pop_task( magma_int_t index )
 {
+    const int max_spin = 100;
     magma_task* task = NULL;
-    check( pthread_mutex_lock( &mutex ));
-    while( q.empty() && ! quit_flag ) {
-        check( pthread_cond_wait( &cond, &mutex ));
-    }
-    // q has item or quit is set (or both)
-    if ( ! q.empty()) {
-        task = q.front();
-        q.pop();
+    int spin = 0;
+    
+    while( true ) {
+        task = take_task( index, false );
+        for( magma_int_t k=1; task == NULL && k < nthread; ++k ) {
+            task = take_task( (index + k) % nthread, true );
+        }
+        if ( task != NULL ) {
+            return task;
+        }
+        if ( nqueued > 0 || ++spin < max_spin ) {
+            std::this_thread::yield();
+            continue;
+        }
+        
+        // nothing queued anywhere: sleep until a task is pushed or quit
+        spin = 0;
+        check( pthread_mutex_lock( &mutex ));
+        nsleeping += 1;
+        while( nqueued == 0 && ! (quit_flag && ntask == 0) ) {
+            check( pthread_cond_wait( &cond, &mutex ));
+        }
+        nsleeping -= 1;
+        bool done = (quit_flag && ntask == 0 && nqueued == 0);
+        check( pthread_mutex_unlock( &mutex ));
+        if ( done ) {
+            return NULL;
+        }
     }
-    //printf( "pop;  ntask %d\n", ntask );
-    check( pthread_mutex_unlock( &mutex ));
-    return task;
 }
 
 
 /***************************************************************************//**
-    Marks task as finished, decrementing number of outstanding tasks.
-    Signals threads that are waiting in sync().
+    Marks task as finished, queues successors whose dependencies are now
+    all done, deletes the task, and decrements number of outstanding tasks.
+    Signals threads that are waiting in sync() when no tasks are left.
 *******************************************************************************/
-void magma_thread_queue::task_done()
+void magma_thread_queue::task_done( magma_task* task, magma_int_t index )
 {
-    check( pthread_mutex_lock( &mutex ));
-    ntask -= 1;
-    //printf( "fini; ntask %d\n", ntask );
-    check( pthread_cond_broadcast( &cond_ntask ));
-    check( pthread_mutex_unlock( &mutex ));
+    for( size_t i=0; i < task->successors.size(); ++i ) {
+        magma_task* succ = task->successors[i];
+        if ( --succ->ndeps == 0 ) {
+            enqueue( succ, index );
+        }
+    }
+    delete task;
+    
+    if ( --ntask == 0 ) {
+        //printf( "fini; ntask %d\n", ntask );
+        check( pthread_mutex_lock( &mutex ));
+        check( pthread_cond_broadcast( &cond_ntask ));
+        if ( quit_flag ) {
+            check( pthread_cond_broadcast( &cond ));
+        }
+        check( pthread_mutex_unlock( &mutex ));
+    }
 }
 
 
 /***************************************************************************//**
     Block until all outstanding tasks have been finished.
     Threads continue to be alive; more tasks can be pushed after sync.
+    Returns without locking if no tasks are outstanding.
 *******************************************************************************/
 void magma_thread_queue::sync()
 {
+    if ( ntask == 0 ) {
+        return;
+    }
     check( pthread_mutex_lock( &mutex ));
     //printf( "sync; ntask %d [start]\n", ntask );
     while( ntask > 0 ) {
@@ -240,8 +579,8 @@ void magma_thread_queue::sync()
 
 
 /***************************************************************************//**
-    Sets quit_flag, so pop_task() will return NULL once queue is empty,
-    telling threads to exit.
+    Sets quit_flag, so pop_task() will return NULL once all outstanding tasks
+    are done, telling threads to exit.
     Signals all threads that are waiting in pop_task().
     Waits for all threads to exit (i.e., joins them).
     It is safe to call quit multiple times -- the first time all the threads are
@@ -264,14 +603,16 @@ void magma_thread_queue::quit()
     check( pthread_mutex_unlock( &mutex ));
     
     // next, join all threads
-    if ( join ) {
-        assert( threads != NULL );
+    if ( join && workers != NULL ) {
+        for( magma_int_t i=0; i < nthread; ++i ) {
+            check( pthread_join( workers[i].thread, NULL ));
+            //printf( "joined %d (%lx)\n", i, (long) workers[i].thread );
+        }
         for( magma_int_t i=0; i < nthread; ++i ) {
-            check( pthread_join( threads[i], NULL ));
-            //printf( "joined %d (%lx)\n", i, (long) threads[i] );
+            check( pthread_mutex_destroy( &workers[i].mutex ));
         }
-        delete[] threads;
-        threads = NULL;
+        delete[] workers;
+        workers = NULL;
     }
 }
 
@@ -282,7 +623,7 @@ void magma_thread_queue::quit()
 magma_int_t magma_thread_queue::get_thread_index( pthread_t thread ) const
 {
     for( magma_int_t i=0; i < nthread; ++i ) {
-        if ( pthread_equal( thread, threads[i] )) {
+        if ( pthread_equal( thread, workers[i].thread )) {
             return i;
         }
     }
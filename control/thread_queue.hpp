@@ -11,7 +11,9 @@
 #ifndef MAGMA_THREAD_HPP
 #define MAGMA_THREAD_HPP
 
-#include <queue>
+#include <atomic>
+#include <deque>
+#include <vector>
 
 #include "magma_internal.h"
 
@@ -20,19 +22,45 @@
 extern "C"
 void* magma_thread_main( void* arg );
 
+class magma_thread_queue;
+
 
 /***************************************************************************//**
     Super class for tasks used with \ref magma_thread_queue.
     Each task should sub-class this and implement the run() method.
+
+    Tasks with higher priority (0 to max_priority) are started first.
+    Tasks are allocated from a pool, so allocating them with new is cheap.
     @ingroup magma_thread
 *******************************************************************************/
 class magma_task
 {
 public:
-    magma_task() {}
+    static const magma_int_t max_priority = 2;
+
+    magma_task( magma_int_t in_priority=0 ):
+        priority( in_priority < 0 ? 0 :
+                  in_priority > max_priority ? max_priority : in_priority ),
+        ndeps( 1 ),
+        pushed( false )
+    {}
     virtual ~magma_task() {}
-    
+
     virtual void run() = 0;  // pure virtual function to execute task
+
+    void depends_on( magma_task* task );
+
+    static void* operator new( size_t size );
+    static void  operator delete( void* ptr, size_t size );
+
+private:
+    friend class magma_thread_queue;
+    friend void* magma_thread_main( void* arg );
+
+    magma_int_t                 priority;
+    std::atomic< magma_int_t >  ndeps;       ///<  unfinished predecessors, plus 1 until pushed
+    std::vector< magma_task* >  successors;  ///<  tasks that depend on this task
+    bool                        pushed;
 };
 
 
@@ -42,28 +70,46 @@ class magma_thread_queue
 public:
     magma_thread_queue();
     ~magma_thread_queue();
-    
+
     void launch( magma_int_t in_nthread );
     void push_task( magma_task* task );
     void sync();
     void quit();
-    
+
 protected:
     friend void* magma_thread_main( void* arg );
-    magma_task* pop_task();
-    void task_done();
-    
+
+    // per-thread deque, one per priority; owner takes from the front,
+    // other threads steal from the back
+    struct worker
+    {
+        magma_thread_queue*         queue;
+        magma_int_t                 index;
+        pthread_t                   thread;
+        pthread_mutex_t             mutex;
+        std::deque< magma_task* >   tasks[ magma_task::max_priority+1 ];
+        char                        pad[ 64 ];  ///<  keeps workers on separate cache lines
+    };
+
+    magma_task* pop_task( magma_int_t index );
+    magma_task* take_task( magma_int_t index, bool steal );
+    void enqueue( magma_task* task, magma_int_t index );
+    void task_done( magma_task* task, magma_int_t index );
+
     magma_int_t get_thread_index( pthread_t thread ) const;
-    
+
 private:
-    std::queue< magma_task* > q;  ///<  queue of tasks
-    bool            quit_flag;    ///<  quit() sets this to true; after this, pop returns NULL
-    magma_int_t     ntask;        ///<  number of unfinished tasks (in queue or currently executing)
-    pthread_mutex_t mutex;        ///<  mutex lock for queue, quit, ntask
-    pthread_cond_t  cond;         ///<  condition variable for changes to queue and quit (see push, pop, quit)
-    pthread_cond_t  cond_ntask;   ///<  condition variable for changes to ntask (see sync, task_done)
-    pthread_t*      threads;      ///<  array of threads
-    magma_int_t     nthread;      ///<  number of threads
+    worker*                     workers;      ///<  array of nthread workers
+    magma_int_t                 nthread;      ///<  number of threads
+    std::deque< magma_task* >   pending;      ///<  tasks pushed before launch()
+    std::atomic< bool >         quit_flag;    ///<  quit() sets this to true; after this, pop returns NULL
+    std::atomic< magma_int_t >  ntask;        ///<  number of unfinished tasks (waiting, queued, or executing)
+    std::atomic< magma_int_t >  nqueued;      ///<  number of tasks in the worker deques
+    std::atomic< magma_int_t >  nsleeping;    ///<  number of threads waiting on cond
+    std::atomic< magma_int_t >  next_worker;  ///<  round robin target for tasks pushed by the main thread
+    pthread_mutex_t             mutex;        ///<  mutex lock for sleeping threads, sync, and quit
+    pthread_cond_t              cond;         ///<  condition variable for new tasks and quit (see push, pop, quit)
+    pthread_cond_t              cond_ntask;   ///<  condition variable for ntask reaching 0 (see sync, task_done)
 };
 
 #endif        //  #ifndef MAGMA_THREAD_HPP
@@ -3,11 +3,320 @@
 #include <errno.h>
 #include <string.h>      // strerror_r
 
+#include <stdlib.h>      // getenv, atexit
+
+#include <atomic>
+#include <chrono>
 #include <set>
 #include <string>
 
 #include "trace.h"
 
+
+/******************************************************************************/
+// Runtime tracing (MAGMA_TRACE).
+//
+// Each thread appends to its own log, a list of fixed-size chunks, so
+// recording takes no lock and never overwrites earlier events. A log is
+// registered once per thread by pushing it onto a lock-free list; logs live
+// until exit, so threads may finish before the trace is written.
+// A record is published by incrementing its chunk's count (release);
+// its end time is set later by the same thread, so a reader that sees
+// end == 0 treats the span as still open.
+
+namespace {
+
+const int trace_chunk_size = 4096;  // records per chunk
+const int trace_max_depth  = 64;    // deeper spans are counted, not recorded
+
+struct trace_record
+{
+    const char*               name;
+    long long                 start;  // ns since trace_t0
+    std::atomic< long long >  end;    // ns since trace_t0; 0 while open
+    magma_int_t               m, n, k;
+    double                    flops;
+    int                       depth;
+};
+
+struct trace_chunk
+{
+    trace_record                 records[ trace_chunk_size ];
+    std::atomic< int >           count;
+    std::atomic< trace_chunk* >  next;
+};
+
+struct trace_log
+{
+    int              tid;
+    int              depth;                       // current nesting depth
+    trace_record*    open[ trace_max_depth ];     // open spans, by depth
+    long long        ndropped;
+    trace_chunk*     first;
+    trace_chunk*     last;
+    trace_log*       next_log;                    // immutable after push
+};
+
+typedef std::chrono::steady_clock trace_clock;
+
+std::atomic< trace_log* >  trace_logs( NULL );
+std::atomic< int >         trace_nthread( 0 );
+trace_clock::time_point    trace_t0;
+const char*                trace_filename = NULL;
+
+thread_local trace_log*    trace_my_log = NULL;
+
+
+// -----------------------------------------------------------------------------
+long long trace_now()
+{
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+               trace_clock::now() - trace_t0 ).count();
+}
+
+
+// -----------------------------------------------------------------------------
+trace_chunk* trace_new_chunk()
+{
+    trace_chunk* chunk = new trace_chunk;
+    chunk->count.store( 0, std::memory_order_relaxed );
+    chunk->next.store( NULL, std::memory_order_relaxed );
+    return chunk;
+}
+
+
+// -----------------------------------------------------------------------------
+trace_log* trace_get_log()
+{
+    trace_log* log = trace_my_log;
+    if ( log == NULL ) {
+        log = new trace_log;
+        log->tid      = trace_nthread.fetch_add( 1 );
+        log->depth    = 0;
+        log->ndropped = 0;
+        log->first    = trace_new_chunk();
+        log->last     = log->first;
+        log->next_log = trace_logs.load( std::memory_order_relaxed );
+        while ( ! trace_logs.compare_exchange_weak(
+                      log->next_log, log,
+                      std::memory_order_release, std::memory_order_relaxed )) {
+            // next_log was updated to the current head; retry
+        }
+        trace_my_log = log;
+    }
+    return log;
+}
+
+
+// -----------------------------------------------------------------------------
+void trace_atexit()
+{
+    magma_trace_write( trace_filename );
+}
+
+
+// -----------------------------------------------------------------------------
+bool trace_init_env()
+{
+    trace_filename = getenv( "MAGMA_TRACE" );
+    if ( trace_filename == NULL || trace_filename[0] == '\0' ) {
+        return false;
+    }
+    trace_t0 = trace_clock::now();
+    atexit( trace_atexit );
+    return true;
+}
+
+
+// -----------------------------------------------------------------------------
+// writes s as a JSON string
+void trace_json_string( FILE* file, const char* s )
+{
+    fputc( '"', file );
+    for( ; *s != '\0'; ++s ) {
+        if ( *s == '"' || *s == '\\' ) {
+            fputc( '\\', file );
+            fputc( *s, file );
+        }
+        else if ( (unsigned char) *s < 0x20 ) {
+            fprintf( file, "\\u%04x", (unsigned char) *s );
+        }
+        else {
+            fputc( *s, file );
+        }
+    }
+    fputc( '"', file );
+}
+
+}  // namespace
+
+
+/***************************************************************************//**
+    @return true if runtime tracing is enabled, i.e., the environment
+    variable MAGMA_TRACE is set to a file name. The variable is read on the
+    first call; the trace is written to that file at exit.
+    @ingroup magma_util
+*******************************************************************************/
+bool magma_trace_enabled()
+{
+    static const bool enabled = trace_init_env();
+    return enabled;
+}
+
+
+/***************************************************************************//**
+    Starts a span on the calling thread. Spans nest; each magma_trace_begin
+    must be matched by magma_trace_end on the same thread.
+    Does nothing if tracing is disabled.
+    
+    @param[in] name     Name of span. Must be a string literal.
+    @param[in] m        Matrix sizes, recorded if nonzero.
+    @param[in] n
+    @param[in] k
+    @param[in] flops    Flop count, recorded if nonzero, e.g., FLOPS_ZGETRF( m, n ).
+    @ingroup magma_util
+*******************************************************************************/
+void magma_trace_begin(
+    const char* name, magma_int_t m, magma_int_t n, magma_int_t k, double flops )
+{
+    if ( ! magma_trace_enabled() ) {
+        return;
+    }
+    trace_log* log = trace_get_log();
+    int depth = log->depth++;
+    if ( depth >= trace_max_depth ) {
+        log->ndropped += 1;
+        return;
+    }
+    
+    trace_chunk* chunk = log->last;
+    int i = chunk->count.load( std::memory_order_relaxed );
+    if ( i == trace_chunk_size ) {
+        trace_chunk* next = trace_new_chunk();
+        chunk->next.store( next, std::memory_order_release );
+        log->last = next;
+        chunk = next;
+        i = 0;
+    }
+    trace_record* rec = &chunk->records[i];
+    rec->name  = name;
+    rec->m     = m;
+    rec->n     = n;
+    rec->k     = k;
+    rec->flops = flops;
+    rec->depth = depth;
+    rec->end.store( 0, std::memory_order_relaxed );
+    rec->start = trace_now();
+    chunk->count.store( i+1, std::memory_order_release );
+    log->open[ depth ] = rec;
+}
+
+
+/***************************************************************************//**
+    Ends the innermost open span on the calling thread.
+    Does nothing if tracing is disabled.
+    @ingroup magma_util
+*******************************************************************************/
+void magma_trace_end()
+{
+    if ( ! magma_trace_enabled() ) {
+        return;
+    }
+    trace_log* log = trace_get_log();
+    if ( log->depth == 0 ) {
+        fprintf( stderr, "Error in %s: no open span.\n", __func__ );
+        return;
+    }
+    int depth = --log->depth;
+    if ( depth < trace_max_depth ) {
+        // never 0, so it is distinguishable from an open span
+        long long end = trace_now();
+        log->open[ depth ]->end.store( end > 0 ? end : 1, std::memory_order_release );
+    }
+}
+
+
+/***************************************************************************//**
+    Writes all spans recorded so far, on all threads, as a Chrome trace-event
+    JSON file. Spans are complete ("X") events with timestamps in
+    microseconds; nesting follows from their times. Spans still open are
+    written as ending now. This is called at exit; it may be called before
+    to write a partial trace.
+    
+    @param[in] filename    Name of output file.
+    @return MAGMA_SUCCESS, or MAGMA_ERR if the file can't be written or
+            tracing is disabled.
+    @ingroup magma_util
+*******************************************************************************/
+magma_int_t magma_trace_write( const char* filename )
+{
+    char buf[ 1024 ];
+    
+    if ( ! magma_trace_enabled() || filename == NULL ) {
+        return MAGMA_ERR;
+    }
+    long long now = trace_now();
+    
+    FILE* file = fopen( filename, "w" );
+    if ( file == NULL ) {
+        strerror_r( errno, buf, sizeof(buf) );
+        fprintf( stderr, "Can't open file '%s': %s (%d)\n", filename, buf, errno );
+        return MAGMA_ERR;
+    }
+    
+    long long nevents = 0, ndropped = 0;
+    const char* sep = "\n";
+    fprintf( file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" );
+    trace_log* log = trace_logs.load( std::memory_order_acquire );
+    for( ; log != NULL; log = log->next_log ) {
+        fprintf( file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, "
+                       "\"args\": {\"name\": \"%s %d\"}}",
+                 sep, log->tid, (log->tid == 0 ? "main" : "thread"), log->tid );
+        sep = ",\n";
+        ndropped += log->ndropped;
+        
+        trace_chunk* chunk = log->first;
+        for( ; chunk != NULL; chunk = chunk->next.load( std::memory_order_acquire )) {
+            int count = chunk->count.load( std::memory_order_acquire );
+            for( int i = 0; i < count; ++i ) {
+                const trace_record& rec = chunk->records[i];
+                long long end = rec.end.load( std::memory_order_acquire );
+                if ( end == 0 ) {
+                    end = now;
+                }
+                fprintf( file, "%s{\"name\": ", sep );
+                trace_json_string( file, rec.name );
+                fprintf( file, ", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, "
+                               "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"depth\": %d",
+                         log->tid, rec.start*1e-3, (end - rec.start)*1e-3, rec.depth );
+                if ( rec.m != 0 ) fprintf( file, ", \"m\": %lld", (long long) rec.m );
+                if ( rec.n != 0 ) fprintf( file, ", \"n\": %lld", (long long) rec.n );
+                if ( rec.k != 0 ) fprintf( file, ", \"k\": %lld", (long long) rec.k );
+                if ( rec.flops != 0 ) {
+                    double sec = (end - rec.start)*1e-9;
+                    fprintf( file, ", \"flops\": %.6g", rec.flops );
+                    if ( sec > 0 ) {
+                        fprintf( file, ", \"gflop_s\": %.4f", rec.flops / sec * 1e-9 );
+                    }
+                }
+                fprintf( file, "}}" );
+                nevents += 1;
+            }
+        }
+    }
+    fprintf( file, "\n]}\n" );
+    fclose( file );
+    
+    fprintf( stderr, "writing trace to '%s': %lld spans on %d threads",
+             filename, nevents, trace_nthread.load() );
+    if ( ndropped > 0 ) {
+        fprintf( stderr, ", %lld spans nested deeper than %d dropped",
+                 ndropped, trace_max_depth );
+    }
+    fprintf( stderr, "\n" );
+    return MAGMA_SUCCESS;
+}
+
 // define TRACING to compile these functions, e.g.,
 // gcc -DTRACING -c trace.cpp
 #ifdef TRACING
@@ -23,6 +23,56 @@ const magma_int_t MAX_EVENTS      = 20000;
 const magma_int_t MAX_LABEL_LEN   = 16;
 
 
+// =============================================================================
+// Runtime tracing of CPU time, independent of TRACING below.
+// Set the environment variable MAGMA_TRACE to a file name, e.g.,
+//     MAGMA_TRACE=zgetrf.json ./testing_zgetrf -N 10000
+// to record nested spans on all CPU threads and write them at exit in the
+// Chrome trace-event JSON format, which chrome://tracing and
+// https://ui.perfetto.dev display.
+// Span names must be string literals (only the pointer is stored).
+
+bool magma_trace_enabled();
+
+void magma_trace_begin( const char* name,
+                        magma_int_t m=0, magma_int_t n=0, magma_int_t k=0,
+                        double flops=0 );
+void magma_trace_end();
+
+magma_int_t magma_trace_write( const char* filename );
+
+
+/***************************************************************************//**
+    Records a span from construction to end of scope, so spans are closed
+    on every return path. Costs one test when tracing is disabled.
+    
+        magma_trace_scope trace( "magma_zgetrf", m, n, 0, flops );
+*******************************************************************************/
+class magma_trace_scope
+{
+public:
+    magma_trace_scope( const char* name,
+                       magma_int_t m=0, magma_int_t n=0, magma_int_t k=0,
+                       double flops=0 ):
+        active( magma_trace_enabled() )
+    {
+        if ( active ) {
+            magma_trace_begin( name, m, n, k, flops );
+        }
+    }
+    
+    ~magma_trace_scope()
+    {
+        if ( active ) {
+            magma_trace_end();
+        }
+    }
+    
+private:
+    bool active;
+};
+
+
 // =============================================================================
 #ifdef TRACING
 
@@ -49,6 +49,17 @@ real_Double_t magma_wtime( void );
 real_Double_t magma_sync_wtime( magma_queue_t queue );
 
 
+// =============================================================================
+// block size tuning (see magma_get_*_nb)
+
+magma_int_t magma_tuning_load( const char* filename );
+magma_int_t magma_tuning_save( const char* filename );
+
+void        magma_tuning_set_nb( const char* routine, magma_int_t size_max, magma_int_t nb );
+void        magma_tuning_clear( const char* routine );
+magma_int_t magma_tuning_get_nb( const char* routine, magma_int_t size, magma_int_t nb );
+
+
 // =============================================================================
 // misc. functions
 
@@ -705,7 +705,10 @@ typedef enum {
     Magma_CSRCOO       = 629,
     Magma_CUCSR        = 630,
     Magma_COOLIST      = 631,
-    Magma_CSR5         = 632
+    Magma_CSR5         = 632,
+    Magma_SELLCS       = 633,
+    Magma_CSRSYM       = 634,
+    Magma_CSRMP        = 635
 } magma_storage_t;
 
 
@@ -783,7 +786,8 @@ typedef enum {
 
 typedef enum {
     Magma_GENERAL      = 581,
-    Magma_SYMMETRIC    = 582
+    Magma_SYMMETRIC    = 582,
+    Magma_HERMITIAN    = 583
 } magma_symmetry_t;
 
 typedef enum {
@@ -797,7 +801,9 @@ typedef enum {
     Magma_DCOMPLEX     = 501,
     Magma_FCOMPLEX     = 502,
     Magma_DOUBLE       = 503,
-    Magma_FLOAT        = 504
+    Magma_FLOAT        = 504,
+    Magma_HALF         = 505,
+    Magma_BFLOAT       = 506
 } magma_precision;
 
 typedef enum {
@@ -823,6 +829,20 @@ typedef enum {
     Magma_SPMV         = 810
 } magma_operation_t;
 
+typedef enum {
+    Magma_TRANSVAL     = 821,  // B = A^T
+    Magma_TRANSCONJ    = 822,  // B = A^H
+    Magma_TRANSABS     = 823,  // B = |A|^T
+    Magma_TRANSSTRUCT  = 824   // nonzero pattern of A^T, values not set
+} magma_transop_t;
+
+typedef enum {
+    Magma_NOREORDER    = 831,
+    Magma_RCM          = 832,
+    Magma_AMD          = 833,
+    Magma_ND           = 834
+} magma_reorder_t;
+
 typedef enum {
     Magma_PREC_SS           = 900,
     Magma_PREC_SST          = 901,
@@ -1048,6 +1068,21 @@ enum CBLAS_SIDE      cblas_side_const   ( magma_side_t  side  );
 #endif
 
 
+// -----------------------------------------------------------------------------
+// Per-bin statistics of the CPU vbatched routines, e.g., magma_zpotrf_vbatched_cpu.
+// Matrices are binned by order n: bin b holds 4*2^(b-1) < n <= 4*2^b,
+// bin 0 holds n <= 4, and the last bin has no upper limit.
+#define MAGMA_VBATCHED_CPU_NBINS 9
+
+typedef struct magma_vbatched_cpu_stats
+{
+    magma_int_t count[ MAGMA_VBATCHED_CPU_NBINS ];  // matrices in bin
+    double      flops[ MAGMA_VBATCHED_CPU_NBINS ];  // nominal flops of bin
+    double      time [ MAGMA_VBATCHED_CPU_NBINS ];  // thread-seconds spent on bin
+    double      wall_time;                          // seconds for the whole batch
+} magma_vbatched_cpu_stats;
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -1106,6 +1106,17 @@ magma_dlaex0(
     magma_range_t range, double vl, double vu, magma_int_t il, magma_int_t iu,
     magma_int_t *info);
 
+magma_int_t
+magma_dlaex0_blocks(
+    magma_int_t n, magma_int_t nblock,
+    const magma_int_t *bstart, const magma_int_t *bsize,
+    double *d, double *e,
+    double *Q, magma_int_t ldq,
+    double *work, magma_int_t *iwork,
+    magmaDouble_ptr dwork,
+    magma_range_t range, double vl, double vu, magma_int_t il, magma_int_t iu,
+    magma_int_t *info);
+
 // CUDA MAGMA only
 magma_int_t
 magma_dlaex0_m(
@@ -1806,6 +1817,20 @@ magma_znan_inf(
     magma_int_t *cnt_nan,
     magma_int_t *cnt_inf);
 
+magma_int_t
+magma_znan_inf_any(
+    magma_uplo_t uplo, magma_int_t m, magma_int_t n,
+    const magmaDoubleComplex *A, magma_int_t lda);
+
+magma_int_t
+magma_znan_inf_norm(
+    magma_uplo_t uplo, magma_int_t m, magma_int_t n,
+    const magmaDoubleComplex *A, magma_int_t lda,
+    magma_int_t *cnt_nan,
+    magma_int_t *cnt_inf,
+    double *norm_max,
+    double *norm_fro);
+
 magma_int_t
 magma_znan_inf_gpu(
     magma_uplo_t uplo, magma_int_t m, magma_int_t n,
@@ -62,6 +62,8 @@ magma_int_t magma_get_zgeqrf_batched_nb(magma_int_t m);
 magma_int_t magma_get_zgeqrf_batched_ntcol(magma_int_t m, magma_int_t n);
 magma_int_t magma_get_zgetri_batched_ntcol(magma_int_t m, magma_int_t n);
 magma_int_t magma_get_ztrsm_batched_stop_nb(magma_side_t side, magma_int_t m, magma_int_t n);
+magma_int_t magma_get_zbatched_cpu_crossover();
+magma_int_t magma_get_zbatched_cpu_interleave();
 
 void
 magmablas_zswapdblk_batched(
@@ -1060,6 +1062,52 @@ blas_zher2k_batched(
     double beta,              magmaDoubleComplex               **hC_array, magma_int_t ldc,
     magma_int_t batchCount );
 
+magma_int_t
+magma_zgetrf_batched_cpu(
+    magma_int_t m, magma_int_t n,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t **ipiv_array,
+    magma_int_t *info_array,
+    magma_int_t batchCount );
+
+magma_int_t
+magma_zgetrs_batched_cpu(
+    magma_trans_t trans, magma_int_t n, magma_int_t nrhs,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t **ipiv_array,
+    magmaDoubleComplex **B_array, magma_int_t ldb,
+    magma_int_t batchCount );
+
+magma_int_t
+magma_zgesv_batched_cpu(
+    magma_int_t n, magma_int_t nrhs,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t **ipiv_array,
+    magmaDoubleComplex **B_array, magma_int_t ldb,
+    magma_int_t *info_array,
+    magma_int_t batchCount );
+
+magma_int_t
+magma_zpotrf_batched_cpu(
+    magma_uplo_t uplo, magma_int_t n,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t *info_array,
+    magma_int_t batchCount );
+
+// one matrix in the calling thread, for the vbatched CPU routines
+magma_int_t
+magma_zpotrf_batched_cpu_one(
+    magma_uplo_t uplo, magma_int_t n,
+    magmaDoubleComplex *A, magma_int_t lda );
+
+magma_int_t
+magma_zgeqrf_batched_cpu(
+    magma_int_t m, magma_int_t n,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magmaDoubleComplex **tau_array,
+    magma_int_t *info_array,
+    magma_int_t batchCount );
+
 // for debugging purpose
 void
 zset_stepinit_ipiv(
@@ -68,6 +68,23 @@ magma_zpotrf_vbatched(
     magmaDoubleComplex **dA_array, magma_int_t *ldda,
     magma_int_t *info_array,  magma_int_t batchCount, 
     magma_queue_t queue);
+
+// host interface
+magma_int_t
+magma_zpotrf_vbatched_cpu(
+    magma_uplo_t uplo, magma_int_t *n_array,
+    magmaDoubleComplex **A_array, magma_int_t *lda_array,
+    magma_int_t *info_array, magma_int_t batchCount,
+    magma_vbatched_cpu_stats *stats );
+
+magma_int_t
+magma_zposv_vbatched_cpu(
+    magma_uplo_t uplo, magma_int_t *n_array, magma_int_t *nrhs_array,
+    magmaDoubleComplex **A_array, magma_int_t *lda_array,
+    magmaDoubleComplex **B_array, magma_int_t *ldb_array,
+    magma_int_t *info_array, magma_int_t batchCount,
+    magma_vbatched_cpu_stats *stats );
+
   /*
    *  BLAS vbatched routines
    */
@@ -222,6 +222,9 @@ magma_init()
                 }
             }
 
+            // pin OpenMP threads if requested by $MAGMA_AFFINITY
+            magma_set_omp_affinity();
+
             #ifndef MAGMA_NO_V1
                 #ifdef HAVE_PTHREAD_KEY
                     // create thread-specific key
@@ -44,6 +44,54 @@ blas_zlacpy_batched(
     #endif
 }
 
+/*******************************************************************************/
+// C = alpha*A*B + beta*C for one n-by-n matrix, n = N known at compile time.
+// For the smallest sizes this beats the BLAS call itself.
+template< int N >
+static void
+zgemm_batched_cpu_smallsq(
+        magmaDoubleComplex alpha,
+        const magmaDoubleComplex *A, magma_int_t lda,
+        const magmaDoubleComplex *B, magma_int_t ldb,
+        magmaDoubleComplex beta,
+        magmaDoubleComplex *C, magma_int_t ldc )
+{
+    const bool beta_zero = MAGMA_Z_EQUAL( beta, MAGMA_Z_ZERO );
+    for (int j = 0; j < N; j++) {
+        magmaDoubleComplex c[N];
+        for (int i = 0; i < N; i++)
+            c[i] = MAGMA_Z_ZERO;
+        for (int l = 0; l < N; l++) {
+            magmaDoubleComplex b = B[l + j*ldb];
+            for (int i = 0; i < N; i++)
+                c[i] += A[i + l*lda] * b;
+        }
+        // as in BLAS, C is not read when beta = 0
+        for (int i = 0; i < N; i++)
+            C[i + j*ldc] = beta_zero ? alpha * c[i]
+                                     : alpha * c[i] + beta * C[i + j*ldc];
+    }
+}
+
+typedef void (*zgemm_batched_cpu_smallsq_t)(
+        magmaDoubleComplex alpha,
+        const magmaDoubleComplex *A, magma_int_t lda,
+        const magmaDoubleComplex *B, magma_int_t ldb,
+        magmaDoubleComplex beta,
+        magmaDoubleComplex *C, magma_int_t ldc );
+
+// @return the kernel specialized on n, or NULL if there is none.
+static zgemm_batched_cpu_smallsq_t zgemm_batched_cpu_smallsq_kernel( magma_int_t n )
+{
+    switch (n) {
+        case 1: return zgemm_batched_cpu_smallsq< 1 >;
+        case 2: return zgemm_batched_cpu_smallsq< 2 >;
+        case 3: return zgemm_batched_cpu_smallsq< 3 >;
+        case 4: return zgemm_batched_cpu_smallsq< 4 >;
+        default: return NULL;
+    }
+}
+
 /*******************************************************************************/
 extern "C" void
 blas_zgemm_batched(
@@ -56,6 +104,14 @@ blas_zgemm_batched(
         magmaDoubleComplex **hC_array, magma_int_t ldc,
         magma_int_t batchCount )
 {
+    // tiny square products skip the BLAS call overhead; alpha = 0 is left
+    // to BLAS, which then does not read A and B
+    zgemm_batched_cpu_smallsq_t smallsq = NULL;
+    if ( transA == MagmaNoTrans && transB == MagmaNoTrans &&
+         m == n && n == k && ! MAGMA_Z_EQUAL( alpha, MAGMA_Z_ZERO ) ) {
+        smallsq = zgemm_batched_cpu_smallsq_kernel( n );
+    }
+
     #if defined(_OPENMP)
     magma_int_t nthreads = magma_get_lapack_numthreads();
     magma_set_lapack_numthreads(1);
@@ -63,6 +119,12 @@ blas_zgemm_batched(
     #pragma omp parallel for schedule(dynamic)
     #endif
     for (int i=0; i < batchCount; i++) {
+        if ( smallsq != NULL ) {
+            smallsq( alpha, hA_array[i], lda,
+                            hB_array[i], ldb,
+                     beta,  hC_array[i], ldc );
+            continue;
+        }
         blasf77_zgemm( lapack_trans_const(transA),
                        lapack_trans_const(transB),
                        &m, &n, &k,
@@ -322,19 +322,19 @@ magma_z_spmv(
             }
         }
     }
-    // CPU case missing!
+    // CPU case
     else {
-        CHECK( magma_zmtransfer( x, &dx, x.memory_location, Magma_DEV, queue ));
-        CHECK( magma_zmtransfer( y, &dy, y.memory_location, Magma_DEV, queue ));
-        CHECK( magma_zmtransfer( A, &dA, A.memory_location, Magma_DEV, queue ));
-        CHECK( magma_z_spmv( alpha, dA, dx, beta, dy, queue ) );
-        magma_zmfree(&x, queue );
-        magma_zmfree(&y, queue );
-        magma_zmfree(&A, queue );
-        CHECK( magma_zmtransfer( dx, &x, dx.memory_location, Magma_CPU, queue ));
-        CHECK( magma_zmtransfer( dy, &y, dy.memory_location, Magma_CPU, queue ));
-        CHECK( magma_zmtransfer( dA, &A, dA.memory_location, Magma_CPU, queue ));
-
+        info = magma_zspmv_cpu( alpha, A, x, beta, y, queue );
+        // no host kernel for this format: compute on the device and
+        // copy the result back into the host vector
+        if ( info == MAGMA_ERR_NOT_SUPPORTED ) {
+            info = 0;
+            CHECK( magma_zmtransfer( x, &dx, x.memory_location, Magma_DEV, queue ));
+            CHECK( magma_zmtransfer( y, &dy, y.memory_location, Magma_DEV, queue ));
+            CHECK( magma_zmtransfer( A, &dA, A.memory_location, Magma_DEV, queue ));
+            CHECK( magma_z_spmv( alpha, dA, dx, beta, dy, queue ) );
+            magma_zgetvector( y.num_rows * y.num_cols, dy.dval, 1, y.val, 1, queue );
+        }
     }
 
 cleanup:
@@ -0,0 +1,835 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> c d s
+*/
+#include <vector>
+#include "magmasparse_internal.h"
+
+// rows handled as one unit in the multi-vector kernels; a chunk of each
+// basis vector stays in cache while it is combined with the others
+#define MERGE_CPU_CHUNK 1024
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes the dot product x^H y of two vectors located on the host,
+    multithreaded with OpenMP.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    x           magmaDoubleComplex*
+                vector x
+
+    @param[in]
+    y           magmaDoubleComplex*
+                vector y
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magmaDoubleComplex
+magma_zdotc_cpu(
+    magma_int_t n,
+    const magmaDoubleComplex *x,
+    const magmaDoubleComplex *y,
+    magma_queue_t queue )
+{
+    double re = 0.0, im = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:re,im)
+    for( magma_int_t i=0; i < n; i++ ){
+        magmaDoubleComplex t = MAGMA_Z_CONJ( x[i] ) * y[i];
+        re += MAGMA_Z_REAL( t );
+        im += MAGMA_Z_IMAG( t );
+    }
+    return MAGMA_Z_MAKE( re, im );
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes the Euclidean norm of a vector located on the host,
+    multithreaded with OpenMP.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vector
+
+    @param[in]
+    x           magmaDoubleComplex*
+                vector x
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" double
+magma_dznrm2_cpu(
+    magma_int_t n,
+    const magmaDoubleComplex *x,
+    magma_queue_t queue )
+{
+    double nrm = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:nrm)
+    for( magma_int_t i=0; i < n; i++ ){
+        nrm += MAGMA_Z_REAL( x[i] ) * MAGMA_Z_REAL( x[i] )
+             + MAGMA_Z_IMAG( x[i] ) * MAGMA_Z_IMAG( x[i] );
+    }
+    return sqrt( nrm );
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes y = alpha * x + beta * y on the host. If beta is zero, y is
+    not read.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    alpha       magmaDoubleComplex
+                scalar alpha
+
+    @param[in]
+    x           magmaDoubleComplex*
+                vector x
+
+    @param[in]
+    beta        magmaDoubleComplex
+                scalar beta
+
+    @param[in,out]
+    y           magmaDoubleComplex*
+                vector y
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zaxpby_cpu(
+    magma_int_t n,
+    magmaDoubleComplex alpha,
+    const magmaDoubleComplex *x,
+    magmaDoubleComplex beta,
+    magmaDoubleComplex *y,
+    magma_queue_t queue )
+{
+    if ( MAGMA_Z_EQUAL( beta, MAGMA_Z_ZERO ) ) {
+        #pragma omp parallel for schedule(static)
+        for( magma_int_t i=0; i < n; i++ ){
+            y[i] = alpha * x[i];
+        }
+    } else {
+        #pragma omp parallel for schedule(static)
+        for( magma_int_t i=0; i < n; i++ ){
+            y[i] = alpha * x[i] + beta * y[i];
+        }
+    }
+    return MAGMA_SUCCESS;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes the k dot products h = V^H y of the columns of V with the
+    vector y in a single pass over y, multithreaded with OpenMP.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    k           magma_int_t
+                number of columns of V
+
+    @param[in]
+    V           magmaDoubleComplex*
+                n-by-k matrix V, column-major
+
+    @param[in]
+    ldv         magma_int_t
+                leading dimension of V
+
+    @param[in]
+    y           magmaDoubleComplex*
+                vector y
+
+    @param[out]
+    h           magmaDoubleComplex*
+                k dot products
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zmdotc_cpu(
+    magma_int_t n,
+    magma_int_t k,
+    const magmaDoubleComplex *V,
+    magma_int_t ldv,
+    const magmaDoubleComplex *y,
+    magmaDoubleComplex *h,
+    magma_queue_t queue )
+{
+    magma_int_t chunks = magma_ceildiv( n, MERGE_CPU_CHUNK );
+
+    for( magma_int_t j=0; j < k; j++ ){
+        h[j] = MAGMA_Z_ZERO;
+    }
+    #pragma omp parallel
+    {
+        std::vector<double> re( k, 0.0 ), im( k, 0.0 );
+        #pragma omp for schedule(static)
+        for( magma_int_t c=0; c < chunks; c++ ){
+            magma_int_t start = c * MERGE_CPU_CHUNK;
+            magma_int_t end = min( n, start + MERGE_CPU_CHUNK );
+            for( magma_int_t j=0; j < k; j++ ){
+                const magmaDoubleComplex *v = V + j*ldv;
+                double sr = 0.0, si = 0.0;
+                for( magma_int_t i=start; i < end; i++ ){
+                    magmaDoubleComplex t = MAGMA_Z_CONJ( v[i] ) * y[i];
+                    sr += MAGMA_Z_REAL( t );
+                    si += MAGMA_Z_IMAG( t );
+                }
+                re[j] += sr;
+                im[j] += si;
+            }
+        }
+        #pragma omp critical
+        {
+            for( magma_int_t j=0; j < k; j++ ){
+                h[j] += MAGMA_Z_MAKE( re[j], im[j] );
+            }
+        }
+    }
+    return MAGMA_SUCCESS;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes y = alpha * V h + beta * y for the n-by-k matrix V in a single
+    pass over y, multithreaded with OpenMP. If beta is zero, y is not read.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    k           magma_int_t
+                number of columns of V
+
+    @param[in]
+    alpha       magmaDoubleComplex
+                scalar alpha
+
+    @param[in]
+    V           magmaDoubleComplex*
+                n-by-k matrix V, column-major
+
+    @param[in]
+    ldv         magma_int_t
+                leading dimension of V
+
+    @param[in]
+    h           magmaDoubleComplex*
+                k coefficients
+
+    @param[in]
+    beta        magmaDoubleComplex
+                scalar beta
+
+    @param[in,out]
+    y           magmaDoubleComplex*
+                vector y
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zmgemv_cpu(
+    magma_int_t n,
+    magma_int_t k,
+    magmaDoubleComplex alpha,
+    const magmaDoubleComplex *V,
+    magma_int_t ldv,
+    const magmaDoubleComplex *h,
+    magmaDoubleComplex beta,
+    magmaDoubleComplex *y,
+    magma_queue_t queue )
+{
+    magma_int_t chunks = magma_ceildiv( n, MERGE_CPU_CHUNK );
+    bool beta_zero = MAGMA_Z_EQUAL( beta, MAGMA_Z_ZERO );
+
+    #pragma omp parallel for schedule(static)
+    for( magma_int_t c=0; c < chunks; c++ ){
+        magma_int_t start = c * MERGE_CPU_CHUNK;
+        magma_int_t end = min( n, start + MERGE_CPU_CHUNK );
+        magmaDoubleComplex sum[MERGE_CPU_CHUNK];
+        for( magma_int_t i=start; i < end; i++ ){
+            sum[i-start] = MAGMA_Z_ZERO;
+        }
+        for( magma_int_t j=0; j < k; j++ ){
+            const magmaDoubleComplex *v = V + j*ldv;
+            magmaDoubleComplex hj = h[j];
+            for( magma_int_t i=start; i < end; i++ ){
+                sum[i-start] += v[i] * hj;
+            }
+        }
+        for( magma_int_t i=start; i < end; i++ ){
+            y[i] = beta_zero ? alpha * sum[i-start]
+                             : alpha * sum[i-start] + beta * y[i];
+        }
+    }
+    return MAGMA_SUCCESS;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes the residual r = b - A x and its norm for A, b, x and r
+    located on the host.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                system matrix
+
+    @param[in]
+    b           magma_z_matrix
+                right-hand side
+
+    @param[in]
+    x           magma_z_matrix
+                solution approximation
+
+    @param[out]
+    r           magma_z_matrix*
+                residual vector, allocated by the caller
+
+    @param[out]
+    res         double*
+                residual norm
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zresidualvec_cpu(
+    magma_z_matrix A,
+    magma_z_matrix b,
+    magma_z_matrix x,
+    magma_z_matrix *r,
+    double *res,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_int_t n = A.num_rows;
+    double nrm = 0.0;
+
+    CHECK( magma_zspmv_cpu( MAGMA_Z_ONE, A, x, MAGMA_Z_ZERO, *r, queue ));
+    #pragma omp parallel for schedule(static) reduction(+:nrm)
+    for( magma_int_t i=0; i < n; i++ ){
+        magmaDoubleComplex t = b.val[i] - r->val[i];
+        r->val[i] = t;
+        nrm += MAGMA_Z_REAL( t ) * MAGMA_Z_REAL( t )
+             + MAGMA_Z_IMAG( t ) * MAGMA_Z_IMAG( t );
+    }
+    *res = sqrt( nrm );
+
+cleanup:
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Merges the solution and residual update of CG:
+        x = x + alpha * p
+        r = r - alpha * q
+    and returns the squared norm r^H r of the new residual.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    alpha       magmaDoubleComplex
+                step length
+
+    @param[in]
+    p           magmaDoubleComplex*
+                search direction
+
+    @param[in]
+    q           magmaDoubleComplex*
+                A times p
+
+    @param[in,out]
+    x           magmaDoubleComplex*
+                solution approximation
+
+    @param[in,out]
+    r           magmaDoubleComplex*
+                residual
+
+    @param[out]
+    rr          double*
+                r^H r
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zcgmerge_xr_cpu(
+    magma_int_t n,
+    magmaDoubleComplex alpha,
+    const magmaDoubleComplex *p,
+    const magmaDoubleComplex *q,
+    magmaDoubleComplex *x,
+    magmaDoubleComplex *r,
+    double *rr,
+    magma_queue_t queue )
+{
+    double nrm = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:nrm)
+    for( magma_int_t i=0; i < n; i++ ){
+        x[i] = x[i] + alpha * p[i];
+        magmaDoubleComplex t = r[i] - alpha * q[i];
+        r[i] = t;
+        nrm += MAGMA_Z_REAL( t ) * MAGMA_Z_REAL( t )
+             + MAGMA_Z_IMAG( t ) * MAGMA_Z_IMAG( t );
+    }
+    *rr = nrm;
+    return MAGMA_SUCCESS;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Merges the search direction update of BiCGSTAB:
+        p = r + beta * ( p - omega * v )
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    beta        magmaDoubleComplex
+                scalar beta
+
+    @param[in]
+    omega       magmaDoubleComplex
+                scalar omega
+
+    @param[in]
+    r           magmaDoubleComplex*
+                residual
+
+    @param[in]
+    v           magmaDoubleComplex*
+                vector v
+
+    @param[in,out]
+    p           magmaDoubleComplex*
+                search direction
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zbicgmerge_p_cpu(
+    magma_int_t n,
+    magmaDoubleComplex beta,
+    magmaDoubleComplex omega,
+    const magmaDoubleComplex *r,
+    const magmaDoubleComplex *v,
+    magmaDoubleComplex *p,
+    magma_queue_t queue )
+{
+    #pragma omp parallel for schedule(static)
+    for( magma_int_t i=0; i < n; i++ ){
+        p[i] = r[i] + beta * ( p[i] - omega * v[i] );
+    }
+    return MAGMA_SUCCESS;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes the intermediate residual of BiCGSTAB:
+        s = r - alpha * v
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    alpha       magmaDoubleComplex
+                scalar alpha
+
+    @param[in]
+    r           magmaDoubleComplex*
+                residual
+
+    @param[in]
+    v           magmaDoubleComplex*
+                vector v
+
+    @param[out]
+    s           magmaDoubleComplex*
+                vector s
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zbicgmerge_s_cpu(
+    magma_int_t n,
+    magmaDoubleComplex alpha,
+    const magmaDoubleComplex *r,
+    const magmaDoubleComplex *v,
+    magmaDoubleComplex *s,
+    magma_queue_t queue )
+{
+    #pragma omp parallel for schedule(static)
+    for( magma_int_t i=0; i < n; i++ ){
+        s[i] = r[i] - alpha * v[i];
+    }
+    return MAGMA_SUCCESS;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes the two dot products t^H s and t^H t needed for omega in
+    BiCGSTAB in a single pass.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    t           magmaDoubleComplex*
+                vector t
+
+    @param[in]
+    s           magmaDoubleComplex*
+                vector s
+
+    @param[out]
+    ts          magmaDoubleComplex*
+                t^H s
+
+    @param[out]
+    tt          double*
+                t^H t
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zbicgmerge_ts_cpu(
+    magma_int_t n,
+    const magmaDoubleComplex *t,
+    const magmaDoubleComplex *s,
+    magmaDoubleComplex *ts,
+    double *tt,
+    magma_queue_t queue )
+{
+    double re = 0.0, im = 0.0, nrm = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:re,im,nrm)
+    for( magma_int_t i=0; i < n; i++ ){
+        magmaDoubleComplex d = MAGMA_Z_CONJ( t[i] ) * s[i];
+        re += MAGMA_Z_REAL( d );
+        im += MAGMA_Z_IMAG( d );
+        nrm += MAGMA_Z_REAL( t[i] ) * MAGMA_Z_REAL( t[i] )
+             + MAGMA_Z_IMAG( t[i] ) * MAGMA_Z_IMAG( t[i] );
+    }
+    *ts = MAGMA_Z_MAKE( re, im );
+    *tt = nrm;
+    return MAGMA_SUCCESS;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Merges the solution and residual update at the end of a BiCGSTAB
+    iteration:
+        x = x + alpha * y + omega * z
+        r = s - omega * t
+    and returns the dot product rr^H r for the next iteration together
+    with the squared residual norm r^H r.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    alpha       magmaDoubleComplex
+                scalar alpha
+
+    @param[in]
+    omega       magmaDoubleComplex
+                scalar omega
+
+    @param[in]
+    rr          magmaDoubleComplex*
+                shadow residual
+
+    @param[in]
+    y           magmaDoubleComplex*
+                preconditioned search direction
+
+    @param[in]
+    z           magmaDoubleComplex*
+                preconditioned s
+
+    @param[in]
+    s           magmaDoubleComplex*
+                vector s
+
+    @param[in]
+    t           magmaDoubleComplex*
+                A times z
+
+    @param[in,out]
+    x           magmaDoubleComplex*
+                solution approximation
+
+    @param[out]
+    r           magmaDoubleComplex*
+                residual
+
+    @param[out]
+    rho         magmaDoubleComplex*
+                rr^H r
+
+    @param[out]
+    nrm2        double*
+                r^H r
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zbicgmerge_xr_cpu(
+    magma_int_t n,
+    magmaDoubleComplex alpha,
+    magmaDoubleComplex omega,
+    const magmaDoubleComplex *rr,
+    const magmaDoubleComplex *y,
+    const magmaDoubleComplex *z,
+    const magmaDoubleComplex *s,
+    const magmaDoubleComplex *t,
+    magmaDoubleComplex *x,
+    magmaDoubleComplex *r,
+    magmaDoubleComplex *rho,
+    double *nrm2,
+    magma_queue_t queue )
+{
+    double re = 0.0, im = 0.0, nrm = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:re,im,nrm)
+    for( magma_int_t i=0; i < n; i++ ){
+        x[i] = x[i] + alpha * y[i] + omega * z[i];
+        magmaDoubleComplex ri = s[i] - omega * t[i];
+        r[i] = ri;
+        magmaDoubleComplex d = MAGMA_Z_CONJ( rr[i] ) * ri;
+        re += MAGMA_Z_REAL( d );
+        im += MAGMA_Z_IMAG( d );
+        nrm += MAGMA_Z_REAL( ri ) * MAGMA_Z_REAL( ri )
+             + MAGMA_Z_IMAG( ri ) * MAGMA_Z_IMAG( ri );
+    }
+    *rho = MAGMA_Z_MAKE( re, im );
+    *nrm2 = nrm;
+    return MAGMA_SUCCESS;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Merges the residual smoothing step of IDR:
+        t  = rs - r
+        gamma = ( t^H rs ) / ( t^H t )
+        rs = rs - gamma * t
+        xs = xs - gamma * ( xs - x )
+    in two passes over the vectors and returns the norm of the smoothed
+    residual rs.
+
+    Arguments
+    ---------
+
+    @param[in]
+    n           magma_int_t
+                length of the vectors
+
+    @param[in]
+    r           magmaDoubleComplex*
+                residual
+
+    @param[in]
+    x           magmaDoubleComplex*
+                solution approximation
+
+    @param[in,out]
+    rs          magmaDoubleComplex*
+                smoothed residual
+
+    @param[in,out]
+    xs          magmaDoubleComplex*
+                smoothed solution approximation
+
+    @param[out]
+    nrm         double*
+                norm of rs
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zidrmerge_smoothing_cpu(
+    magma_int_t n,
+    const magmaDoubleComplex *r,
+    const magmaDoubleComplex *x,
+    magmaDoubleComplex *rs,
+    magmaDoubleComplex *xs,
+    double *nrm,
+    magma_queue_t queue )
+{
+    double re = 0.0, im = 0.0, tt = 0.0, rsrs = 0.0;
+    magmaDoubleComplex gamma;
+
+    #pragma omp parallel for schedule(static) reduction(+:re,im,tt)
+    for( magma_int_t i=0; i < n; i++ ){
+        magmaDoubleComplex t = rs[i] - r[i];
+        magmaDoubleComplex d = MAGMA_Z_CONJ( t ) * rs[i];
+        re += MAGMA_Z_REAL( d );
+        im += MAGMA_Z_IMAG( d );
+        tt += MAGMA_Z_REAL( t ) * MAGMA_Z_REAL( t )
+            + MAGMA_Z_IMAG( t ) * MAGMA_Z_IMAG( t );
+    }
+    gamma = MAGMA_Z_MAKE( re, im ) / MAGMA_Z_MAKE( tt, 0.0 );
+
+    #pragma omp parallel for schedule(static) reduction(+:rsrs)
+    for( magma_int_t i=0; i < n; i++ ){
+        magmaDoubleComplex t = rs[i] - gamma * ( rs[i] - r[i] );
+        rs[i] = t;
+        xs[i] = xs[i] - gamma * ( xs[i] - x[i] );
+        rsrs += MAGMA_Z_REAL( t ) * MAGMA_Z_REAL( t )
+              + MAGMA_Z_IMAG( t ) * MAGMA_Z_IMAG( t );
+    }
+    *nrm = sqrt( rsrs );
+    return MAGMA_SUCCESS;
+}
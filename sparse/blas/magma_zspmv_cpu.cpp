@@ -0,0 +1,645 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> c d s
+*/
+#include "magmasparse_internal.h"
+#include "magmasparse_lowprec.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/***************************************************************************//**
+    Splits the index range [0, n) described by the pointer array ptr into
+    parts chunks holding about the same number of entries, and returns the
+    bounds of chunk id. ptr has n+1 entries, e.g., a CSR row pointer.
+    Rows with many nonzeros are not split, so a chunk can be empty.
+*******************************************************************************/
+
+static void
+magma_zspmv_cpu_split(
+    magma_int_t n,
+    const magma_index_t *ptr,
+    magma_int_t parts,
+    magma_int_t id,
+    magma_int_t *start,
+    magma_int_t *end )
+{
+    magma_int_t bound[2];
+    for( magma_int_t b=0; b < 2; b++ ){
+        magma_int_t p = id + b;
+        if( p == 0 ){
+            bound[b] = 0;
+        } else if( p >= parts ){
+            bound[b] = n;
+        } else {
+            // first index whose pointer reaches the target
+            int64_t target = (int64_t) ptr[0]
+                + ( (int64_t) ( ptr[n] - ptr[0] ) * p ) / parts;
+            magma_int_t lo = 0, hi = n;
+            while( lo < hi ){
+                magma_int_t mid = lo + (hi - lo) / 2;
+                if( ptr[mid] < target )
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            bound[b] = lo;
+        }
+    }
+    *start = bound[0];
+    *end = bound[1];
+}
+
+
+/***************************************************************************//**
+    Computes the partial sums of the C rows of one SELL-C-sigma slice. With
+    the slice height known at compile time, the loop over the rows of the
+    slice has a fixed trip count and unit stride, so the compiler keeps the
+    partial sums in SIMD registers of the target (SSE, AVX2, AVX-512).
+*******************************************************************************/
+
+template< int C >
+static inline void
+magma_zsellcs_slice(
+    magma_int_t width,
+    const magmaDoubleComplex *val,
+    const magma_index_t *col,
+    const magmaDoubleComplex *xp,
+    magma_int_t xr,
+    magmaDoubleComplex *sum )
+{
+    magmaDoubleComplex acc[C];
+    for( int j=0; j < C; j++ ){
+        acc[j] = MAGMA_Z_ZERO;
+    }
+    for( magma_int_t k=0; k < width; k++ ){
+        #pragma omp simd
+        for( int j=0; j < C; j++ ){
+            acc[j] += val[ k*C + j ] * xp[ col[ k*C + j ]*xr ];
+        }
+    }
+    for( int j=0; j < C; j++ ){
+        sum[j] = acc[j];
+    }
+}
+
+
+// same for any slice height C <= 64
+static inline void
+magma_zsellcs_slice_any(
+    magma_int_t C,
+    magma_int_t width,
+    const magmaDoubleComplex *val,
+    const magma_index_t *col,
+    const magmaDoubleComplex *xp,
+    magma_int_t xr,
+    magmaDoubleComplex *sum )
+{
+    for( magma_int_t j=0; j < C; j++ ){
+        sum[j] = MAGMA_Z_ZERO;
+    }
+    for( magma_int_t k=0; k < width; k++ ){
+        #pragma omp simd
+        for( magma_int_t j=0; j < C; j++ ){
+            sum[j] += val[ k*C + j ] * xp[ col[ k*C + j ]*xr ];
+        }
+    }
+}
+
+
+/***************************************************************************//**
+    Computes rows [start, end) of a CSRMP SpMV. The value format FMT is a
+    template parameter, so the inner loop has no branch on it; the values
+    are widened to the working precision and accumulated there.
+*******************************************************************************/
+
+template< int FMT >
+static inline double
+magma_zcsrmp_component(
+    const void *val,
+    magma_int_t k )
+{
+    if ( FMT == Magma_HALF )
+        return magma_half2float( ((const uint16_t*) val)[k] );
+    else if ( FMT == Magma_BFLOAT )
+        return magma_bfloat2float( ((const uint16_t*) val)[k] );
+    else
+        return ((const float*) val)[k];
+}
+
+
+template< int FMT >
+static void
+magma_zcsrmp_rows(
+    magma_z_matrix A,
+    magma_int_t start,
+    magma_int_t end,
+    magmaDoubleComplex alpha,
+    magmaDoubleComplex beta,
+    bool beta_zero,
+    const magmaDoubleComplex *xp,
+    magma_int_t xr,
+    magmaDoubleComplex *yp,
+    magma_int_t yr )
+{
+    const magma_int_t nc = sizeof(magmaDoubleComplex) / sizeof(double);
+    for( magma_int_t i=start; i < end; i++ ){
+        const uint16_t *p = A.mpcol + A.rowidx[i];
+        magmaDoubleComplex sum = MAGMA_Z_ZERO;
+        magma_index_t c = i;
+        for( magma_index_t k=A.row[i]; k < A.row[i+1]; k++ ){
+            c = magma_csrmp_next_col( &p, c, k == A.row[i] );
+            double re = magma_zcsrmp_component<FMT>( A.val, k*nc );
+            double im = ( nc > 1 ) ? magma_zcsrmp_component<FMT>( A.val, k*nc+1 ) : 0.0;
+            sum += MAGMA_Z_MAKE( re, im ) * xp[ c*xr ];
+        }
+        yp[i*yr] = beta_zero ? alpha * sum
+                             : alpha * sum + beta * yp[i*yr];
+    }
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+
+    Computes the SpMV
+              y = alpha * A * x + beta * y
+    on the host for matrix A and (blocks of) vectors x, y located in
+    Magma_CPU memory.
+
+    Supported formats for A are CSR (including CSRL, CSRU, CUCSR, CSRCOO),
+    CSC, ELL, ELLPACKT, ELLD, ELLRT, SELLP, SELLCS, CSRSYM, CSRMP and DENSE.
+    If x holds more than one vector, x and y may be stored either in
+    row-major or column-major order, as given in x.major and y.major.
+
+    The rows are distributed across the OpenMP threads such that every
+    thread handles about the same number of nonzeros. If beta is zero,
+    y is not read.
+
+    For any other format, MAGMA_ERR_NOT_SUPPORTED is returned without
+    touching y, so the caller can fall back to the device.
+
+    Arguments
+    ---------
+
+    @param[in]
+    alpha       magmaDoubleComplex
+                scalar alpha
+
+    @param[in]
+    A           magma_z_matrix
+                sparse matrix A located on the host
+
+    @param[in]
+    x           magma_z_matrix
+                input vector(s) x located on the host
+
+    @param[in]
+    beta        magmaDoubleComplex
+                scalar beta
+
+    @param[in,out]
+    y           magma_z_matrix
+                output vector(s) y located on the host
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zblas
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zspmv_cpu(
+    magmaDoubleComplex alpha,
+    magma_z_matrix A,
+    magma_z_matrix x,
+    magmaDoubleComplex beta,
+    magma_z_matrix y,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magmaDoubleComplex zero = MAGMA_Z_ZERO;
+    magmaDoubleComplex *work = NULL;
+    magma_int_t num_threads = 1;
+    bool beta_zero = MAGMA_Z_EQUAL( beta, zero );
+
+    // strides of row and vector index in x and y
+    magma_int_t num_vecs, xr, xv, yr, yv;
+
+    if ( A.memory_location != Magma_CPU ||
+         x.memory_location != Magma_CPU ||
+         y.memory_location != Magma_CPU ) {
+        info = MAGMA_ERR_INVALID_PTR;
+        goto cleanup;
+    }
+
+    if ( A.storage_type != Magma_CSR      &&
+         A.storage_type != Magma_CSRL     &&
+         A.storage_type != Magma_CSRU     &&
+         A.storage_type != Magma_CUCSR    &&
+         A.storage_type != Magma_CSRCOO   &&
+         A.storage_type != Magma_CSC      &&
+         A.storage_type != Magma_ELL      &&
+         A.storage_type != Magma_ELLPACKT &&
+         A.storage_type != Magma_ELLD     &&
+         A.storage_type != Magma_ELLRT    &&
+         A.storage_type != Magma_SELLP    &&
+         A.storage_type != Magma_SELLCS   &&
+         A.storage_type != Magma_CSRSYM   &&
+         A.storage_type != Magma_CSRMP    &&
+         A.storage_type != Magma_DENSE ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    // same convention as the device multi-vector SpMV
+    num_vecs = ( A.num_cols < x.num_rows || x.num_cols > 1 )
+                ? x.num_rows / A.num_cols * x.num_cols : 1;
+    if ( num_vecs > 1 && x.major == MagmaRowMajor ) {
+        xr = num_vecs;
+        xv = 1;
+    } else {
+        xr = 1;
+        xv = A.num_cols;
+    }
+    if ( num_vecs > 1 && y.major == MagmaRowMajor ) {
+        yr = num_vecs;
+        yv = 1;
+    } else {
+        yr = 1;
+        yv = A.num_rows;
+    }
+
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+
+    if ( A.storage_type == Magma_CSR    ||
+         A.storage_type == Magma_CSRL   ||
+         A.storage_type == Magma_CSRU   ||
+         A.storage_type == Magma_CUCSR  ||
+         A.storage_type == Magma_CSRCOO )
+    {
+        #pragma omp parallel num_threads( num_threads )
+        {
+#ifdef _OPENMP
+            magma_int_t id = omp_get_thread_num();
+            magma_int_t nt = omp_get_num_threads();
+#else
+            magma_int_t id = 0;
+            magma_int_t nt = 1;
+#endif
+            magma_int_t start, end;
+            magma_zspmv_cpu_split( A.num_rows, A.row, nt, id, &start, &end );
+            for( magma_int_t v=0; v < num_vecs; v++ ){
+                const magmaDoubleComplex *xp = x.val + v*xv;
+                magmaDoubleComplex *yp = y.val + v*yv;
+                for( magma_int_t i=start; i < end; i++ ){
+                    magmaDoubleComplex sum = zero;
+                    magma_index_t kend = A.row[i+1];
+                    for( magma_index_t k=A.row[i]; k < kend; k++ ){
+                        sum += A.val[k] * xp[ A.col[k]*xr ];
+                    }
+                    yp[i*yr] = beta_zero ? alpha * sum
+                                         : alpha * sum + beta * yp[i*yr];
+                }
+            }
+        }
+    }
+    else if ( A.storage_type == Magma_CSC )
+    {
+        // columns scatter into y: each thread accumulates into a private
+        // copy of y for its nnz-balanced range of columns, then the
+        // copies are summed up row-parallel.
+        magma_int_t ny = A.num_rows * num_vecs;
+        CHECK( magma_zmalloc_cpu( &work, ny * num_threads ));
+
+        #pragma omp parallel num_threads( num_threads )
+        {
+#ifdef _OPENMP
+            magma_int_t id = omp_get_thread_num();
+            magma_int_t nt = omp_get_num_threads();
+#else
+            magma_int_t id = 0;
+            magma_int_t nt = 1;
+#endif
+            magmaDoubleComplex *w = work + id * ny;
+            #pragma omp for
+            for( magma_int_t i=0; i < ny * num_threads; i++ ){
+                work[i] = zero;
+            }
+            magma_int_t start, end;
+            magma_zspmv_cpu_split( A.num_cols, A.col, nt, id, &start, &end );
+            for( magma_int_t v=0; v < num_vecs; v++ ){
+                const magmaDoubleComplex *xp = x.val + v*xv;
+                magmaDoubleComplex *wp = w + v*A.num_rows;
+                for( magma_int_t j=start; j < end; j++ ){
+                    magmaDoubleComplex xj = xp[j*xr];
+                    magma_index_t kend = A.col[j+1];
+                    for( magma_index_t k=A.col[j]; k < kend; k++ ){
+                        wp[ A.row[k] ] += A.val[k] * xj;
+                    }
+                }
+            }
+            #pragma omp barrier
+            #pragma omp for
+            for( magma_int_t i=0; i < ny; i++ ){
+                magmaDoubleComplex sum = zero;
+                for( magma_int_t t=0; t < num_threads; t++ ){
+                    sum += work[ t*ny + i ];
+                }
+                magma_int_t v = i / A.num_rows;
+                magma_int_t r = i % A.num_rows;
+                magmaDoubleComplex *yp = y.val + v*yv + r*yr;
+                *yp = beta_zero ? alpha * sum : alpha * sum + beta * (*yp);
+            }
+        }
+    }
+    else if ( A.storage_type == Magma_ELL )
+    {
+        // column-major ELL, padded with zero values
+        magma_int_t m = A.num_rows;
+        for( magma_int_t v=0; v < num_vecs; v++ ){
+            const magmaDoubleComplex *xp = x.val + v*xv;
+            magmaDoubleComplex *yp = y.val + v*yv;
+            #pragma omp parallel for schedule(static)
+            for( magma_int_t i=0; i < m; i++ ){
+                magmaDoubleComplex sum = zero;
+                for( magma_int_t k=0; k < A.max_nnz_row; k++ ){
+                    sum += A.val[ k*m + i ] * xp[ A.col[ k*m + i ]*xr ];
+                }
+                yp[i*yr] = beta_zero ? alpha * sum
+                                     : alpha * sum + beta * yp[i*yr];
+            }
+        }
+    }
+    else if ( A.storage_type == Magma_ELLPACKT ||
+              A.storage_type == Magma_ELLD     ||
+              A.storage_type == Magma_ELLRT )
+    {
+        // row-major ELL variants; ELLPACKT and ELLD pad with col = -1,
+        // ELLRT pads the rows to a multiple of the alignment
+        magma_int_t rowlength = A.max_nnz_row;
+        if ( A.storage_type == Magma_ELLRT ) {
+            rowlength = magma_roundup( A.max_nnz_row, A.alignment );
+        }
+        for( magma_int_t v=0; v < num_vecs; v++ ){
+            const magmaDoubleComplex *xp = x.val + v*xv;
+            magmaDoubleComplex *yp = y.val + v*yv;
+            #pragma omp parallel for schedule(static)
+            for( magma_int_t i=0; i < A.num_rows; i++ ){
+                magmaDoubleComplex sum = zero;
+                magma_int_t len = ( A.storage_type == Magma_ELLRT )
+                                    ? A.row[i] : rowlength;
+                const magmaDoubleComplex *val = A.val + i*rowlength;
+                const magma_index_t *col = A.col + i*rowlength;
+                for( magma_int_t k=0; k < len; k++ ){
+                    if ( col[k] >= 0 ) {
+                        sum += val[k] * xp[ col[k]*xr ];
+                    }
+                }
+                yp[i*yr] = beta_zero ? alpha * sum
+                                     : alpha * sum + beta * yp[i*yr];
+            }
+        }
+    }
+    else if ( A.storage_type == Magma_SELLP )
+    {
+        // slices of C rows stored column-major within the slice, so the
+        // innermost loop over the rows of a slice is unit-stride
+        magma_int_t C = A.blocksize;
+        #pragma omp parallel num_threads( num_threads )
+        {
+#ifdef _OPENMP
+            magma_int_t id = omp_get_thread_num();
+            magma_int_t nt = omp_get_num_threads();
+#else
+            magma_int_t id = 0;
+            magma_int_t nt = 1;
+#endif
+            magma_int_t start, end;
+            magmaDoubleComplex *sum = NULL;
+            magma_zmalloc_cpu( &sum, C );
+            magma_zspmv_cpu_split( A.numblocks, A.row, nt, id, &start, &end );
+            for( magma_int_t v=0; sum != NULL && v < num_vecs; v++ ){
+                const magmaDoubleComplex *xp = x.val + v*xv;
+                magmaDoubleComplex *yp = y.val + v*yv;
+                for( magma_int_t s=start; s < end; s++ ){
+                    magma_int_t width = ( A.row[s+1] - A.row[s] ) / C;
+                    const magmaDoubleComplex *val = A.val + A.row[s];
+                    const magma_index_t *col = A.col + A.row[s];
+                    for( magma_int_t j=0; j < C; j++ ){
+                        sum[j] = zero;
+                    }
+                    for( magma_int_t k=0; k < width; k++ ){
+                        for( magma_int_t j=0; j < C; j++ ){
+                            sum[j] += val[ k*C + j ] * xp[ col[ k*C + j ]*xr ];
+                        }
+                    }
+                    magma_int_t rows = min( C, A.num_rows - s*C );
+                    for( magma_int_t j=0; j < rows; j++ ){
+                        magma_int_t i = s*C + j;
+                        yp[i*yr] = beta_zero ? alpha * sum[j]
+                                             : alpha * sum[j] + beta * yp[i*yr];
+                    }
+                }
+            }
+            if ( sum == NULL ) {
+                #pragma omp atomic write
+                info = MAGMA_ERR_HOST_ALLOC;
+            }
+            magma_free_cpu( sum );
+        }
+    }
+    else if ( A.storage_type == Magma_SELLCS )
+    {
+        // like SELLP, but the rows are sorted inside the sigma windows and
+        // rowidx maps them back; the common slice heights get a kernel with
+        // the height fixed at compile time
+        magma_int_t C = A.blocksize;
+        #pragma omp parallel num_threads( num_threads )
+        {
+#ifdef _OPENMP
+            magma_int_t id = omp_get_thread_num();
+            magma_int_t nt = omp_get_num_threads();
+#else
+            magma_int_t id = 0;
+            magma_int_t nt = 1;
+#endif
+            magma_int_t start, end;
+            magmaDoubleComplex sum[64];
+            magma_zspmv_cpu_split( A.numblocks, A.row, nt, id, &start, &end );
+            for( magma_int_t v=0; v < num_vecs; v++ ){
+                const magmaDoubleComplex *xp = x.val + v*xv;
+                magmaDoubleComplex *yp = y.val + v*yv;
+                for( magma_int_t s=start; s < end; s++ ){
+                    magma_int_t width = ( A.row[s+1] - A.row[s] ) / C;
+                    const magmaDoubleComplex *val = A.val + A.row[s];
+                    const magma_index_t *col = A.col + A.row[s];
+                    switch( C ){
+                        case 2:  magma_zsellcs_slice<2>( width, val, col, xp, xr, sum );  break;
+                        case 4:  magma_zsellcs_slice<4>( width, val, col, xp, xr, sum );  break;
+                        case 8:  magma_zsellcs_slice<8>( width, val, col, xp, xr, sum );  break;
+                        case 16: magma_zsellcs_slice<16>( width, val, col, xp, xr, sum ); break;
+                        case 32: magma_zsellcs_slice<32>( width, val, col, xp, xr, sum ); break;
+                        default: magma_zsellcs_slice_any( C, width, val, col, xp, xr, sum );
+                    }
+                    magma_int_t rows = min( C, A.num_rows - s*C );
+                    for( magma_int_t j=0; j < rows; j++ ){
+                        magma_int_t i = A.rowidx[ s*C + j ];
+                        yp[i*yr] = beta_zero ? alpha * sum[j]
+                                             : alpha * sum[j] + beta * yp[i*yr];
+                    }
+                }
+            }
+        }
+    }
+    else if ( A.storage_type == Magma_CSRSYM )
+    {
+        // Only the lower triangle is stored, so every off-diagonal entry
+        // a_ij also contributes a_ij (or conj(a_ij)) * x_i to row j < i.
+        // Every thread accumulates into a private buffer covering its rows
+        // and the rows below them it updates, [lo, end). Afterwards, every
+        // thread sums the buffers for its own rows, so no atomics are needed.
+        bool hermitian = ( A.sym == Magma_HERMITIAN );
+        magma_int_t *bounds = NULL;     // start, end, lo, offset per thread
+        CHECK( magma_malloc_cpu( (void**) &bounds, 4*num_threads*sizeof(magma_int_t) ));
+        #pragma omp parallel num_threads( num_threads )
+        {
+#ifdef _OPENMP
+            magma_int_t id = omp_get_thread_num();
+            magma_int_t nt = omp_get_num_threads();
+#else
+            magma_int_t id = 0;
+            magma_int_t nt = 1;
+#endif
+            magma_int_t start, end, lo;
+            magma_zspmv_cpu_split( A.num_rows, A.row, nt, id, &start, &end );
+            // the columns of a row are sorted, the first one is the lowest
+            lo = start;
+            for( magma_int_t i=start; i < end; i++ ){
+                if ( A.row[i] < A.row[i+1] ) {
+                    lo = min( lo, (magma_int_t) A.col[ A.row[i] ] );
+                }
+            }
+            bounds[4*id]   = start;
+            bounds[4*id+1] = end;
+            bounds[4*id+2] = lo;
+            #pragma omp barrier
+            #pragma omp single
+            {
+                magma_int_t total = 0;
+                for( magma_int_t t=0; t < nt; t++ ){
+                    bounds[4*t+3] = total;
+                    total += bounds[4*t+1] - bounds[4*t+2];
+                }
+                if ( magma_zmalloc_cpu( &work, max( total, 1 )) != MAGMA_SUCCESS ) {
+                    info = MAGMA_ERR_HOST_ALLOC;
+                }
+            }
+            // implicit barrier of single
+            for( magma_int_t v=0; info == 0 && v < num_vecs; v++ ){
+                const magmaDoubleComplex *xp = x.val + v*xv;
+                magmaDoubleComplex *yp = y.val + v*yv;
+                magmaDoubleComplex *acc = work + bounds[4*id+3] - lo;
+                for( magma_int_t j=lo; j < end; j++ ){
+                    acc[j] = zero;
+                }
+                for( magma_int_t i=start; i < end; i++ ){
+                    magmaDoubleComplex sum = zero;
+                    magmaDoubleComplex xi = xp[i*xr];
+                    for( magma_index_t k=A.row[i]; k < A.row[i+1]; k++ ){
+                        magma_index_t j = A.col[k];
+                        sum += A.val[k] * xp[j*xr];
+                        if ( j != i ) {
+                            acc[j] += ( hermitian ? MAGMA_Z_CONJ( A.val[k] ) : A.val[k] ) * xi;
+                        }
+                    }
+                    acc[i] += sum;
+                }
+                #pragma omp barrier
+                // add the contributions of the threads above to the own rows
+                for( magma_int_t t=id+1; t < nt; t++ ){
+                    magma_int_t tlo = bounds[4*t+2];
+                    const magmaDoubleComplex *tacc = work + bounds[4*t+3] - tlo;
+                    for( magma_int_t j=max( tlo, start ); j < min( bounds[4*t], end ); j++ ){
+                        acc[j] += tacc[j];
+                    }
+                }
+                for( magma_int_t i=start; i < end; i++ ){
+                    yp[i*yr] = beta_zero ? alpha * acc[i]
+                                         : alpha * acc[i] + beta * yp[i*yr];
+                }
+                #pragma omp barrier
+            }
+        }
+        magma_free_cpu( bounds );
+    }
+    else if ( A.storage_type == Magma_CSRMP )
+    {
+        // reduced precision values and 16-bit column deltas, see
+        // magmasparse_lowprec.h; rows are split by nonzeros as for CSR
+        #pragma omp parallel num_threads( num_threads )
+        {
+#ifdef _OPENMP
+            magma_int_t id = omp_get_thread_num();
+            magma_int_t nt = omp_get_num_threads();
+#else
+            magma_int_t id = 0;
+            magma_int_t nt = 1;
+#endif
+            magma_int_t start, end;
+            magma_zspmv_cpu_split( A.num_rows, A.row, nt, id, &start, &end );
+            for( magma_int_t v=0; v < num_vecs; v++ ){
+                const magmaDoubleComplex *xp = x.val + v*xv;
+                magmaDoubleComplex *yp = y.val + v*yv;
+                if ( A.val_format == Magma_HALF ) {
+                    magma_zcsrmp_rows<Magma_HALF>( A, start, end, alpha, beta, beta_zero, xp, xr, yp, yr );
+                } else if ( A.val_format == Magma_BFLOAT ) {
+                    magma_zcsrmp_rows<Magma_BFLOAT>( A, start, end, alpha, beta, beta_zero, xp, xr, yp, yr );
+                } else {
+                    magma_zcsrmp_rows<Magma_FLOAT>( A, start, end, alpha, beta, beta_zero, xp, xr, yp, yr );
+                }
+            }
+        }
+    }
+    else if ( A.storage_type == Magma_DENSE )
+    {
+        // host conversions produce row-major dense matrices
+        magma_int_t ar, ac;
+        if ( A.major == MagmaColMajor ) {
+            ar = 1;
+            ac = ( A.ld > 0 ) ? A.ld : A.num_rows;
+        } else {
+            ar = ( A.ld > 0 ) ? A.ld : A.num_cols;
+            ac = 1;
+        }
+        for( magma_int_t v=0; v < num_vecs; v++ ){
+            const magmaDoubleComplex *xp = x.val + v*xv;
+            magmaDoubleComplex *yp = y.val + v*yv;
+            #pragma omp parallel for schedule(static)
+            for( magma_int_t i=0; i < A.num_rows; i++ ){
+                magmaDoubleComplex sum = zero;
+                const magmaDoubleComplex *ai = A.val + i*ar;
+                for( magma_int_t j=0; j < A.num_cols; j++ ){
+                    sum += ai[ j*ac ] * xp[ j*xr ];
+                }
+                yp[i*yr] = beta_zero ? alpha * sum
+                                     : alpha * sum + beta * yp[i*yr];
+            }
+        }
+    }
+
+cleanup:
+    magma_free_cpu( work );
+    return info;
+}
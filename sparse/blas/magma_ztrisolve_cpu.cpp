@@ -0,0 +1,460 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include <thread>  // yield
+
+#include "magmasparse_internal.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// levels with fewer rows are solved by one thread, together with the
+// narrow levels following them, so they cost one barrier instead of many
+#define TRISOLVE_MIN_WIDTH 64
+
+// rows handed out at once in the sync-free solve
+#define TRISOLVE_CHUNK 16
+
+
+// Strides of row and vector index of the num_vecs vectors in X.
+static void
+magma_ztrisolve_strides(
+    magma_z_matrix X,
+    magma_int_t n,
+    magma_int_t num_vecs,
+    magma_int_t *sr,
+    magma_int_t *sv )
+{
+    if ( num_vecs > 1 && X.major == MagmaRowMajor ) {
+        *sr = num_vecs;
+        *sv = 1;
+    } else {
+        *sr = 1;
+        *sv = n;
+    }
+}
+
+
+// Checks the arguments of the host triangular solves and returns the number
+// of right-hand sides in num_vecs.
+static magma_int_t
+magma_ztrisolve_check(
+    magma_z_matrix T,
+    magma_int_t n,
+    magma_z_matrix b,
+    magma_z_matrix x,
+    magma_int_t *num_vecs )
+{
+    if ( T.memory_location != Magma_CPU || b.memory_location != Magma_CPU ||
+         x.memory_location != Magma_CPU ) {
+        return MAGMA_ERR_INVALID_PTR;
+    }
+    if ( T.num_rows != n ||
+         b.num_rows * b.num_cols != x.num_rows * x.num_cols ||
+         ( n > 0 && ( b.num_rows * b.num_cols ) % n != 0 ) ) {
+        return MAGMA_ERR_ILLEGAL_VALUE;
+    }
+    *num_vecs = ( n > 0 ) ? b.num_rows * b.num_cols / n : 0;
+    return MAGMA_SUCCESS;
+}
+
+
+// Solves row i for all vectors. x may be b: row i of b is only read before
+// row i of x is written, and the rows of x read are already solved.
+static inline void
+magma_ztrisolve_row(
+    const magma_z_matrix &T,
+    bool lower,
+    magma_index_t dpos,
+    magma_index_t i,
+    magma_int_t num_vecs,
+    const magmaDoubleComplex *b, magma_int_t br, magma_int_t bv,
+    magmaDoubleComplex *x, magma_int_t xr, magma_int_t xv )
+{
+    for( magma_int_t v=0; v < num_vecs; v++ ) {
+        x[ i*xr + v*xv ] = b[ i*br + v*bv ];
+    }
+    for( magma_index_t k=T.row[i]; k < T.row[i+1]; k++ ) {
+        magma_index_t j = T.col[k];
+        if ( lower ? j < i : j > i ) {
+            magmaDoubleComplex t = T.val[k];
+            for( magma_int_t v=0; v < num_vecs; v++ ) {
+                x[ i*xr + v*xv ] -= t * x[ j*xr + v*xv ];
+            }
+        }
+    }
+    if ( dpos >= 0 ) {
+        magmaDoubleComplex d = T.val[ dpos ];
+        for( magma_int_t v=0; v < num_vecs; v++ ) {
+            x[ i*xr + v*xv ] = x[ i*xr + v*xv ] / d;
+        }
+    }
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Solves T x = b on the host for a sparse triangular matrix T in CSR, using
+    the level sets of the plan: all rows of one level are distributed across
+    the OpenMP threads, with a barrier between levels. Narrow levels are
+    solved by a single thread, so long chains of dependent rows do not pay
+    one barrier per row.
+
+    b and x may hold several right-hand sides, stored as given in b.major and
+    x.major. The solve can be done in place, with x.val == b.val.
+
+    Arguments
+    ---------
+
+    @param[in]
+    T           magma_z_matrix
+                Triangular matrix in CSR located on the host.
+
+    @param[in]
+    plan        magma_trisolve_plan
+                Plan of T from magma_ztrisolve_plan_create.
+
+    @param[in]
+    b           magma_z_matrix
+                Right-hand side(s) located on the host.
+
+    @param[in,out]
+    x           magma_z_matrix*
+                Solution(s) located on the host.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_ztrisolve_cpu(
+    magma_z_matrix T,
+    magma_trisolve_plan plan,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = plan.num_rows;
+    magma_int_t num_vecs = 1, br, bv, xr, xv;
+    bool lower = ( plan.uplo == MagmaLower );
+    bool unit = ( plan.diag == MagmaUnit );
+
+    CHECK( magma_ztrisolve_check( T, n, b, *x, &num_vecs ));
+    magma_ztrisolve_strides( b, n, num_vecs, &br, &bv );
+    magma_ztrisolve_strides( *x, n, num_vecs, &xr, &xv );
+
+    #pragma omp parallel
+    {
+        magma_int_t l = 0;
+        while( l < plan.num_levels ) {
+            magma_index_t start = plan.level_ptr[l];
+            if ( plan.level_ptr[l+1] - start >= TRISOLVE_MIN_WIDTH ) {
+                #pragma omp for schedule(static)
+                for( magma_index_t p=start; p < plan.level_ptr[l+1]; p++ ) {
+                    magma_index_t i = plan.order[p];
+                    magma_ztrisolve_row( T, lower, unit ? -1 : plan.diag_pos[i],
+                        i, num_vecs, b.val, br, bv, x->val, xr, xv );
+                }
+                l++;
+            } else {
+                // all threads agree on the block of narrow levels
+                while( l < plan.num_levels &&
+                       plan.level_ptr[l+1] - plan.level_ptr[l] < TRISOLVE_MIN_WIDTH ) {
+                    l++;
+                }
+                #pragma omp single
+                for( magma_index_t p=start; p < plan.level_ptr[l]; p++ ) {
+                    magma_index_t i = plan.order[p];
+                    magma_ztrisolve_row( T, lower, unit ? -1 : plan.diag_pos[i],
+                        i, num_vecs, b.val, br, bv, x->val, xr, xv );
+                }
+            }
+        }
+    }
+
+cleanup:
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Solves T x = b on the host for a sparse triangular matrix T in CSR without
+    barriers: the rows are handed out to the OpenMP threads in the order of
+    the plan, and a thread waits on a ready flag for every row it depends on.
+    This pays off if the plan has many narrow levels.
+
+    b and x may hold several right-hand sides, stored as given in b.major and
+    x.major. The solve can be done in place, with x.val == b.val.
+
+    Arguments
+    ---------
+
+    @param[in]
+    T           magma_z_matrix
+                Triangular matrix in CSR located on the host.
+
+    @param[in]
+    plan        magma_trisolve_plan
+                Plan of T from magma_ztrisolve_plan_create.
+
+    @param[in]
+    b           magma_z_matrix
+                Right-hand side(s) located on the host.
+
+    @param[in,out]
+    x           magma_z_matrix*
+                Solution(s) located on the host.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_ztrisolve_syncfree_cpu(
+    magma_z_matrix T,
+    magma_trisolve_plan plan,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = plan.num_rows;
+    magma_int_t num_vecs = 1, br, bv, xr, xv;
+    magma_int_t next = 0;
+    bool lower = ( plan.uplo == MagmaLower );
+    bool unit = ( plan.diag == MagmaUnit );
+    char *ready = NULL;
+
+    CHECK( magma_ztrisolve_check( T, n, b, *x, &num_vecs ));
+    magma_ztrisolve_strides( b, n, num_vecs, &br, &bv );
+    magma_ztrisolve_strides( *x, n, num_vecs, &xr, &xv );
+    CHECK( magma_malloc_cpu( (void**) &ready, max( n, 1 )));
+    #pragma omp parallel for schedule(static)
+    for( magma_int_t i=0; i < n; i++ ) {
+        ready[i] = 0;
+    }
+
+    #pragma omp parallel
+    {
+        while( true ) {
+            magma_int_t first;
+            // blocks are handed out in order, so the lowest unsolved row
+            // never waits
+            #pragma omp atomic capture
+            { first = next; next += TRISOLVE_CHUNK; }
+            if ( first >= n ) {
+                break;
+            }
+            magma_int_t last = min( first + TRISOLVE_CHUNK, n );
+            for( magma_int_t p=first; p < last; p++ ) {
+                magma_index_t i = plan.order[p];
+                for( magma_index_t k=T.row[i]; k < T.row[i+1]; k++ ) {
+                    magma_index_t j = T.col[k];
+                    if ( lower ? j < i : j > i ) {
+                        char done;
+                        while( true ) {
+                            #pragma omp atomic read
+                            done = ready[j];
+                            if ( done ) {
+                                break;
+                            }
+                            // let the owner of row j run if threads share cores
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+                #pragma omp flush
+                magma_ztrisolve_row( T, lower, unit ? -1 : plan.diag_pos[i],
+                    i, num_vecs, b.val, br, bv, x->val, xr, xv );
+                #pragma omp flush
+                #pragma omp atomic write
+                ready[i] = 1;
+            }
+        }
+    }
+
+cleanup:
+    magma_free_cpu( ready );
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Solves T x = b on the host for a sparse triangular matrix T in CSR, one
+    row after the other. This needs no plan and serves as reference for the
+    parallel triangular solves.
+
+    b and x may hold several right-hand sides, stored as given in b.major and
+    x.major.
+
+    Arguments
+    ---------
+
+    @param[in]
+    uplo        magma_uplo_t
+                MagmaLower or MagmaUpper: triangle of T used in the solve.
+
+    @param[in]
+    diag        magma_diag_t
+                MagmaUnit or MagmaNonUnit.
+
+    @param[in]
+    T           magma_z_matrix
+                Triangular matrix in CSR located on the host.
+
+    @param[in]
+    b           magma_z_matrix
+                Right-hand side(s) located on the host.
+
+    @param[in,out]
+    x           magma_z_matrix*
+                Solution(s) located on the host.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_ztrisolve_serial_cpu(
+    magma_uplo_t uplo,
+    magma_diag_t diag,
+    magma_z_matrix T,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = T.num_rows;
+    magma_int_t num_vecs = 1, br, bv, xr, xv;
+    bool lower = ( uplo == MagmaLower );
+
+    CHECK( magma_ztrisolve_check( T, n, b, *x, &num_vecs ));
+    magma_ztrisolve_strides( b, n, num_vecs, &br, &bv );
+    magma_ztrisolve_strides( *x, n, num_vecs, &xr, &xv );
+
+    for( magma_int_t r=0; r < n; r++ ) {
+        magma_index_t i = lower ? r : n-1-r;
+        magma_index_t dpos = -1;
+        if ( diag == MagmaNonUnit ) {
+            for( magma_index_t k=T.row[i]; k < T.row[i+1]; k++ ) {
+                if ( T.col[k] == i ) {
+                    dpos = k;
+                }
+            }
+            if ( dpos < 0 ) {
+                info = MAGMA_ERR_BADPRECOND;
+                goto cleanup;
+            }
+        }
+        magma_ztrisolve_row( T, lower, dpos, i, num_vecs,
+            b.val, br, bv, x->val, xr, xv );
+    }
+
+cleanup:
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Applies an incomplete sparse approximate inverse (ISAI) M of the
+    triangular matrix T on the host:
+              x = M * b
+    followed by sweeps relaxation steps
+              x = x + M * ( b - T * x ).
+    This is the host counterpart of magma_zisai_l and magma_zisai_r: it only
+    needs SpMVs, which parallelize perfectly, and the relaxation steps move x
+    towards the exact triangular solve.
+
+    Arguments
+    ---------
+
+    @param[in]
+    T           magma_z_matrix
+                Triangular matrix located on the host.
+
+    @param[in]
+    M           magma_z_matrix
+                Approximate inverse of T located on the host.
+
+    @param[in]
+    b           magma_z_matrix
+                Right-hand side(s) located on the host.
+
+    @param[in,out]
+    x           magma_z_matrix*
+                Solution(s) located on the host, must not share memory with b.
+
+    @param[in,out]
+    work        magma_z_matrix*
+                Workspace of the size of b, allocated on first use.
+                Only needed for sweeps > 0.
+
+    @param[in]
+    sweeps      magma_int_t
+                Number of relaxation steps.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_ztrisolve_isai_cpu(
+    magma_z_matrix T,
+    magma_z_matrix M,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_z_matrix *work,
+    magma_int_t sweeps,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magmaDoubleComplex c_zero = MAGMA_Z_ZERO, c_one = MAGMA_Z_ONE;
+    magma_int_t n = b.num_rows*b.num_cols;
+
+    CHECK( magma_zspmv_cpu( c_one, M, b, c_zero, *x, queue ));      // x = M b
+    if ( sweeps > 0 && work->val == NULL ) {
+        CHECK( magma_zvinit( work, Magma_CPU, b.num_rows, b.num_cols, c_zero, queue ));
+        work->major = b.major;
+    }
+    for( magma_int_t s=0; s < sweeps; s++ ) {
+        CHECK( magma_zspmv_cpu( c_one, T, *x, c_zero, *work, queue )); // w = T x
+        #pragma omp parallel for schedule(static)
+        for( magma_int_t i=0; i < n; i++ ) {
+            work->val[i] = b.val[i] - work->val[i];                   // w = b - w
+        }
+        CHECK( magma_zspmv_cpu( c_one, M, *work, c_one, *x, queue ));  // x = x + M w
+    }
+
+cleanup:
+    return info;
+}
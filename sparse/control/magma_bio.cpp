@@ -0,0 +1,330 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       Precision independent part of the binary CSR container, see
+       magmasparse_bio.h for the file layout.
+*/
+#include <vector>
+
+#include "magmasparse_internal.h"
+#include "magmasparse_bio.h"
+
+#if ! defined( _WIN32 ) && ! defined( _WIN64 )
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+static inline uint32_t bio_swap32( uint32_t x )
+{
+    return   ((x & 0x000000ffu) << 24) | ((x & 0x0000ff00u) <<  8)
+           | ((x & 0x00ff0000u) >>  8) | ((x & 0xff000000u) >> 24);
+}
+
+static inline uint64_t bio_swap64( uint64_t x )
+{
+    return   ((uint64_t) bio_swap32( (uint32_t) x ) << 32)
+           | bio_swap32( (uint32_t) (x >> 32) );
+}
+
+
+size_t magma_bio_align( size_t offset )
+{
+    return (offset + MAGMA_BIO_ALIGN - 1) / MAGMA_BIO_ALIGN * MAGMA_BIO_ALIGN;
+}
+
+
+size_t magma_bio_value_size( uint32_t value_type )
+{
+    switch ( value_type ) {
+        case MAGMA_BIO_S: return sizeof(float);
+        case MAGMA_BIO_D: return sizeof(double);
+        case MAGMA_BIO_C: return 2*sizeof(float);
+        case MAGMA_BIO_Z: return 2*sizeof(double);
+        default:          return 0;
+    }
+}
+
+
+/*  Returns 1 if filename starts with the container magic, 0 otherwise. */
+int magma_bio_is_container( const char *filename )
+{
+    char magic[8];
+    int found = 0;
+    FILE *f = fopen( filename, "rb" );
+    if ( f != NULL ) {
+        found = fread( magic, 1, sizeof(magic), f ) == sizeof(magic)
+                && memcmp( magic, MAGMA_BIO_MAGIC, sizeof(magic) ) == 0;
+        fclose( f );
+    }
+    return found;
+}
+
+
+/*  Copies the header from the first size bytes of a container into h and
+    converts it to the host byte order; *swapped tells whether the sections
+    need swapping.                                                        */
+int magma_bio_read_header( const void *data, size_t size,
+                           magma_bio_header *h, int *swapped )
+{
+    if ( size < sizeof(magma_bio_header) )
+        return MAGMA_ERR_UNKNOWN;
+    memcpy( h, data, sizeof(magma_bio_header) );
+    if ( memcmp( h->magic, MAGMA_BIO_MAGIC, sizeof(h->magic) ) != 0 )
+        return MAGMA_ERR_NOT_SUPPORTED;
+
+    if ( h->endian == MAGMA_BIO_ENDIAN_TAG ) {
+        *swapped = 0;
+    }
+    else if ( bio_swap32( h->endian ) == MAGMA_BIO_ENDIAN_TAG ) {
+        *swapped = 1;
+        h->version      = bio_swap32( h->version );
+        h->endian       = bio_swap32( h->endian );
+        h->index_size   = bio_swap32( h->index_size );
+        h->value_type   = bio_swap32( h->value_type );
+        h->flags        = bio_swap32( h->flags );
+        h->sym          = (int32_t) bio_swap32( (uint32_t) h->sym );
+        h->fill_mode    = (int32_t) bio_swap32( (uint32_t) h->fill_mode );
+        h->num_rows     = (int64_t) bio_swap64( (uint64_t) h->num_rows );
+        h->num_cols     = (int64_t) bio_swap64( (uint64_t) h->num_cols );
+        h->nnz          = (int64_t) bio_swap64( (uint64_t) h->nnz );
+        h->row_offset   = bio_swap64( h->row_offset );
+        h->col_offset   = bio_swap64( h->col_offset );
+        h->val_offset   = bio_swap64( h->val_offset );
+        h->row_checksum = bio_swap64( h->row_checksum );
+        h->col_checksum = bio_swap64( h->col_checksum );
+        h->val_checksum = bio_swap64( h->val_checksum );
+        h->file_size    = bio_swap64( h->file_size );
+    }
+    else {
+        return MAGMA_ERR_NOT_SUPPORTED;
+    }
+    return 0;
+}
+
+
+/*  Checks that the sections described by h are aligned, ordered, and lie
+    within a file of file_size bytes.                                     */
+int magma_bio_check_header( const magma_bio_header *h, uint64_t file_size )
+{
+    uint64_t vsize = magma_bio_value_size( h->value_type );
+    uint64_t isize = h->index_size;
+
+    if ( h->version < 1 || h->version > MAGMA_BIO_VERSION )
+        return MAGMA_ERR_NOT_SUPPORTED;
+    if ( (isize != 4 && isize != 8) || vsize == 0 )
+        return MAGMA_ERR_NOT_SUPPORTED;
+    if ( h->num_rows < 0 || h->num_cols < 0 || h->nnz < 0 )
+        return MAGMA_ERR_UNKNOWN;
+    if ( h->file_size > file_size )
+        return MAGMA_ERR_UNKNOWN;
+    // bounds the products below, so they cannot overflow
+    if ( (uint64_t) h->num_rows >= file_size || (uint64_t) h->nnz > file_size )
+        return MAGMA_ERR_UNKNOWN;
+    if ( h->row_offset % MAGMA_BIO_ALIGN != 0 ||
+         h->col_offset % MAGMA_BIO_ALIGN != 0 ||
+         h->val_offset % MAGMA_BIO_ALIGN != 0 )
+        return MAGMA_ERR_UNKNOWN;
+    if ( h->row_offset < sizeof(magma_bio_header) ||
+         h->row_offset + (h->num_rows+1)*isize > h->col_offset ||
+         h->col_offset + h->nnz*isize > h->val_offset ||
+         h->val_offset + h->nnz*vsize > h->file_size )
+        return MAGMA_ERR_UNKNOWN;
+    return 0;
+}
+
+
+/*  Fletcher-64 over the 32-bit words of data, a trailing partial word is
+    padded with zeros. Chunks are summed in parallel: a chunk of L words
+    with sums (a_k, b_k) advances (a, b) to (a + a_k, b + L*a + b_k).      */
+uint64_t magma_bio_checksum( const void *data, size_t bytes )
+{
+    const uint64_t mod = 0xffffffffu;
+    const uint32_t *words = (const uint32_t*) data;
+    size_t nwords = bytes / 4;
+    uint64_t a = 0, b = 0;
+
+    int nthreads = 1;
+    #ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+    #endif
+    std::vector< uint64_t > asum( nthreads, 0 ), bsum( nthreads, 0 );
+    std::vector< size_t > len( nthreads, 0 );
+
+    #pragma omp parallel num_threads( nthreads )
+    {
+        int id = 0, nt = 1;
+        #ifdef _OPENMP
+        id = omp_get_thread_num();
+        nt = omp_get_num_threads();
+        #endif
+        size_t begin = nwords / nt * id + (id < (int)(nwords % nt) ? id : nwords % nt);
+        size_t end   = begin + nwords / nt + (id < (int)(nwords % nt) ? 1 : 0);
+        uint64_t ta = 0, tb = 0;
+        // 64-bit sums of up to 2^16 words cannot overflow
+        for( size_t i = begin; i < end; ) {
+            size_t block_end = (end - i > 65536) ? i + 65536 : end;
+            for( ; i < block_end; i++ ) {
+                ta += words[i];
+                tb += ta;
+            }
+            ta %= mod;
+            tb %= mod;
+        }
+        asum[id] = ta;
+        bsum[id] = tb;
+        len[id] = end - begin;
+    }
+    for( int k = 0; k < nthreads; k++ ) {
+        b = (b + (len[k] % mod) * a + bsum[k]) % mod;
+        a = (a + asum[k]) % mod;
+    }
+    if ( bytes % 4 != 0 ) {
+        uint32_t tail = 0;
+        memcpy( &tail, (const char*) data + 4*nwords, bytes % 4 );
+        a = (a + tail) % mod;
+        b = (b + a) % mod;
+    }
+    return (b << 32) | a;
+}
+
+
+/*  Makes the whole file accessible at map->base. The file is mapped
+    copy-on-write, so writable maps can be modified without touching the
+    file; where mapping is not available the file is read into a buffer.  */
+int magma_bio_map_file( const char *filename, int writable, magma_bio_map *map )
+{
+    map->base = NULL;
+    map->size = 0;
+    map->mapped = 0;
+
+    FILE *f = fopen( filename, "rb" );
+    if ( f == NULL )
+        return MAGMA_ERR_NOT_FOUND;
+
+#if ! defined( _WIN32 ) && ! defined( _WIN64 )
+    struct stat st;
+    if ( fstat( fileno(f), &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 ) {
+        int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+        void *base = mmap( NULL, st.st_size, prot, MAP_PRIVATE, fileno(f), 0 );
+        if ( base != MAP_FAILED ) {
+            fclose( f );
+            map->base = (char*) base;
+            map->size = st.st_size;
+            map->mapped = 1;
+            return 0;
+        }
+    }
+#endif
+
+    // no mapping: read the file into one buffer
+    long size;
+    if ( fseek( f, 0, SEEK_END ) != 0 || (size = ftell( f )) < 0
+         || fseek( f, 0, SEEK_SET ) != 0 ) {
+        fclose( f );
+        return MAGMA_ERR_UNKNOWN;
+    }
+    map->base = (char*) malloc( size > 0 ? size : 1 );
+    if ( map->base == NULL ) {
+        fclose( f );
+        return MAGMA_ERR_HOST_ALLOC;
+    }
+    if ( fread( map->base, 1, size, f ) != (size_t) size ) {
+        free( map->base );
+        map->base = NULL;
+        fclose( f );
+        return MAGMA_ERR_UNKNOWN;
+    }
+    fclose( f );
+    map->size = size;
+    return 0;
+}
+
+
+void magma_bio_unmap_file( magma_bio_map *map )
+{
+#if ! defined( _WIN32 ) && ! defined( _WIN64 )
+    if ( map->mapped )
+        munmap( map->base, map->size );
+    else
+#endif
+        free( map->base );
+    map->base = NULL;
+    map->size = 0;
+    map->mapped = 0;
+}
+
+
+void *magma_bio_handle( magma_bio_map *map )
+{
+    magma_bio_map *handle = (magma_bio_map*) malloc( sizeof(magma_bio_map) );
+    if ( handle != NULL ) {
+        *handle = *map;
+        map->base = NULL;
+        map->size = 0;
+        map->mapped = 0;
+    }
+    return handle;
+}
+
+
+void magma_bio_release( void *handle )
+{
+    magma_bio_map *map = (magma_bio_map*) handle;
+    if ( map == NULL )
+        return;
+    magma_bio_unmap_file( map );
+    free( map );
+}
+
+
+int64_t magma_bio_get_index( const void *section, size_t i,
+                             uint32_t index_size, int swapped )
+{
+    if ( index_size == 4 ) {
+        uint32_t v;
+        memcpy( &v, (const char*) section + 4*i, 4 );
+        return (int32_t) (swapped ? bio_swap32( v ) : v);
+    }
+    else {
+        uint64_t v;
+        memcpy( &v, (const char*) section + 8*i, 8 );
+        return (int64_t) (swapped ? bio_swap64( v ) : v);
+    }
+}
+
+
+void magma_bio_get_value( const void *section, size_t i,
+                          uint32_t value_type, int swapped,
+                          double *re, double *im )
+{
+    const char *p = (const char*) section + magma_bio_value_size( value_type ) * i;
+    int ncomp = (value_type == MAGMA_BIO_C || value_type == MAGMA_BIO_Z) ? 2 : 1;
+    double v[2] = { 0., 0. };
+    for( int c = 0; c < ncomp; c++ ) {
+        if ( value_type == MAGMA_BIO_S || value_type == MAGMA_BIO_C ) {
+            uint32_t u;
+            float x;
+            memcpy( &u, p + 4*c, 4 );
+            u = swapped ? bio_swap32( u ) : u;
+            memcpy( &x, &u, 4 );
+            v[c] = x;
+        }
+        else {
+            uint64_t u;
+            memcpy( &u, p + 8*c, 8 );
+            u = swapped ? bio_swap64( u ) : u;
+            memcpy( &v[c], &u, 8 );
+        }
+    }
+    *re = v[0];
+    *im = v[1];
+}
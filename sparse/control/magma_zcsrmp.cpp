@@ -0,0 +1,302 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include <algorithm>
+#include <utility>  // pair
+#include <vector>
+#include <climits>
+
+#include "magmasparse_internal.h"
+#include "magmasparse_lowprec.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// real components of one value
+#define NCOMP ( sizeof(magmaDoubleComplex) / sizeof(double) )
+
+
+// Stores the components of v at position k of the value array.
+static inline void
+magma_zcsrmp_store(
+    magma_precision val_format,
+    void *val,
+    magma_int_t k,
+    magmaDoubleComplex v )
+{
+    double comp[2] = { MAGMA_Z_REAL( v ), MAGMA_Z_IMAG( v ) };
+    for( magma_int_t c=0; c < (magma_int_t) NCOMP; c++ ) {
+        if ( val_format == Magma_HALF ) {
+            ((uint16_t*) val)[ k*NCOMP + c ] = magma_float2half( (float) comp[c] );
+        } else if ( val_format == Magma_BFLOAT ) {
+            ((uint16_t*) val)[ k*NCOMP + c ] = magma_float2bfloat( (float) comp[c] );
+        } else {
+            ((float*) val)[ k*NCOMP + c ] = (float) comp[c];
+        }
+    }
+}
+
+
+// Reads the value at position k of the value array.
+static inline magmaDoubleComplex
+magma_zcsrmp_load(
+    magma_precision val_format,
+    const void *val,
+    magma_int_t k )
+{
+    double comp[2] = { 0.0, 0.0 };
+    for( magma_int_t c=0; c < (magma_int_t) NCOMP; c++ ) {
+        if ( val_format == Magma_HALF ) {
+            comp[c] = magma_half2float( ((const uint16_t*) val)[ k*NCOMP + c ] );
+        } else if ( val_format == Magma_BFLOAT ) {
+            comp[c] = magma_bfloat2float( ((const uint16_t*) val)[ k*NCOMP + c ] );
+        } else {
+            comp[c] = ((const float*) val)[ k*NCOMP + c ];
+        }
+    }
+    return MAGMA_Z_MAKE( comp[0], comp[1] );
+}
+
+
+// Words of the index stream for a sorted row i with columns col[0:len).
+static inline magma_int_t
+magma_zcsrmp_words(
+    magma_index_t i,
+    const magma_index_t *col,
+    magma_index_t len )
+{
+    magma_int_t words = 0;
+    for( magma_index_t k=0; k < len; k++ ) {
+        int64_t d = (int64_t) col[k] - ( k == 0 ? i : col[k-1] );
+        if ( k == 0 ) {
+            d = ( d < 0 ) ? -2*d - 1 : 2*d;   // zig-zag
+        }
+        words += ( d < MAGMA_CSRMP_ESCAPE ) ? 1 : 3;
+    }
+    return words;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Converts a host CSR matrix into Magma_CSRMP: the values are rounded to
+    the precision val_format, the column indices are delta-encoded in 16-bit
+    words. Each real component takes 4 bytes for Magma_FLOAT and 2 bytes for
+    Magma_HALF and Magma_BFLOAT; a column index typically takes 2 bytes.
+    magma_zspmv_cpu multiplies the result and accumulates in the working
+    precision.
+
+    Values are rounded to float first, so fp16 and bfloat16 values may
+    differ from a direct rounding in the last bit in rare cases.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                Matrix in CSR located on the host.
+
+    @param[in]
+    val_format  magma_precision
+                Magma_FLOAT, Magma_HALF or Magma_BFLOAT.
+
+    @param[out]
+    B           magma_z_matrix*
+                Matrix in Magma_CSRMP.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zcsr2csrmp(
+    magma_z_matrix A,
+    magma_precision val_format,
+    magma_z_matrix *B,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = A.num_rows;
+    magma_int_t csize = magma_csrmp_component_size( val_format );
+    int64_t total = 0;
+    magma_index_t max_nnz_row = 0;
+    uint16_t *stream = NULL;
+    void *val = NULL;
+
+    if ( A.memory_location != Magma_CPU || A.storage_type != Magma_CSR ||
+         ( val_format != Magma_FLOAT && val_format != Magma_HALF &&
+           val_format != Magma_BFLOAT ) ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    // fill in information for B
+    B->storage_type = Magma_CSRMP;
+    B->memory_location = A.memory_location;
+    B->fill_mode = A.fill_mode;
+    B->sym = A.sym;
+    B->num_rows = A.num_rows;
+    B->num_cols = A.num_cols;
+    B->nnz = A.nnz; B->true_nnz = A.true_nnz;
+    B->diameter = A.diameter;
+    B->val_format = val_format;
+
+    CHECK( magma_index_malloc_cpu( &B->row, n+1 ));
+    CHECK( magma_index_malloc_cpu( &B->rowidx, n+1 ));
+    B->row[0] = 0;
+    B->rowidx[0] = 0;
+
+    // words of the index stream per row, rows are sorted on the fly
+    #pragma omp parallel
+    {
+        std::vector< magma_index_t > cols;
+        #pragma omp for schedule(dynamic, 1024) reduction(+:total) reduction(max:max_nnz_row)
+        for( magma_int_t i=0; i < n; i++ ) {
+            cols.assign( A.col + A.row[i], A.col + A.row[i+1] );
+            std::sort( cols.begin(), cols.end() );
+            magma_int_t words = magma_zcsrmp_words( i, cols.data(), cols.size() );
+            B->row[i+1] = A.row[i+1] - A.row[i];
+            B->rowidx[i+1] = words;
+            total += words;
+            max_nnz_row = max( max_nnz_row, B->row[i+1] );
+        }
+    }
+    if ( total > INT_MAX ) {
+        printf("%% error: index stream too long for CSRMP.\n");
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    CHECK( magma_zmatrix_createrowptr( n, B->row, queue ));
+    CHECK( magma_zmatrix_createrowptr( n, B->rowidx, queue ));
+    B->max_nnz_row = max_nnz_row;
+
+    CHECK( magma_malloc_cpu( (void**) &stream, max( total, 1 ) * sizeof(uint16_t) ));
+    CHECK( magma_malloc_cpu( &val, max( A.nnz, 1 ) * NCOMP * csize ));
+    B->mpcol = stream;
+    B->val = (magmaDoubleComplex*) val;
+
+    #pragma omp parallel
+    {
+        std::vector< std::pair< magma_index_t, magmaDoubleComplex > > rowval;
+        #pragma omp for schedule(dynamic, 1024)
+        for( magma_int_t i=0; i < n; i++ ) {
+            rowval.clear();
+            for( magma_index_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+                rowval.push_back( std::make_pair( A.col[k], A.val[k] ));
+            }
+            std::stable_sort( rowval.begin(), rowval.end(),
+                []( const std::pair< magma_index_t, magmaDoubleComplex >& a,
+                    const std::pair< magma_index_t, magmaDoubleComplex >& b )
+                    { return a.first < b.first; } );
+            uint16_t *p = stream + B->rowidx[i];
+            magma_index_t prev = i;
+            for( magma_index_t k=0; k < (magma_index_t) rowval.size(); k++ ) {
+                magma_index_t c = rowval[k].first;
+                int64_t d = (int64_t) c - prev;
+                if ( k == 0 ) {
+                    d = ( d < 0 ) ? -2*d - 1 : 2*d;
+                }
+                if ( d < MAGMA_CSRMP_ESCAPE ) {
+                    *p++ = (uint16_t) d;
+                } else {
+                    *p++ = MAGMA_CSRMP_ESCAPE;
+                    *p++ = (uint16_t) ( (uint32_t) c & 0xFFFF );
+                    *p++ = (uint16_t) ( (uint32_t) c >> 16 );
+                }
+                prev = c;
+                magma_zcsrmp_store( val_format, val, B->row[i]+k, rowval[k].second );
+            }
+        }
+    }
+
+cleanup:
+    if ( info != 0 ) {
+        magma_zmfree( B, queue );
+    }
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Converts a host Magma_CSRMP matrix back into CSR with sorted columns.
+    The values are the rounded ones.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                Matrix in Magma_CSRMP located on the host.
+
+    @param[out]
+    B           magma_z_matrix*
+                Matrix in CSR.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zcsrmp2csr(
+    magma_z_matrix A,
+    magma_z_matrix *B,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = A.num_rows;
+
+    if ( A.memory_location != Magma_CPU || A.storage_type != Magma_CSRMP ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    // fill in information for B
+    B->storage_type = Magma_CSR;
+    B->memory_location = A.memory_location;
+    B->fill_mode = A.fill_mode;
+    B->sym = A.sym;
+    B->num_rows = A.num_rows;
+    B->num_cols = A.num_cols;
+    B->nnz = A.nnz; B->true_nnz = A.true_nnz;
+    B->max_nnz_row = A.max_nnz_row;
+    B->diameter = A.diameter;
+
+    CHECK( magma_index_malloc_cpu( &B->row, n+1 ));
+    CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
+    CHECK( magma_zmalloc_cpu( &B->val, A.nnz ));
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n+1; i++ ) {
+        B->row[i] = A.row[i];
+    }
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ) {
+        const uint16_t *p = A.mpcol + A.rowidx[i];
+        magma_index_t c = i;
+        for( magma_index_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+            c = magma_csrmp_next_col( &p, c, k == A.row[i] );
+            B->col[k] = c;
+            B->val[k] = magma_zcsrmp_load( A.val_format, A.val, k );
+        }
+    }
+
+cleanup:
+    return info;
+}
@@ -9,6 +9,7 @@
        @author Hartwig Anzt
 */
 #include "magmasparse_internal.h"
+#include "magmasparse_bio.h"
 
 // todo: see how to destroy info
 // there are different, e.g., cusparseDestroyCsrsv2Info(info), etc.
@@ -80,6 +81,28 @@ magma_zmfree(
             A->num_cols = 0;
             A->nnz = 0; A->true_nnz = 0;
         }
+        if ( A->storage_type == Magma_SELLCS ) {
+            if (A->ownership) {
+                magma_free_cpu( A->val );
+                magma_free_cpu( A->row );
+                magma_free_cpu( A->col );
+                magma_free_cpu( A->rowidx );
+            }
+            A->num_rows = 0;
+            A->num_cols = 0;
+            A->nnz = 0; A->true_nnz = 0;
+        }
+        if ( A->storage_type == Magma_CSRMP ) {
+            if (A->ownership) {
+                magma_free_cpu( A->val );
+                magma_free_cpu( A->row );
+                magma_free_cpu( A->mpcol );
+                magma_free_cpu( A->rowidx );
+            }
+            A->num_rows = 0;
+            A->num_cols = 0;
+            A->nnz = 0; A->true_nnz = 0;
+        }
         if ( A->storage_type == Magma_CSR5 ) {
             if (A->ownership) {
                 magma_free_cpu( A->val );
@@ -117,7 +140,8 @@ magma_zmfree(
              A->storage_type == Magma_CSC  ||
              A->storage_type == Magma_CSRD ||
              A->storage_type == Magma_CSRL ||
-             A->storage_type == Magma_CSRU )
+             A->storage_type == Magma_CSRU ||
+             A->storage_type == Magma_CSRSYM )
         {
             if (A->ownership) {
                 magma_free_cpu( A->val );
@@ -128,7 +152,8 @@ magma_zmfree(
             A->num_cols = 0;
             A->nnz = 0; A->true_nnz = 0;
         }
-        if (  A->storage_type == Magma_CSRCOO ) {
+        if (  A->storage_type == Magma_CSRCOO ||
+              A->storage_type == Magma_COO ) {
             if (A->ownership) {
                 magma_free_cpu( A->val );
                 magma_free_cpu( A->col );
@@ -159,6 +184,9 @@ magma_zmfree(
             A->num_cols = 0;
             A->nnz = 0; A->true_nnz = 0;
         }
+        // a matrix read from a binary container points into its mapping
+        magma_bio_release( A->mapping );
+        A->mapping = NULL;
         A->val = NULL;
         A->col = NULL;
         A->row = NULL;
@@ -738,6 +766,20 @@ magma_zprecondfree(
         magma_free( precond_par->U_dgraphindegree_bak );
         precond_par->U_dgraphindegree_bak = NULL;
     }
+    if ( precond_par->hL.val != NULL ) {
+        magma_zmfree( &precond_par->hL, queue );
+        precond_par->hL.val = NULL;
+    }
+    if ( precond_par->hU.val != NULL ) {
+        magma_zmfree( &precond_par->hU, queue );
+        precond_par->hU.val = NULL;
+    }
+    if ( precond_par->hd.val != NULL ) {
+        magma_zmfree( &precond_par->hd, queue );
+        precond_par->hd.val = NULL;
+    }
+    magma_ztrisolve_plan_free( &precond_par->Lplan, queue );
+    magma_ztrisolve_plan_free( &precond_par->Uplan, queue );
 
     precond_par->solver = Magma_NONE;
     
@@ -810,8 +810,8 @@ cleanup:
 /***************************************************************************//**
     Purpose
     -------
-    Transposes a matrix that already contains rowidx. The idea is to use a 
-    linked list.
+    Transposes a matrix that already contains rowidx. The entries need not
+    be grouped by row. See magma_zmtransposeop_cpu.
 
     Arguments
     ---------
@@ -838,96 +838,10 @@ magma_zcsrcoo_transpose(
     magma_queue_t queue)
 {
     magma_int_t info = 0;
-    magma_index_t *linked_list;
-    magma_index_t *row_ptr;
-    magma_index_t *last_rowel;
-    
-    magma_int_t el_per_block, num_threads=1;
-    
-    B->storage_type = A.storage_type;
-    B->memory_location = A.memory_location;
-    
-    B->num_rows = A.num_rows;
-    B->num_cols = A.num_cols;
-    B->nnz      = A.nnz;
-    
-    CHECK(magma_index_malloc_cpu(&linked_list, A.nnz));
-    CHECK(magma_index_malloc_cpu(&row_ptr, A.num_rows+1));
-    CHECK(magma_index_malloc_cpu(&last_rowel, A.num_rows+1));
-    CHECK(magma_index_malloc_cpu(&B->row, A.num_rows+1));
-    CHECK(magma_index_malloc_cpu(&B->rowidx, A.nnz));
-    CHECK(magma_index_malloc_cpu(&B->col, A.nnz));
-    CHECK(magma_zmalloc_cpu(&B->val, A.nnz));
-#ifdef _OPENMP
-    #pragma omp parallel
-    {
-        num_threads = omp_get_max_threads();
-    }
-#else
-    num_threads = 1;
-#endif
-    
-    #pragma omp parallel for
-    for (magma_int_t i=0; i<A.num_rows; i++) {
-        row_ptr[i] = -1;
-    }
-    #pragma omp parallel for
-    for (magma_int_t i=0; i<A.num_rows+1; i++) {
-        B->row[i] = 0;
-    }
-    
-    el_per_block = magma_ceildiv(A.num_rows, num_threads);
 
-    #pragma omp parallel
-    {
-#ifdef _OPENMP
-    magma_int_t id = omp_get_thread_num();
-#else
-    magma_int_t id = 0;
-#endif
-        for (magma_int_t i=0; i<A.nnz; i++) {
-            magma_index_t row = A.col[ i ];
-            if((row < (id+1)*el_per_block) && (row >=(id)*el_per_block)) {
-                if(row_ptr[row] == -1) {
-                    row_ptr[ row ] = i;
-                    linked_list[ i ] = 0;
-                    last_rowel[ row ] = i;
-                } else {
-                    linked_list[ last_rowel[ row ] ] = i;
-                    linked_list[ i ] = 0;
-                    last_rowel[ row ] = i;
-                }
-                B->row[row+1] = B->row[row+1] + 1;
-            }
-        }
-    }
-    
-    // new rowptr
-    B->row[0]=0;   
-    magma_zmatrix_createrowptr(B->num_rows, B->row, queue);
-    
+    CHECK( magma_zmtransposeop_cpu( A, B, Magma_TRANSVAL, NULL, queue ));
 
-    assert(B->row[B->num_rows] == A.nnz);
-    
-    #pragma omp parallel for
-    for (magma_int_t row=0; row<A.num_rows; row++) {
-        magma_int_t el = row_ptr[row];
-        if(el>-1) {
-            
-            for (magma_int_t i=B->row[row]; i<B->row[row+1]; i++) {
-                // assert(A.col[el] == row);
-                B->val[i] = A.val[el];
-                B->col[i] = A.rowidx[el];
-                B->rowidx[i] = row;
-                el = linked_list[el];
-            }
-        }
-    }
-    
 cleanup:
-    magma_free_cpu(row_ptr);
-    magma_free_cpu(last_rowel);
-    magma_free_cpu(linked_list);
     return info;
 }
 
@@ -1049,6 +963,8 @@ magma_zmatrix_swap(
     magma_int_t tmp;
     magma_index_t *index_swap;
     magmaDoubleComplex *val_swap;
+    magma_bool_t ownership_swap;
+    void *mapping_swap;
     
     assert(A->storage_type == B->storage_type);
     assert(A->memory_location == B->memory_location);
@@ -1073,6 +989,14 @@ magma_zmatrix_swap(
     A->val = B->val;
     B->val = val_swap;
     
+    // ownership and the container mapping move with the arrays
+    ownership_swap = A->ownership;
+    A->ownership = B->ownership;
+    B->ownership = ownership_swap;
+    mapping_swap = A->mapping;
+    A->mapping = B->mapping;
+    B->mapping = mapping_swap;
+    
     return info;
 }
 
@@ -1296,7 +1220,7 @@ magma_zmatrix_abssum(
 /***************************************************************************//**
     Purpose
     -------
-    SOrts the elements in a CSR matrix for increasing column index.
+    Sorts the elements in a CSR matrix for increasing column index.
 
     Arguments
     ---------
@@ -1320,10 +1244,19 @@ magma_zcsr_sort(
     magma_int_t info = 0;
     
     if (A->memory_location == Magma_CPU && A->storage_type == Magma_CSR){
-        #pragma omp parallel  
-        for (int row=0; row<A->num_rows; row++) {
-            magma_zindexsort(&A->col[A->row[row]], 0, 
-                A->row[row+1]-A->row[row]-1, queue);
+        // values move with their column indices; rows that are already
+        // sorted are skipped, as quicksort is slow on sorted input
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (magma_int_t row=0; row<A->num_rows; row++) {
+            magma_index_t *col = &A->col[A->row[row]];
+            magma_int_t len = A->row[row+1]-A->row[row];
+            magma_int_t k = 1;
+            while (k < len && col[k-1] <= col[k]) {
+                k++;
+            }
+            if (k < len) {
+                magma_zindexsortval(col, &A->val[A->row[row]], 0, len-1, queue);
+            }
         }
     } else {
         info = MAGMA_ERR_NOT_SUPPORTED;
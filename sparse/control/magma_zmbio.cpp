@@ -0,0 +1,349 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+
+//  binary CSR container, see magmasparse_bio.h for the file layout
+
+#include "magmasparse_internal.h"
+#include "magmasparse_bio.h"
+
+#define PRECISION_z
+
+#if defined(PRECISION_z)
+#define BIO_VALUE_TYPE MAGMA_BIO_Z
+#elif defined(PRECISION_c)
+#define BIO_VALUE_TYPE MAGMA_BIO_C
+#elif defined(PRECISION_d)
+#define BIO_VALUE_TYPE MAGMA_BIO_D
+#else
+#define BIO_VALUE_TYPE MAGMA_BIO_S
+#endif
+
+
+/**
+    Purpose
+    -------
+
+    Writes a matrix to a binary CSR container. The container holds the
+    row pointer, the column indices, and the values in host layout, each
+    section 64-byte aligned, so that magma_z_csr_bin can map it back into
+    memory without converting it. Matrices that are not in CSR format or
+    not on the CPU are converted first.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                matrix to write out
+
+    @param[in]
+    filename    const char*
+                output-filename of the container
+
+    @param[in]
+    checksum    magma_int_t
+                if nonzero, Fletcher-64 checksums of all sections are
+                stored in the header and verified by magma_z_csr_bin
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C"
+magma_int_t
+magma_zwrite_csr_bin(
+    magma_z_matrix A,
+    const char *filename,
+    magma_int_t checksum,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    FILE *fp = NULL;
+    magma_z_matrix B={Magma_CSR}, C={Magma_CSR};
+    magma_z_matrix *M = &A;
+    magma_bio_header h;
+    char zeros[ MAGMA_BIO_ALIGN ] = { 0 };
+    size_t row_bytes, col_bytes, val_bytes;
+
+    if ( A.memory_location != Magma_CPU ) {
+        CHECK( magma_zmtransfer( A, &B, A.memory_location, Magma_CPU, queue ));
+        M = &B;
+    }
+    if ( M->storage_type != Magma_CSR  && M->storage_type != Magma_CSRL &&
+         M->storage_type != Magma_CSRU && M->storage_type != Magma_CSRCOO ) {
+        CHECK( magma_zmconvert( *M, &C, M->storage_type, Magma_CSR, queue ));
+        M = &C;
+    }
+
+    row_bytes = (M->num_rows+1) * sizeof(magma_index_t);
+    col_bytes = M->nnz * sizeof(magma_index_t);
+    val_bytes = M->nnz * sizeof(magmaDoubleComplex);
+
+    memset( &h, 0, sizeof(h) );
+    memcpy( h.magic, MAGMA_BIO_MAGIC, sizeof(h.magic) );
+    h.version      = MAGMA_BIO_VERSION;
+    h.endian       = MAGMA_BIO_ENDIAN_TAG;
+    h.index_size   = sizeof(magma_index_t);
+    h.value_type   = BIO_VALUE_TYPE;
+    h.sym          = M->sym;
+    h.fill_mode    = M->fill_mode;
+    h.num_rows     = M->num_rows;
+    h.num_cols     = M->num_cols;
+    h.nnz          = M->nnz;
+    h.row_offset   = magma_bio_align( sizeof(h) );
+    h.col_offset   = magma_bio_align( h.row_offset + row_bytes );
+    h.val_offset   = magma_bio_align( h.col_offset + col_bytes );
+    h.file_size    = h.val_offset + val_bytes;
+    if ( checksum ) {
+        h.flags       |= MAGMA_BIO_CHECKSUMS;
+        h.row_checksum = magma_bio_checksum( M->row, row_bytes );
+        h.col_checksum = magma_bio_checksum( M->col, col_bytes );
+        h.val_checksum = magma_bio_checksum( M->val, val_bytes );
+    }
+
+    fp = fopen( filename, "wb" );
+    if ( fp == NULL ) {
+        printf("\n%% error writing matrix: missing write permission for %s\n", filename );
+        info = MAGMA_ERR_NOT_FOUND;
+        goto cleanup;
+    }
+    if (    fwrite( &h, sizeof(h), 1, fp ) != 1
+         || fwrite( zeros, 1, h.row_offset - sizeof(h), fp ) != h.row_offset - sizeof(h)
+         || fwrite( M->row, 1, row_bytes, fp ) != row_bytes
+         || fwrite( zeros, 1, h.col_offset - h.row_offset - row_bytes, fp )
+                          != h.col_offset - h.row_offset - row_bytes
+         || fwrite( M->col, 1, col_bytes, fp ) != col_bytes
+         || fwrite( zeros, 1, h.val_offset - h.col_offset - col_bytes, fp )
+                          != h.val_offset - h.col_offset - col_bytes
+         || fwrite( M->val, 1, val_bytes, fp ) != val_bytes ) {
+        printf("\n%% error writing matrix to %s\n", filename );
+        info = MAGMA_ERR_UNKNOWN;
+        goto cleanup;
+    }
+
+cleanup:
+    if ( fp != NULL ) {
+        if ( fclose( fp ) != 0 && info == 0 ) {
+            printf("\n%% error writing matrix to %s\n", filename );
+            info = MAGMA_ERR_UNKNOWN;
+        }
+    }
+    magma_zmfree( &B, queue );
+    magma_zmfree( &C, queue );
+    return info;
+}
+
+
+/**
+    Purpose
+    -------
+
+    Reads a CSR matrix from a binary container written by
+    magma_zwrite_csr_bin.
+
+    If the container was written with the same index size, precision, and
+    byte order, the file is mapped copy-on-write and A points directly into
+    the mapping: nothing is read until it is accessed, and the mapping is
+    released by magma_zmfree. Otherwise the sections are converted into
+    newly allocated arrays.
+
+    A zero-copy matrix has ownership = MagmaFalse and keeps the mapping in
+    A->mapping. Its values and indices may be changed in place (the mapping
+    is private, the file stays as it is), but its arrays must not be freed
+    or reallocated, so routines that replace the arrays of their argument
+    need a copy, e.g. from magma_zmtransfer. Like owned arrays, the mapping
+    belongs to the structure: views from magma_zcsrset do not share it, and
+    of several copies of the structure only one may be freed.
+
+    Values of a different precision are converted
+    like in magma_z_csr_mtx, i.e., imaginary parts are dropped when reading
+    complex values into a real matrix.
+
+    Arguments
+    ---------
+
+    @param[out]
+    A           magma_z_matrix*
+                matrix in magma sparse matrix format
+
+    @param[in]
+    filename    const char*
+                filename of the container
+
+    @param[in]
+    verify      magma_int_t
+                if nonzero, the section checksums (if present) and the
+                structure of the matrix are verified, which touches all data
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C"
+magma_int_t
+magma_z_csr_bin(
+    magma_z_matrix *A,
+    const char *filename,
+    magma_int_t verify,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_bio_map map = { NULL, 0, 0 };
+    magma_bio_header h;
+    int swapped = 0, zero_copy = 0;
+    const char *row_section, *col_section, *val_section;
+    magma_index_t *row = NULL, *col = NULL;
+    magmaDoubleComplex *val = NULL;
+    magma_int_t num_rows, nnz, bad = 0;
+
+    // make sure the target structure is empty
+    magma_zmfree( A, queue );
+    A->ownership = MagmaTrue;
+
+    info = magma_bio_map_file( filename, 1, &map );
+    if ( info != 0 ) {
+        printf("%% Unable to open file %s\n", filename);
+        goto cleanup;
+    }
+    info = magma_bio_read_header( map.base, map.size, &h, &swapped );
+    if ( info == 0 ) {
+        info = magma_bio_check_header( &h, map.size );
+    }
+    if ( info != 0 ) {
+        printf("%% Reading sparse matrix from file (%s):", filename);
+        printf("\n%% Invalid or unsupported binary container.\n");
+        goto cleanup;
+    }
+
+    num_rows = h.num_rows;
+    nnz      = h.nnz;
+    if (    (magma_index_t) h.num_rows != h.num_rows
+         || (magma_index_t) h.num_cols != h.num_cols
+         || (magma_index_t) h.nnz != h.nnz ) {
+        printf("%% Reading sparse matrix from file (%s):", filename);
+        printf("\n%% Matrix too large for magma_index_t.\n");
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    row_section = map.base + h.row_offset;
+    col_section = map.base + h.col_offset;
+    val_section = map.base + h.val_offset;
+
+    if ( verify && (h.flags & MAGMA_BIO_CHECKSUMS) ) {
+        if (    magma_bio_checksum( row_section, (num_rows+1)*h.index_size ) != h.row_checksum
+             || magma_bio_checksum( col_section, nnz*h.index_size ) != h.col_checksum
+             || magma_bio_checksum( val_section, nnz*magma_bio_value_size( h.value_type ))
+                                                                    != h.val_checksum ) {
+            printf("%% Reading sparse matrix from file (%s):", filename);
+            printf("\n%% Checksum mismatch, the file is corrupted.\n");
+            info = MAGMA_ERR_UNKNOWN;
+            goto cleanup;
+        }
+    }
+
+    zero_copy = ! swapped
+                && h.index_size == sizeof(magma_index_t)
+                && h.value_type == BIO_VALUE_TYPE;
+    if ( zero_copy ) {
+        row = (magma_index_t*) row_section;
+        col = (magma_index_t*) col_section;
+        val = (magmaDoubleComplex*) val_section;
+    }
+    else {
+        CHECK( magma_index_malloc_cpu( &row, num_rows+1 ));
+        CHECK( magma_index_malloc_cpu( &col, nnz ));
+        CHECK( magma_zmalloc_cpu( &val, nnz ));
+
+        #pragma omp parallel for reduction(max:bad)
+        for( magma_int_t i=0; i < num_rows+1; i++ ) {
+            int64_t r = magma_bio_get_index( row_section, i, h.index_size, swapped );
+            if ( r < 0 || r > nnz )
+                bad = 1;
+            row[i] = (magma_index_t) r;
+        }
+        #pragma omp parallel for reduction(max:bad)
+        for( magma_int_t j=0; j < nnz; j++ ) {
+            real_Double_t re, im;  // double in all precisions
+            int64_t c = magma_bio_get_index( col_section, j, h.index_size, swapped );
+            if ( c < 0 || c >= h.num_cols )
+                bad = 1;
+            col[j] = (magma_index_t) c;
+            magma_bio_get_value( val_section, j, h.value_type, swapped, &re, &im );
+            val[j] = MAGMA_Z_MAKE( re, im );
+        }
+    }
+
+    // cheap consistency check, everything else only on request
+    if ( row[0] != 0 || row[num_rows] != nnz ) {
+        bad = 1;
+    }
+    if ( verify && ! bad ) {
+        #pragma omp parallel for reduction(max:bad)
+        for( magma_int_t i=0; i < num_rows; i++ ) {
+            if ( row[i] > row[i+1] ) {
+                bad = 1;
+                continue;
+            }
+            for( magma_index_t j=row[i]; j < row[i+1]; j++ ) {
+                if ( col[j] < 0 || col[j] >= h.num_cols )
+                    bad = 1;
+            }
+        }
+    }
+    if ( bad ) {
+        printf("%% Reading sparse matrix from file (%s):", filename);
+        printf("\n%% Invalid CSR structure in binary container.\n");
+        info = MAGMA_ERR_UNKNOWN;
+        goto cleanup;
+    }
+
+    A->storage_type    = Magma_CSR;
+    A->memory_location = Magma_CPU;
+    A->num_rows        = num_rows;
+    A->num_cols        = h.num_cols;
+    A->nnz             = nnz;
+    A->true_nnz        = nnz;
+    A->sym             = (magma_symmetry_t) h.sym;
+    A->fill_mode       = (magma_uplo_t) h.fill_mode;
+    A->row             = row;
+    A->col             = col;
+    A->val             = val;
+    if ( zero_copy ) {
+        // A keeps the mapping, magma_zmfree releases it
+        A->mapping = magma_bio_handle( &map );
+        if ( A->mapping == NULL ) {
+            info = MAGMA_ERR_HOST_ALLOC;
+            goto cleanup;
+        }
+        A->ownership = MagmaFalse;
+    }
+    row = NULL;
+    col = NULL;
+    val = NULL;
+
+cleanup:
+    if ( ! zero_copy ) {
+        magma_free_cpu( row );
+        magma_free_cpu( col );
+        magma_free_cpu( val );
+    }
+    if ( map.base != NULL ) {
+        magma_bio_unmap_file( &map );
+    }
+    return info;
+}
@@ -8,7 +8,14 @@
        @precisions normal z -> s d c
        @author Hartwig Anzt
 */
+#include <algorithm>
+#include <utility>  // pair
+#include <vector>
+
 #include "magmasparse_internal.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <cuda.h>  // for CUDA_VERSION
 
@@ -39,6 +46,171 @@
 #endif
 
 
+/***************************************************************************//**
+    Host conversion core.
+
+    All host conversions that change the order of the entries go through
+    magma_zmconvert_coo2csr: rows are counted with atomics, the counts are
+    turned into the row pointer by the parallel prefix sum in
+    magma_zmatrix_createrowptr, the entries are scattered to their rows in
+    parallel, and each row is sorted by column. Ties keep the input order,
+    so the result does not depend on the number of threads.
+    Conversions that keep the order of the entries count the entries of
+    each row in parallel, build the row pointer the same way, and then fill
+    the rows in parallel.
+*******************************************************************************/
+
+// Expands the pointer array ptr of n rows (or columns) into the index of
+// every entry, i.e., idx[k] = i for ptr[i] <= k < ptr[i+1].
+static void
+magma_zmconvert_expand(
+    magma_int_t n,
+    const magma_index_t *ptr,
+    magma_index_t *idx )
+{
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ) {
+        for( magma_int_t k=ptr[i]; k < ptr[i+1]; k++ ) {
+            idx[k] = i;
+        }
+    }
+}
+
+
+// Sorts the entries start to end-1 of col and val by column. Stable, so
+// duplicate columns keep their order.
+static void
+magma_zmconvert_sortrow(
+    magma_index_t *col,
+    magmaDoubleComplex *val,
+    magma_int_t start,
+    magma_int_t end )
+{
+    if ( end - start <= 32 ) {
+        // insertion sort for short rows
+        for( magma_int_t k=start+1; k < end; k++ ) {
+            magma_index_t c = col[k];
+            magmaDoubleComplex v = val[k];
+            magma_int_t j = k;
+            while ( j > start && col[j-1] > c ) {
+                col[j] = col[j-1];
+                val[j] = val[j-1];
+                j--;
+            }
+            col[j] = c;
+            val[j] = v;
+        }
+    }
+    else {
+        std::vector< std::pair< magma_index_t, magmaDoubleComplex > > rowval( end - start );
+        for( magma_int_t k=start; k < end; k++ ) {
+            rowval[k-start] = std::make_pair( col[k], val[k] );
+        }
+        std::stable_sort( rowval.begin(), rowval.end(),
+            []( const std::pair< magma_index_t, magmaDoubleComplex >& a,
+                const std::pair< magma_index_t, magmaDoubleComplex >& b ) {
+                return a.first < b.first;
+            });
+        for( magma_int_t k=start; k < end; k++ ) {
+            col[k] = rowval[k-start].first;
+            val[k] = rowval[k-start].second;
+        }
+    }
+}
+
+
+// Sorts the nnz entries (rowidx[k], colidx[k], val[k]) into CSR with n rows:
+// row (n+1 entries), col and valout (nnz entries each).
+// Also transposes CSR (rowidx = A.col, colidx = expanded A.row) into CSC.
+static magma_int_t
+magma_zmconvert_coo2csr(
+    magma_int_t n,
+    magma_int_t nnz,
+    const magma_index_t *rowidx,
+    const magma_index_t *colidx,
+    const magmaDoubleComplex *val,
+    magma_index_t *row,
+    magma_index_t *col,
+    magmaDoubleComplex *valout,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_index_t *perm=NULL, *fill=NULL;
+
+    CHECK( magma_index_malloc_cpu( &perm, nnz ));
+    CHECK( magma_index_malloc_cpu( &fill, n+1 ));
+
+    // count
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n+1; i++ ) {
+        row[i] = 0;
+    }
+    #pragma omp parallel for
+    for( magma_int_t k=0; k < nnz; k++ ) {
+        #pragma omp atomic
+        row[ rowidx[k]+1 ]++;
+    }
+    CHECK( magma_zmatrix_createrowptr( n, row, queue ));
+
+    // scatter entry numbers; fill is the insertion pointer of each row
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n; i++ ) {
+        fill[i] = row[i];
+    }
+    #pragma omp parallel for
+    for( magma_int_t k=0; k < nnz; k++ ) {
+        magma_index_t dest;
+        #pragma omp atomic capture
+        dest = fill[ rowidx[k] ]++;
+        perm[dest] = k;
+    }
+
+    // sort each row by (column, entry number), then gather; rows scattered
+    // by one thread are already in order
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ) {
+        magma_index_t *begin = perm + row[i];
+        magma_index_t *end   = perm + row[i+1];
+        auto less = [&]( magma_index_t a, magma_index_t b ) {
+            return colidx[a] < colidx[b] || ( colidx[a] == colidx[b] && a < b );
+        };
+        if ( ! std::is_sorted( begin, end, less )) {
+            std::sort( begin, end, less );
+        }
+        for( magma_index_t *e = begin; e < end; e++ ) {
+            col[ e - perm ]    = colidx[ *e ];
+            valout[ e - perm ] = val[ *e ];
+        }
+    }
+
+cleanup:
+    magma_free_cpu( perm );
+    magma_free_cpu( fill );
+    return info;
+}
+
+
+// Returns in bcol the sorted block columns of the nonzero blocks in block
+// row bi of the CSR matrix A, with size_b x size_b blocks.
+static void
+magma_zmconvert_blockcols(
+    magma_z_matrix A,
+    magma_int_t size_b,
+    magma_int_t bi,
+    std::vector< magma_index_t >& bcol )
+{
+    magma_int_t end = min( (bi+1)*size_b, A.num_rows );
+    bcol.clear();
+    for( magma_int_t i=bi*size_b; i < end; i++ ) {
+        for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++ ) {
+            bcol.push_back( A.col[j] / size_b );
+        }
+    }
+    std::sort( bcol.begin(), bcol.end() );
+    bcol.erase( std::unique( bcol.begin(), bcol.end() ), bcol.end() );
+}
+
+
 /**
     Purpose
     -------
@@ -97,32 +269,33 @@ magma_z_csr_compressor(
 {
     magma_int_t info = 0;
 
-    magma_index_t i,j, nnz_new=0, (*row_nnz)=NULL, nnz_this_row;
-    CHECK( magma_index_malloc_cpu( &(row_nnz), (*n) ));
+    magma_int_t nnz_new;
     CHECK( magma_index_malloc_cpu( rown, *n+1 ));
-    for( i=0; i<*n; i++ ) {
-        (*rown)[i] = nnz_new;
-        nnz_this_row = 0;
-        for( j=(*row)[i]; j<(*row)[i+1]; j++ ) {
+    (*rown)[0] = 0;
+    #pragma omp parallel for
+    for( magma_int_t i=0; i<*n; i++ ) {
+        magma_index_t nnz_this_row = 0;
+        for( magma_int_t j=(*row)[i]; j<(*row)[i+1]; j++ ) {
             if ( (MAGMA_Z_REAL((*val)[j]) != 0) || (MAGMA_Z_IMAG((*val)[j]) != 0) ) {
-                nnz_new++;
                 nnz_this_row++;
             }
         }
-        row_nnz[i] = nnz_this_row;
+        (*rown)[i+1] = nnz_this_row;
     }
-    (*rown)[*n] = nnz_new;
+    CHECK( magma_zmatrix_createrowptr( *n, *rown, queue ));
+    nnz_new = (*rown)[*n];
 
     CHECK( magma_zmalloc_cpu( valn, nnz_new ));
     CHECK( magma_index_malloc_cpu( coln, nnz_new ));
 
-    nnz_new = 0;
-    for( i=0; i<*n; i++ ) {
-        for( j=(*row)[i]; j<(*row)[i+1]; j++ ) {
+    #pragma omp parallel for
+    for( magma_int_t i=0; i<*n; i++ ) {
+        magma_index_t k = (*rown)[i];
+        for( magma_int_t j=(*row)[i]; j<(*row)[i+1]; j++ ) {
             if ( (MAGMA_Z_REAL((*val)[j]) != 0) || (MAGMA_Z_IMAG((*val)[j]) != 0) ) {
-                (*valn)[nnz_new]= (*val)[j];
-                (*coln)[nnz_new]= (*col)[j];
-                nnz_new++;
+                (*valn)[k]= (*val)[j];
+                (*coln)[k]= (*col)[j];
+                k++;
             }
         }
     }
@@ -130,12 +303,13 @@ magma_z_csr_compressor(
 
 cleanup:
     if ( info != 0 ) {
-        magma_free_cpu( valn );
-        magma_free_cpu( coln );
-        magma_free_cpu( rown );
+        magma_free_cpu( *valn );
+        magma_free_cpu( *coln );
+        magma_free_cpu( *rown );
+        *valn = NULL;
+        *coln = NULL;
+        *rown = NULL;
     }
-    magma_free_cpu( row_nnz );
-    row_nnz = NULL;
     return info;
 }
 
@@ -146,6 +320,9 @@ cleanup:
 
     Converter between different sparse storage formats.
 
+    On the CPU, the conversions run in parallel using OpenMP; the result
+    does not depend on the number of threads.
+
     Arguments
     ---------
 
@@ -248,10 +425,12 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
                 CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
 
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.nnz; i++) {
                     B->val[i] = A.val[i];
                     B->col[i] = A.col[i];
                 }
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++) {
                     B->row[i] = A.row[i];
                 }
@@ -273,22 +452,26 @@ magma_zmconvert(
                 B->true_nnz = A.true_nnz;
                 B->diameter = A.diameter;
 
-                magma_int_t numzeros=0;
+                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
+                B->row[0] = 0;
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows; i++) {
+                    magma_index_t numzeros = 0;
                     for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++) {
                         if ( A.col[j] <= i) {
                             numzeros++;
                         }
                     }
+                    B->row[i+1] = numzeros;
                 }
-                B->nnz = numzeros;
-                CHECK( magma_zmalloc_cpu( &B->val, numzeros ));
-                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
-                CHECK( magma_index_malloc_cpu( &B->col, numzeros ));
+                CHECK( magma_zmatrix_createrowptr( A.num_rows, B->row, queue ));
+                B->nnz = B->row[A.num_rows];
+                CHECK( magma_zmalloc_cpu( &B->val, B->nnz ));
+                CHECK( magma_index_malloc_cpu( &B->col, B->nnz ));
 
-                numzeros=0;
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows; i++) {
-                    B->row[i]=numzeros;
+                    magma_index_t numzeros = B->row[i];
                     for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++) {
                         if ( A.col[j] < i) {
                             B->val[numzeros] = A.val[j];
@@ -308,7 +491,6 @@ magma_zmconvert(
                         }
                     }
                 }
-                B->row[B->num_rows] = numzeros;
             }
 
             // CSR to CSRU
@@ -321,22 +503,26 @@ magma_zmconvert(
                 B->num_cols = A.num_cols;
                 B->diameter = A.diameter;
                 B->fill_mode = MagmaUpper;
-                magma_int_t numzeros=0;
+                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
+                B->row[0] = 0;
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows; i++) {
+                    magma_index_t numzeros = 0;
                     for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++) {
                         if ( A.col[j] >= i) {
                             numzeros++;
                         }
                     }
+                    B->row[i+1] = numzeros;
                 }
-                B->nnz = numzeros;
-                CHECK( magma_zmalloc_cpu( &B->val, numzeros ));
-                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
-                CHECK( magma_index_malloc_cpu( &B->col, numzeros ));
+                CHECK( magma_zmatrix_createrowptr( A.num_rows, B->row, queue ));
+                B->nnz = B->row[A.num_rows];
+                CHECK( magma_zmalloc_cpu( &B->val, B->nnz ));
+                CHECK( magma_index_malloc_cpu( &B->col, B->nnz ));
 
-                numzeros=0;
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows; i++) {
-                    B->row[i]=numzeros;
+                    magma_index_t numzeros = B->row[i];
                     for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++) {
                         if ( A.col[j] >= i) {
                             B->val[numzeros] = A.val[j];
@@ -345,7 +531,6 @@ magma_zmconvert(
                         }
                     }
                 }
-                B->row[B->num_rows] = numzeros;
             }
 
             // CSR to CSRD (diagonal elements first)
@@ -364,6 +549,7 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
                 CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
 
+                #pragma omp parallel for
                 for(magma_int_t i=0; i < A.num_rows; i++) {
                     magma_int_t count = 1;
                     for(magma_int_t j=A.row[i]; j < A.row[i+1]; j++) {
@@ -377,6 +563,7 @@ magma_zmconvert(
                         }
                     }
                 }
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++) {
                     B->row[i] = A.row[i];
                 }
@@ -389,12 +576,7 @@ magma_zmconvert(
 
                 magma_free_cpu( B->row );
                 CHECK( magma_index_malloc_cpu( &B->row, A.nnz ));
-
-                for(magma_int_t i=0; i < A.num_rows; i++) {
-                    for(magma_int_t j=A.row[i]; j < A.row[i+1]; j++) {
-                        B->row[j] = i;
-                    }
-                }
+                magma_zmconvert_expand( A.num_rows, A.row, B->row );
             }
 
             // CSR to CSRCOO
@@ -403,12 +585,7 @@ magma_zmconvert(
                 B->storage_type = Magma_CSRCOO;
 
                 CHECK( magma_index_malloc_cpu( &B->rowidx, A.nnz ));
-
-                for(magma_int_t i=0; i < A.num_rows; i++) {
-                    for(magma_int_t j=A.row[i]; j < A.row[i+1]; j++) {
-                        B->rowidx[j] = i;
-                    }
-                }
+                magma_zmconvert_expand( A.num_rows, A.row, B->rowidx );
             }
 
             // CSR to CSRLIST
@@ -423,11 +600,13 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &B->rowidx, A.nnz+A.num_rows*2 ));
                 CHECK( magma_index_malloc_cpu( &B->list, A.nnz+A.num_rows*2 ));
 
+                #pragma omp parallel for
                 for(magma_int_t i=0; i < A.nnz; i++) {
                     B->col[i] = A.col[i];
                     B->val[i] = A.val[i];
                 }
 
+                #pragma omp parallel for schedule(dynamic, 1024)
                 for(magma_int_t i=0; i < A.num_rows; i++) {
                     for(magma_int_t j=A.row[i]; j < A.row[i+1]; j++) {
                         B->rowidx[j] = i;
@@ -435,14 +614,39 @@ magma_zmconvert(
                     for(magma_int_t j=A.row[i]; j < A.row[i+1]-1; j++) {
                         B->list[j] = j+1;
                     }
-                    B->list[A.row[i+1]-1] = 0;
+                    if ( A.row[i+1] > A.row[i] ) {
+                        B->list[A.row[i+1]-1] = 0;
+                    }
                 }
+                #pragma omp parallel for
                 for(magma_int_t i=A.nnz; i < A.nnz+A.num_rows*2; i++) {
                     B->list[i] = -1;
                 }
                 B->true_nnz = A.nnz+A.num_rows*2;
             }
 
+            // CSR to CSC (col is the column pointer, row holds the row indices)
+            else if ( new_format == Magma_CSC ) {
+                // fill in information for B
+                B->storage_type = Magma_CSC;
+                B->memory_location = A.memory_location;
+                B->fill_mode = A.fill_mode;
+                B->num_rows = A.num_rows; B->true_nnz = A.true_nnz;
+                B->num_cols = A.num_cols;
+                B->nnz = A.nnz;
+                B->max_nnz_row = A.max_nnz_row;
+                B->diameter = A.diameter;
+
+                CHECK( magma_zmalloc_cpu( &B->val, A.nnz ));
+                CHECK( magma_index_malloc_cpu( &B->row, A.nnz ));
+                CHECK( magma_index_malloc_cpu( &B->col, A.num_cols+1 ));
+                CHECK( magma_index_malloc_cpu( &row_tmp, A.nnz ));
+
+                magma_zmconvert_expand( A.num_rows, A.row, row_tmp );
+                CHECK( magma_zmconvert_coo2csr( A.num_cols, A.nnz, A.col, row_tmp, A.val,
+                                                B->col, B->row, B->val, queue ));
+            }
+
             // CSR to ELLPACKT (using row-major storage)
             else if (  new_format == Magma_ELLPACKT ) {
                 // fill in information for B
@@ -455,10 +659,11 @@ magma_zmconvert(
                 B->max_nnz_row = A.max_nnz_row;
                 B->diameter = A.diameter;
                 // conversion
-                magma_index_t i, j, maxrowlength=0;
+                magma_index_t maxrowlength=0;
                 CHECK( magma_index_malloc_cpu( &length, A.num_rows));
 
-                for( i=0; i < A.num_rows; i++ ) {
+                #pragma omp parallel for reduction(max:maxrowlength)
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
                     length[i] = A.row[i+1]-A.row[i];
                     if (length[i] > maxrowlength)
                         maxrowlength = length[i];
@@ -469,13 +674,15 @@ magma_zmconvert(
                 CHECK( magma_zmalloc_cpu( &B->val, maxrowlength*A.num_rows ));
                 CHECK( magma_index_malloc_cpu( &B->col, maxrowlength*A.num_rows ));
 
-                for( i=0; i < (maxrowlength*A.num_rows); i++) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < (maxrowlength*A.num_rows); i++) {
                     B->val[i] = MAGMA_Z_MAKE(0., 0.);
                     B->col[i] =  -1;
                 }
-                for( i=0; i < A.num_rows; i++ ) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
                     magma_int_t offset = 0;
-                    for( j=A.row[i]; j < A.row[i+1]; j++ ) {
+                    for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++ ) {
                         B->val[i*maxrowlength+offset] = A.val[j];
                         B->col[i*maxrowlength+offset] = A.col[j];
                         offset++;
@@ -497,10 +704,11 @@ magma_zmconvert(
                 B->diameter = A.diameter;
 
                 // conversion
-                magma_index_t i, j, maxrowlength=0;
+                magma_index_t maxrowlength=0;
                 CHECK( magma_index_malloc_cpu( &length, A.num_rows));
 
-                for( i=0; i < A.num_rows; i++ ) {
+                #pragma omp parallel for reduction(max:maxrowlength)
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
                     length[i] = A.row[i+1]-A.row[i];
                     if (length[i] > maxrowlength)
                         maxrowlength = length[i];
@@ -511,14 +719,16 @@ magma_zmconvert(
                 CHECK( magma_zmalloc_cpu( &B->val, maxrowlength*A.num_rows ));
                 CHECK( magma_index_malloc_cpu( &B->col, maxrowlength*A.num_rows ));
 
-                for( i=0; i < (maxrowlength*A.num_rows); i++) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < (maxrowlength*A.num_rows); i++) {
                     B->val[i] = MAGMA_Z_MAKE(0., 0.);
                     B->col[i] = 0;
                 }
 
-                for( i=0; i < A.num_rows; i++ ) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
                     magma_int_t offset = 0;
-                    for( j=A.row[i]; j < A.row[i+1]; j++ ) {
+                    for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++ ) {
                         B->val[offset*A.num_rows+i] = A.val[j];
                         B->col[offset*A.num_rows+i] = A.col[j];
                         offset++;
@@ -541,10 +751,11 @@ magma_zmconvert(
                 B->diameter = A.diameter;
 
                 // conversion
-                magma_index_t i, j, maxrowlength=0;
+                magma_index_t maxrowlength=0;
                 CHECK( magma_index_malloc_cpu( &length, A.num_rows));
 
-                for( i=0; i < A.num_rows; i++ ) {
+                #pragma omp parallel for reduction(max:maxrowlength)
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
                     length[i] = A.row[i+1]-A.row[i];
                     if (length[i] > maxrowlength)
                         maxrowlength = length[i];
@@ -556,14 +767,16 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &B->col, maxrowlength*A.num_rows ));
 
 
-                for( i=0; i < (maxrowlength*A.num_rows); i++) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < (maxrowlength*A.num_rows); i++) {
                     B->val[i] = MAGMA_Z_MAKE(0., 0.);
                     B->col[i] =  -1;
                 }
 
-                for( i=0; i < A.num_rows; i++ ) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
                     magma_int_t offset = 1;
-                    for( j=A.row[i]; j < A.row[i+1]; j++ ) {
+                    for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++ ) {
                         if ( A.col[j] == i ) { // diagonal case
                             B->val[i*maxrowlength] = A.val[j];
                             B->col[i*maxrowlength] = A.col[j];
@@ -590,10 +803,11 @@ magma_zmconvert(
                 B->diameter = A.diameter;
 
                 // conversion
-                magma_index_t i, j, maxrowlength=0;
+                magma_index_t maxrowlength=0;
                 CHECK( magma_index_malloc_cpu( &length, A.num_rows));
 
-                for( i=0; i < A.num_rows; i++ ) {
+                #pragma omp parallel for reduction(max:maxrowlength)
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
                     length[i] = A.row[i+1]-A.row[i];
                     if (length[i] > maxrowlength)
                         maxrowlength = length[i];
@@ -609,14 +823,16 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &B->col, rowlength*A.num_rows ));
                 CHECK( magma_index_malloc_cpu( &B->row, A.num_rows ));
 
-                for( i=0; i < rowlength*A.num_rows; i++) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < rowlength*A.num_rows; i++) {
                     B->val[i] = MAGMA_Z_MAKE(0., 0.);
                     B->col[i] =  0;
                 }
 
-                for( i=0; i < A.num_rows; i++ ) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
                     magma_int_t offset = 0;
-                    for( j=A.row[i]; j < A.row[i+1]; j++ ) {
+                    for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++ ) {
                         B->val[i*rowlength+offset] = A.val[j];
                         B->col[i*rowlength+offset] = A.col[j];
                         offset++;
@@ -655,32 +871,30 @@ magma_zmconvert(
                 magma_int_t C = B->blocksize;
                 magma_int_t slices = ( A.num_rows+C-1)/(C);
                 B->numblocks = slices;
-                magma_int_t alignedlength, alignment = B->alignment;
+                magma_int_t alignment = B->alignment;
+                magma_index_t max_nnz_row = 0;
                 // conversion
-                magma_index_t i, j, k, maxrowlength=0;
-                CHECK( magma_index_malloc_cpu( &length, C));
                 // B-row points to the start of each slice
                 CHECK( magma_index_malloc_cpu( &B->row, slices+1 ));
 
 
                 B->row[0] = 0;
-                for( i=0; i < slices; i++ ) {
-                    maxrowlength = 0;
-                    for(j=0; j < C; j++) {
-                        if (i*C+j < A.num_rows) {
-                            length[j] = A.row[i*C+j+1]-A.row[i*C+j];
-                        }
-                        else
-                            length[j]=0;
-                        if (length[j] > maxrowlength) {
-                            maxrowlength = length[j];
+                #pragma omp parallel for reduction(max:max_nnz_row)
+                for( magma_int_t i=0; i < slices; i++ ) {
+                    magma_index_t maxrowlength = 0;
+                    for( magma_int_t j=0; j < C && i*C+j < A.num_rows; j++) {
+                        magma_index_t len = A.row[i*C+j+1]-A.row[i*C+j];
+                        if (len > maxrowlength) {
+                            maxrowlength = len;
                         }
                     }
-                    alignedlength = magma_roundup( maxrowlength, alignment );
-                    B->row[i+1] = B->row[i] + alignedlength * C;
-                    if ( alignedlength > B->max_nnz_row )
-                        B->max_nnz_row = alignedlength;
+                    magma_index_t alignedlength = magma_roundup( maxrowlength, alignment );
+                    B->row[i+1] = alignedlength * C;
+                    if ( alignedlength > max_nnz_row )
+                        max_nnz_row = alignedlength;
                 }
+                CHECK( magma_zmatrix_createrowptr( slices, B->row, queue ));
+                B->max_nnz_row = max_nnz_row;
                 B->nnz = B->row[slices];
                 //printf( "Conversion to SELLC with %d slices of size %d and"
                 //       " %d nonzeros.\n", slices, C, B->nnz );
@@ -690,17 +904,19 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &B->col, B->row[slices] ));
 
                 // zero everything
-                for( i=0; i < B->row[slices]; i++ ) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < B->row[slices]; i++ ) {
                     B->val[ i ] = MAGMA_Z_MAKE(0., 0.);
                     B->col[ i ] =  0;
                 }
                 // fill in values
-                for( i=0; i < slices; i++ ) {
-                    for(j=0; j < C; j++) {
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < slices; i++ ) {
+                    for( magma_int_t j=0; j < C; j++) {
                         magma_int_t line = i*C+j;
                         magma_int_t offset = 0;
                         if ( line < A.num_rows) {
-                            for( k=A.row[line]; k < A.row[line+1]; k++ ) {
+                            for( magma_int_t k=A.row[line]; k < A.row[line+1]; k++ ) {
                                 B->val[ B->row[i] + j +offset*C ] = A.val[k];
                                 B->col[ B->row[i] + j +offset*C ] = A.col[k];
                                 offset++;
@@ -727,10 +943,12 @@ magma_zmconvert(
                 // conversion
                 CHECK( magma_zmalloc_cpu( &B->val, A.num_rows*A.num_cols ));
 
+                #pragma omp parallel for
                 for( magma_int_t i=0; i<(A.num_rows)*(A.num_cols); i++) {
                     B->val[i] = MAGMA_Z_MAKE(0., 0.);
                 }
 
+                #pragma omp parallel for
                 for(magma_int_t i=0; i < A.num_rows; i++ ) {
                     for(magma_int_t j=A.row[i]; j < A.row[i+1]; j++ )
                         B->val[i * (A.num_cols) + A.col[j] ] = A.val[ j ];
@@ -740,11 +958,70 @@ magma_zmconvert(
             }
 
             // CSR to BCSR
+            // blocks are stored row-major, as by cusparseZcsr2bsr
             else if ( new_format == Magma_BCSR ) {
-                CHECK( magma_zmtransfer(A, &dA, Magma_CPU, Magma_DEV, queue ) );
-                dB.blocksize = B->blocksize;
-                CHECK( magma_zmconvert(dA, &dB, Magma_CSR, Magma_BCSR, queue ) );
-                CHECK( magma_zmtransfer(dB, B, Magma_DEV, Magma_CPU, queue ) );
+                magma_int_t size_b = B->blocksize;
+                if ( size_b < 1 ) {
+                    printf("error: blocksize not supported!\n");
+                    info = MAGMA_ERR_NOT_SUPPORTED;
+                    goto cleanup;
+                }
+                // fill in information for B
+                B->storage_type = Magma_BCSR;
+                B->memory_location = A.memory_location;
+                B->fill_mode = A.fill_mode;
+                B->num_rows = A.num_rows; B->true_nnz = A.true_nnz;
+                B->num_cols = A.num_cols;
+                B->nnz = A.nnz;
+                B->max_nnz_row = A.max_nnz_row;
+                B->diameter = A.diameter;
+                magma_int_t mb = magma_ceildiv( A.num_rows, size_b );
+                magma_int_t bsize = size_b*size_b;
+
+                // count the nonzero blocks of each block row
+                CHECK( magma_index_malloc_cpu( &B->row, mb+1 ));
+                B->row[0] = 0;
+                #pragma omp parallel
+                {
+                    std::vector< magma_index_t > bcol;
+                    #pragma omp for schedule(dynamic, 64)
+                    for( magma_int_t bi=0; bi < mb; bi++ ) {
+                        magma_zmconvert_blockcols( A, size_b, bi, bcol );
+                        B->row[bi+1] = bcol.size();
+                    }
+                }
+                CHECK( magma_zmatrix_createrowptr( mb, B->row, queue ));
+                B->numblocks = B->row[mb];
+
+                CHECK( magma_index_malloc_cpu( &B->col, B->numblocks ));
+                CHECK( magma_zmalloc_cpu( &B->val, B->numblocks*bsize ));
+
+                // fill the blocks
+                #pragma omp parallel
+                {
+                    std::vector< magma_index_t > bcol;
+                    #pragma omp for schedule(dynamic, 64)
+                    for( magma_int_t bi=0; bi < mb; bi++ ) {
+                        magma_zmconvert_blockcols( A, size_b, bi, bcol );
+                        magma_index_t *bcolB = B->col + B->row[bi];
+                        magmaDoubleComplex *valB = B->val + B->row[bi]*bsize;
+                        for( size_t b=0; b < bcol.size(); b++ ) {
+                            bcolB[b] = bcol[b];
+                        }
+                        for( magma_int_t k=0; k < (magma_int_t) bcol.size()*bsize; k++ ) {
+                            valB[k] = MAGMA_Z_ZERO;
+                        }
+                        magma_int_t end = min( (bi+1)*size_b, A.num_rows );
+                        for( magma_int_t i=bi*size_b; i < end; i++ ) {
+                            for( magma_int_t j=A.row[i]; j < A.row[i+1]; j++ ) {
+                                magma_int_t b = std::lower_bound( bcol.begin(), bcol.end(),
+                                                    A.col[j] / size_b ) - bcol.begin();
+                                valB[ b*bsize + (i - bi*size_b)*size_b + A.col[j] % size_b ]
+                                    = A.val[j];
+                            }
+                        }
+                    }
+                }
             }
 
             // CSR to CSR5
@@ -764,6 +1041,7 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
                 CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
 
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++) {
                     B->row[i] = A.row[i];
                 }
@@ -814,12 +1092,14 @@ magma_zmconvert(
                 //printf("sigma = %i, p = %i\n", B->csr5_sigma, B->csr5_p);
                 // malloc the newly added arrays for CSR5
                 CHECK( magma_uindex_malloc_cpu( &B->tile_ptr, B->csr5_p+1 ));
+                #pragma omp parallel for
                 for( magma_int_t i=0; i<B->csr5_p+1; i++) {
                     B->tile_ptr[i] = 0;
                 }
 
                 CHECK( magma_uindex_malloc_cpu( &B->tile_desc,
                           B->csr5_p * MAGMA_CSR5_OMEGA * B->csr5_num_packets ));
+                #pragma omp parallel for
                 for( magma_int_t i=0; i<B->csr5_p * MAGMA_CSR5_OMEGA
                                         * B->csr5_num_packets; i++) {
                     B->tile_desc[i] = 0;
@@ -827,6 +1107,7 @@ magma_zmconvert(
 
 
                 CHECK( magma_zmalloc_cpu( &B->calibrator, B->csr5_p ));
+                #pragma omp parallel for
                 for( magma_int_t i=0; i<B->csr5_p; i++) {
                     B->calibrator[i] = MAGMA_Z_MAKE(0., 0.);
                 }
@@ -841,6 +1122,7 @@ magma_zmconvert(
                 // convert csr data to csr5 data (3 steps)
                 // step 1 generate tile pointer
                 // step 1.1 binary search row pointer
+                #pragma omp parallel for
                 for (magma_index_t global_id = 0; global_id <= B->csr5_p;
                      global_id++)
                 {
@@ -867,6 +1149,10 @@ magma_zmconvert(
                 }
                 
                 // step 1.2 check empty rows
+                // tile_ptr[group_id+1] is read by tile group_id, so mark
+                // the tiles in a second loop
+                CHECK( magma_index_malloc_cpu( &length, B->csr5_p ));
+                #pragma omp parallel for
                 for (magma_index_t group_id = 0; group_id < B->csr5_p; group_id++) {
                     int dirty = 0;
                 
@@ -875,20 +1161,21 @@ magma_zmconvert(
                     start = (start << 1) >> 1;
                     stop  = (stop << 1) >> 1;
                 
-                    if (start == stop)
-                        continue;
-                
-                    for (magma_uindex_t row_idx = start; row_idx <= stop; row_idx++) {
-                        if (B->row[row_idx] == B->row[row_idx+1]) {
-                            dirty = 1;
-                            break;
+                    if (start != stop) {
+                        for (magma_uindex_t row_idx = start; row_idx <= stop; row_idx++) {
+                            if (B->row[row_idx] == B->row[row_idx+1]) {
+                                dirty = 1;
+                                break;
+                            }
                         }
                     }
-                
-                    if (dirty) {
-                        start |= sizeof(magma_uindex_t) == 4
+                    length[group_id] = dirty;
+                }
+                #pragma omp parallel for
+                for (magma_index_t group_id = 0; group_id < B->csr5_p; group_id++) {
+                    if (length[group_id]) {
+                        B->tile_ptr[group_id] |= sizeof(magma_uindex_t) == 4
                                            ? 0x80000000 : 0x8000000000000000;
-                        B->tile_ptr[group_id] = start;
                     }
                 }
                 B->csr5_tail_tile_start = (B->tile_ptr[B->csr5_p-1] << 1) >> 1;
@@ -899,6 +1186,8 @@ magma_zmconvert(
                                      + B->csr5_bit_scansum_offset;
                 
                 //generate_tile_descriptor_s1_kernel
+                // tile par_id only sets bits in its own descriptor
+                #pragma omp parallel for schedule(dynamic, 16)
                 for (int par_id = 0; par_id < B->csr5_p-1; par_id++) {
                     const magma_index_t row_start = B->tile_ptr[par_id]
                                                     & 0x7FFFFFFF;
@@ -927,8 +1216,13 @@ magma_zmconvert(
                 }
                 
                 //generate_tile_descriptor_s2_kernel
-                int num_thread = 1; //omp_get_max_threads();
+#ifdef _OPENMP
+                int num_thread = omp_get_max_threads();
+#else
+                int num_thread = 1;
+#endif
                 magma_index_t *s_segn_scan_all, *s_present_all;
+                magma_int_t empty_tiles = 0;
                 
                 CHECK( magma_index_malloc_cpu( &s_segn_scan_all,
                                            2 * MAGMA_CSR5_OMEGA * num_thread ));
@@ -946,9 +1240,13 @@ magma_zmconvert(
                 
                 //const int bit_all_offset = bit_y_offset + bit_scansum_offset;
                 
-                //#pragma omp parallel for
+                #pragma omp parallel for schedule(dynamic, 16) reduction(+:empty_tiles)
                 for (int par_id = 0; par_id < B->csr5_p-1; par_id++) {
-                    int tid = 0; //omp_get_thread_num();
+#ifdef _OPENMP
+                    int tid = omp_get_thread_num();
+#else
+                    int tid = 0;
+#endif
                     int *s_segn_scan = &s_segn_scan_all[tid * 2
                                                         * MAGMA_CSR5_OMEGA];
                     int *s_present = &s_present_all[tid * 2
@@ -1022,7 +1320,7 @@ magma_zmconvert(
                     if (with_empty_rows) {
                         B->tile_desc_offset_ptr[par_id]
                             = s_segn_scan[MAGMA_CSR5_OMEGA];
-                        B->tile_desc_offset_ptr[B->csr5_p] = 1;
+                        empty_tiles++;
                     }
                 
                     //#pragma simd
@@ -1054,6 +1352,9 @@ magma_zmconvert(
                 
                 magma_free_cpu(s_segn_scan_all);
                 magma_free_cpu(s_present_all);
+                if (empty_tiles > 0) {
+                    B->tile_desc_offset_ptr[B->csr5_p] = 1;
+                }
                 
                 if (B->tile_desc_offset_ptr[B->csr5_p]) {
                     //scan_single(B->tile_desc_offset_ptr, p+1);
@@ -1078,7 +1379,7 @@ magma_zmconvert(
                     //err = generate_tile_descriptor_offset
                     const int bit_bitflag = 32 - bit_all_offset;
                 
-                    //#pragma omp parallel for
+                    #pragma omp parallel for schedule(dynamic, 16)
                     for (int par_id = 0; par_id < B->csr5_p-1; par_id++) {
                         bool with_empty_rows = (B->tile_ptr[par_id] >> 31)&0x1;
                         if (!with_empty_rows)
@@ -1176,7 +1477,7 @@ magma_zmconvert(
                 }
                 
                 // step 3. transpose column_index and value arrays
-                //#pragma omp parallel for
+                #pragma omp parallel for
                 for (int par_id = 0; par_id < B->csr5_p; par_id++) {
                     // if this is fast track tile, do not transpose it
                     if (B->tile_ptr[par_id] == B->tile_ptr[par_id + 1]) {
@@ -1214,6 +1515,87 @@ magma_zmconvert(
                 //printf( "done\n" );
             }
 
+            // CSR to SELL-C-sigma (host only)
+            // B->blocksize is the slice height C, B->alignment the sorting
+            // window sigma; sigma defaults to 8C for B->alignment <= 1 (the
+            // SELLP default), and for B->blocksize <= 0 both are tuned
+            else if ( new_format == Magma_SELLCS ) {
+                magma_int_t C = B->blocksize;
+                magma_int_t sigma = ( B->alignment > 1 ) ? B->alignment : 8*C;
+                if ( C <= 0 ) {
+                    CHECK( magma_zsellcs_tune( A, &C, &sigma, queue ));
+                }
+                CHECK( magma_zcsr2sellcs( A, C, sigma, B, queue ));
+            }
+
+            // CSR to CSRMP (host only)
+            // B->val_format selects the value precision, float by default;
+            // like blocksize, it is an input that magma_zmfree keeps, so set
+            // it before every conversion (or call magma_zcsr2csrmp)
+            else if ( new_format == Magma_CSRMP ) {
+                magma_precision val_format = B->val_format;
+                if ( val_format != Magma_HALF && val_format != Magma_BFLOAT ) {
+                    val_format = Magma_FLOAT;
+                }
+                CHECK( magma_zcsr2csrmp( A, val_format, B, queue ));
+            }
+
+            // CSR to CSRSYM: the lower triangle of a symmetric matrix,
+            // or of a Hermitian one if A.sym is Magma_HERMITIAN
+            else if ( new_format == Magma_CSRSYM ) {
+                B->storage_type = Magma_CSRSYM;
+                B->memory_location = A.memory_location;
+                B->fill_mode = MagmaLower;
+                B->sym = ( A.sym == Magma_HERMITIAN ) ? Magma_HERMITIAN : Magma_SYMMETRIC;
+                B->num_rows = A.num_rows;
+                B->num_cols = A.num_cols;
+                B->diameter = A.diameter;
+                if ( A.num_rows != A.num_cols ) {
+                    printf("error: CSRSYM needs a square matrix.\n");
+                    info = MAGMA_ERR_NOT_SUPPORTED;
+                    goto cleanup;
+                }
+                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
+                B->row[0] = 0;
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    magma_index_t count = 0;
+                    for( magma_index_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+                        if ( A.col[k] <= i ) {
+                            count++;
+                        }
+                    }
+                    B->row[i+1] = count;
+                }
+                CHECK( magma_zmatrix_createrowptr( A.num_rows, B->row, queue ));
+                B->nnz = B->row[A.num_rows];
+                B->true_nnz = B->nnz;
+                CHECK( magma_zmalloc_cpu( &B->val, B->nnz ));
+                CHECK( magma_index_malloc_cpu( &B->col, B->nnz ));
+                // the SpMV relies on sorted columns
+                #pragma omp parallel
+                {
+                    std::vector< std::pair< magma_index_t, magmaDoubleComplex > > rowval;
+                    #pragma omp for schedule(dynamic, 1024)
+                    for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                        rowval.clear();
+                        for( magma_index_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+                            if ( A.col[k] <= i ) {
+                                rowval.push_back( std::make_pair( A.col[k], A.val[k] ));
+                            }
+                        }
+                        std::stable_sort( rowval.begin(), rowval.end(),
+                            []( const std::pair< magma_index_t, magmaDoubleComplex >& a,
+                                const std::pair< magma_index_t, magmaDoubleComplex >& b )
+                                { return a.first < b.first; } );
+                        for( magma_index_t k=0; k < (magma_index_t) rowval.size(); k++ ) {
+                            B->col[ B->row[i]+k ] = rowval[k].first;
+                            B->val[ B->row[i]+k ] = rowval[k].second;
+                        }
+                    }
+                }
+            }
+
             else {
                 printf("error: format not supported.\n");
                 info = MAGMA_ERR_NOT_SUPPORTED;
@@ -1234,13 +1616,9 @@ magma_zmconvert(
             // CSRD to CSR (diagonal elements first)
             else if ( old_format == Magma_CSRD ) {
                 CHECK( magma_zmconvert( A, B, Magma_CSR, Magma_CSR, queue ));
+                #pragma omp parallel for schedule(dynamic, 1024)
                 for( magma_int_t i=0; i < A.num_rows; i++) {
-                    magma_zindexsortval(
-                    B->col,
-                    B->val,
-                    B->row[i],
-                    B->row[i+1]-1,
-                    queue );
+                    magma_zmconvert_sortrow( B->col, B->val, B->row[i], B->row[i+1] );
                 }
             }
 
@@ -1252,29 +1630,32 @@ magma_zmconvert(
             // CSRLIST to CSR
             else if ( old_format == Magma_CSRLIST ) {
                 CHECK( magma_zmconvert( A, B, Magma_CSR, Magma_CSR, queue ));
-                magma_int_t element, row, numnnz;
 
-                numnnz = 0;
-                // fill the rowpointer
+                // fill the rowpointer with the lengths of the row lists
                 B->row[0] = 0;
-                for( row=0; row<A.num_rows; row++ ){
-                    element = A.row[row];
+                #pragma omp parallel for schedule(dynamic, 1024)
+                for( magma_int_t row=0; row<A.num_rows; row++ ){
+                    magma_index_t element = A.row[row];
+                    magma_index_t numnnz = 0;
                     do{
-                        B->val[ numnnz ] = A.val[ element ];
-                        B->col[ numnnz ] = A.col[ element ];
                         numnnz++;
                         element = A.list[ element ];
                     }while( element != 0 );
                     B->row[ row+1 ] = numnnz;
                 }
-                // sort elements in every row according to col
-                for( magma_int_t i=0; i < A.num_rows; i++) {
-                    magma_zindexsortval(
-                    B->col,
-                    B->val,
-                    B->row[i],
-                    B->row[i+1]-1,
-                    queue );
+                CHECK( magma_zmatrix_createrowptr( A.num_rows, B->row, queue ));
+                // copy the row lists and sort elements in every row according to col
+                #pragma omp parallel for schedule(dynamic, 1024)
+                for( magma_int_t row=0; row<A.num_rows; row++ ){
+                    magma_index_t element = A.row[row];
+                    magma_index_t numnnz = B->row[row];
+                    do{
+                        B->val[ numnnz ] = A.val[ element ];
+                        B->col[ numnnz ] = A.col[ element ];
+                        numnnz++;
+                        element = A.list[ element ];
+                    }while( element != 0 );
+                    magma_zmconvert_sortrow( B->col, B->val, B->row[row], B->row[row+1] );
                 }
             }
 
@@ -1295,6 +1676,7 @@ magma_zmconvert(
 
                 CHECK( magma_index_malloc_cpu( &row_tmp, A.num_rows+1 ));
                 //fill the row-pointer
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++ )
                     row_tmp[i] = i*A.max_nnz_row;
                 //now use AA_ELL, IA_ELL, row_tmp as CSR with some zeros.
@@ -1324,11 +1706,13 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &col_tmp, A.num_rows*A.max_nnz_row ));
 
                 //fill the row-pointer
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++ )
                     row_tmp[i] = i*A.max_nnz_row;
-                //transform RowMajor to ColMajor
-                for( magma_int_t j=0; j < A.max_nnz_row; j++ ) {
-                    for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                //transform ColMajor to RowMajor
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    for( magma_int_t j=0; j < A.max_nnz_row; j++ ) {
                         col_tmp[i*A.max_nnz_row+j] = A.col[j*A.num_rows+i];
                         val_tmp[i*A.max_nnz_row+j] = A.val[j*A.num_rows+i];
                     }
@@ -1369,12 +1753,14 @@ magma_zmconvert(
                 // conversion
                 CHECK( magma_index_malloc_cpu( &row_tmp, A.num_rows+1 ));
                 //fill the row-pointer
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++ )
                     row_tmp[i] = i*A.max_nnz_row;
                 // sort the diagonal element into the right place
                 CHECK( magma_zmalloc_cpu( &val_tmp2, A.num_rows*A.max_nnz_row ));
                 CHECK( magma_index_malloc_cpu( &col_tmp2, A.num_rows*A.max_nnz_row ));
 
+                #pragma omp parallel for
                 for( magma_int_t j=0; j < A.num_rows; j++ ) {
                     magma_index_t diagcol = A.col[j*A.max_nnz_row];
                     magma_int_t smaller = 0;
@@ -1421,6 +1807,7 @@ magma_zmconvert(
                 // conversion
                 CHECK( magma_index_malloc_cpu( &row_tmp, A.num_rows+1 ));
                 //fill the row-pointer
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++ )
                     row_tmp[i] = i*rowlength;
                 //now use AA_ELL, IA_ELL, row_tmp as CSR with some zeros.
@@ -1454,17 +1841,20 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &col_tmp,
                                                A.max_nnz_row*(A.num_rows+C) ));
                 // zero everything
+                #pragma omp parallel for
                 for(magma_int_t i=0; i < A.max_nnz_row*(A.num_rows+C); i++ ) {
                     val_tmp[ i ] = MAGMA_Z_MAKE(0., 0.);
                     col_tmp[ i ] =  0;
                 }
 
                 //fill the row-pointer
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++ ) {
                     row_tmp[i] = A.max_nnz_row*i;
                 }
 
                 //transform RowMajor to ColMajor
+                #pragma omp parallel for
                 for( magma_int_t k=0; k < slices; k++) {
                     magma_int_t blockinfo = (A.row[k+1]-A.row[k])/A.blocksize;
                     for( magma_int_t j=0; j < C; j++ ) {
@@ -1504,12 +1894,13 @@ magma_zmconvert(
                 CHECK( magma_index_malloc_cpu( &B->row, B->num_rows+1 ));
                 CHECK( magma_index_malloc_cpu( &B->col, B->nnz ));
 
+                #pragma omp parallel for
                 for( magma_int_t i=0; i < A.num_rows+1; i++) {
                     B->row[i] = A.row[i];
                 }
 
                 // step 1. transpose column_index and value arrays
-                //#pragma omp parallel for
+                #pragma omp parallel for
                 for (int par_id = 0; par_id < A.csr5_p; par_id++)
                 {
                     // if this is fast track tile, do not transpose it
@@ -1566,55 +1957,194 @@ magma_zmconvert(
                 B->diameter = A.diameter;
 
                 // conversion
-
-                B->nnz=0;
-                for( magma_int_t i=0; i<(A.num_rows)*(A.num_cols); i++ ) {
-                    if ( MAGMA_Z_REAL(A.val[i]) != 0.0 || MAGMA_Z_IMAG(A.val[i]) != 0.0 )
-                        (B->nnz)++;
+                CHECK( magma_index_malloc_cpu( &B->row, B->num_rows+1 ));
+                B->row[0] = 0;
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    magma_index_t nnz_row = 0;
+                    for( magma_int_t j=0; j < A.num_cols; j++ ) {
+                        magmaDoubleComplex v = A.val[ i*A.num_cols + j ];
+                        if ( MAGMA_Z_REAL(v) != 0.0 || MAGMA_Z_IMAG(v) != 0.0 )
+                            nnz_row++;
+                    }
+                    B->row[i+1] = nnz_row;
                 }
+                CHECK( magma_zmatrix_createrowptr( B->num_rows, B->row, queue ));
+                B->nnz = B->row[B->num_rows];
                 CHECK( magma_zmalloc_cpu( &B->val, B->nnz));
-                CHECK( magma_index_malloc_cpu( &B->row, B->num_rows+1 ));
                 CHECK( magma_index_malloc_cpu( &B->col, B->nnz ));
 
-                magma_int_t i = 0;
-                magma_int_t j = 0;
-                magma_int_t k = 0;
-
-                for(i=0; i<(A.num_rows)*(A.num_cols); i++)
-                {
-                    if ( i%(B->num_cols) == 0 )
-                    {
-                        (B->row)[k] = j;
-                        k++;
-                    }
-                    if ( MAGMA_Z_REAL(A.val[i]) != 0 || MAGMA_Z_IMAG(A.val[i]) != 0)
-                    {
-                        (B->val)[j] = A.val[i];
-                        (B->col)[j] = i%(B->num_cols);
-                        j++;
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    magma_index_t k = B->row[i];
+                    for( magma_int_t j=0; j < A.num_cols; j++ ) {
+                        magmaDoubleComplex v = A.val[ i*A.num_cols + j ];
+                        if ( MAGMA_Z_REAL(v) != 0 || MAGMA_Z_IMAG(v) != 0 ) {
+                            B->val[k] = v;
+                            B->col[k] = j;
+                            k++;
+                        }
                     }
                 }
-                (B->row)[B->num_rows]=B->nnz;
 
                 //printf( "done\n" );
             }
 
             // BCSR to CSR
+            // zeros in the blocks and the padding of the last block row
+            // and column are dropped, as by the CSR compressor
             else if ( old_format == Magma_BCSR ) {
-                CHECK( magma_zmtransfer(A, &dA, Magma_CPU, Magma_DEV, queue ) );
-                CHECK( magma_zmconvert(dA, &dB, Magma_BCSR, Magma_CSR, queue ) );
-                magma_zmfree( &dA, queue );
-                CHECK( magma_zmtransfer(dB, B, Magma_DEV, Magma_CPU, queue ) );
-                magma_zmfree( &dB, queue );
+                // fill in information for B
+                B->storage_type = Magma_CSR;
+                B->memory_location = A.memory_location;
+                B->fill_mode = A.fill_mode;
+                B->num_rows = A.num_rows; B->true_nnz = A.true_nnz;
+                B->num_cols = A.num_cols;
+                B->max_nnz_row = A.max_nnz_row;
+                B->diameter = A.diameter;
+                magma_int_t size_b = A.blocksize;
+                magma_int_t bsize = size_b*size_b;
+
+                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
+                B->row[0] = 0;
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    magma_int_t bi = i / size_b, r = i % size_b;
+                    magma_index_t nnz_row = 0;
+                    for( magma_int_t b=A.row[bi]; b < A.row[bi+1]; b++ ) {
+                        for( magma_int_t c=0; c < size_b; c++ ) {
+                            magmaDoubleComplex v = A.val[ b*bsize + r*size_b + c ];
+                            if ( A.col[b]*size_b + c < A.num_cols &&
+                                 ( MAGMA_Z_REAL(v) != 0 || MAGMA_Z_IMAG(v) != 0 ))
+                                nnz_row++;
+                        }
+                    }
+                    B->row[i+1] = nnz_row;
+                }
+                CHECK( magma_zmatrix_createrowptr( A.num_rows, B->row, queue ));
+                B->nnz = B->row[A.num_rows];
+                CHECK( magma_zmalloc_cpu( &B->val, B->nnz ));
+                CHECK( magma_index_malloc_cpu( &B->col, B->nnz ));
+
+                #pragma omp parallel for
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    magma_int_t bi = i / size_b, r = i % size_b;
+                    magma_index_t k = B->row[i];
+                    for( magma_int_t b=A.row[bi]; b < A.row[bi+1]; b++ ) {
+                        for( magma_int_t c=0; c < size_b; c++ ) {
+                            magmaDoubleComplex v = A.val[ b*bsize + r*size_b + c ];
+                            if ( A.col[b]*size_b + c < A.num_cols &&
+                                 ( MAGMA_Z_REAL(v) != 0 || MAGMA_Z_IMAG(v) != 0 )) {
+                                B->val[k] = v;
+                                B->col[k] = A.col[b]*size_b + c;
+                                k++;
+                            }
+                        }
+                    }
+                }
             }
 
             // COO to CSR
+            // row indices are in rowidx (see magma_zmtransfer), or in row
             else if ( old_format == Magma_COO ) {
-                CHECK( magma_zmtransfer(A, &dA, Magma_CPU, Magma_DEV, queue ) );
-                CHECK( magma_zmconvert(dA, &dB, Magma_COO, Magma_CSR, queue ) );
-                magma_zmfree( &dA, queue );
-                CHECK( magma_zmtransfer(dB, B, Magma_DEV, Magma_CPU, queue ) );
-                magma_zmfree( &dB, queue );
+                // fill in information for B
+                B->storage_type = Magma_CSR;
+                B->memory_location = A.memory_location;
+                B->fill_mode = A.fill_mode;
+                B->num_rows = A.num_rows; B->true_nnz = A.true_nnz;
+                B->num_cols = A.num_cols;
+                B->nnz = A.nnz;
+                B->max_nnz_row = A.max_nnz_row;
+                B->diameter = A.diameter;
+
+                CHECK( magma_zmalloc_cpu( &B->val, A.nnz ));
+                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
+                CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
+
+                CHECK( magma_zmconvert_coo2csr( A.num_rows, A.nnz,
+                           (A.rowidx != NULL ? A.rowidx : A.row), A.col, A.val,
+                           B->row, B->col, B->val, queue ));
+            }
+
+            // CSC to CSR
+            else if ( old_format == Magma_CSC ) {
+                // fill in information for B
+                B->storage_type = Magma_CSR;
+                B->memory_location = A.memory_location;
+                B->fill_mode = A.fill_mode;
+                B->num_rows = A.num_rows; B->true_nnz = A.true_nnz;
+                B->num_cols = A.num_cols;
+                B->nnz = A.nnz;
+                B->max_nnz_row = A.max_nnz_row;
+                B->diameter = A.diameter;
+
+                CHECK( magma_zmalloc_cpu( &B->val, A.nnz ));
+                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
+                CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
+                CHECK( magma_index_malloc_cpu( &col_tmp, A.nnz ));
+
+                magma_zmconvert_expand( A.num_cols, A.col, col_tmp );
+                CHECK( magma_zmconvert_coo2csr( A.num_rows, A.nnz, A.row, col_tmp, A.val,
+                                                B->row, B->col, B->val, queue ));
+            }
+
+            // SELL-C-sigma to CSR
+            else if ( old_format == Magma_SELLCS ) {
+                CHECK( magma_zsellcs2csr( A, B, queue ));
+            }
+
+            // CSRMP to CSR
+            else if ( old_format == Magma_CSRMP ) {
+                CHECK( magma_zcsrmp2csr( A, B, queue ));
+            }
+
+            // CSRSYM to CSR: the strict lower triangle is mirrored
+            else if ( old_format == Magma_CSRSYM ) {
+                B->storage_type = Magma_CSR;
+                B->memory_location = A.memory_location;
+                B->fill_mode = MagmaFull;
+                B->sym = A.sym;
+                B->num_rows = A.num_rows;
+                B->num_cols = A.num_cols;
+                B->diameter = A.diameter;
+                CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
+                CHECK( magma_index_malloc_cpu( &row_tmp, A.num_rows+1 ));
+                for( magma_int_t i=0; i < A.num_rows+1; i++ ) {
+                    B->row[i] = 0;
+                }
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    for( magma_index_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+                        B->row[ i+1 ]++;
+                        if ( A.col[k] != i ) {
+                            B->row[ A.col[k]+1 ]++;
+                        }
+                    }
+                }
+                CHECK( magma_zmatrix_createrowptr( A.num_rows, B->row, queue ));
+                B->nnz = B->row[A.num_rows];
+                B->true_nnz = B->nnz;
+                CHECK( magma_zmalloc_cpu( &B->val, B->nnz ));
+                CHECK( magma_index_malloc_cpu( &B->col, B->nnz ));
+                // row i holds its lower part first, then the mirrored
+                // entries (j,i), j > i, in increasing j: columns stay sorted
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    row_tmp[i] = B->row[i] + A.row[i+1] - A.row[i];
+                }
+                for( magma_int_t i=0; i < A.num_rows; i++ ) {
+                    magma_index_t dest = B->row[i];
+                    for( magma_index_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+                        magma_index_t j = A.col[k];
+                        B->col[dest] = j;
+                        B->val[dest] = A.val[k];
+                        dest++;
+                        if ( j != i ) {
+                            B->col[ row_tmp[j] ] = i;
+                            B->val[ row_tmp[j] ] = ( A.sym == Magma_HERMITIAN )
+                                                 ? MAGMA_Z_CONJ( A.val[k] ) : A.val[k];
+                            row_tmp[j]++;
+                        }
+                    }
+                }
             }
 
             else {
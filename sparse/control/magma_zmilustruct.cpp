@@ -12,7 +12,15 @@
 //  in this file, many routines are taken from
 //  the IO functions provided by MatrixMarket
 
+#include <stdlib.h>  // getenv, atof
+#include <algorithm>
+#include <thread>  // yield
+#include <vector>
+
 #include "magmasparse_internal.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 /******************************************************************************
@@ -49,6 +57,293 @@ void magma_zshell_sort(
     }
 }
 
+// rows of the symbolic factorization are carved out of blocks of this many
+// indices, one chain of blocks per thread
+#define SYMBILU_BLOCK 1048576
+
+// Per-thread row storage. Blocks never move, so a row finished by one thread
+// can be read by all others.
+struct magma_zsymbilu_arena
+{
+    std::vector< magma_index_t* > blocks;
+    magma_index_t *cur;
+    magma_int_t left;
+};
+
+
+static magma_int_t
+magma_zsymbilu_take(
+    magma_zsymbilu_arena &arena,
+    magma_int_t len,
+    magma_index_t **ptr )
+{
+    magma_int_t info = 0;
+    magma_index_t *block = NULL;
+
+    if ( len > arena.left ) {
+        magma_int_t size = max( len, SYMBILU_BLOCK );
+        CHECK( magma_index_malloc_cpu( &block, size ));
+        arena.blocks.push_back( block );
+        arena.cur = block;
+        arena.left = size;
+    }
+    *ptr = arena.cur;
+    arena.cur += len;
+    arena.left -= len;
+
+cleanup:
+    return info;
+}
+
+
+static void
+magma_zsymbilu_release(
+    std::vector< magma_zsymbilu_arena > &arena )
+{
+    for( size_t t=0; t < arena.size(); t++ ) {
+        for( size_t b=0; b < arena[t].blocks.size(); b++ ) {
+            magma_free_cpu( arena[t].blocks[b] );
+        }
+    }
+    arena.clear();
+}
+
+
+/*
+// symbolic level ILU
+// computes the patterns of L and U row by row, in parallel
+// row i is merged with the U rows of its pivots k < i in increasing order,
+// as in the serial linked-list algorithm; a thread only waits for row k
+// once it reaches pivot k, so the rows are pipelined
+// on output, nl[i+1] and nu[i+1] hold the lengths of the L and U parts of
+// row i, and rows[i] points to the L columns, followed by the U columns
+// and the U levels
+// assumes no zero rows
+*/
+
+static magma_int_t
+magma_zsymbilu_rows(
+    const magma_int_t levfill,
+    const magma_int_t n,
+    const magma_index_t *ia,
+    const magma_index_t *ja,
+    magma_index_t *nl,
+    magma_index_t *nu,
+    magma_index_t **rows,
+    std::vector< magma_zsymbilu_arena > &arena )
+{
+    magma_int_t info = 0;
+    magma_int_t nextrow = 0, singular = 0;
+    char *done = NULL;
+    magma_int_t num_threads = 1;
+
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    arena.resize( num_threads );
+    for( magma_int_t t=0; t < num_threads; t++ ) {
+        arena[t].cur = NULL;
+        arena[t].left = 0;
+    }
+    CHECK( magma_malloc_cpu( (void**) &done, max( n, 1 )));
+    #pragma omp parallel for num_threads( num_threads )
+    for( magma_int_t i=0; i < n; i++ ) {
+        done[i] = 0;
+    }
+
+    #pragma omp parallel num_threads( num_threads ) reduction( +:singular )
+    {
+#ifdef _OPENMP
+        magma_int_t id = omp_get_thread_num();
+#else
+        magma_int_t id = 0;
+#endif
+        std::vector< magma_index_t > wcol, wlev, tcol, tlev;
+
+        while( true ) {
+            magma_int_t i;
+            // rows are handed out one at a time and in order, so the
+            // lowest unfinished row never waits
+            #pragma omp atomic capture
+            i = nextrow++;
+            if ( i >= n ) {
+                break;
+            }
+
+            // sorted row of A, all entries on level 0
+            wcol.assign( ja + ia[i], ja + ia[i+1] );
+            std::sort( wcol.begin(), wcol.end() );
+            wlev.assign( wcol.size(), 0 );
+
+            // entries up to and including the current pivot are final
+            size_t p = 0;
+            for( ; p < wcol.size() && wcol[p] < i; p++ ) {
+                magma_index_t k = wcol[p];
+                char ready;
+                while( true ) {
+                    #pragma omp atomic read
+                    ready = done[k];
+                    if ( ready ) {
+                        break;
+                    }
+                    // let the owner of row k run if threads share cores
+                    std::this_thread::yield();
+                }
+                #pragma omp flush
+
+                const magma_index_t *ucol = rows[k] + nl[k+1];
+                const magma_index_t *ulev = ucol + nu[k+1];
+                magma_int_t ulen = nu[k+1];
+                magma_index_t newlev;
+
+                // merge the rest of the row with U(k,:) behind the diagonal
+                tcol.clear();
+                tlev.clear();
+                size_t a = p+1;
+                magma_int_t b = 1;
+                while( a < wcol.size() || b < ulen ) {
+                    if ( b >= ulen || ( a < wcol.size() && wcol[a] < ucol[b] )) {
+                        tcol.push_back( wcol[a] );
+                        tlev.push_back( wlev[a] );
+                        a++;
+                        continue;
+                    }
+                    newlev = wlev[p] + ulev[b] + 1;
+                    if ( a < wcol.size() && wcol[a] == ucol[b] ) {
+                        tcol.push_back( wcol[a] );
+                        tlev.push_back( min( wlev[a], newlev ));
+                        a++;
+                    } else if ( newlev <= levfill ) {
+                        // new fill-in
+                        tcol.push_back( ucol[b] );
+                        tlev.push_back( newlev );
+                    }
+                    b++;
+                }
+                wcol.resize( p+1 );
+                wlev.resize( p+1 );
+                wcol.insert( wcol.end(), tcol.begin(), tcol.end() );
+                wlev.insert( wlev.end(), tlev.begin(), tlev.end() );
+            }
+            if ( p == wcol.size() || wcol[p] != i ) {
+                singular++;
+            }
+
+            // store the row: L columns, U columns, U levels
+            magma_int_t lenl = p;
+            magma_int_t lenu = wcol.size() - p;
+            magma_index_t *dst = NULL;
+            if ( magma_zsymbilu_take( arena[id], lenl + 2*lenu, &dst ) != MAGMA_SUCCESS ) {
+                // keep the pipeline going with an empty row
+                #pragma omp atomic write
+                info = MAGMA_ERR_HOST_ALLOC;
+                lenl = 0;
+                lenu = 0;
+            }
+            for( magma_int_t j=0; j < lenl + lenu; j++ ) {
+                dst[j] = wcol[j];
+            }
+            for( magma_int_t j=0; j < lenu; j++ ) {
+                dst[lenl+lenu+j] = wlev[p+j];
+            }
+            rows[i] = dst;
+            nl[i+1] = lenl;
+            nu[i+1] = lenu;
+            #pragma omp flush
+            #pragma omp atomic write
+            done[i] = 1;
+        }
+    }
+
+    if ( singular > 0 ) {
+        printf("ILU structurally singular (%lld rows without diagonal).\n",
+               (long long) singular );
+    }
+
+cleanup:
+    magma_free_cpu( done );
+    return info;
+}
+
+
+/*
+// symbolic ILU(k) of the CSR pattern ia/ja; leaves the row pointers of L and
+// U in ial and iau, the rows in the per-thread arenas, and the pattern sizes
+// in stats
+*/
+
+static magma_int_t
+magma_zsymbilu_analyze(
+    magma_int_t levels,
+    magma_int_t n,
+    const magma_index_t *ia,
+    const magma_index_t *ja,
+    magma_index_t *ial,
+    magma_index_t *iau,
+    magma_index_t **rows,
+    std::vector< magma_zsymbilu_arena > &arena,
+    magma_fill_stats *stats,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_int_t max_row = 0;
+
+    CHECK( magma_zsymbilu_rows( levels, n, ia, ja, ial, iau, rows, arena ));
+
+    #pragma omp parallel for reduction( max:max_row )
+    for( magma_int_t i=0; i < n; i++ ) {
+        max_row = max( max_row, ial[i+1] + iau[i+1] );
+    }
+    ial[0] = 0;
+    iau[0] = 0;
+    CHECK( magma_zmatrix_createrowptr( n, ial, queue ));
+    CHECK( magma_zmatrix_createrowptr( n, iau, queue ));
+
+    stats->levels = levels;
+    stats->num_rows = n;
+    stats->nnz = ia[n];
+    stats->nnz_l = ial[n];
+    stats->nnz_u = iau[n];
+    stats->max_row = max_row;
+    stats->fill_ratio = ( ia[n] > 0 ) ?
+        (real_Double_t) ( ial[n] + iau[n] ) / (real_Double_t) ia[n] : 0.0;
+    // L and U plus the refilled A, values and indices
+    stats->memory = 2.0 * ( ial[n] + iau[n] )
+                        * ( sizeof(magma_index_t) + sizeof(magmaDoubleComplex) )
+                  + 2.0 * ( n+1 ) * sizeof(magma_index_t);
+
+cleanup:
+    return info;
+}
+
+
+/*
+// gathers the L and U columns from the arenas into jal and jau
+*/
+
+static void
+magma_zsymbilu_gather(
+    magma_int_t n,
+    const magma_index_t *ial,
+    const magma_index_t *iau,
+    magma_index_t **rows,
+    magma_index_t *jal,
+    magma_index_t *jau )
+{
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ) {
+        magma_int_t lenl = ial[i+1] - ial[i];
+        magma_int_t lenu = iau[i+1] - iau[i];
+        for( magma_int_t j=0; j < lenl; j++ ) {
+            jal[ ial[i] + j ] = rows[i][j];
+        }
+        for( magma_int_t j=0; j < lenu; j++ ) {
+            jau[ iau[i] + j ] = rows[i][lenl+j];
+        }
+    }
+}
+
+
 /*
 // symbolic level ILU
 // factors magma_int_to separate upper and lower parts
@@ -72,166 +367,34 @@ magma_zsymbolic_ilu(
 {
     magma_int_t info = 0;
     
-    magma_int_t i;
-    magma_index_t *lnklst=NULL;
-    magma_index_t *curlev=NULL;
-    magma_index_t *levels=NULL;
-    magma_index_t *iwork=NULL;
-    
-    magma_int_t knzl = 0;
-    magma_int_t knzu = 0;
-
-    CHECK( magma_index_malloc_cpu( &lnklst, n ));
-    CHECK( magma_index_malloc_cpu( &curlev, n ));
-    CHECK( magma_index_malloc_cpu( &levels, *nzu ));
-    CHECK( magma_index_malloc_cpu( &iwork, n ));
-    
-    for(magma_int_t t=0; t<n; t++){
-        lnklst[t] = 0;
-        curlev[t] = 0;
-        iwork[t] = 0;
-    }
-
-    for(magma_int_t t=0; t<*nzu; t++){
-        levels[t] = 0;
+    magma_index_t **rows = NULL;
+    std::vector< magma_zsymbilu_arena > arena;
+    magma_fill_stats stats;
+
+    CHECK( magma_malloc_cpu( (void**) &rows, max( n, 1 )*sizeof(magma_index_t*) ));
+    CHECK( magma_zsymbilu_analyze( levfill, n, ia, ja, ial, iau, rows, arena,
+                                   &stats, NULL ));
+
+    if ( stats.nnz_l > *nzl ) {
+        printf("ILU: STORAGE parameter value %d<%d too small.\n", int(*nzl), int(stats.nnz_l));
+        printf("Increase STORAGE parameter.\n");
+        info = -1;
+        goto cleanup;
     }
-
-    ial[0] = 0;
-    iau[0] = 0;
-
-    for (i=0; i<n; i++) {
-        //printf("check line %d\n", i);
-        magma_int_t first, next, j;
-
-        /* copy column indices of row into workspace and sort them */
-
-        magma_int_t len = ia[i+1] - ia[i];
-        next = 0;
-        for (j=ia[i]; j<ia[i+1]; j++)
-            iwork[next++] = ja[j];
-        magma_zshell_sort(len, iwork);
-        //printf("check2 line %d\n", i);
-        /* construct implied linked list for row */
-
-        first = iwork[0];
-        curlev[first] = 0;
-
-        for (j=0; j<=len-2; j++)
-        {
-            lnklst[iwork[j]] = iwork[j+1];
-            curlev[iwork[j]] = 0;
-        }
-        // printf("check3 line %d iwork[len-1]:%d\n", i, iwork[len-1]);
-        lnklst[iwork[len-1]] = n;
-        curlev[iwork[len-1]] = 0;
-
-        /* merge with rows in U */
-        // printf("check4 line %d lnklst[iwork[len-1]]:%d\n", i, lnklst[iwork[len-1]]);
-        next = first;
-        // printf("next:%d (!<) first:%d\n", next, i);
-        while (next < i)
-        {
-          //  printf("check line %d while %d\n", i, next);
-            magma_int_t oldlst = next;
-            magma_int_t nxtlst = lnklst[next];
-            magma_int_t row = next;
-            magma_int_t ii;
-
-            /* scan row */
-
-            for (ii=iau[row]+1; ii<iau[row+1]; /*nop*/)
-            {
-                if (jau[ii] < nxtlst)
-                {
-                    /* new fill-in */
-                    magma_int_t newlev = curlev[row] + levels[ii] + 1;
-                    if (newlev <= levfill)
-                    {
-                        lnklst[oldlst]  = jau[ii];
-                        lnklst[jau[ii]] = nxtlst;
-                        oldlst = jau[ii];
-                        curlev[jau[ii]] = newlev;
-                    }
-                    ii++;
-                }
-                else if (jau[ii] == nxtlst)
-                {
-                    magma_int_t newlev;
-                    oldlst = nxtlst;
-                    nxtlst = lnklst[oldlst];
-                    newlev = curlev[row] + levels[ii] + 1;
-                    curlev[jau[ii]] = min( curlev[jau[ii]], newlev );
-                    ii++;
-                }
-                else /* (jau[ii] > nxtlst) */
-                {
-                    oldlst = nxtlst;
-                    nxtlst = lnklst[oldlst];
-                }
-            }
-            next = lnklst[next];
-        }
-        
-        /* gather the pattern magma_int_to L and U */
-       // printf("check line5 %d\n", i);
-        next = first;
-        while (next < i)
-        {
-            if (knzl >= *nzl) {
-                printf("ILU: STORAGE parameter value %d<%d too small.\n", int(*nzl), int(knzl));
-                printf("Increase STORAGE parameter.\n");
-                info = -1;
-                goto cleanup;
-            }
-            jal[knzl++] = next;
-            next = lnklst[next];
-        }
-        ial[i+1] = knzl;
-        //  printf("check line6 %d\n", i);
-        if (next != i)
-        {
-            printf("ILU structurally singular.\n");
-            /*
-                assert(knzu < *nzu);
-                levels[knzu] = 2*n;
-                jau[knzu++] = i;
-            */
-        }
-        //  printf("check line7 %d\n", i);
-        //                 printf("next:%d  n:%d \n", next, n);
-        while (next < n)
-        {
-            if (knzu >= *nzu) {
-                printf("ILU: STORAGE parameter value %d < %d too small.\n", int(*nzu), int(knzu));
-                printf("Increase STORAGE parameter.\n");
-                info = -1;
-                goto cleanup;
-            }
-            // printf("1 knzu:%d  next:%d \n", knzu, next );
-            levels[knzu] = curlev[next];
-            //  printf("2 knzu:%d  next:%d \n", knzu, next );
-            jau[knzu++] = next;
-            //  printf("3 knzu:%d  next:%d \n", knzu, next );
-            next = lnklst[next];
-            //  printf("4 next:%d  n:%d \n", next, n);
-        }
-        iau[i+1] = knzu;
+    if ( stats.nnz_u > *nzu ) {
+        printf("ILU: STORAGE parameter value %d < %d too small.\n", int(*nzu), int(stats.nnz_u));
+        printf("Increase STORAGE parameter.\n");
+        info = -1;
+        goto cleanup;
     }
+    magma_zsymbilu_gather( n, ial, iau, rows, jal, jau );
 
-    *nzl = knzl;
-    *nzu = knzu;
-
-    // printf("ende\n");
-
-#if 0
-    printf( "Actual nnz for ILU: %d\n", *nzl + *nzu );
-#endif
+    *nzl = stats.nnz_l;
+    *nzu = stats.nnz_u;
 
 cleanup:
-    magma_free_cpu(lnklst);
-    magma_free_cpu(curlev);
-    magma_free_cpu(levels);
-    magma_free_cpu(iwork);
+    magma_zsymbilu_release( arena );
+    magma_free_cpu( rows );
     
     return info;
 }
@@ -271,12 +434,85 @@ void magma_zmexFunction(magma_int_t nlhs, magma_int_t n, magmaDoubleComplex omeg
 
 
 
+/**
+    Purpose
+    -------
+
+    Runs the symbolic ILU(k) factorization of A without allocating L and U,
+    and returns the size of the pattern and the host memory magma_zsymbilu
+    would need for it. This allows rejecting a fill level before committing
+    the memory.
+
+    Arguments
+    ---------
+    @param[in]
+    A           magma_z_matrix
+                input matrix in CSR format on the CPU
+
+    @param[in]
+    levels      magma_int_t
+                fill in level
+
+    @param[out]
+    stats       magma_fill_stats*
+                nonzeros of L and U, longest row, fill ratio and memory
+                estimate in bytes
+                
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C"
+magma_int_t
+magma_zsymbilu_stats(
+    magma_z_matrix A,
+    magma_int_t levels,
+    magma_fill_stats *stats,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    
+    magma_index_t *ial = NULL, *iau = NULL;
+    magma_index_t **rows = NULL;
+    std::vector< magma_zsymbilu_arena > arena;
+    
+    if( A.memory_location != Magma_CPU || A.storage_type != Magma_CSR ){
+        printf("error: symbolic ILU statistics need a CSR matrix on the CPU.\n");
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    CHECK( magma_index_malloc_cpu( &ial, A.num_rows+1 ));
+    CHECK( magma_index_malloc_cpu( &iau, A.num_rows+1 ));
+    CHECK( magma_malloc_cpu( (void**) &rows, max( A.num_rows, 1 )*sizeof(magma_index_t*) ));
+    CHECK( magma_zsymbilu_analyze( levels, A.num_rows, A.row, A.col, ial, iau,
+                                   rows, arena, stats, queue ));
+    
+cleanup:
+    magma_zsymbilu_release( arena );
+    magma_free_cpu( rows );
+    magma_free_cpu( ial );
+    magma_free_cpu( iau );
+    return info;
+}
+
+
+
 /**
     Purpose
     -------
 
     This routine performs a symbolic ILU factorization.
     The algorithm is taken from an implementation written by Edmond Chow.
+    The rows are computed in parallel and pipelined: a row only waits for
+    the rows it is eliminated with.
+    
+    If the environment variable MAGMA_SYMBILU_MAX_MB is set, a pattern
+    whose memory estimate (see magma_zsymbilu_stats) exceeds that many
+    megabytes is rejected with MAGMA_ERR_HOST_ALLOC before L and U are
+    allocated.
 
     Arguments
     ---------
@@ -319,6 +555,10 @@ magma_zsymbilu(
     
     magma_z_matrix A_copy={Magma_CSR}, B={Magma_CSR};
     magma_z_matrix hA={Magma_CSR}, CSRCOOA={Magma_CSR};
+    magma_index_t **rows = NULL;
+    std::vector< magma_zsymbilu_arena > arena;
+    magma_fill_stats stats;
+    const char *limit = NULL;
     
     // make sure the target structure is empty
     magma_zmfree( L, queue );
@@ -333,29 +573,49 @@ magma_zsymbilu(
 
         CHECK( magma_zmconvert( B, L, Magma_CSR, Magma_CSR , queue));
         CHECK( magma_zmconvert( B, U, Magma_CSR, Magma_CSR, queue ));
-
-        magma_int_t num_lnnz = (levels > 0 ) ? B.nnz/2*(2*levels+50) : B.nnz;
-        magma_int_t num_unnz = (levels > 0 ) ? B.nnz/2*(2*levels+50) : B.nnz;
-
         magma_free_cpu( L->col );
         magma_free_cpu( U->col );
-        CHECK( magma_index_malloc_cpu( &L->col, num_lnnz ));
-        CHECK( magma_index_malloc_cpu( &U->col, num_unnz ));
-
-        magma_zsymbolic_ilu( levels, A->num_rows, &num_lnnz, &num_unnz, B.row, B.col,
-                                            L->row, L->col, U->row, U->col );
-        L->nnz = num_lnnz;
-        U->nnz = num_unnz;
         magma_free_cpu( L->val );
         magma_free_cpu( U->val );
+        L->col = NULL;
+        U->col = NULL;
+        L->val = NULL;
+        U->val = NULL;
+
+        // the pattern sizes are known before L and U are allocated
+        CHECK( magma_malloc_cpu( (void**) &rows, max( A->num_rows, 1 )*sizeof(magma_index_t*) ));
+        CHECK( magma_zsymbilu_analyze( levels, A->num_rows, B.row, B.col,
+                                       L->row, U->row, rows, arena, &stats, queue ));
+        limit = getenv( "MAGMA_SYMBILU_MAX_MB" );
+        if ( limit != NULL && stats.memory > atof( limit ) * 1048576. ) {
+            printf("ILU(%lld): %lld + %lld nonzeros need %.1f MB, more than "
+                   "MAGMA_SYMBILU_MAX_MB=%s.\n",
+                   (long long) levels, (long long) stats.nnz_l,
+                   (long long) stats.nnz_u, stats.memory / 1048576., limit );
+            info = MAGMA_ERR_HOST_ALLOC;
+            goto cleanup;
+        }
+
+        L->nnz = stats.nnz_l;
+        U->nnz = stats.nnz_u;
+        CHECK( magma_index_malloc_cpu( &L->col, L->nnz ));
+        CHECK( magma_index_malloc_cpu( &U->col, U->nnz ));
+        magma_zsymbilu_gather( A->num_rows, L->row, U->row, rows, L->col, U->col );
+        magma_zsymbilu_release( arena );
+        magma_free_cpu( rows );
+        rows = NULL;
+
         CHECK( magma_zmalloc_cpu( &L->val, L->nnz ));
         CHECK( magma_zmalloc_cpu( &U->val, U->nnz ));
+        #pragma omp parallel for
         for( magma_int_t i=0; i<L->nnz; i++ )
             L->val[i] = MAGMA_Z_MAKE( 0.0, 0.0 );
 
+        #pragma omp parallel for
         for( magma_int_t i=0; i<U->nnz; i++ )
             U->val[i] = MAGMA_Z_MAKE( 0.0, 0.0 );
         // take the original values (scaled) as initial guess for L
+        #pragma omp parallel for schedule(dynamic, 1024)
         for(magma_int_t i=0; i<L->num_rows; i++){
             for(magma_int_t j=B.row[i]; j<B.row[i+1]; j++){
                 magma_index_t lcol = B.col[j];
@@ -368,6 +628,7 @@ magma_zsymbilu(
         }
 
         // take the original values (scaled) as initial guess for U
+        #pragma omp parallel for schedule(dynamic, 1024)
         for(magma_int_t i=0; i<U->num_rows; i++){
             for(magma_int_t j=B.row[i]; j<B.row[i+1]; j++){
                 magma_index_t lcol = B.col[j];
@@ -386,9 +647,13 @@ magma_zsymbilu(
         CHECK( magma_zmalloc_cpu( &A->val, L->nnz+U->nnz ));
         A->nnz = L->nnz+U->nnz;
         
-        magma_int_t z = 0;
+        #pragma omp parallel for
+        for(magma_int_t i=0; i<A->num_rows+1; i++){
+            A->row[i] = L->row[i] + U->row[i];
+        }
+        #pragma omp parallel for schedule(dynamic, 1024)
         for(magma_int_t i=0; i<A->num_rows; i++){
-            A->row[i] = z;
+            magma_int_t z = A->row[i];
             for(magma_int_t j=L->row[i]; j<L->row[i+1]; j++){
                 A->col[z] = L->col[j];
                 A->val[z] = L->val[j];
@@ -400,8 +665,8 @@ magma_zsymbilu(
                 z++;
             }
         }
-        A->row[A->num_rows] = z;
         // reset the values of A to the original entries
+        #pragma omp parallel for schedule(dynamic, 1024)
         for(magma_int_t i=0; i<A->num_rows; i++){
             for(magma_int_t j=A_copy.row[i]; j<A_copy.row[i+1]; j++){
                 magma_index_t lcol = A_copy.col[j];
@@ -432,6 +697,8 @@ cleanup:
         magma_zmfree( L, queue );
         magma_zmfree( U, queue );
     }
+    magma_zsymbilu_release( arena );
+    magma_free_cpu( rows );
     magma_zmfree( &A_copy, queue );
     magma_zmfree( &B, queue );
     magma_zmfree( &hA, queue );
@@ -19,6 +19,10 @@
 
 #include "magmasparse_internal.h"
 #include "magmasparse_mmio.h"
+#include "magmasparse_bio.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 /**
@@ -107,14 +111,18 @@ magma_int_t read_z_csr_from_mtx(
     
     magma_index_t *coo_col=NULL, *coo_row=NULL;
     magmaDoubleComplex *coo_val=NULL;
-    magma_index_t *new_col=NULL, *new_row=NULL;
-    magmaDoubleComplex *new_val=NULL;
-    magma_int_t hermitian = 0;
+    magma_index_t *rowptr=NULL;
+    int64_t *perm=NULL;
+    magma_int_t hermitian = 0, symmetric = 0, parse_error = 0;
+    magma_int_t parts = 1;
+    real_Double_t start, end;
     
-    std::vector< std::pair< magma_index_t, magmaDoubleComplex > > rowval;
+    std::vector< size_t > bounds;
+    std::vector< int64_t > first;
     
     FILE *fid = NULL;
     MM_typecode matcode;
+    mm_data data = { NULL, 0, NULL, 0 };
     fid = fopen(filename, "r");
     
     if (fid == NULL) {
@@ -168,47 +176,82 @@ magma_int_t read_z_csr_from_mtx(
     CHECK( magma_index_malloc_cpu( &coo_row, *nnz ) );
     CHECK( magma_zmalloc_cpu( &coo_val, *nnz ) );
 
-    if (mm_is_real(matcode) || mm_is_integer(matcode)) {
-        for(magma_int_t i = 0; i < *nnz; ++i) {
-            magma_index_t ROW, COL;
-            double VAL;  // always read in a double and convert later if necessary
-            
-            fscanf(fid, " %d %d %lf \n", &ROW, &COL, &VAL);
-            
-            coo_row[i] = ROW - 1;
-            coo_col[i] = COL - 1;
-            coo_val[i] = MAGMA_Z_MAKE( VAL, 0.);
-        }
-    } else if (mm_is_pattern(matcode) ) {
-        for(magma_int_t i = 0; i < *nnz; ++i) {
-            magma_index_t ROW, COL;
-            
-            fscanf(fid, " %d %d \n", &ROW, &COL );
-            
-            coo_row[i] = ROW - 1;
-            coo_col[i] = COL - 1;
-            coo_val[i] = MAGMA_Z_MAKE( 1.0, 0.);
-        }
-    } else if (mm_is_complex(matcode) ){
-        for (magma_int_t i = 0; i < *nnz; ++i) {
+    // map the data section and parse it in parallel: the section is cut
+    // into chunks at line boundaries, the entries per chunk are counted,
+    // and every chunk is then parsed into its slice of the COO arrays
+    start = magma_wtime();
+    if ( mm_map_data( fid, &data ) != 0 ) {
+        printf("\n%% Could not read data section.\n");
+        info = MAGMA_ERR_HOST_ALLOC;
+        goto cleanup;
+    }
+#ifdef _OPENMP
+    parts = omp_get_max_threads();
+#endif
+    bounds.resize( parts+1 );
+    first.resize( parts+1 );
+    mm_split_lines( data.data, data.size, parts, &bounds[0] );
+    
+    #pragma omp parallel for schedule(static, 1)
+    for( magma_int_t k=0; k < parts; k++ ) {
+        first[k+1] = mm_count_entries( data.data + bounds[k],
+                                       data.data + bounds[k+1] );
+    }
+    first[0] = 0;
+    for( magma_int_t k=0; k < parts; k++ ) {
+        first[k+1] += first[k];
+    }
+    if ( first[parts] < *nnz ) {
+        printf("\n%% Premature end of file: %lld of %lld entries.\n",
+               (long long) first[parts], (long long) *nnz );
+        info = MAGMA_ERR_UNKNOWN;
+        goto cleanup;
+    }
+
+    #pragma omp parallel for schedule(static, 1) reduction(+:parse_error)
+    for( magma_int_t k=0; k < parts; k++ ) {
+        const char *p = data.data + bounds[k];
+        const char *pend = data.data + bounds[k+1];
+        int64_t i = first[k];
+        while ( p < pend && i < *nnz ) {
+            const char *eol = mm_next_line( p, pend );
+            if ( mm_count_entries( p, eol ) == 0 ) {
+                p = eol;
+                continue;
+            }
             magma_index_t ROW, COL;
-            double VAL, VALC;  // always read in a double and convert later if necessary
-            
-            fscanf(fid, " %d %d %lf %lf\n", &ROW, &COL, &VAL, &VALC);
-            
-            coo_row[i] = ROW - 1;
-            coo_col[i] = COL - 1;
-            coo_val[i] = MAGMA_Z_MAKE( VAL, VALC);
+            double VAL = 1.0, VALC = 0.0;  // always read in a double and convert later if necessary
+            int err = mm_parse_index( &p, eol, &ROW )
+                    | mm_parse_index( &p, eol, &COL );
+            if ( mm_is_real(matcode) || mm_is_integer(matcode) ) {
+                err |= mm_parse_double( &p, eol, &VAL );
+            } else if ( mm_is_complex(matcode) ) {
+                err |= mm_parse_double( &p, eol, &VAL )
+                     | mm_parse_double( &p, eol, &VALC );
+            }
+            if ( err != 0 || ROW < 1 || ROW > num_rows
+                          || COL < 1 || COL > num_cols ) {
+                parse_error++;
+            } else {
+                coo_row[i] = ROW - 1;
+                coo_col[i] = COL - 1;
+                coo_val[i] = MAGMA_Z_MAKE( VAL, VALC );
+            }
+            i++;
+            p = eol;
         }
-        // printf(" ...successfully read complex matrix... ");
-    } else {
-        printf("\n%% Unrecognized data type\n");
-        info = MAGMA_ERR_NOT_SUPPORTED;
-        goto cleanup;
     }
+    end = magma_wtime();
+    mm_unmap_data( &data );
     fclose(fid);
     fid = NULL;
-    printf(" done. Converting to CSR:");
+    if ( parse_error > 0 ) {
+        printf("\n%% Could not parse %lld entries.\n", (long long) parse_error );
+        info = MAGMA_ERR_UNKNOWN;
+        goto cleanup;
+    }
+    printf(" done (%.1f MB/s). Converting to CSR:",
+           (double) bounds[parts] / 1e6 / max( end - start, 1e-9 ) );
     fflush(stdout);
     
 
@@ -219,110 +262,105 @@ magma_int_t read_z_csr_from_mtx(
     if ( mm_is_symmetric(matcode) || mm_is_hermitian(matcode) ) { 
                                         // duplicate off diagonal entries
         printf("\n%% Detected symmetric case.");
-        
-        magma_index_t off_diagonals = 0;
-        for(magma_int_t i = 0; i < *nnz; ++i) {
-            if (coo_row[i] != coo_col[i])
-                ++off_diagonals;
-        }
-        magma_index_t true_nonzeros = 2*off_diagonals + (*nnz - off_diagonals);
-        
-        //printf("%% total number of nonzeros: %d\n%%", int(*nnz));
+        symmetric = 1;
+    }
 
-        CHECK( magma_index_malloc_cpu( &new_row, true_nonzeros ));
-        CHECK( magma_index_malloc_cpu( &new_col, true_nonzeros ));
-        CHECK( magma_zmalloc_cpu( &new_val, true_nonzeros ));
-    
-        magma_index_t ptr = 0;
-        for(magma_int_t i = 0; i < *nnz; ++i) {
-            if (coo_row[i] != coo_col[i]) {
-                new_row[ptr] = coo_row[i];
-                new_col[ptr] = coo_col[i];
-                new_val[ptr] = coo_val[i];
-                ptr++;
-                new_col[ptr] = coo_row[i];
-                new_row[ptr] = coo_col[i];
-                new_val[ptr] = (hermitian == 0) ? coo_val[i] : conj(coo_val[i]);
-                ptr++;
-            } else {
-                new_row[ptr] = coo_row[i];
-                new_col[ptr] = coo_col[i];
-                new_val[ptr] = coo_val[i];
-                ptr++;
-            }
+    // Parallel counting sort into CSR. Every entry of the (expanded) COO
+    // list gets a key: its position i, or 2*i and 2*i+1 for an
+    // off-diagonal entry and its mirror in the symmetric case. This is
+    // the order of the expanded COO list, so sorting the keys of a row by
+    // (column, key) reproduces exactly the serial conversion.
+    CHECK( magma_index_malloc_cpu( &rowptr, num_rows+1 ) );
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < num_rows+1; i++ ) {
+        rowptr[i] = 0;
+    }
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < *nnz; i++ ) {
+        #pragma omp atomic
+        rowptr[ coo_row[i]+1 ]++;
+        if ( symmetric && coo_row[i] != coo_col[i] ) {
+            #pragma omp atomic
+            rowptr[ coo_col[i]+1 ]++;
         }
-        
-        magma_free_cpu(coo_row); 
-        magma_free_cpu(coo_col); 
-        magma_free_cpu(coo_val);
-
-        coo_row = new_row;
-        coo_col = new_col;
-        coo_val = new_val;
-        
-        *nnz = true_nonzeros;
-    } // end symmetric case
-    
-    CHECK( magma_zmalloc_cpu( val, *nnz ) );
+    }
+    CHECK( magma_zmatrix_createrowptr( num_rows, rowptr, queue ));
+    *nnz = rowptr[num_rows];
     
     CHECK( magma_index_malloc_cpu( col, *nnz ) );
     CHECK( magma_index_malloc_cpu( row, (*n_row+1) ) );
     CHECK( magma_zmalloc_cpu( val, *nnz ) );
-
-    // original code from  Nathan Bell and Michael Garland
-    for (magma_index_t i = 0; i < num_rows; i++)
-        (*row)[i] = 0;
-    
-    for (magma_index_t i = 0; i < *nnz; i++)
-        (*row)[coo_row[i]]++;
+    CHECK( magma_malloc_cpu( (void**) &perm, *nnz * sizeof(int64_t) ));
     
-    // cumulative sum the nnz per row to get row[]
-    magma_int_t cumsum;
-    cumsum = 0;
-    for(magma_int_t i = 0; i < num_rows; i++) {
-        magma_index_t temp = (*row)[i];
-        (*row)[i] = cumsum;
-        cumsum += temp;
+    // row[] serves as insertion pointer and is restored afterwards
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < num_rows+1; i++ ) {
+        (*row)[i] = rowptr[i];
     }
-    (*row)[num_rows] = *nnz;
-    
-    // write Aj,Ax into Bj,Bx
-    for(magma_int_t i = 0; i < *nnz; i++) {
-        magma_index_t row_  = coo_row[i];
-        magma_index_t dest = (*row)[row_];
-        (*col)[dest] = coo_col[i];
-        (*val)[dest] = coo_val[i];
-        (*row)[row_]++;
-    }
-    
-    int last;
-    last = 0;
-    for(int i = 0; i <= num_rows; i++) {
-        int temp  = (*row)[i];
-        (*row)[i] = last;
-        last      = temp;
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < num_nonzeros; i++ ) {
+        magma_index_t dest;
+        if ( symmetric ) {
+            #pragma omp atomic capture
+            dest = (*row)[ coo_row[i] ]++;
+            perm[dest] = 2*(int64_t) i;
+            if ( coo_row[i] != coo_col[i] ) {
+                #pragma omp atomic capture
+                dest = (*row)[ coo_col[i] ]++;
+                perm[dest] = 2*(int64_t) i + 1;
+            }
+        } else {
+            #pragma omp atomic capture
+            dest = (*row)[ coo_row[i] ]++;
+            perm[dest] = i;
+        }
     }
     
-    (*row)[*n_row] = *nnz;
-
-    // sort column indices within each row
-    // copy into vector of pairs (column index, value), sort by column index, then copy back
-    for (magma_index_t k=0; k < *n_row; ++k) {
-        int kk  = (*row)[k];
-        int len = (*row)[k+1] - (*row)[k];
-        rowval.resize( len );
-        for( int i=0; i < len; ++i ) {
-            rowval[i] = std::make_pair( (*col)[kk+i], (*val)[kk+i] );
-        }
-        std::sort( rowval.begin(), rowval.end(), compare_first );
-        for( int i=0; i < len; ++i ) {
-            (*col)[kk+i] = rowval[i].first;
-            (*val)[kk+i] = rowval[i].second;
+    // sort column indices within each row, then gather columns and values
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t k=0; k < num_rows; k++ ) {
+        int64_t *kbegin = perm + rowptr[k];
+        int64_t *kend = perm + rowptr[k+1];
+        if ( symmetric ) {
+            std::sort( kbegin, kend,
+                [&]( int64_t a, int64_t b ) {
+                    magma_index_t ca = (a & 1) ? coo_row[a >> 1] : coo_col[a >> 1];
+                    magma_index_t cb = (b & 1) ? coo_row[b >> 1] : coo_col[b >> 1];
+                    return ca < cb || ( ca == cb && a < b );
+                });
+            for( int64_t *e = kbegin; e < kend; e++ ) {
+                int64_t i = *e >> 1;
+                magma_int_t dest = e - perm;
+                if ( *e & 1 ) {
+                    (*col)[dest] = coo_row[i];
+                    (*val)[dest] = (hermitian == 0) ? coo_val[i] : conj(coo_val[i]);
+                } else {
+                    (*col)[dest] = coo_col[i];
+                    (*val)[dest] = coo_val[i];
+                }
+            }
+        } else {
+            std::sort( kbegin, kend,
+                [&]( int64_t a, int64_t b ) {
+                    return coo_col[a] < coo_col[b] || ( coo_col[a] == coo_col[b] && a < b );
+                });
+            for( int64_t *e = kbegin; e < kend; e++ ) {
+                magma_int_t dest = e - perm;
+                (*col)[dest] = coo_col[*e];
+                (*val)[dest] = coo_val[*e];
+            }
         }
     }
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < num_rows+1; i++ ) {
+        (*row)[i] = rowptr[i];
+    }
 
     printf(" done.\n");
 cleanup:
+    if ( data.map != NULL ) {
+        mm_unmap_data( &data );
+    }
     if ( fid != NULL ) {
         fclose( fid );
         fid = NULL;
@@ -330,6 +368,8 @@ cleanup:
     magma_free_cpu(coo_row);
     magma_free_cpu(coo_col);
     magma_free_cpu(coo_val);
+    magma_free_cpu(rowptr);
+    magma_free_cpu(perm);
     return info;
 }
 
@@ -921,6 +961,12 @@ cleanup:
     file and converts it into CSR format. It duplicates the off-diagonal
     entries in the symmetric case.
 
+    The file is read at once, which needs about three times the memory of
+    the matrix. For larger matrices, see magma_z_csr_mtx_slice.
+
+    Binary containers from magma_zwrite_csr_bin are read with
+    magma_z_csr_bin, i.e., A points into the mapped file if possible.
+
     Arguments
     ---------
 
@@ -951,22 +997,22 @@ magma_z_csr_mtx(
     int csr_compressor = 0;       // checks for zeros in original file
     
     magma_z_matrix B={Magma_CSR};
-
-    magma_index_t *coo_col = NULL;
-    magma_index_t *coo_row = NULL;
-    magmaDoubleComplex *coo_val = NULL;
-    magmaDoubleComplex *new_val = NULL;
-    magma_index_t* new_row = NULL;
-    magma_index_t* new_col = NULL;
-    magma_int_t hermitian = 0;
+    magma_storage_t type;
+    magma_location_t location;
     
     // make sure the target structure is empty
     magma_zmfree( A, queue );
     A->ownership = MagmaTrue;
-    std::vector< std::pair< magma_index_t, magmaDoubleComplex > > rowval;
     
     FILE *fid = NULL;
     MM_typecode matcode;
+
+    // binary containers are recognized by their magic
+    if ( magma_bio_is_container( filename ) ) {
+        CHECK( magma_z_csr_bin( A, filename, MagmaFalse, queue ));
+        goto cleanup;
+    }
+
     fid = fopen(filename, "r");
     
     if (fid == NULL) {
@@ -975,16 +1021,17 @@ magma_z_csr_mtx(
         goto cleanup;
     }
     
-    printf("%% Reading sparse matrix from file (%s):", filename);
-    fflush(stdout);
-    
     if (mm_read_banner(fid, &matcode) != 0) {
+        printf("%% Reading sparse matrix from file (%s):", filename);
         printf("\n%% Could not process Matrix Market banner: %s.\n", matcode);
         info = MAGMA_ERR_NOT_SUPPORTED;
         goto cleanup;
     }
+    fclose(fid);
+    fid = NULL;
     
     if (!mm_is_valid(matcode)) {
+        printf("%% Reading sparse matrix from file (%s):", filename);
         printf("\n%% Invalid Matrix Market file.\n");
         info = MAGMA_ERR_NOT_SUPPORTED;
         goto cleanup;
@@ -998,184 +1045,29 @@ magma_z_csr_mtx(
              mm_is_sparse(matcode) ) )
     {
         mm_snprintf_typecode( buffer, sizeof(buffer), matcode );
+        printf("%% Reading sparse matrix from file (%s):", filename);
         printf("\n%% Sorry, MAGMA-sparse does not support Market Market type: [%s]\n", buffer );
         printf("%% Only real-valued or pattern coordinate matrices are supported.\n");
         info = MAGMA_ERR_NOT_SUPPORTED;
         goto cleanup;
     }
 
-    magma_index_t num_rows, num_cols, num_nonzeros;
-    if (mm_read_mtx_crd_size(fid, &num_rows, &num_cols, &num_nonzeros) != 0) {
-        info = MAGMA_ERR_UNKNOWN;
-        goto cleanup;
-    }
-    
+    // parallel reader, expands symmetric and hermitian matrices
+    CHECK( read_z_csr_from_mtx( &type, &location, &A->num_rows, &A->num_cols,
+                                &A->nnz, &A->val, &A->row, &A->col,
+                                filename, queue ));
     A->storage_type    = Magma_CSR;
     A->memory_location = Magma_CPU;
-    A->num_rows        = num_rows;
-    A->num_cols        = num_cols;
-    A->nnz             = num_nonzeros;
     A->fill_mode       = MagmaFull;
-    
-    CHECK( magma_index_malloc_cpu( &coo_col, A->nnz ) );
-    CHECK( magma_index_malloc_cpu( &coo_row, A->nnz ) );
-    CHECK( magma_zmalloc_cpu( &coo_val, A->nnz ) );
+    A->sym = ( mm_is_symmetric(matcode) || mm_is_hermitian(matcode) )
+             ? Magma_SYMMETRIC : Magma_GENERAL;
 
+    // explicit zeros in real-valued files are removed
     if (mm_is_real(matcode) || mm_is_integer(matcode)) {
-        for(magma_int_t i = 0; i < A->nnz; ++i) {
-            magma_index_t ROW, COL;
-            double VAL;  // always read in a double and convert later if necessary
-            
-            fscanf(fid, " %d %d %lf \n", &ROW, &COL, &VAL);
-            if ( VAL == 0 )
+        #pragma omp parallel for reduction(max:csr_compressor)
+        for( magma_int_t i=0; i < A->nnz; i++ ) {
+            if ( MAGMA_Z_REAL( A->val[i] ) == 0 )
                 csr_compressor = 1;
-            coo_row[i] = ROW - 1;
-            coo_col[i] = COL - 1;
-            coo_val[i] = MAGMA_Z_MAKE( VAL, 0.);
-        }
-    } else if (mm_is_pattern(matcode) ) {
-        for(magma_int_t i = 0; i < A->nnz; ++i) {
-            magma_index_t ROW, COL;
-            
-            fscanf(fid, " %d %d \n", &ROW, &COL );
-            
-            coo_row[i] = ROW - 1;
-            coo_col[i] = COL - 1;
-            coo_val[i] = MAGMA_Z_MAKE( 1.0, 0.);
-        }
-    } else if (mm_is_complex(matcode) ){
-        for (magma_int_t i = 0; i < A->nnz; ++i) {
-            magma_index_t ROW, COL;
-            double VAL, VALC;  // always read in a double and convert later if necessary
-            
-            fscanf(fid, " %d %d %lf %lf\n", &ROW, &COL, &VAL, &VALC);
-            
-            coo_row[i] = ROW - 1;
-            coo_col[i] = COL - 1;
-            coo_val[i] = MAGMA_Z_MAKE( VAL, VALC);
-        }
-        // printf(" ...successfully read complex matrix... ");
-    } else {
-        printf("\n%% Unrecognized data type\n");
-        info = MAGMA_ERR_NOT_SUPPORTED;
-        goto cleanup;
-    }
-    fclose(fid);
-    fid = NULL;
-    printf(" done. Converting to CSR:");
-    fflush(stdout);
-    
-    A->sym = Magma_GENERAL;
-
-
-    if( mm_is_hermitian(matcode) ) {
-        hermitian = 1;
-    }
-    if ( mm_is_symmetric(matcode) || mm_is_hermitian(matcode) ) { 
-                                        // duplicate off diagonal entries
-        printf("\n%% Detected symmetric case.");
-        A->sym = Magma_SYMMETRIC;
-        magma_index_t off_diagonals = 0;
-        for(magma_int_t i = 0; i < A->nnz; ++i) {
-            if (coo_row[i] != coo_col[i])
-                ++off_diagonals;
-        }
-        magma_index_t true_nonzeros = 2*off_diagonals + (A->nnz - off_diagonals);
-        
-        //printf("%% total number of nonzeros: %d\n%%", int(A->nnz));
-
-        CHECK( magma_index_malloc_cpu( &new_row, true_nonzeros ));
-        CHECK( magma_index_malloc_cpu( &new_col, true_nonzeros ));
-        CHECK( magma_zmalloc_cpu( &new_val, true_nonzeros ));
-        
-        magma_index_t ptr = 0;
-        for(magma_int_t i = 0; i < A->nnz; ++i) {
-            if (coo_row[i] != coo_col[i]) {
-                new_row[ptr] = coo_row[i];
-                new_col[ptr] = coo_col[i];
-                new_val[ptr] = coo_val[i];
-                ptr++;
-                new_col[ptr] = coo_row[i];
-                new_row[ptr] = coo_col[i];
-                new_val[ptr] = (hermitian == 0) ? coo_val[i] : conj(coo_val[i]);
-                ptr++;
-            } else {
-                new_row[ptr] = coo_row[i];
-                new_col[ptr] = coo_col[i];
-                new_val[ptr] = coo_val[i];
-                ptr++;
-            }
-        }
-        
-        magma_free_cpu(coo_row);
-        magma_free_cpu(coo_col);
-        magma_free_cpu(coo_val);
-
-        coo_row = new_row;
-        coo_col = new_col;
-        coo_val = new_val;
-        A->nnz = true_nonzeros;
-        //printf("total number of nonzeros: %d\n", A->nnz);
-    } // end symmetric case
-    
-    CHECK( magma_zmalloc_cpu( &A->val, A->nnz ));
-    CHECK( magma_index_malloc_cpu( &A->col, A->nnz ));
-    CHECK( magma_index_malloc_cpu( &A->row, A->num_rows+1 ));
-    
-    // original code from Nathan Bell and Michael Garland
-    for (magma_index_t i = 0; i < num_rows; i++)
-        (A->row)[i] = 0;
-    
-    for (magma_index_t i = 0; i < A->nnz; i++)
-        (A->row)[coo_row[i]]++;
-        
-    // cumulative sum the nnz per row to get row[]
-    magma_int_t cumsum;
-    cumsum = 0;
-    for(magma_int_t i = 0; i < num_rows; i++) {
-        magma_index_t temp = (A->row)[i];
-        (A->row)[i] = cumsum;
-        cumsum += temp;
-    }
-    (A->row)[num_rows] = A->nnz;
-    
-    // write Aj,Ax into Bj,Bx
-    for(magma_int_t i = 0; i < A->nnz; i++) {
-        magma_index_t row_ = coo_row[i];
-        magma_index_t dest = (A->row)[row_];
-        (A->col)[dest] = coo_col[i];
-        (A->val)[dest] = coo_val[i];
-        (A->row)[row_]++;
-    }    
-    magma_free_cpu(coo_row);
-    magma_free_cpu(coo_col);
-    magma_free_cpu(coo_val);
-    coo_row = NULL;
-    coo_col = NULL;
-    coo_val = NULL;
-
-    int last;
-    last = 0;
-    for(int i = 0; i <= num_rows; i++) {
-        int temp    = (A->row)[i];
-        (A->row)[i] = last;
-        last        = temp;
-    }
-    (A->row)[A->num_rows] = A->nnz;
-    
-    // sort column indices within each row
-    // copy into vector of pairs (column index, value), sort by column index, then copy back
-    for (magma_index_t k=0; k < A->num_rows; ++k) {
-        int kk  = (A->row)[k];
-        int len = (A->row)[k+1] - (A->row)[k];
-        rowval.resize( len );
-        for( int i=0; i < len; ++i ) {
-            rowval[i] = std::make_pair( (A->col)[kk+i], (A->val)[kk+i] );
-        }
-        std::sort( rowval.begin(), rowval.end(), compare_first );
-        for( int i=0; i < len; ++i ) {
-            (A->col)[kk+i] = rowval[i].first;
-            (A->val)[kk+i] = rowval[i].second;
         }
     }
 
@@ -1185,7 +1077,7 @@ magma_z_csr_mtx(
         CHECK( magma_z_csr_compressor(
             &(A->val), &(A->row), &(A->col),
             &B.val, &B.row, &B.col, &B.num_rows, queue ));
-        B.nnz = B.row[num_rows];
+        B.nnz = B.row[A->num_rows];
         //printf(" remaining nonzeros:%d ", B.nnz);
         magma_free_cpu( A->val );
         magma_free_cpu( A->row );
@@ -1195,38 +1087,139 @@ magma_z_csr_mtx(
         //printf("done.\n");
     }
     A->true_nnz = A->nnz;
-    printf(" done.\n");
 cleanup:
     if ( fid != NULL ) {
         fclose( fid );
         fid = NULL;
     }
     magma_zmfree( &B, queue );
-    magma_free_cpu(coo_row);
-    magma_free_cpu(coo_col);
-    magma_free_cpu(coo_val);
     return info;
 }
 
 
+// Parses one block of the data section in parallel into the COO arrays,
+// which are resized to hold its entries. At most remaining entries are
+// read; count returns how many.
+static void
+magma_zmtx_parse_block(
+    const char *data,
+    size_t size,
+    MM_typecode matcode,
+    magma_index_t num_rows,
+    magma_index_t num_cols,
+    int64_t remaining,
+    std::vector< magma_index_t >& coo_row,
+    std::vector< magma_index_t >& coo_col,
+    std::vector< magmaDoubleComplex >& coo_val,
+    int64_t *count,
+    magma_int_t *parse_error )
+{
+    magma_int_t parts = 1;
+    magma_int_t errors = 0;
+#ifdef _OPENMP
+    parts = omp_get_max_threads();
+#endif
+    std::vector< size_t > bounds( parts+1 );
+    std::vector< int64_t > first( parts+1 );
+    mm_split_lines( data, size, parts, &bounds[0] );
+
+    #pragma omp parallel for schedule(static, 1)
+    for( magma_int_t k=0; k < parts; k++ ) {
+        first[k+1] = mm_count_entries( data + bounds[k], data + bounds[k+1] );
+    }
+    first[0] = 0;
+    for( magma_int_t k=0; k < parts; k++ ) {
+        first[k+1] += first[k];
+    }
+    int64_t total = min( first[parts], remaining );
+    coo_row.resize( total );
+    coo_col.resize( total );
+    coo_val.resize( total );
+
+    #pragma omp parallel for schedule(static, 1) reduction(+:errors)
+    for( magma_int_t k=0; k < parts; k++ ) {
+        const char *p = data + bounds[k];
+        const char *pend = data + bounds[k+1];
+        int64_t i = first[k];
+        while ( p < pend && i < total ) {
+            const char *eol = mm_next_line( p, pend );
+            if ( mm_count_entries( p, eol ) == 0 ) {
+                p = eol;
+                continue;
+            }
+            magma_index_t ROW, COL;
+            double VAL = 1.0, VALC = 0.0;
+            int err = mm_parse_index( &p, eol, &ROW )
+                    | mm_parse_index( &p, eol, &COL );
+            if ( mm_is_real(matcode) || mm_is_integer(matcode) ) {
+                err |= mm_parse_double( &p, eol, &VAL );
+            } else if ( mm_is_complex(matcode) ) {
+                err |= mm_parse_double( &p, eol, &VAL )
+                     | mm_parse_double( &p, eol, &VALC );
+            }
+            if ( err != 0 || ROW < 1 || ROW > num_rows
+                          || COL < 1 || COL > num_cols ) {
+                errors++;
+                ROW = COL = 0;  // keeps the entry harmless
+            }
+            coo_row[i] = ROW - 1;
+            coo_col[i] = COL - 1;
+            coo_val[i] = MAGMA_Z_MAKE( VAL, VALC );
+            i++;
+            p = eol;
+        }
+    }
+    *count = total;
+    *parse_error += errors;
+}
+
+
 /**
     Purpose
     -------
 
-    Reads in a SYMMETRIC matrix stored in coo format from a Matrix Market (.mtx)
-    file and converts it into CSR format. It does not duplicate the off-diagonal
-    entries!
+    Reads the rows start:end-1 of a matrix stored in coo format in a Matrix
+    Market (.mtx) file into CSR format, with the same result as magma_z_csr_mtx
+    followed by cutting out these rows. The rows of the slice are the ones
+    magma_zmslice assigns to slice out of num_slices, so every process can read
+    its own partition; num_slices = 1 reads the complete matrix.
+
+    Unlike magma_z_csr_mtx, the file is streamed twice in blocks of bounded
+    size: the first pass counts the entries of every row of the slice, the
+    second scatters them into the preallocated CSR arrays. Besides the slice,
+    only one block of the file and its entries are held in memory, so also
+    matrices larger than the main memory can be read slice by slice.
+
+    Off-diagonal entries are duplicated in the symmetric case, explicit zeros
+    in real-valued files are removed.
 
     Arguments
     ---------
 
     @param[out]
     A           magma_z_matrix*
-                matrix in magma sparse matrix format
+                rows start:end-1 in CSR, with the column count of the matrix
 
     @param[in]
     filename    const char*
                 filname of the mtx matrix
+
+    @param[in]
+    num_slices  magma_int_t
+                number of slices the rows are split into
+
+    @param[in]
+    slice       magma_int_t
+                slice to read, 0 <= slice < num_slices
+
+    @param[out]
+    start       magma_int_t*
+                first row of the slice
+
+    @param[out]
+    end         magma_int_t*
+                one past the last row of the slice
+
     @param[in]
     queue       magma_queue_t
                 Queue to execute in.
@@ -1236,9 +1229,252 @@ cleanup:
 
 extern "C"
 magma_int_t
-magma_z_csr_mtxsymm(
+magma_z_csr_mtx_slice(
     magma_z_matrix *A,
     const char *filename,
+    magma_int_t num_slices,
+    magma_int_t slice,
+    magma_int_t *start,
+    magma_int_t *end,
+    magma_queue_t queue )
+{
+    char buffer[ 1024 ];
+    magma_int_t info = 0;
+
+    // bytes of the file held in memory at a time
+    const size_t block_size = (size_t) 1 << 26;
+
+    magma_index_t num_rows = 0, num_cols = 0, num_nonzeros = 0;
+    magma_int_t lstart = 0, lend = 0, size = 0;
+    magma_int_t hermitian = 0, symmetric = 0, drop_zeros = 0, parse_error = 0;
+    magmaDoubleComplex zero = MAGMA_Z_ZERO;
+    int64_t read = 0, count = 0;
+    const char *data = NULL;
+    size_t data_size = 0;
+    magma_index_t *fill = NULL;
+    real_Double_t tstart, tend;
+
+    std::vector< magma_index_t > coo_row, coo_col;
+    std::vector< magmaDoubleComplex > coo_val;
+
+    FILE *fid = NULL;
+    MM_typecode matcode;
+    mm_stream stream = { NULL, 0, NULL, 0, 0, 0, 0 };
+
+    // make sure the target structure is empty
+    magma_zmfree( A, queue );
+    A->ownership = MagmaTrue;
+    A->storage_type    = Magma_CSR;
+    A->memory_location = Magma_CPU;
+    A->fill_mode       = MagmaFull;
+
+    if ( num_slices < 1 || slice < 0 || slice >= num_slices ) {
+        info = MAGMA_ERR_ILLEGAL_VALUE;
+        goto cleanup;
+    }
+
+    fid = fopen(filename, "r");
+    if (fid == NULL) {
+        printf("%% Unable to open file %s\n", filename);
+        info = MAGMA_ERR_NOT_FOUND;
+        goto cleanup;
+    }
+
+    printf("%% Streaming sparse matrix from file (%s):", filename);
+    fflush(stdout);
+
+    if (mm_read_banner(fid, &matcode) != 0) {
+        printf("\n%% Could not process Matrix Market banner: %s.\n", matcode);
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    if (!mm_is_valid(matcode)) {
+        printf("\n%% Invalid Matrix Market file.\n");
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    if ( ! ( ( mm_is_real(matcode)    ||
+               mm_is_integer(matcode) ||
+               mm_is_pattern(matcode) ||
+               mm_is_complex(matcode) ) &&
+             mm_is_coordinate(matcode)  &&
+             mm_is_sparse(matcode) ) )
+    {
+        mm_snprintf_typecode( buffer, sizeof(buffer), matcode );
+        printf("\n%% Sorry, MAGMA-sparse does not support Market Market type: [%s]\n", buffer );
+        printf("%% Only real-valued or pattern coordinate matrices are supported.\n");
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    if (mm_read_mtx_crd_size(fid, &num_rows, &num_cols, &num_nonzeros) != 0) {
+        info = MAGMA_ERR_UNKNOWN;
+        goto cleanup;
+    }
+    hermitian = mm_is_hermitian(matcode);
+    symmetric = mm_is_symmetric(matcode) || hermitian;
+    drop_zeros = mm_is_real(matcode) || mm_is_integer(matcode);
+
+    // same partitioning as magma_zmslice
+    size = magma_ceildiv( num_rows, num_slices );
+    lstart = min( slice*size, (magma_int_t) num_rows );
+    lend = min( (slice+1)*size, (magma_int_t) num_rows );
+    size = lend - lstart;
+    printf(" rows %lld to %lld.", (long long) lstart, (long long) lend-1 );
+    fflush(stdout);
+
+    CHECK( magma_index_malloc_cpu( &A->row, size+1 ));
+    for( magma_int_t i=0; i < size+1; i++ ) {
+        A->row[i] = 0;
+    }
+    if ( mm_stream_open( fid, block_size, &stream ) != 0 ) {
+        info = MAGMA_ERR_HOST_ALLOC;
+        goto cleanup;
+    }
+
+    // first pass: count the entries of the rows in the slice
+    tstart = magma_wtime();
+    read = 0;
+    while ( read < num_nonzeros ) {
+        if ( mm_stream_next( &stream, &data, &data_size ) != 0 ) {
+            printf("\n%% Line too long.\n");
+            info = MAGMA_ERR_UNKNOWN;
+            goto cleanup;
+        }
+        if ( data_size == 0 ) {
+            break;
+        }
+        magma_zmtx_parse_block( data, data_size, matcode, num_rows, num_cols,
+                                num_nonzeros - read, coo_row, coo_col, coo_val,
+                                &count, &parse_error );
+        read += count;
+        #pragma omp parallel for
+        for( int64_t k=0; k < count; k++ ) {
+            magma_index_t r = coo_row[k], c = coo_col[k];
+            if ( drop_zeros && MAGMA_Z_EQUAL( coo_val[k], zero ) ) {
+                continue;
+            }
+            if ( r >= lstart && r < lend ) {
+                #pragma omp atomic
+                A->row[ r-lstart+1 ]++;
+            }
+            if ( symmetric && r != c && c >= lstart && c < lend ) {
+                #pragma omp atomic
+                A->row[ c-lstart+1 ]++;
+            }
+        }
+    }
+    if ( read < num_nonzeros ) {
+        printf("\n%% Premature end of file: %lld of %lld entries.\n",
+               (long long) read, (long long) num_nonzeros );
+        info = MAGMA_ERR_UNKNOWN;
+        goto cleanup;
+    }
+    if ( parse_error > 0 ) {
+        printf("\n%% Could not parse %lld entries.\n", (long long) parse_error );
+        info = MAGMA_ERR_UNKNOWN;
+        goto cleanup;
+    }
+    CHECK( magma_zmatrix_createrowptr( size, A->row, queue ));
+    A->nnz = A->row[size];
+
+    CHECK( magma_index_malloc_cpu( &A->col, A->nnz ));
+    CHECK( magma_zmalloc_cpu( &A->val, A->nnz ));
+    CHECK( magma_index_malloc_cpu( &fill, size+1 ));
+    for( magma_int_t i=0; i < size; i++ ) {
+        fill[i] = A->row[i];
+    }
+
+    // second pass: scatter the entries in file order, so entries with the
+    // same column keep their order in the stable sort below
+    if ( mm_stream_rewind( &stream ) != 0 ) {
+        info = MAGMA_ERR_UNKNOWN;
+        goto cleanup;
+    }
+    read = 0;
+    while ( read < num_nonzeros ) {
+        if ( mm_stream_next( &stream, &data, &data_size ) != 0 ) {
+            info = MAGMA_ERR_UNKNOWN;
+            goto cleanup;
+        }
+        if ( data_size == 0 ) {
+            break;
+        }
+        magma_zmtx_parse_block( data, data_size, matcode, num_rows, num_cols,
+                                num_nonzeros - read, coo_row, coo_col, coo_val,
+                                &count, &parse_error );
+        read += count;
+        for( int64_t k=0; k < count; k++ ) {
+            magma_index_t r = coo_row[k], c = coo_col[k];
+            if ( drop_zeros && MAGMA_Z_EQUAL( coo_val[k], zero ) ) {
+                continue;
+            }
+            if ( r >= lstart && r < lend ) {
+                magma_index_t dest = fill[ r-lstart ]++;
+                A->col[dest] = c;
+                A->val[dest] = coo_val[k];
+            }
+            if ( symmetric && r != c && c >= lstart && c < lend ) {
+                magma_index_t dest = fill[ c-lstart ]++;
+                A->col[dest] = r;
+                A->val[dest] = (hermitian == 0) ? coo_val[k] : conj(coo_val[k]);
+            }
+        }
+    }
+    tend = magma_wtime();
+    mm_stream_close( &stream );
+    fclose(fid);
+    fid = NULL;
+
+    // sort the column indices within each row
+    #pragma omp parallel
+    {
+        std::vector< std::pair< magma_index_t, magmaDoubleComplex > > rowval;
+        #pragma omp for schedule(dynamic, 1024)
+        for( magma_int_t i=0; i < size; i++ ) {
+            rowval.clear();
+            for( magma_index_t k=A->row[i]; k < A->row[i+1]; k++ ) {
+                rowval.push_back( std::make_pair( A->col[k], A->val[k] ));
+            }
+            std::stable_sort( rowval.begin(), rowval.end(), compare_first );
+            for( magma_index_t k=A->row[i]; k < A->row[i+1]; k++ ) {
+                A->col[k] = rowval[ k-A->row[i] ].first;
+                A->val[k] = rowval[ k-A->row[i] ].second;
+            }
+        }
+    }
+
+    A->num_rows = size;
+    A->num_cols = num_cols;
+    A->true_nnz = A->nnz;
+    A->sym = symmetric ? Magma_SYMMETRIC : Magma_GENERAL;
+    *start = lstart;
+    *end = lend;
+    printf(" done (%.2f seconds).\n", tend - tstart );
+
+cleanup:
+    mm_stream_close( &stream );
+    if ( fid != NULL ) {
+        fclose( fid );
+        fid = NULL;
+    }
+    magma_free_cpu( fill );
+    if ( info != 0 ) {
+        magma_zmfree( A, queue );
+    }
+    return info;
+}
+
+
+// reads into CSR, or into CSRSYM if lower != 0 and the file is symmetric or
+// Hermitian; see magma_z_csr_mtxsymm and magma_z_csrsym_mtx
+static magma_int_t
+magma_z_mtxsymm_read(
+    magma_z_matrix *A,
+    const char *filename,
+    magma_int_t lower,
     magma_queue_t queue )
 {
     char buffer[ 1024 ];
@@ -1361,6 +1597,21 @@ magma_z_csr_mtxsymm(
     if ( mm_is_symmetric(matcode) || mm_is_hermitian(matcode) ) { 
             // do not duplicate off diagonal entries!
         A->sym = Magma_SYMMETRIC;
+        if ( lower ) {
+            A->sym = mm_is_hermitian(matcode) ? Magma_HERMITIAN : Magma_SYMMETRIC;
+            A->storage_type = Magma_CSRSYM;
+            A->fill_mode = MagmaLower;
+            // the file holds the lower triangle, entries given in the upper
+            // triangle are moved there
+            for( magma_int_t i=0; i < A->nnz; i++ ) {
+                if ( coo_row[i] < coo_col[i] ) {
+                    std::swap( coo_row[i], coo_col[i] );
+                    if ( A->sym == Magma_HERMITIAN ) {
+                        coo_val[i] = MAGMA_Z_CONJ( coo_val[i] );
+                    }
+                }
+            }
+        }
     } // end symmetric case
     
     CHECK( magma_index_malloc_cpu( &A->col, A->nnz ) );
@@ -1455,3 +1706,79 @@ cleanup:
     magma_free_cpu(coo_val);
     return info;
 }
+
+
+/**
+    Purpose
+    -------
+
+    Reads in a SYMMETRIC matrix stored in coo format from a Matrix Market (.mtx)
+    file and converts it into CSR format. It does not duplicate the off-diagonal
+    entries!
+
+    Arguments
+    ---------
+
+    @param[out]
+    A           magma_z_matrix*
+                matrix in magma sparse matrix format
+
+    @param[in]
+    filename    const char*
+                filname of the mtx matrix
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C"
+magma_int_t
+magma_z_csr_mtxsymm(
+    magma_z_matrix *A,
+    const char *filename,
+    magma_queue_t queue )
+{
+    return magma_z_mtxsymm_read( A, filename, 0, queue );
+}
+
+
+/**
+    Purpose
+    -------
+
+    Reads in a symmetric or Hermitian matrix stored in coo format from a
+    Matrix Market (.mtx) file into Magma_CSRSYM: the lower triangle and the
+    diagonal in CSR with sorted columns, which magma_zspmv_cpu multiplies
+    without expanding it. Entries given in the upper triangle are moved to
+    the lower one, conjugated for a Hermitian file. A->sym is set to
+    Magma_SYMMETRIC or Magma_HERMITIAN. Other files are read into CSR as by
+    magma_z_csr_mtxsymm.
+
+    Arguments
+    ---------
+
+    @param[out]
+    A           magma_z_matrix*
+                matrix in magma sparse matrix format
+
+    @param[in]
+    filename    const char*
+                filname of the mtx matrix
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C"
+magma_int_t
+magma_z_csrsym_mtx(
+    magma_z_matrix *A,
+    const char *filename,
+    magma_queue_t queue )
+{
+    return magma_z_mtxsymm_read( A, filename, 1, queue );
+}
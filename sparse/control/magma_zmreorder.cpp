@@ -0,0 +1,891 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include <algorithm>
+#include <utility>  // pair
+#include <vector>
+
+#include "magmasparse_internal.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// nested dissection stops splitting parts of at most this many vertices
+#define ND_LEAF_SIZE 64
+
+
+/***************************************************************************//**
+    Reordering.
+
+    All orderings work on the adjacency graph of A + A^T without the
+    diagonal, and return perm with perm[new] = old, i.e. row perm[i] of A
+    becomes row i of P A P^T.
+    - RCM: reverse Cuthill-McKee from a pseudo-peripheral vertex of every
+      connected component; reduces the bandwidth.
+    - AMD: minimum degree on the quotient graph with approximate external
+      degrees and element absorption; reduces the fill of the factors.
+    - ND:  nested dissection with level-structure vertex separators; parts
+      are numbered before their separator.
+*******************************************************************************/
+
+
+/*
+    Builds the symmetric adjacency graph of A (CSR, square) without the
+    diagonal, with sorted and unique neighbor lists.
+*/
+static magma_int_t
+magma_zmreorder_graph(
+    magma_z_matrix A,
+    magma_index_t **xadj,
+    magma_index_t **adj,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_int_t n = A.num_rows;
+    magma_index_t *cnt = NULL, *fill = NULL, *tmp = NULL;
+
+    CHECK( magma_index_malloc_cpu( &cnt, n+1 ));
+    CHECK( magma_index_malloc_cpu( &fill, n ));
+    CHECK( magma_index_malloc_cpu( &tmp, 2*A.nnz ));
+
+    // every off-diagonal entry (i,j) adds j to i and i to j
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n+1; i++ ) {
+        cnt[i] = 0;
+    }
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ) {
+        for( magma_int_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+            magma_index_t j = A.col[k];
+            if ( j != i ) {
+                #pragma omp atomic
+                cnt[i+1]++;
+                #pragma omp atomic
+                cnt[j+1]++;
+            }
+        }
+    }
+    CHECK( magma_zmatrix_createrowptr( n, cnt, queue ));
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n; i++ ) {
+        fill[i] = cnt[i];
+    }
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ) {
+        for( magma_int_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+            magma_index_t j = A.col[k];
+            magma_index_t dest;
+            if ( j != i ) {
+                #pragma omp atomic capture
+                dest = fill[i]++;
+                tmp[dest] = j;
+                #pragma omp atomic capture
+                dest = fill[j]++;
+                tmp[dest] = i;
+            }
+        }
+    }
+
+    // sort, drop duplicates, and compact
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ) {
+        magma_index_t *begin = tmp + cnt[i];
+        magma_index_t *end   = tmp + cnt[i+1];
+        std::sort( begin, end );
+        fill[i] = std::unique( begin, end ) - begin;
+    }
+    CHECK( magma_index_malloc_cpu( xadj, n+1 ));
+    (*xadj)[0] = 0;
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n; i++ ) {
+        (*xadj)[i+1] = fill[i];
+    }
+    CHECK( magma_zmatrix_createrowptr( n, *xadj, queue ));
+    CHECK( magma_index_malloc_cpu( adj, (*xadj)[n] ));
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ) {
+        for( magma_int_t k=0; k < fill[i]; k++ ) {
+            (*adj)[ (*xadj)[i] + k ] = tmp[ cnt[i] + k ];
+        }
+    }
+
+cleanup:
+    magma_free_cpu( cnt );
+    magma_free_cpu( fill );
+    magma_free_cpu( tmp );
+    return info;
+}
+
+
+/*
+    Breadth-first search from root over the vertices v with part[v] == id.
+    Returns the vertices in BFS order in order[0..count-1], their levels in
+    level[], and the number of levels.
+*/
+static magma_int_t
+magma_zmreorder_bfs(
+    magma_index_t root,
+    const magma_index_t *xadj,
+    const magma_index_t *adj,
+    const magma_index_t *part,
+    magma_index_t id,
+    magma_index_t *level,
+    magma_index_t *mark,
+    magma_index_t stamp,
+    magma_index_t *order,
+    magma_int_t *count )
+{
+    magma_int_t head = 0, tail = 0;
+
+    order[tail++] = root;
+    mark[root] = stamp;
+    level[root] = 0;
+    while( head < tail ) {
+        magma_index_t v = order[head++];
+        for( magma_int_t k=xadj[v]; k < xadj[v+1]; k++ ) {
+            magma_index_t u = adj[k];
+            if ( mark[u] != stamp && ( part == NULL || part[u] == id )) {
+                mark[u] = stamp;
+                level[u] = level[v] + 1;
+                order[tail++] = u;
+            }
+        }
+    }
+    *count = tail;
+    return level[ order[tail-1] ] + 1;
+}
+
+
+/*
+    Finds a pseudo-peripheral vertex of the component of root (George and
+    Liu): repeatedly restart the search from a vertex of minimum degree in
+    the last level until the number of levels stops growing.
+    On return, order[0..count-1] holds the component in BFS order from the
+    returned vertex.
+*/
+static magma_index_t
+magma_zmreorder_peripheral(
+    magma_index_t root,
+    const magma_index_t *xadj,
+    const magma_index_t *adj,
+    const magma_index_t *part,
+    magma_index_t id,
+    magma_index_t *level,
+    magma_index_t *mark,
+    magma_index_t *stamp,
+    magma_index_t *order,
+    magma_int_t *count )
+{
+    magma_int_t depth = magma_zmreorder_bfs( root, xadj, adj, part, id, level,
+                                             mark, ++(*stamp), order, count );
+    while( true ) {
+        // vertex of minimum degree in the last level
+        magma_index_t cand = order[ *count-1 ];
+        for( magma_int_t k = *count-1; k >= 0 && level[ order[k] ] == depth-1; k-- ) {
+            magma_index_t v = order[k];
+            if ( xadj[v+1] - xadj[v] < xadj[cand+1] - xadj[cand] ) {
+                cand = v;
+            }
+        }
+        magma_int_t cnt;
+        magma_int_t d = magma_zmreorder_bfs( cand, xadj, adj, part, id, level,
+                                             mark, ++(*stamp), order, &cnt );
+        if ( d <= depth ) {
+            // keep the search from cand; it is at least as deep
+            *count = cnt;
+            return cand;
+        }
+        depth = d;
+    }
+}
+
+
+/*
+    Reverse Cuthill-McKee.
+*/
+static magma_int_t
+magma_zmreorder_rcm(
+    magma_int_t n,
+    const magma_index_t *xadj,
+    const magma_index_t *adj,
+    magma_index_t *perm )
+{
+    magma_int_t info = 0;
+    magma_index_t *level = NULL, *mark = NULL, *order = NULL, *done = NULL;
+    magma_index_t stamp = 0;
+    magma_int_t k = 0;
+    std::vector< std::pair< magma_index_t, magma_index_t > > nbr;
+
+    CHECK( magma_index_malloc_cpu( &level, n ));
+    CHECK( magma_index_malloc_cpu( &mark, n ));
+    CHECK( magma_index_malloc_cpu( &order, n ));
+    CHECK( magma_index_malloc_cpu( &done, n ));
+    for( magma_int_t i=0; i < n; i++ ) {
+        mark[i] = 0;
+        done[i] = 0;
+    }
+
+    for( magma_int_t s=0; s < n; s++ ) {
+        if ( done[s] ) {
+            continue;
+        }
+        magma_int_t count;
+        magma_index_t root = magma_zmreorder_peripheral( s, xadj, adj, NULL, 0,
+                                level, mark, &stamp, order, &count );
+        // Cuthill-McKee: visit the neighbors in order of increasing degree
+        magma_int_t head = k;
+        perm[k++] = root;
+        done[root] = 1;
+        while( head < k ) {
+            magma_index_t v = perm[head++];
+            nbr.clear();
+            for( magma_int_t j=xadj[v]; j < xadj[v+1]; j++ ) {
+                magma_index_t u = adj[j];
+                if ( ! done[u] ) {
+                    done[u] = 1;
+                    nbr.push_back( std::make_pair( xadj[u+1] - xadj[u], u ));
+                }
+            }
+            std::sort( nbr.begin(), nbr.end() );
+            for( size_t j=0; j < nbr.size(); j++ ) {
+                perm[k++] = nbr[j].second;
+            }
+        }
+    }
+    std::reverse( perm, perm + n );
+
+cleanup:
+    magma_free_cpu( level );
+    magma_free_cpu( mark );
+    magma_free_cpu( order );
+    magma_free_cpu( done );
+    return info;
+}
+
+
+/*
+    Approximate minimum degree on the quotient graph.
+
+    Eliminated vertices become elements; the variables adjacent to element
+    p are Lp. Eliminating p absorbs all elements adjacent to p. The degree
+    of a variable i in Lp is bounded by
+        |A_i| + |Lp \ i| + sum over other elements e of i of |Le \ Lp|,
+    where A_i are the variable neighbors of i that are not in Lp.
+    No supervariables are detected.
+*/
+static magma_int_t
+magma_zmreorder_amd(
+    magma_int_t n,
+    const magma_index_t *xadj,
+    const magma_index_t *adj,
+    magma_index_t *perm )
+{
+    magma_int_t info = 0;
+    // status: 0 variable, 1 element, 2 absorbed element
+    std::vector< char > status( n, 0 );
+    std::vector< std::vector< magma_index_t > > avar( n ), elem( n ), evar( n );
+    std::vector< magma_index_t > deg( n ), head( n+1, -1 ), next( n ), prev( n );
+    std::vector< magma_index_t > mark( n, -1 ), w( n, 0 ), wmark( n, -1 );
+    std::vector< magma_index_t > Lp;
+    magma_index_t mindeg = 0;
+
+    for( magma_int_t i=0; i < n; i++ ) {
+        avar[i].assign( adj + xadj[i], adj + xadj[i+1] );
+        deg[i] = xadj[i+1] - xadj[i];
+    }
+    // degree lists
+    auto dl_insert = [&]( magma_index_t i ) {
+        magma_index_t d = deg[i];
+        next[i] = head[d];
+        prev[i] = -1;
+        if ( head[d] != -1 ) {
+            prev[ head[d] ] = i;
+        }
+        head[d] = i;
+        mindeg = min( mindeg, d );
+    };
+    auto dl_remove = [&]( magma_index_t i ) {
+        if ( prev[i] != -1 ) {
+            next[ prev[i] ] = next[i];
+        } else {
+            head[ deg[i] ] = next[i];
+        }
+        if ( next[i] != -1 ) {
+            prev[ next[i] ] = prev[i];
+        }
+    };
+    for( magma_int_t i=0; i < n; i++ ) {
+        dl_insert( i );
+    }
+
+    for( magma_int_t k=0; k < n; k++ ) {
+        while( head[mindeg] == -1 ) {
+            mindeg++;
+        }
+        magma_index_t p = head[mindeg];
+        dl_remove( p );
+        perm[k] = p;
+        status[p] = 1;
+
+        // Lp: variable neighbors of p and variables of its elements
+        Lp.clear();
+        mark[p] = p;
+        for( size_t j=0; j < avar[p].size(); j++ ) {
+            magma_index_t v = avar[p][j];
+            if ( status[v] == 0 && mark[v] != p ) {
+                mark[v] = p;
+                Lp.push_back( v );
+            }
+        }
+        for( size_t j=0; j < elem[p].size(); j++ ) {
+            magma_index_t e = elem[p][j];
+            if ( status[e] != 1 ) {
+                continue;
+            }
+            for( size_t l=0; l < evar[e].size(); l++ ) {
+                magma_index_t v = evar[e][l];
+                if ( status[v] == 0 && mark[v] != p ) {
+                    mark[v] = p;
+                    Lp.push_back( v );
+                }
+            }
+            // e is contained in p
+            status[e] = 2;
+            std::vector< magma_index_t >().swap( evar[e] );
+        }
+        evar[p] = Lp;
+        std::vector< magma_index_t >().swap( avar[p] );
+        std::vector< magma_index_t >().swap( elem[p] );
+
+        // w[e] = |Le \ Lp| for the other elements next to Lp
+        for( size_t j=0; j < Lp.size(); j++ ) {
+            std::vector< magma_index_t > &el = elem[ Lp[j] ];
+            for( size_t l=0; l < el.size(); l++ ) {
+                magma_index_t e = el[l];
+                if ( status[e] != 1 ) {
+                    continue;
+                }
+                if ( wmark[e] != p ) {
+                    // drop eliminated variables from Le on first touch
+                    std::vector< magma_index_t > &ev = evar[e];
+                    size_t live = 0;
+                    for( size_t m=0; m < ev.size(); m++ ) {
+                        if ( status[ ev[m] ] == 0 ) {
+                            ev[live++] = ev[m];
+                        }
+                    }
+                    ev.resize( live );
+                    wmark[e] = p;
+                    w[e] = live;
+                }
+                w[e]--;
+            }
+        }
+
+        // update the variables of Lp
+        magma_index_t lsize = Lp.size();
+        for( size_t j=0; j < Lp.size(); j++ ) {
+            magma_index_t i = Lp[j];
+            dl_remove( i );
+
+            // elements: drop absorbed ones and those inside Lp, add p
+            magma_int_t d = lsize - 1;
+            std::vector< magma_index_t > &el = elem[i];
+            size_t live = 0;
+            for( size_t l=0; l < el.size(); l++ ) {
+                magma_index_t e = el[l];
+                if ( status[e] == 1 && w[e] > 0 ) {
+                    el[live++] = e;
+                    d += w[e];
+                } else if ( status[e] == 1 ) {
+                    // aggressive absorption: Le is a subset of Lp
+                    status[e] = 2;
+                    std::vector< magma_index_t >().swap( evar[e] );
+                }
+            }
+            el.resize( live );
+            el.push_back( p );
+
+            // variables: drop eliminated ones and those covered by Lp
+            std::vector< magma_index_t > &av = avar[i];
+            live = 0;
+            for( size_t l=0; l < av.size(); l++ ) {
+                magma_index_t v = av[l];
+                if ( status[v] == 0 && mark[v] != p ) {
+                    av[live++] = v;
+                }
+            }
+            av.resize( live );
+            d += live;
+
+            deg[i] = min( d, (magma_int_t) (n - k - 2) );
+            deg[i] = max( deg[i], 0 );
+            dl_insert( i );
+        }
+    }
+
+    return info;
+}
+
+
+/*
+    Nested dissection. Every part is split at the middle level of a level
+    structure rooted at a pseudo-peripheral vertex; the two halves are
+    numbered first and the separator last. Disconnected parts are split
+    into their components without a separator.
+*/
+static magma_int_t
+magma_zmreorder_nd(
+    magma_int_t n,
+    const magma_index_t *xadj,
+    const magma_index_t *adj,
+    magma_index_t *perm )
+{
+    magma_int_t info = 0;
+    magma_index_t *part = NULL, *level = NULL, *mark = NULL, *order = NULL;
+    magma_index_t stamp = 0, nparts = 1;
+    // pending parts: first position in perm, vertices in perm[start..end-1]
+    std::vector< std::pair< magma_int_t, magma_int_t > > stack;
+    std::vector< magma_index_t > buf;
+
+    CHECK( magma_index_malloc_cpu( &part, n ));
+    CHECK( magma_index_malloc_cpu( &level, n ));
+    CHECK( magma_index_malloc_cpu( &mark, n ));
+    CHECK( magma_index_malloc_cpu( &order, n ));
+    for( magma_int_t i=0; i < n; i++ ) {
+        part[i] = 0;
+        mark[i] = 0;
+        perm[i] = i;
+    }
+    if ( n > 0 ) {
+        stack.push_back( std::make_pair( 0, n ));
+    }
+
+    while( ! stack.empty() ) {
+        magma_int_t start = stack.back().first;
+        magma_int_t end   = stack.back().second;
+        magma_int_t size  = end - start;
+        magma_index_t id  = part[ perm[start] ];
+        stack.pop_back();
+        if ( size <= ND_LEAF_SIZE ) {
+            continue;
+        }
+
+        magma_int_t count;
+        magma_zmreorder_peripheral( perm[start], xadj, adj, part, id,
+                                    level, mark, &stamp, order, &count );
+        if ( count < size ) {
+            // split off the component of perm[start]
+            magma_index_t cid = nparts++;
+            for( magma_int_t k=0; k < count; k++ ) {
+                part[ order[k] ] = cid;
+            }
+            buf.assign( perm + start, perm + end );
+            magma_int_t a = start, b = start + count;
+            for( size_t k=0; k < buf.size(); k++ ) {
+                if ( part[ buf[k] ] == cid ) {
+                    perm[a++] = buf[k];
+                } else {
+                    perm[b++] = buf[k];
+                }
+            }
+            stack.push_back( std::make_pair( start, start + count ));
+            stack.push_back( std::make_pair( start + count, end ));
+            continue;
+        }
+
+        // separator: first level that reaches half of the vertices
+        magma_index_t depth = level[ order[count-1] ] + 1;
+        if ( depth < 3 ) {
+            continue;
+        }
+        magma_index_t sep = level[ order[count/2] ];
+        sep = max( sep, 1 );
+        sep = min( sep, depth-2 );
+        magma_index_t lo = nparts++, hi = nparts++, sid = nparts++;
+        magma_int_t nlo = 0, nsep = 0;
+        for( magma_int_t k=0; k < count; k++ ) {
+            magma_index_t v = order[k];
+            if ( level[v] < sep ) {
+                part[v] = lo;
+                nlo++;
+            } else if ( level[v] == sep ) {
+                part[v] = sid;
+                nsep++;
+            } else {
+                part[v] = hi;
+            }
+        }
+        // low half, high half, separator; order[] is grouped by level
+        magma_int_t a = start, b = start + nlo, c = end - nsep;
+        for( magma_int_t k=0; k < count; k++ ) {
+            magma_index_t v = order[k];
+            if ( part[v] == lo ) {
+                perm[a++] = v;
+            } else if ( part[v] == hi ) {
+                perm[b++] = v;
+            } else {
+                perm[c++] = v;
+            }
+        }
+        stack.push_back( std::make_pair( start, start + nlo ));
+        stack.push_back( std::make_pair( start + nlo, end - nsep ));
+    }
+
+cleanup:
+    magma_free_cpu( part );
+    magma_free_cpu( level );
+    magma_free_cpu( mark );
+    magma_free_cpu( order );
+    return info;
+}
+
+
+/**
+    Purpose
+    -------
+
+    Computes a symmetric reordering of a square matrix: reverse
+    Cuthill-McKee (bandwidth), approximate minimum degree (fill), or nested
+    dissection (graph partitioning). Only the nonzero pattern of A + A^T is
+    used. Row perm[i] of A becomes row i of the reordered matrix.
+    Magma_NOREORDER returns the identity for any A.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                input matrix (CSR on the CPU)
+
+    @param[in]
+    ordering    magma_reorder_t
+                Magma_RCM, Magma_AMD, Magma_ND or Magma_NOREORDER
+
+    @param[out]
+    perm        magma_index_t*
+                permutation, length A.num_rows, allocated by the caller
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zmorder(
+    magma_z_matrix A,
+    magma_reorder_t ordering,
+    magma_index_t *perm,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_index_t *xadj = NULL, *adj = NULL;
+
+    // the identity needs only the number of rows, also for non-square A
+    if ( ordering == Magma_NOREORDER ) {
+        #pragma omp parallel for
+        for( magma_int_t i=0; i < A.num_rows; i++ ) {
+            perm[i] = i;
+        }
+        goto cleanup;
+    }
+    if ( A.memory_location != Magma_CPU || A.storage_type != Magma_CSR ||
+         A.num_rows != A.num_cols ) {
+        printf( "%%error: reordering needs a square CSR matrix on the CPU.\n" );
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    CHECK( magma_zmreorder_graph( A, &xadj, &adj, queue ));
+    switch( ordering ) {
+        case Magma_RCM:
+            CHECK( magma_zmreorder_rcm( A.num_rows, xadj, adj, perm ));
+            break;
+        case Magma_AMD:
+            CHECK( magma_zmreorder_amd( A.num_rows, xadj, adj, perm ));
+            break;
+        case Magma_ND:
+            CHECK( magma_zmreorder_nd( A.num_rows, xadj, adj, perm ));
+            break;
+        default:
+            printf( "%%error: ordering not supported.\n" );
+            info = MAGMA_ERR_NOT_SUPPORTED;
+    }
+
+cleanup:
+    magma_free_cpu( xadj );
+    magma_free_cpu( adj );
+    return info;
+}
+
+
+/**
+    Purpose
+    -------
+
+    Applies a symmetric permutation: B = P A P^T, i.e.
+    B(i,j) = A(perm[i], perm[j]). The rows of B are sorted.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                input matrix (CSR on the CPU)
+
+    @param[in]
+    perm        magma_index_t*
+                permutation, perm[new] = old
+
+    @param[out]
+    B           magma_z_matrix*
+                permuted matrix (CSR on the CPU)
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zmpermute(
+    magma_z_matrix A,
+    magma_index_t *perm,
+    magma_z_matrix *B,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_index_t *invp = NULL;
+    magma_int_t n = A.num_rows;
+
+    if ( A.memory_location != Magma_CPU || A.storage_type != Magma_CSR ||
+         A.num_rows != A.num_cols ) {
+        printf( "%%error: permutation needs a square CSR matrix on the CPU.\n" );
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    magma_zmfree( B, queue );
+    B->ownership = MagmaTrue;
+    B->storage_type = Magma_CSR;
+    B->memory_location = Magma_CPU;
+    B->num_rows = n;
+    B->num_cols = n;
+    B->nnz = A.nnz;
+    B->true_nnz = A.nnz;
+    CHECK( magma_index_malloc_cpu( &invp, n ));
+    CHECK( magma_index_malloc_cpu( &B->row, n+1 ));
+    CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
+    CHECK( magma_zmalloc_cpu( &B->val, A.nnz ));
+
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n; i++ ) {
+        invp[ perm[i] ] = i;
+        B->row[i+1] = A.row[ perm[i]+1 ] - A.row[ perm[i] ];
+    }
+    B->row[0] = 0;
+    CHECK( magma_zmatrix_createrowptr( n, B->row, queue ));
+
+    #pragma omp parallel
+    {
+        std::vector< std::pair< magma_index_t, magmaDoubleComplex > > rowval;
+        #pragma omp for schedule(dynamic, 1024)
+        for( magma_int_t i=0; i < n; i++ ) {
+            magma_index_t old = perm[i];
+            rowval.clear();
+            for( magma_int_t k=A.row[old]; k < A.row[old+1]; k++ ) {
+                rowval.push_back( std::make_pair( invp[ A.col[k] ], A.val[k] ));
+            }
+            std::sort( rowval.begin(), rowval.end(),
+                []( const std::pair< magma_index_t, magmaDoubleComplex > &a,
+                    const std::pair< magma_index_t, magmaDoubleComplex > &b )
+                { return a.first < b.first; } );
+            for( size_t k=0; k < rowval.size(); k++ ) {
+                B->col[ B->row[i] + k ] = rowval[k].first;
+                B->val[ B->row[i] + k ] = rowval[k].second;
+            }
+        }
+    }
+
+cleanup:
+    if ( info != 0 ) {
+        magma_zmfree( B, queue );
+    }
+    magma_free_cpu( invp );
+    return info;
+}
+
+
+/**
+    Purpose
+    -------
+
+    Permutes the rows of a dense vector or block of vectors on the CPU:
+    y = P x (y[i] = x[perm[i]]) for MagmaNoTrans, or y = P^T x
+    (y[perm[i]] = x[i]) for MagmaTrans. Use MagmaNoTrans for the right-hand
+    side of P A P^T and MagmaTrans to map its solution back.
+
+    Arguments
+    ---------
+
+    @param[in]
+    x           magma_z_matrix
+                input vector (DENSE on the CPU)
+
+    @param[in]
+    perm        magma_index_t*
+                permutation, perm[new] = old
+
+    @param[in]
+    trans       magma_trans_t
+                MagmaNoTrans or MagmaTrans
+
+    @param[out]
+    y           magma_z_matrix*
+                permuted vector
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zvpermute(
+    magma_z_matrix x,
+    magma_index_t *perm,
+    magma_trans_t trans,
+    magma_z_matrix *y,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_int_t rs, cs;  // row and column stride
+
+    if ( x.memory_location != Magma_CPU || x.storage_type != Magma_DENSE ) {
+        printf( "%%error: permutation needs a dense vector on the CPU.\n" );
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    CHECK( magma_zmtransfer( x, y, Magma_CPU, Magma_CPU, queue ));
+    if ( x.major == MagmaRowMajor ) {
+        rs = x.num_cols;
+        cs = 1;
+    } else {
+        rs = 1;
+        cs = x.num_rows;
+    }
+
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < x.num_rows; i++ ) {
+        for( magma_int_t j=0; j < x.num_cols; j++ ) {
+            if ( trans == MagmaNoTrans ) {
+                y->val[ i*rs + j*cs ] = x.val[ perm[i]*rs + j*cs ];
+            } else {
+                y->val[ perm[i]*rs + j*cs ] = x.val[ i*rs + j*cs ];
+            }
+        }
+    }
+
+cleanup:
+    return info;
+}
+
+
+/**
+    Purpose
+    -------
+
+    Reorders a square matrix in place: A is replaced by P A P^T for the
+    given ordering. Works for any format and location; the matrix is
+    reordered in CSR on the CPU and converted back. If perm is not NULL,
+    the permutation is returned in *perm (allocated, to be freed with
+    magma_free_cpu) so right-hand sides and solutions can be mapped with
+    magma_zvpermute.
+
+    Arguments
+    ---------
+
+    @param[in,out]
+    A           magma_z_matrix*
+                matrix to reorder
+
+    @param[in]
+    ordering    magma_reorder_t
+                Magma_RCM, Magma_AMD, Magma_ND or Magma_NOREORDER
+
+    @param[out]
+    perm        magma_index_t**
+                permutation, perm[new] = old, or NULL
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zmreorder(
+    magma_z_matrix *A,
+    magma_reorder_t ordering,
+    magma_index_t **perm,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_index_t *p = NULL;
+    magma_z_matrix hA={Magma_CSR}, CSRA={Magma_CSR}, PA={Magma_CSR};
+    magma_storage_t A_storage = A->storage_type;
+    magma_location_t A_location = A->memory_location;
+
+    if ( ordering == Magma_NOREORDER && perm == NULL ) {
+        goto cleanup;
+    }
+    if ( A->num_rows != A->num_cols ) {
+        printf( "%% warning: non-square matrix.\n" );
+        printf( "%% Fallback: no reordering.\n" );
+        ordering = Magma_NOREORDER;
+    }
+
+    CHECK( magma_index_malloc_cpu( &p, A->num_rows ));
+    if ( A_location == Magma_CPU && A_storage == Magma_CSR ) {
+        CHECK( magma_zmorder( *A, ordering, p, queue ));
+        if ( ordering != Magma_NOREORDER ) {
+            CHECK( magma_zmpermute( *A, p, &PA, queue ));
+            CHECK( magma_zmatrix_swap( &PA, A, queue ));
+        }
+    }
+    else {
+        CHECK( magma_zmtransfer( *A, &hA, A_location, Magma_CPU, queue ));
+        CHECK( magma_zmconvert( hA, &CSRA, hA.storage_type, Magma_CSR, queue ));
+        CHECK( magma_zmorder( CSRA, ordering, p, queue ));
+        if ( ordering != Magma_NOREORDER ) {
+            CHECK( magma_zmpermute( CSRA, p, &PA, queue ));
+            magma_zmfree( &hA, queue );
+            magma_zmfree( A, queue );
+            CHECK( magma_zmconvert( PA, &hA, Magma_CSR, A_storage, queue ));
+            CHECK( magma_zmtransfer( hA, A, Magma_CPU, A_location, queue ));
+        }
+    }
+
+    if ( perm != NULL ) {
+        *perm = p;
+        p = NULL;
+    }
+
+cleanup:
+    magma_free_cpu( p );
+    magma_zmfree( &hA, queue );
+    magma_zmfree( &CSRA, queue );
+    magma_zmfree( &PA, queue );
+    return info;
+}
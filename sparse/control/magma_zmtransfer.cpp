@@ -9,6 +9,7 @@
        @author Hartwig Anzt
 */
 #include "magmasparse_internal.h"
+#include "magmasparse_lowprec.h"
 
 
 /**
@@ -375,7 +376,8 @@ magma_zmtransfer(
              A.storage_type == Magma_CUCSR ||
              A.storage_type == Magma_CSRD  ||
              A.storage_type == Magma_CSRL  ||
-             A.storage_type == Magma_CSRU )
+             A.storage_type == Magma_CSRU  ||
+             A.storage_type == Magma_CSRSYM )
         {
             // fill in information for B
             B->storage_type = A.storage_type;
@@ -597,6 +599,73 @@ magma_zmtransfer(
                 B->row[i] = A.row[i];
             }
         }
+        //SELL-C-sigma-type (host only)
+        else if (  A.storage_type == Magma_SELLCS ) {
+            // fill in information for B
+            B->storage_type = A.storage_type;
+            B->memory_location = Magma_CPU;
+            B->sym = A.sym;
+            B->diagorder_type = A.diagorder_type;
+            B->fill_mode = A.fill_mode;
+            B->num_rows = A.num_rows;
+            B->num_cols = A.num_cols;
+            B->nnz = A.nnz; B->true_nnz = A.true_nnz;
+            B->max_nnz_row = A.max_nnz_row;
+            B->diameter = A.diameter;
+            B->blocksize = A.blocksize;
+            B->alignment = A.alignment;
+            B->numblocks = A.numblocks;
+            // memory allocation
+            CHECK( magma_zmalloc_cpu( &B->val, A.nnz ));
+            CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
+            CHECK( magma_index_malloc_cpu( &B->row, A.numblocks + 1 ));
+            CHECK( magma_index_malloc_cpu( &B->rowidx, A.num_rows ));
+            // data transfer
+            #pragma omp parallel for
+            for( magma_int_t i=0; i<A.nnz; i++ ) {
+                B->val[i] = A.val[i];
+                B->col[i] = A.col[i];
+            }
+            #pragma omp parallel for
+            for( magma_int_t i=0; i<A.numblocks+1; i++ ) {
+                B->row[i] = A.row[i];
+            }
+            #pragma omp parallel for
+            for( magma_int_t i=0; i<A.num_rows; i++ ) {
+                B->rowidx[i] = A.rowidx[i];
+            }
+        }
+        //CSRMP-type (host only), values and index stream are copied bytewise
+        else if (  A.storage_type == Magma_CSRMP ) {
+            magma_int_t vbytes = A.nnz * ( sizeof(magmaDoubleComplex) / sizeof(double) )
+                                * magma_csrmp_component_size( A.val_format );
+            magma_int_t ibytes = A.rowidx[A.num_rows] * sizeof(uint16_t);
+            // fill in information for B
+            B->storage_type = A.storage_type;
+            B->memory_location = Magma_CPU;
+            B->sym = A.sym;
+            B->diagorder_type = A.diagorder_type;
+            B->fill_mode = A.fill_mode;
+            B->num_rows = A.num_rows;
+            B->num_cols = A.num_cols;
+            B->nnz = A.nnz; B->true_nnz = A.true_nnz;
+            B->max_nnz_row = A.max_nnz_row;
+            B->diameter = A.diameter;
+            B->val_format = A.val_format;
+            // memory allocation
+            CHECK( magma_malloc_cpu( (void**) &B->val, max( vbytes, 1 )));
+            CHECK( magma_malloc_cpu( (void**) &B->mpcol, max( ibytes, 1 )));
+            CHECK( magma_index_malloc_cpu( &B->row, A.num_rows + 1 ));
+            CHECK( magma_index_malloc_cpu( &B->rowidx, A.num_rows + 1 ));
+            // data transfer
+            memcpy( B->val, A.val, vbytes );
+            memcpy( B->mpcol, A.mpcol, ibytes );
+            #pragma omp parallel for
+            for( magma_int_t i=0; i<A.num_rows+1; i++ ) {
+                B->row[i] = A.row[i];
+                B->rowidx[i] = A.rowidx[i];
+            }
+        }
         //CSR5-type
         else if ( A.storage_type == Magma_CSR5 ) {
             // fill in information for B
@@ -9,119 +9,303 @@
        @author Hartwig Anzt
 
 */
+#include <algorithm>
 #include <cstdlib>
 #include "magmasparse_internal.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
+// minimum number of entries per chunk of the transpose
+#define MTRANS_MIN_CHUNK 4096
+
+
+/**
+ * The transpose is a counting sort of the entries by column.
+ * The entries of A are split into contiguous chunks, one per thread. Every
+ * chunk counts its columns in a private histogram; a prefix over the chunks
+ * gives each chunk its own slice of every row of B, so the scatter needs no
+ * atomics and writes each row of B front to back. The entries of a row of B
+ * keep their order in A, so the result does not depend on the thread count.
+ *
+ * perm[k] is the position of entry k of A in B. If the caller keeps it, the
+ * values of a matrix with the same pattern can be transposed again in one
+ * pass without counting.
+ */
+
+// Number of chunks for nnz entries and n histogram bins. Each chunk owns a
+// histogram of n bins, so bound the histograms to a few times nnz + n.
+static magma_int_t
+magma_z_mtrans_chunks(
+    magma_int_t nnz,
+    magma_int_t n )
+{
+    magma_int_t num_threads = 1;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    magma_int_t chunks = min( num_threads, nnz / MTRANS_MIN_CHUNK + 1 );
+    chunks = min( chunks, 4*(nnz + n) / (n + 1) + 1 );
+    return max( chunks, 1 );
+}
 
 
 /**
  * op(from[i], to[i]);
+ *
+ * Transposes the nnz entries (row(k), col[k], val[k]) of the m x n matrix
+ * into the CSR arrays Brow (n+1), Bcol, Bval and, if not NULL, Browidx.
+ * The row of entry k is rowidx[k] if rowidx is not NULL, otherwise it is
+ * found from the row pointer row (m+1). perm (nnz) returns the position of
+ * every entry in B.
  */
 template <typename Operator>
 inline magma_int_t
 magma_z_mtrans_template(
-    magma_z_matrix A, 
-    magma_z_matrix *B,
+    magma_int_t m,
+    magma_int_t n,
+    magma_int_t nnz,
+    const magma_index_t *row,
+    const magma_index_t *rowidx,
+    const magma_index_t *col,
+    const magmaDoubleComplex *val,
+    magma_index_t *Brow,
+    magma_index_t *Browidx,
+    magma_index_t *Bcol,
+    magmaDoubleComplex *Bval,
+    magma_index_t *perm,
     Operator op,
     magma_queue_t queue )
 {
     magma_int_t info = 0;
-    
-    magma_index_t *linked_list;
-    magma_index_t *row_ptr;
-    magma_index_t *last_rowel;
-    
-    // magma_int_t num_threads;
-    // magma_int_t el_per_block;
+    magma_index_t *count = NULL;
+
+    magma_int_t chunks = magma_z_mtrans_chunks( nnz, n );
+    magma_int_t el_per_chunk = magma_ceildiv( nnz, chunks );
+
+    CHECK( magma_index_malloc_cpu( &count, chunks*n ));
+
+    // private histogram of every chunk
+    #pragma omp parallel for schedule(static, 1)
+    for( magma_int_t c=0; c<chunks; c++ ){
+        magma_index_t *cnt = count + c*n;
+        magma_int_t end = min( (c+1)*el_per_chunk, nnz );
+        for( magma_int_t i=0; i<n; i++ ){
+            cnt[i] = 0;
+        }
+        for( magma_int_t k=c*el_per_chunk; k<end; k++ ){
+            cnt[ col[k] ]++;
+        }
+    }
+
+    // offset of every chunk within each row of B, and the row lengths
+    Brow[0] = 0;
+    #pragma omp parallel for
+    for( magma_int_t i=0; i<n; i++ ){
+        magma_index_t nnz_row = 0;
+        for( magma_int_t c=0; c<chunks; c++ ){
+            magma_index_t tmp = count[ c*n+i ];
+            count[ c*n+i ] = nnz_row;
+            nnz_row += tmp;
+        }
+        Brow[i+1] = nnz_row;
+    }
+    CHECK( magma_zmatrix_createrowptr( n, Brow, queue ));
+
+    // scatter
+    #pragma omp parallel for schedule(static, 1)
+    for( magma_int_t c=0; c<chunks; c++ ){
+        magma_index_t *cnt = count + c*n;
+        magma_int_t start = c*el_per_chunk;
+        magma_int_t end = min( (c+1)*el_per_chunk, nnz );
+        magma_index_t r = 0;
+        if( rowidx == NULL && start < end ){
+            r = std::upper_bound( row, row+m+1, (magma_index_t) start ) - row - 1;
+        }
+        for( magma_int_t k=start; k<end; k++ ){
+            if( rowidx != NULL ){
+                r = rowidx[k];
+            } else {
+                while( row[r+1] <= k ){
+                    r++;
+                }
+            }
+            magma_index_t i = col[k];
+            magma_index_t p = Brow[i] + cnt[i]++;
+            perm[k] = p;
+            Bcol[p] = r;
+            if( Browidx != NULL ){
+                Browidx[p] = i;
+            }
+            op(val[k], Bval[p]);
+        }
+    }
+
+cleanup:
+    magma_free_cpu( count );
+    return info;
+}
+
+
+/**
+ * op(from[i], to[perm[i]]);
+ */
+template <typename Operator>
+inline void
+magma_z_mtrans_values_template(
+    magma_int_t nnz,
+    const magmaDoubleComplex *val,
+    const magma_index_t *perm,
+    magmaDoubleComplex *Bval,
+    Operator op )
+{
+    #pragma omp parallel for
+    for( magma_int_t k=0; k<nnz; k++ ){
+        op(val[k], Bval[ perm[k] ]);
+    }
+}
+
+
+inline void cpy(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to = from; }
+
+//inline function computing the conjugate
+inline void conjop(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to = MAGMA_Z_CONJ(from); }
+
+// inline function passing a value
+inline void pass(const magmaDoubleComplex &from, magmaDoubleComplex &to) { }
+
+// inline function passing absolute value
+inline void absval(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to = MAGMA_Z_MAKE(MAGMA_Z_ABS(from), 0.0 ); }
+
+
+/**
+    Purpose
+    -------
+
+    Generates op(A)^T on the CPU in one pass, where op is the identity,
+    the conjugate, the absolute value, or only the nonzero pattern.
+
+    The entries of every row of B are in the order they have in A, so B is
+    sorted if A is. If A.rowidx is set, the row of each entry is taken from
+    A.rowidx, the entries of A need not be grouped by row, and B->rowidx
+    is set as well.
+
+    If perm is not NULL and *perm is NULL, the position in B of every entry
+    of A is returned in *perm (allocated, length A.nnz). If *perm is not
+    NULL, B must already hold the transpose of a matrix with the pattern
+    of A computed with this perm, and only the values of B are updated.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                input matrix (CSR)
+
+    @param[in,out]
+    B           magma_z_matrix*
+                output matrix (CSR)
+
+    @param[in]
+    op          magma_transop_t
+                Magma_TRANSVAL, Magma_TRANSCONJ, Magma_TRANSABS or
+                Magma_TRANSSTRUCT.
+
+    @param[in,out]
+    perm        magma_index_t**
+                Permutation from A to B, or NULL.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+extern "C" magma_int_t
+magma_zmtransposeop_cpu(
+    magma_z_matrix A,
+    magma_z_matrix *B,
+    magma_transop_t op,
+    magma_index_t **perm,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_index_t *p = NULL;
+
+    // only the values change
+    if( perm != NULL && *perm != NULL ){
+        switch( op ){
+            case Magma_TRANSVAL:
+                magma_z_mtrans_values_template( A.nnz, A.val, *perm, B->val, cpy );
+                break;
+            case Magma_TRANSCONJ:
+                magma_z_mtrans_values_template( A.nnz, A.val, *perm, B->val, conjop );
+                break;
+            case Magma_TRANSABS:
+                magma_z_mtrans_values_template( A.nnz, A.val, *perm, B->val, absval );
+                break;
+            case Magma_TRANSSTRUCT:
+                break;
+            default:
+                info = MAGMA_ERR_NOT_SUPPORTED;
+        }
+        return info;
+    }
+
     magma_zmfree( B, queue );
     B->ownership = MagmaTrue;
-    
+
     B->storage_type = A.storage_type;
     B->memory_location = A.memory_location;
-    
-    B->num_rows = A.num_rows;
-    B->num_cols = A.num_cols;
+
+    B->num_rows = A.num_cols;
+    B->num_cols = A.num_rows;
     B->nnz      = A.nnz;
-    
-    CHECK( magma_index_malloc_cpu( &linked_list, A.nnz ));
-    CHECK( magma_index_malloc_cpu( &row_ptr, A.num_rows ));
-    CHECK( magma_index_malloc_cpu( &last_rowel, A.num_rows ));
-    CHECK( magma_index_malloc_cpu( &B->row, A.num_rows+1 ));
-    CHECK( magma_index_malloc_cpu( &B->rowidx, A.nnz ));
+
+    CHECK( magma_index_malloc_cpu( &p, A.nnz ));
+    CHECK( magma_index_malloc_cpu( &B->row, B->num_rows+1 ));
     CHECK( magma_index_malloc_cpu( &B->col, A.nnz ));
     CHECK( magma_zmalloc_cpu( &B->val, A.nnz ) );
-    
-    magma_free_cpu( A.rowidx );
-    
-    CHECK( magma_zmatrix_addrowindex(&A, queue) );
-    
-    //#pragma omp parallel
-    // {
-    //     num_threads = omp_get_max_threads();
-    // }
-    
-    //#pragma omp parallel for
-    for( magma_int_t i=0; i<A.num_rows; i++ ){
-        row_ptr[i] = -1;
+    if( A.rowidx != NULL ){
+        CHECK( magma_index_malloc_cpu( &B->rowidx, A.nnz ));
     }
-    //#pragma omp parallel for
-    for( magma_int_t i=0; i<A.num_rows+1; i++ ){
-        B->row[i] = 0;
-    }
-    
-    //el_per_block = magma_ceildiv( A.num_rows, num_threads );
-
-    //#pragma omp parallel
-    {
-        // magma_int_t id = omp_get_thread_num();
-        for(magma_int_t i=0; i<A.nnz; i++ ){
-            magma_index_t row = A.col[ i ];
-            //if( (row < (id+1)*el_per_block) && (row >=(id)*el_per_block)  ){
-            {
-                if( row_ptr[row] == -1 ){
-                    row_ptr[ row ] = i;
-                    linked_list[ i ] = 0;
-                    last_rowel[ row ] = i;
-                } else {
-                    linked_list[ last_rowel[ row ] ] = i;
-                    linked_list[ i ] = 0;
-                    last_rowel[ row ] = i;
-                }
-                B->row[row+1] = B->row[row+1] + 1;
-            }
-        }
+
+    switch( op ){
+        case Magma_TRANSVAL:
+            CHECK( magma_z_mtrans_template( A.num_rows, A.num_cols, A.nnz, A.row, A.rowidx,
+                A.col, A.val, B->row, B->rowidx, B->col, B->val, p, cpy, queue ));
+            break;
+        case Magma_TRANSCONJ:
+            CHECK( magma_z_mtrans_template( A.num_rows, A.num_cols, A.nnz, A.row, A.rowidx,
+                A.col, A.val, B->row, B->rowidx, B->col, B->val, p, conjop, queue ));
+            break;
+        case Magma_TRANSABS:
+            CHECK( magma_z_mtrans_template( A.num_rows, A.num_cols, A.nnz, A.row, A.rowidx,
+                A.col, A.val, B->row, B->rowidx, B->col, B->val, p, absval, queue ));
+            break;
+        case Magma_TRANSSTRUCT:
+            CHECK( magma_z_mtrans_template( A.num_rows, A.num_cols, A.nnz, A.row, A.rowidx,
+                A.col, A.val, B->row, B->rowidx, B->col, B->val, p, pass, queue ));
+            break;
+        default:
+            info = MAGMA_ERR_NOT_SUPPORTED;
+            goto cleanup;
     }
-    
-    // new rowptr
-    B->row[0]=0;   
-    magma_zmatrix_createrowptr( B->num_rows, B->row, queue );
-    
-
-    assert( B->row[B->num_rows] == A.nnz );
-    
-    //#pragma omp parallel for
-    for( magma_int_t row=0; row<A.num_rows; row++){
-        magma_int_t el = row_ptr[row];
-        if( el>-1 ) {
-            for( magma_int_t i=B->row[row]; i<B->row[row+1]; i++ ){
-                op(A.val[el], B->val[i]);
-                B->col[i] = A.rowidx[el];
-                el = linked_list[el];
-            }
-        }
+
+    if( perm != NULL ){
+        *perm = p;
+        p = NULL;
     }
-    
+
 cleanup:
-    magma_free_cpu( row_ptr );
-    magma_free_cpu( last_rowel );
-    magma_free_cpu( linked_list );
-    magma_free_cpu( A.rowidx );
+    magma_free_cpu( p );
+    if( info != 0 ){
+        magma_zmfree( B, queue );
+    }
     return info;
 }
 
 
-inline void cpy(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to = from; }
-
 /**
     Purpose
     -------
@@ -146,20 +330,19 @@ inline void cpy(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to = f
     ********************************************************************/
 extern "C" magma_int_t
 magma_zmtranspose_cpu(
-    magma_z_matrix A, 
+    magma_z_matrix A,
     magma_z_matrix *B,
     magma_queue_t queue){
-    
+
     magma_int_t info = 0;
-    
-    CHECK( magma_z_mtrans_template(A, B, cpy, queue) );
-    
+
+    A.rowidx = NULL;
+    CHECK( magma_zmtransposeop_cpu(A, B, Magma_TRANSVAL, NULL, queue) );
+
 cleanup:
     return info;
 }
 
-//inline function computing the conjugate
-inline void conjop(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to = MAGMA_Z_CONJ(from); }
 
 /**
     Purpose
@@ -185,20 +368,19 @@ inline void conjop(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to
     ********************************************************************/
 extern "C" magma_int_t
 magma_zmtransposeconj_cpu(
-    magma_z_matrix A, 
+    magma_z_matrix A,
     magma_z_matrix *B,
     magma_queue_t queue){
-    
+
     magma_int_t info = 0;
-    
-    CHECK( magma_z_mtrans_template(A, B, conjop, queue) );
-    
+
+    A.rowidx = NULL;
+    CHECK( magma_zmtransposeop_cpu(A, B, Magma_TRANSCONJ, NULL, queue) );
+
 cleanup:
     return info;
 }
 
-// inline function passing a value
-inline void pass(const magmaDoubleComplex &from, magmaDoubleComplex &to) { }
 
 /**
     Purpose
@@ -224,20 +406,19 @@ inline void pass(const magmaDoubleComplex &from, magmaDoubleComplex &to) { }
     ********************************************************************/
 extern "C" magma_int_t
 magma_zmtransposestruct_cpu(
-    magma_z_matrix A, 
+    magma_z_matrix A,
     magma_z_matrix *B,
     magma_queue_t queue){
-    
+
     magma_int_t info = 0;
-    
-    CHECK( magma_z_mtrans_template(A, B, pass, queue) );
-    
+
+    A.rowidx = NULL;
+    CHECK( magma_zmtransposeop_cpu(A, B, Magma_TRANSSTRUCT, NULL, queue) );
+
 cleanup:
     return info;
 }
 
-// inline function passing absolute value
-inline void absval(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to = MAGMA_Z_MAKE(MAGMA_Z_ABS(from), 0.0 ); }
 
 /**
     Purpose
@@ -263,16 +444,15 @@ inline void absval(const magmaDoubleComplex &from, magmaDoubleComplex &to) { to
     ********************************************************************/
 extern "C" magma_int_t
 magma_zmtransposeabs_cpu(
-    magma_z_matrix A, 
+    magma_z_matrix A,
     magma_z_matrix *B,
     magma_queue_t queue){
-    
+
     magma_int_t info = 0;
-    
-    CHECK( magma_z_mtrans_template(A, B, absval, queue) );
-    
+
+    A.rowidx = NULL;
+    CHECK( magma_zmtransposeop_cpu(A, B, Magma_TRANSABS, NULL, queue) );
+
 cleanup:
     return info;
 }
-
-
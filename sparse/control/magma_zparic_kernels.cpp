@@ -177,3 +177,60 @@ cleanup:
     
     return info;
 }
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    This function does one asynchronous ParIC sweep using a plan created by
+    magma_zparic_plan_create for the current patterns of A and L.
+    Input and output array are identical.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                System matrix in COO.
+
+    @param[in]
+    L           magma_z_matrix*
+                Current approximation for the lower triangular factor
+                The format is sorted CSR.
+
+    @param[in]
+    plan        magma_sweep_plan
+                Sweep plan.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+
+extern "C" magma_int_t
+magma_zparic_sweep_plan(
+    magma_z_matrix A,
+    magma_z_matrix *L,
+    magma_sweep_plan plan,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (magma_int_t e=0; e < plan.num_entries; e++) {
+        magmaDoubleComplex s = A.val[ plan.aidx[e] ];
+        for (magma_int_t p=plan.ptr[e]; p < plan.ptr[e+1]; p++) {
+            s = s - L->val[ plan.lidx[p] ] * L->val[ plan.ridx[p] ];
+        }
+        if ( plan.didx[e] >= 0 )      // modify l entry
+            L->val[ plan.target[e] ] =  s / L->val[ plan.didx[e] ];
+        else {                        // modify diagonal entry
+            L->val[ plan.target[e] ] = MAGMA_Z_MAKE( sqrt( fabs( MAGMA_Z_REAL(s) )), 0.0 );
+        }
+    }
+
+    return info;
+}
@@ -0,0 +1,516 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include <algorithm>
+#include <cstring>
+
+#include "magmasparse_internal.h"
+#include "magmasparse_bio.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/***************************************************************************//**
+    Incremental ParILUT candidates.
+
+    The candidates of row i depend on row i of L0, U0, L and U, and on the
+    rows col1 of U for every col1 in row i of L. After the first steps of
+    ParILUT most rows of L and U keep their pattern, so most candidate rows
+    are the same as in the step before. The cache keeps the patterns of L
+    and U and the candidates of the last step; a step compares the patterns,
+    recomputes the rows that depend on a changed row, and copies all others.
+
+    A recomputed row is written to the arena of the thread that computed it
+    as a record nl, nl0, nu, nu0 followed by the nl columns for L and the
+    nu columns for U; the first nl0 (nu0) of them come from L0 (U0).
+*******************************************************************************/
+
+#define MAGMA_CAND_HEADER 4
+
+
+// Upper bound of the words of the record of row.
+static inline magma_int_t
+magma_zparilut_candidates_bound(
+    const magma_z_matrix *L0,
+    const magma_z_matrix *U0,
+    const magma_z_matrix *L,
+    const magma_z_matrix *U,
+    magma_index_t row )
+{
+    magma_int_t fill = 0;
+    for( magma_index_t el1=L->row[row]; el1<L->row[row+1]-1; el1++ ){
+        magma_index_t col1 = L->col[ el1 ];
+        fill += U->row[ col1+1 ] - U->row[ col1 ];
+    }
+    return MAGMA_CAND_HEADER + ( L0->row[row+1] - L0->row[row] )
+        + ( U0->row[row+1] - U0->row[row] ) + 2*fill;
+}
+
+
+// Appends the entries of the sorted row pattern P0 missing in the sorted
+// row pattern P to out, returns their number.
+static inline magma_int_t
+magma_zparilut_candidates_missing(
+    const magma_z_matrix *P0,
+    const magma_z_matrix *P,
+    magma_index_t row,
+    magma_index_t *out )
+{
+    magma_int_t num = 0;
+    magma_index_t k = P->row[row];
+    magma_index_t kend = P->row[row+1];
+    for( magma_index_t k0=P0->row[row]; k0<P0->row[row+1]; k0++ ){
+        magma_index_t col = P0->col[ k0 ];
+        while( k < kend && P->col[ k ] < col ){
+            k++;
+        }
+        if( k == kend || P->col[ k ] != col ){
+            out[ num++ ] = col;
+        }
+    }
+    return num;
+}
+
+
+// Writes the record of row to out as magma_zparilut_candidates orders the
+// candidates, returns the words written. out must hold
+// magma_zparilut_candidates_bound words.
+static magma_int_t
+magma_zparilut_candidates_row(
+    const magma_z_matrix *L0,
+    const magma_z_matrix *U0,
+    const magma_z_matrix *L,
+    const magma_z_matrix *U,
+    magma_index_t row,
+    magma_int_t bound,
+    magma_index_t *out )
+{
+    // the L candidates take at most nnz(L0 row) + fill words, so the U
+    // candidates are written behind that and moved down at the end
+    magma_int_t nnz_l0 = L0->row[row+1] - L0->row[row];
+    magma_int_t nnz_u0 = U0->row[row+1] - U0->row[row];
+    magma_int_t fill = ( bound - MAGMA_CAND_HEADER - nnz_l0 - nnz_u0 ) / 2;
+    magma_index_t *lout = out + MAGMA_CAND_HEADER;
+    magma_index_t *uout = lout + nnz_l0 + fill;
+    const magma_index_t *lbegin = L->col + L->row[row];
+    const magma_index_t *lend   = L->col + L->row[row+1];
+    const magma_index_t *ubegin = U->col + U->row[row];
+    const magma_index_t *uend   = U->col + U->row[row+1];
+
+    magma_int_t nl0 = magma_zparilut_candidates_missing( L0, L, row, lout );
+    magma_int_t nu0 = magma_zparilut_candidates_missing( U0, U, row, uout );
+    magma_int_t nl = nl0, nu = nu0;
+
+    // ILU(1) fill-in: L(row,col1) * U(col1,col2) for col1 < row < col2
+    for( magma_index_t el1=L->row[row]; el1<L->row[row+1]-1; el1++ ){
+        magma_index_t col1 = L->col[ el1 ];
+        for( magma_index_t el2 = U->row[ col1 ]+1; el2 < U->row[ col1+1 ]; el2++ ){
+            magma_index_t col2 = U->col[ el2 ];
+            if( col2 < row ){
+                if( ! std::binary_search( lbegin, lend, col2 ) ){
+                    lout[ nl++ ] = col2;
+                }
+            } else {
+                if( ! std::binary_search( ubegin, uend, col2 ) ){
+                    uout[ nu++ ] = col2;
+                }
+            }
+        }
+    }
+    if( uout != lout + nl ){
+        memmove( lout + nl, uout, nu * sizeof(magma_index_t) );
+    }
+    out[0] = nl;
+    out[1] = nl0;
+    out[2] = nu;
+    out[3] = nu0;
+    return MAGMA_CAND_HEADER + nl + nu;
+}
+
+
+// Whether row i of the CSR pattern (row, col) equals the one of A.
+static inline bool
+magma_zparilut_candidates_same(
+    const magma_index_t *row,
+    const magma_index_t *col,
+    const magma_z_matrix *A,
+    magma_index_t i )
+{
+    magma_index_t len = A->row[i+1] - A->row[i];
+    return row[i+1] - row[i] == len &&
+        memcmp( col + row[i], A->col + A->row[i], len*sizeof(magma_index_t) ) == 0;
+}
+
+
+// Checksum of the CSR pattern of A, to tell a new L0, U0 from the cached one.
+static inline uint64_t
+magma_zparilut_candidates_sum(
+    const magma_z_matrix *A )
+{
+    uint64_t rsum = magma_bio_checksum( A->row, (A->num_rows+1)*sizeof(magma_index_t) );
+    uint64_t csum = magma_bio_checksum( A->col, A->row[A->num_rows]*sizeof(magma_index_t) );
+    return rsum ^ ( csum * 0x9e3779b97f4a7c15ull );
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Computes the same candidates as magma_zparilut_candidates, but keeps them
+    in cache between the ParILUT steps and only recomputes the rows whose
+    inputs changed since the last call. The first call, or a call with a
+    different L0, U0, computes all rows. L0 and U0 count as different if
+    their row pointers, nonzero counts or pattern checksums differ; to reuse
+    a cache for another system, free it with magma_zcandidate_cache_free
+    to be safe.
+
+    The rows of L0, U0, L and U have to be sorted. The per-thread scratch
+    arenas of the cache are kept between the calls.
+
+    Arguments
+    ---------
+
+    @param[in]
+    L0          magma_z_matrix
+                tril( ILU(0) ) pattern of original system matrix.
+
+    @param[in]
+    U0          magma_z_matrix
+                triu( ILU(0) ) pattern of original system matrix.
+
+    @param[in]
+    L           magma_z_matrix
+                Current lower triangular factor.
+
+    @param[in]
+    U           magma_z_matrix
+                Current upper triangular factor in CSR.
+
+    @param[in,out]
+    cache       magma_candidate_cache*
+                Candidates of the last call, zero-initialized before the
+                first call. Free with magma_zcandidate_cache_free.
+
+    @param[out]
+    L_new       magma_z_matrix*
+                List of candidates for L in COO format.
+
+    @param[out]
+    U_new       magma_z_matrix*
+                List of candidates for U in COO format.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zparilut_candidates_inc(
+    magma_z_matrix L0,
+    magma_z_matrix U0,
+    magma_z_matrix L,
+    magma_z_matrix U,
+    magma_candidate_cache *cache,
+    magma_z_matrix *L_new,
+    magma_z_matrix *U_new,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = L.num_rows;
+    magma_int_t num_threads = 1;
+    magma_int_t recomputed = 0;
+    magma_index_t *ccol_l = NULL, *ccol_u = NULL;
+    uint64_t l0_sum = magma_zparilut_candidates_sum( &L0 );
+    uint64_t u0_sum = magma_zparilut_candidates_sum( &U0 );
+    bool reset = ( cache->num_rows != n ||
+                   cache->l0_row != L0.row || cache->u0_row != U0.row ||
+                   cache->l0_nnz != L0.nnz || cache->u0_nnz != U0.nnz ||
+                   cache->l0_sum != l0_sum || cache->u0_sum != u0_sum );
+
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+
+    magma_zmfree( L_new, queue );
+    magma_zmfree( U_new, queue );
+
+    if( reset ){
+        CHECK( magma_zcandidate_cache_free( cache, queue ));
+        CHECK( magma_index_malloc_cpu( &cache->lrow, n+1 ));
+        CHECK( magma_index_malloc_cpu( &cache->urow, n+1 ));
+        CHECK( magma_index_malloc_cpu( &cache->crow_l, n+1 ));
+        CHECK( magma_index_malloc_cpu( &cache->crow_u, n+1 ));
+        CHECK( magma_index_malloc_cpu( &cache->corig_l, n ));
+        CHECK( magma_index_malloc_cpu( &cache->corig_u, n ));
+        CHECK( magma_index_malloc_cpu( &cache->flag, n ));
+        CHECK( magma_index_malloc_cpu( &cache->owner, n ));
+        CHECK( magma_index_malloc_cpu( &cache->offset, n ));
+        cache->crow_l[0] = 0;
+        cache->crow_u[0] = 0;
+    }
+    if( cache->num_arenas < num_threads ){
+        for( magma_int_t t=0; t < cache->num_arenas; t++ ){
+            magma_free_cpu( cache->arena[t] );
+        }
+        magma_free_cpu( cache->arena );
+        magma_free_cpu( cache->arena_size );
+        cache->arena = NULL;
+        cache->arena_size = NULL;
+        cache->num_arenas = 0;
+        CHECK( magma_malloc_cpu( (void**) &cache->arena, num_threads*sizeof(magma_index_t*) ));
+        CHECK( magma_malloc_cpu( (void**) &cache->arena_size, num_threads*sizeof(magma_int_t) ));
+        for( magma_int_t t=0; t < num_threads; t++ ){
+            cache->arena[t] = NULL;
+            cache->arena_size[t] = 0;
+        }
+        cache->num_arenas = num_threads;
+    }
+
+    // rows of L (bit 1) and U (bit 2) that changed since the last call
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ){
+        magma_index_t f = 3;
+        if( ! reset ){
+            f = 0;
+            if( ! magma_zparilut_candidates_same( cache->lrow, cache->lcol, &L, i ) )
+                f |= 1;
+            if( ! magma_zparilut_candidates_same( cache->urow, cache->ucol, &U, i ) )
+                f |= 2;
+        }
+        cache->flag[i] = f;
+    }
+
+    // row i is recomputed if row i of L or U changed, or row col1 of U for
+    // a col1 in row i of L; owner is -1 for the rows that are copied
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ){
+        bool dirty = ( cache->flag[i] != 0 );
+        for( magma_index_t k=L.row[i]; ! dirty && k < L.row[i+1]-1; k++ ){
+            dirty = ( cache->flag[ L.col[k] ] & 2 ) != 0;
+        }
+        cache->owner[i] = dirty ? 0 : -1;
+    }
+
+    // recompute into the arenas
+    #pragma omp parallel num_threads( num_threads ) reduction(+:recomputed)
+    {
+#ifdef _OPENMP
+        magma_int_t id = omp_get_thread_num();
+#else
+        magma_int_t id = 0;
+#endif
+        magma_int_t used = 0;
+        #pragma omp for schedule(dynamic, 256)
+        for( magma_int_t i=0; i < n; i++ ){
+            if( cache->owner[i] < 0 || info != 0 )
+                continue;
+            magma_int_t bound = magma_zparilut_candidates_bound( &L0, &U0, &L, &U, i );
+            if( used + bound > cache->arena_size[id] ){
+                magma_int_t size = max( 2*cache->arena_size[id], used + bound );
+                magma_index_t *arena = NULL;
+                if( magma_index_malloc_cpu( &arena, size ) != MAGMA_SUCCESS ){
+                    #pragma omp atomic write
+                    info = MAGMA_ERR_HOST_ALLOC;
+                    continue;
+                }
+                if( used > 0 ){
+                    memcpy( arena, cache->arena[id], used*sizeof(magma_index_t) );
+                }
+                magma_free_cpu( cache->arena[id] );
+                cache->arena[id] = arena;
+                cache->arena_size[id] = size;
+            }
+            cache->owner[i] = id;
+            cache->offset[i] = used;
+            used += magma_zparilut_candidates_row( &L0, &U0, &L, &U, i, bound,
+                                                   cache->arena[id] + used );
+            recomputed++;
+        }
+    }
+    if( info != 0 ){
+        goto cleanup;
+    }
+
+    // row pointers of the new candidates
+    L_new->num_rows = L.num_rows;
+    L_new->num_cols = L.num_cols;
+    L_new->storage_type = Magma_CSR;
+    L_new->memory_location = Magma_CPU;
+    U_new->num_rows = L.num_rows;
+    U_new->num_cols = L.num_cols;
+    U_new->storage_type = Magma_CSR;
+    U_new->memory_location = Magma_CPU;
+    CHECK( magma_index_malloc_cpu( &L_new->row, n+1 ));
+    CHECK( magma_index_malloc_cpu( &U_new->row, n+1 ));
+    L_new->row[0] = 0;
+    U_new->row[0] = 0;
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n; i++ ){
+        if( cache->owner[i] >= 0 ){
+            const magma_index_t *rec = cache->arena[ cache->owner[i] ] + cache->offset[i];
+            L_new->row[i+1] = rec[0];
+            U_new->row[i+1] = rec[2];
+        } else {
+            L_new->row[i+1] = cache->crow_l[i+1] - cache->crow_l[i];
+            U_new->row[i+1] = cache->crow_u[i+1] - cache->crow_u[i];
+        }
+    }
+    CHECK( magma_zmatrix_createrowptr( n, L_new->row, queue ));
+    CHECK( magma_zmatrix_createrowptr( n, U_new->row, queue ));
+    L_new->nnz = L_new->row[n];
+    U_new->nnz = U_new->row[n];
+
+    // new cached candidates: recomputed rows from the arenas, others copied
+    CHECK( magma_index_malloc_cpu( &ccol_l, L_new->nnz ));
+    CHECK( magma_index_malloc_cpu( &ccol_u, U_new->nnz ));
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ){
+        magma_int_t nl = L_new->row[i+1] - L_new->row[i];
+        magma_int_t nu = U_new->row[i+1] - U_new->row[i];
+        const magma_index_t *lsrc, *usrc;
+        if( cache->owner[i] >= 0 ){
+            const magma_index_t *rec = cache->arena[ cache->owner[i] ] + cache->offset[i];
+            cache->corig_l[i] = rec[1];
+            cache->corig_u[i] = rec[3];
+            lsrc = rec + MAGMA_CAND_HEADER;
+            usrc = lsrc + nl;
+        } else {
+            lsrc = cache->ccol_l + cache->crow_l[i];
+            usrc = cache->ccol_u + cache->crow_u[i];
+        }
+        memcpy( ccol_l + L_new->row[i], lsrc, nl*sizeof(magma_index_t) );
+        memcpy( ccol_u + U_new->row[i], usrc, nu*sizeof(magma_index_t) );
+    }
+    magma_free_cpu( cache->ccol_l );
+    magma_free_cpu( cache->ccol_u );
+    cache->ccol_l = ccol_l;
+    cache->ccol_u = ccol_u;
+    ccol_l = NULL;
+    ccol_u = NULL;
+
+    // the output in COO: entries from L0, U0 get the value 3, fill-in 1
+    CHECK( magma_zmalloc_cpu( &L_new->val, L_new->nnz ));
+    CHECK( magma_index_malloc_cpu( &L_new->rowidx, L_new->nnz ));
+    CHECK( magma_index_malloc_cpu( &L_new->col, L_new->nnz ));
+    CHECK( magma_zmalloc_cpu( &U_new->val, U_new->nnz ));
+    CHECK( magma_index_malloc_cpu( &U_new->rowidx, U_new->nnz ));
+    CHECK( magma_index_malloc_cpu( &U_new->col, U_new->nnz ));
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for( magma_int_t i=0; i < n; i++ ){
+        cache->crow_l[i+1] = L_new->row[i+1];
+        cache->crow_u[i+1] = U_new->row[i+1];
+        for( magma_index_t k=L_new->row[i]; k < L_new->row[i+1]; k++ ){
+            L_new->col[k] = cache->ccol_l[k];
+            L_new->rowidx[k] = i;
+            L_new->val[k] = ( k - L_new->row[i] < cache->corig_l[i] )
+                ? MAGMA_Z_ONE + MAGMA_Z_ONE + MAGMA_Z_ONE : MAGMA_Z_ONE;
+        }
+        for( magma_index_t k=U_new->row[i]; k < U_new->row[i+1]; k++ ){
+            U_new->col[k] = cache->ccol_u[k];
+            U_new->rowidx[k] = i;
+            U_new->val[k] = ( k - U_new->row[i] < cache->corig_u[i] )
+                ? MAGMA_Z_ONE + MAGMA_Z_ONE + MAGMA_Z_ONE : MAGMA_Z_ONE;
+        }
+    }
+
+    // remember the patterns of L and U for the next call
+    if( reset || cache->lrow[n] != L.row[n] ){
+        magma_free_cpu( cache->lcol );
+        cache->lcol = NULL;
+        CHECK( magma_index_malloc_cpu( &cache->lcol, L.row[n] ));
+    }
+    if( reset || cache->urow[n] != U.row[n] ){
+        magma_free_cpu( cache->ucol );
+        cache->ucol = NULL;
+        CHECK( magma_index_malloc_cpu( &cache->ucol, U.row[n] ));
+    }
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n+1; i++ ){
+        cache->lrow[i] = L.row[i];
+        cache->urow[i] = U.row[i];
+    }
+    #pragma omp parallel for
+    for( magma_int_t k=0; k < L.row[n]; k++ ){
+        cache->lcol[k] = L.col[k];
+    }
+    #pragma omp parallel for
+    for( magma_int_t k=0; k < U.row[n]; k++ ){
+        cache->ucol[k] = U.col[k];
+    }
+    cache->num_rows = n;
+    cache->l0_nnz = L0.nnz;
+    cache->u0_nnz = U0.nnz;
+    cache->l0_row = L0.row;
+    cache->u0_row = U0.row;
+    cache->l0_sum = l0_sum;
+    cache->u0_sum = u0_sum;
+    cache->num_recomputed = recomputed;
+
+cleanup:
+    magma_free_cpu( ccol_l );
+    magma_free_cpu( ccol_u );
+    if( info != 0 ){
+        // the cache may be half updated
+        magma_zcandidate_cache_free( cache, queue );
+        magma_zmfree( L_new, queue );
+        magma_zmfree( U_new, queue );
+    }
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Frees the arrays of a candidate cache.
+
+    Arguments
+    ---------
+
+    @param[in,out]
+    cache       magma_candidate_cache*
+                Candidate cache.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zcandidate_cache_free(
+    magma_candidate_cache *cache,
+    magma_queue_t queue )
+{
+    magma_free_cpu( cache->lrow );
+    magma_free_cpu( cache->lcol );
+    magma_free_cpu( cache->urow );
+    magma_free_cpu( cache->ucol );
+    magma_free_cpu( cache->crow_l );
+    magma_free_cpu( cache->ccol_l );
+    magma_free_cpu( cache->crow_u );
+    magma_free_cpu( cache->ccol_u );
+    magma_free_cpu( cache->corig_l );
+    magma_free_cpu( cache->corig_u );
+    magma_free_cpu( cache->flag );
+    magma_free_cpu( cache->owner );
+    magma_free_cpu( cache->offset );
+    for( magma_int_t t=0; t < cache->num_arenas; t++ ){
+        magma_free_cpu( cache->arena[t] );
+    }
+    magma_free_cpu( cache->arena );
+    magma_free_cpu( cache->arena_size );
+    memset( cache, 0, sizeof(magma_candidate_cache) );
+    return MAGMA_SUCCESS;
+}
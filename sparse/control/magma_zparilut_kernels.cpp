@@ -10,6 +10,8 @@
 
 */
 
+#include <algorithm>
+
 #include "magmasparse_internal.h"
 #ifdef _OPENMP
 #include <omp.h>
@@ -18,6 +20,19 @@
 #define SWAP(a, b)  { val_swap = a; a = b; b = val_swap; }
 
 
+// Value of A at (row, col), zero if A has no such entry. A is sorted CSR.
+static inline magmaDoubleComplex
+magma_zparilut_aval(
+    const magma_z_matrix *A,
+    magma_index_t row,
+    magma_index_t col )
+{
+    const magma_index_t *begin = A->col + A->row[row];
+    const magma_index_t *end   = A->col + A->row[row+1];
+    const magma_index_t *pos = std::lower_bound( begin, end, col );
+    return ( pos != end && *pos == col ) ? A->val[ pos - A->col ] : MAGMA_Z_ZERO;
+}
+
 
 
 /***************************************************************************//**
@@ -30,6 +45,9 @@
     of L and U, not A.
     
     This is the CPU version of the asynchronous ParILUT sweep.
+    The entries of A are looked up by binary search, so the columns in
+    every row of A have to be sorted, e.g., by magma_zcsr_sort; they are
+    not checked.
 
     Arguments
     ---------
@@ -75,14 +93,8 @@ magma_zparilut_sweep(
         // as we look at the lower triangular,
         // col<row, i.e. disregard last element in row
         if(col < row) {
-            magmaDoubleComplex A_e = MAGMA_Z_ZERO;
             // check whether A contains element in this location
-            for (i = A->row[row]; i<A->row[row+1]; i++) {
-                if(A->col[i] == col) {
-                    A_e = A->val[i];
-                    break;
-                }
-            }
+            magmaDoubleComplex A_e = magma_zparilut_aval( A, row, col );
             //now do the actual iteration
             i = L->row[ row ];
             j = U->row[ col ];
@@ -123,14 +135,8 @@ magma_zparilut_sweep(
             magma_int_t i,j,icol,jcol;
             magma_index_t row = U->col[ e ];
             magma_index_t col = U->rowidx[ e ];
-            magmaDoubleComplex A_e = MAGMA_Z_ZERO;
             // check whether A contains element in this location
-            for (i = A->row[row]; i<A->row[row+1]; i++) {
-                if(A->col[i] == col) {
-                    A_e = A->val[i];
-                    break;
-                }
-            }
+            magmaDoubleComplex A_e = magma_zparilut_aval( A, row, col );
             //now do the actual iteration
             i = L->row[ row ];
             j = U->row[ col ];
@@ -175,6 +181,7 @@ magma_zparilut_sweep(
     of L and U, not A.
     
     This is the CPU version of the synchronous ParILUT sweep.
+    As for magma_zparilut_sweep, the rows of A have to be sorted.
 
     Arguments
     ---------
@@ -222,14 +229,8 @@ magma_zparilut_sweep_sync(
         magma_index_t row = U->col[ e ];
         magma_index_t col = U->rowidx[ e ];
         {   
-            magmaDoubleComplex A_e = MAGMA_Z_ZERO;
             // check whether A contains element in this location
-            for (i = A->row[row]; i<A->row[row+1]; i++) {
-                if(A->col[i] == col) {
-                    A_e = A->val[i];
-                    break;
-                }
-            }
+            magmaDoubleComplex A_e = magma_zparilut_aval( A, row, col );
             //now do the actual iteration
             i = L->row[ row ];
             j = U->row[ col ];
@@ -273,14 +274,8 @@ magma_zparilut_sweep_sync(
         if(row == col) { 
             L_new_val[ e ] = MAGMA_Z_ONE; // lower triangular has 1-diagonal
         } else {
-            magmaDoubleComplex A_e = MAGMA_Z_ZERO;
             // check whether A contains element in this location
-            for (i = A->row[row]; i<A->row[row+1]; i++) {
-                if(A->col[i] == col) {
-                    A_e = A->val[i];
-                    break;
-                }
-            }
+            magmaDoubleComplex A_e = magma_zparilut_aval( A, row, col );
             //now do the actual iteration
             i = L->row[ row ];
             j = U->row[ col ];
@@ -331,6 +326,7 @@ cleanup:
     -------
     This function computes the ILU residual in the locations included in the 
     sparsity pattern of R.
+    The rows of A have to be sorted, as for magma_zparilut_sweep.
 
     Arguments
     ---------
@@ -338,7 +334,7 @@ cleanup:
 
     @param[in]
     A           magma_z_matrix
-                System matrix A.
+                System matrix A. The format is sorted CSR.
 
     @param[in]
     L           magma_z_matrix
@@ -377,13 +373,7 @@ magma_zparilut_residuals(
             magma_int_t i,j,icol,jcol;
             magma_index_t row = R->rowidx[ e ];
             magma_index_t col = R->col[ e ];
-            magmaDoubleComplex A_e = MAGMA_Z_ZERO;
-            for (i = A.row[row]; i<A.row[row+1]; i++) {
-                if(A.col[i] == col) {
-                    A_e = A.val[i];
-                    i = A.row[row+1];
-                }
-            }
+            magmaDoubleComplex A_e = magma_zparilut_aval( &A, row, col );
             //now do the actual iteration
             i = L.row[ row ];
             j = U.row[ col ];
@@ -0,0 +1,420 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include <algorithm>
+#include <vector>
+
+#include "magmasparse_internal.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/***************************************************************************//**
+    SELL-C-sigma on the host.
+
+    see paper by M. KREUTZER, G. HAGER, G WELLEIN, H. FEHSKE A. BISHOP
+    A UNIFIED SPARSE MATRIX DATA FORMAT
+    FOR MODERN PROCESSORS WITH WIDE SIMD UNITS
+
+    Inside every window of sigma consecutive rows, the rows are sorted by
+    decreasing length. The sorted rows are cut into slices of C rows, and
+    every slice is padded to its longest row and stored column-major, like
+    SELLP. Sorting keeps the padding small, the windows keep the accesses to
+    x local. With C a multiple of the SIMD width, the C rows of a slice are
+    processed in one SIMD loop.
+
+    Magma_SELLCS uses the SELLP fields: blocksize is C, alignment is sigma,
+    numblocks the number of slices and row the slice pointer. magma_zmconvert
+    sorts in windows of sigma = 8C unless alignment is larger than 1, and
+    tunes C and sigma if blocksize is not positive. In addition,
+    rowidx[p] is the original row of sorted row p. Padding entries have the
+    value zero and repeat the last column index of their row.
+*******************************************************************************/
+
+
+// Number of elements in one SIMD register of the host.
+static magma_int_t
+magma_zsellcs_lanes()
+{
+#if defined(__AVX512F__)
+    magma_int_t bytes = 64;
+#elif defined(__AVX__)
+    magma_int_t bytes = 32;
+#else
+    magma_int_t bytes = 16;
+#endif
+    return max( bytes / (magma_int_t) sizeof(magmaDoubleComplex), 1 );
+}
+
+
+// Sorts the rows of every window of sigma rows by decreasing length. The
+// sort is stable, so equal rows keep their order.
+static void
+magma_zsellcs_sort(
+    magma_int_t n,
+    magma_int_t sigma,
+    const magma_index_t *len,
+    magma_index_t *perm )
+{
+    magma_int_t windows = magma_ceildiv( n, sigma );
+    #pragma omp parallel for schedule(dynamic)
+    for( magma_int_t w=0; w < windows; w++ ) {
+        magma_index_t *begin = perm + w*sigma;
+        magma_index_t *end = perm + min( (w+1)*sigma, n );
+        for( magma_index_t *p=begin; p < end; p++ ) {
+            *p = (magma_index_t)( p - perm );
+        }
+        if ( sigma > 1 ) {
+            std::stable_sort( begin, end,
+                [len]( magma_index_t a, magma_index_t b ) { return len[a] > len[b]; } );
+        }
+    }
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Converts a host CSR matrix into SELL-C-sigma.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                Matrix in CSR located on the host.
+
+    @param[in]
+    C           magma_int_t
+                Slice height, 1 <= C <= 64. A multiple of the SIMD width.
+
+    @param[in]
+    sigma       magma_int_t
+                Sorting window in rows; 1 disables sorting.
+
+    @param[out]
+    B           magma_z_matrix*
+                Matrix in Magma_SELLCS.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zcsr2sellcs(
+    magma_z_matrix A,
+    magma_int_t C,
+    magma_int_t sigma,
+    magma_z_matrix *B,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = A.num_rows;
+    magma_int_t slices = 0;
+    magma_index_t max_nnz_row = 0;
+    magma_index_t *len = NULL;
+
+    if ( A.memory_location != Magma_CPU || A.storage_type != Magma_CSR ||
+         C < 1 || C > 64 || sigma < 1 ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    slices = magma_ceildiv( n, C );
+
+    // fill in information for B
+    B->storage_type = Magma_SELLCS;
+    B->memory_location = A.memory_location;
+    B->fill_mode = A.fill_mode;
+    B->num_rows = A.num_rows; B->true_nnz = A.true_nnz;
+    B->num_cols = A.num_cols;
+    B->diameter = A.diameter;
+    B->blocksize = C;
+    B->alignment = sigma;
+    B->numblocks = slices;
+
+    CHECK( magma_index_malloc_cpu( &len, max( n, 1 )));
+    CHECK( magma_index_malloc_cpu( &B->rowidx, max( n, 1 )));
+    CHECK( magma_index_malloc_cpu( &B->row, slices+1 ));
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n; i++ ) {
+        len[i] = A.row[i+1] - A.row[i];
+    }
+    magma_zsellcs_sort( n, sigma, len, B->rowidx );
+
+    // B->row points to the start of each slice
+    B->row[0] = 0;
+    #pragma omp parallel for reduction(max:max_nnz_row)
+    for( magma_int_t s=0; s < slices; s++ ) {
+        magma_index_t width = 0;
+        for( magma_int_t j=s*C; j < min( (s+1)*C, n ); j++ ) {
+            width = max( width, len[ B->rowidx[j] ] );
+        }
+        B->row[s+1] = width * C;
+        max_nnz_row = max( max_nnz_row, width );
+    }
+    CHECK( magma_zmatrix_createrowptr( slices, B->row, queue ));
+    B->max_nnz_row = max_nnz_row;
+    B->nnz = B->row[slices];
+
+    CHECK( magma_zmalloc_cpu( &B->val, max( B->nnz, 1 )));
+    CHECK( magma_index_malloc_cpu( &B->col, max( B->nnz, 1 )));
+
+    // fill in values, padding repeats the last column of the row
+    #pragma omp parallel for schedule(dynamic, 64)
+    for( magma_int_t s=0; s < slices; s++ ) {
+        magma_int_t width = ( B->row[s+1] - B->row[s] ) / C;
+        magmaDoubleComplex *val = B->val + B->row[s];
+        magma_index_t *col = B->col + B->row[s];
+        for( magma_int_t j=0; j < C; j++ ) {
+            magma_int_t p = s*C + j;
+            magma_index_t k = 0, last = 0;
+            if ( p < n ) {
+                magma_index_t i = B->rowidx[p];
+                for( ; k < len[i]; k++ ) {
+                    val[ k*C + j ] = A.val[ A.row[i] + k ];
+                    col[ k*C + j ] = A.col[ A.row[i] + k ];
+                }
+                last = ( k > 0 ) ? A.col[ A.row[i] + k-1 ] : 0;
+            }
+            for( ; k < width; k++ ) {
+                val[ k*C + j ] = MAGMA_Z_ZERO;
+                col[ k*C + j ] = last;
+            }
+        }
+    }
+
+cleanup:
+    magma_free_cpu( len );
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Converts a host SELL-C-sigma matrix back into CSR. As for SELLP, zero
+    values are dropped.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                Matrix in Magma_SELLCS located on the host.
+
+    @param[out]
+    B           magma_z_matrix*
+                Matrix in CSR.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zsellcs2csr(
+    magma_z_matrix A,
+    magma_z_matrix *B,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = A.num_rows;
+    magma_int_t C = A.blocksize;
+    magmaDoubleComplex zero = MAGMA_Z_ZERO;
+
+    if ( A.memory_location != Magma_CPU || A.storage_type != Magma_SELLCS ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    // fill in information for B
+    B->storage_type = Magma_CSR;
+    B->memory_location = A.memory_location;
+    B->fill_mode = A.fill_mode;
+    B->num_rows = A.num_rows; B->true_nnz = A.true_nnz;
+    B->num_cols = A.num_cols;
+    B->max_nnz_row = A.max_nnz_row;
+    B->diameter = A.diameter;
+
+    CHECK( magma_index_malloc_cpu( &B->row, n+1 ));
+    B->row[0] = 0;
+    #pragma omp parallel for
+    for( magma_int_t p=0; p < n; p++ ) {
+        magma_int_t s = p / C, j = p % C;
+        magma_int_t width = ( A.row[s+1] - A.row[s] ) / C;
+        magma_index_t count = 0;
+        for( magma_int_t k=0; k < width; k++ ) {
+            if ( ! MAGMA_Z_EQUAL( A.val[ A.row[s] + k*C + j ], zero ) ) {
+                count++;
+            }
+        }
+        B->row[ A.rowidx[p]+1 ] = count;
+    }
+    CHECK( magma_zmatrix_createrowptr( n, B->row, queue ));
+    B->nnz = B->row[n];
+    CHECK( magma_zmalloc_cpu( &B->val, max( B->nnz, 1 )));
+    CHECK( magma_index_malloc_cpu( &B->col, max( B->nnz, 1 )));
+
+    #pragma omp parallel for
+    for( magma_int_t p=0; p < n; p++ ) {
+        magma_int_t s = p / C, j = p % C;
+        magma_int_t width = ( A.row[s+1] - A.row[s] ) / C;
+        magma_index_t offset = B->row[ A.rowidx[p] ];
+        for( magma_int_t k=0; k < width; k++ ) {
+            magmaDoubleComplex v = A.val[ A.row[s] + k*C + j ];
+            if ( ! MAGMA_Z_EQUAL( v, zero ) ) {
+                B->val[offset] = v;
+                B->col[offset] = A.col[ A.row[s] + k*C + j ];
+                offset++;
+            }
+        }
+    }
+
+cleanup:
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Chooses the slice height C and the sorting window sigma of SELL-C-sigma
+    for a host CSR matrix.
+
+    The candidates for C are 1, 2 and 4 times the number of matrix elements
+    in one SIMD register of the host (AVX-512, AVX or SSE, as compiled),
+    the candidates for sigma are 1, 8C, 64C and 512C. For every pair, the
+    padded size is computed from the row lengths. The pairs with the
+    smallest padding are converted and timed with magma_zspmv_cpu, and
+    the fastest one is returned.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                Matrix in CSR located on the host.
+
+    @param[out]
+    C           magma_int_t*
+                Slice height.
+
+    @param[out]
+    sigma       magma_int_t*
+                Sorting window.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zsellcs_tune(
+    magma_z_matrix A,
+    magma_int_t *C,
+    magma_int_t *sigma,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    // number of candidates that are timed, and SpMVs per candidate
+    const magma_int_t num_timed = 3, num_runs = 5;
+
+    magma_int_t n = A.num_rows;
+    magma_int_t lanes = magma_zsellcs_lanes();
+    magma_index_t *len = NULL, *perm = NULL;
+    magma_z_matrix B={Magma_CSR}, x={Magma_CSR}, y={Magma_CSR};
+    magmaDoubleComplex c_one = MAGMA_Z_ONE, c_zero = MAGMA_Z_ZERO;
+    real_Double_t best = -1.0;
+    // candidate: padded size, C, sigma
+    std::vector< std::vector< magma_int_t > > cand;
+
+    *C = min( 4*lanes, 64 );
+    *sigma = 1;
+    if ( A.memory_location != Magma_CPU || A.storage_type != Magma_CSR ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    if ( n == 0 ) {
+        goto cleanup;
+    }
+
+    CHECK( magma_index_malloc_cpu( &len, n ));
+    CHECK( magma_index_malloc_cpu( &perm, n ));
+    #pragma omp parallel for
+    for( magma_int_t i=0; i < n; i++ ) {
+        len[i] = A.row[i+1] - A.row[i];
+    }
+    for( magma_int_t c=lanes; c <= min( 4*lanes, 64 ); c *= 2 ) {
+        magma_int_t windows[4] = { 1, 8*c, 64*c, 512*c };
+        for( magma_int_t w=0; w < 4; w++ ) {
+            magma_int_t s = min( windows[w], n );
+            if ( w > 0 && min( windows[w-1], n ) == s ) {
+                break;   // the previous window already covered all rows
+            }
+            magma_int_t size = 0;
+            magma_zsellcs_sort( n, s, len, perm );
+            #pragma omp parallel for reduction(+:size)
+            for( magma_int_t sl=0; sl < magma_ceildiv( n, c ); sl++ ) {
+                magma_index_t width = 0;
+                for( magma_int_t j=sl*c; j < min( (sl+1)*c, n ); j++ ) {
+                    width = max( width, len[ perm[j] ] );
+                }
+                size += width * c;
+            }
+            std::vector< magma_int_t > entry( 3 );
+            entry[0] = size;
+            entry[1] = c;
+            entry[2] = s;
+            cand.push_back( entry );
+        }
+    }
+    // smallest padding first, among equal sizes the smaller window
+    std::stable_sort( cand.begin(), cand.end(),
+        []( const std::vector< magma_int_t >& a, const std::vector< magma_int_t >& b )
+            { return a[0] < b[0]; } );
+
+    CHECK( magma_zvinit( &x, Magma_CPU, A.num_cols, 1, c_one, queue ));
+    CHECK( magma_zvinit( &y, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    for( magma_int_t t=0; t < min( num_timed, (magma_int_t) cand.size() ); t++ ) {
+        CHECK( magma_zcsr2sellcs( A, cand[t][1], cand[t][2], &B, queue ));
+        CHECK( magma_zspmv_cpu( c_one, B, x, c_zero, y, queue ));   // warmup
+        real_Double_t tmin = -1.0;
+        for( magma_int_t r=0; r < num_runs; r++ ) {
+            real_Double_t start = magma_wtime();
+            CHECK( magma_zspmv_cpu( c_one, B, x, c_zero, y, queue ));
+            real_Double_t time = magma_wtime() - start;
+            tmin = ( tmin < 0.0 || time < tmin ) ? time : tmin;
+        }
+        if ( best < 0.0 || tmin < best ) {
+            best = tmin;
+            *C = cand[t][1];
+            *sigma = cand[t][2];
+        }
+        magma_zmfree( &B, queue );
+    }
+
+cleanup:
+    magma_zmfree( &B, queue );
+    magma_zmfree( &x, queue );
+    magma_zmfree( &y, queue );
+    magma_free_cpu( len );
+    magma_free_cpu( perm );
+    return info;
+}
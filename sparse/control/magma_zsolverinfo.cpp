@@ -606,6 +606,20 @@ magma_zsolverinfo_init(
     precond_par->L_dgraphindegree_bak = NULL;
     precond_par->U_dgraphindegree_bak = NULL;
 
+    precond_par->hL.val = NULL;
+    precond_par->hL.col = NULL;
+    precond_par->hL.row = NULL;
+    precond_par->hU.val = NULL;
+    precond_par->hU.col = NULL;
+    precond_par->hU.row = NULL;
+    precond_par->hd.val = NULL;
+    precond_par->Lplan.level_ptr = NULL;
+    precond_par->Lplan.order = NULL;
+    precond_par->Lplan.diag_pos = NULL;
+    precond_par->Uplan.level_ptr = NULL;
+    precond_par->Uplan.order = NULL;
+    precond_par->Uplan.diag_pos = NULL;
+
 cleanup:
     if( info != 0 ){
         magma_free( solver_par->timing );
@@ -0,0 +1,290 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include "magmasparse_internal.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/***************************************************************************//**
+    Sweep plans.
+
+    A sweep of ParILU or ParIC updates every entry of the factors
+    from the matching entry of A and the sparse dot product of one row of L
+    with one column of U. As long as the nonzero pattern does not change,
+    the positions involved are the same in every sweep. A plan stores them
+    once, so a sweep only streams over the products.
+
+    Every entry e of the plan writes position target[e] of its factor. The
+    products of e are lidx[p], ridx[p] for ptr[e] <= p < ptr[e+1], in the
+    order in which the sweeps accumulate them. As in the sweeps, the last
+    product of the merge is left out if it is the entry itself.
+*******************************************************************************/
+
+
+// Merges lcol[li..lend-1] with rcol[ri..rend-1] the way the sweeps do.
+// Returns the number of products; their positions go to lout and rout if
+// those are not NULL. A match in the last step is dropped. On return, li and
+// ri are the final positions and rlast is ri at the start of the last step.
+static inline magma_int_t
+magma_zsweep_plan_merge(
+    const magma_index_t *lcol,
+    magma_int_t &li,
+    magma_int_t lend,
+    const magma_index_t *rcol,
+    magma_int_t &ri,
+    magma_int_t rend,
+    magma_int_t &rlast,
+    magma_index_t *lout,
+    magma_index_t *rout )
+{
+    magma_int_t num = 0;
+    magma_int_t pending = 0, pl = 0, pr = 0;
+    rlast = ri;
+    while( li < lend && ri < rend ){
+        rlast = ri;
+        if( pending ){
+            if( lout != NULL ){
+                lout[num] = pl;
+                rout[num] = pr;
+            }
+            num++;
+            pending = 0;
+        }
+        magma_index_t lc = lcol[li];
+        magma_index_t rc = rcol[ri];
+        if( lc == rc ){
+            pending = 1;
+            pl = li;
+            pr = ri;
+        }
+        li = ( lc <= rc ) ? li+1 : li;
+        ri = ( lc >= rc ) ? ri+1 : ri;
+    }
+    return num;
+}
+
+
+// Frees the arrays of plan and allocates them for num_entries entries.
+static magma_int_t
+magma_zsweep_plan_alloc(
+    magma_int_t num_entries,
+    magma_sweep_plan *plan,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    CHECK( magma_zsweep_plan_free( plan, queue ));
+    plan->num_entries = num_entries;
+    CHECK( magma_index_malloc_cpu( &plan->target, num_entries ));
+    CHECK( magma_index_malloc_cpu( &plan->aidx, num_entries ));
+    CHECK( magma_index_malloc_cpu( &plan->didx, num_entries ));
+    CHECK( magma_index_malloc_cpu( &plan->ptr, num_entries+1 ));
+
+cleanup:
+    return info;
+}
+
+
+// Turns the product counts in plan->ptr[1..num_entries] into the pointer
+// and allocates the product arrays.
+static magma_int_t
+magma_zsweep_plan_products(
+    magma_sweep_plan *plan,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    plan->ptr[0] = 0;
+    CHECK( magma_zmatrix_createrowptr( plan->num_entries, plan->ptr, queue ));
+    plan->num_products = plan->ptr[ plan->num_entries ];
+    CHECK( magma_index_malloc_cpu( &plan->lidx, plan->num_products ));
+    CHECK( magma_index_malloc_cpu( &plan->ridx, plan->num_products ));
+
+cleanup:
+    return info;
+}
+
+
+// ParILU and ParIC plan: one entry per entry of A, U is given as U^T in CSR.
+static magma_int_t
+magma_zsweep_plan_ilu(
+    magma_z_matrix A,
+    magma_z_matrix L,
+    magma_z_matrix U,
+    magma_sweep_plan *plan,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    CHECK( magma_zsweep_plan_alloc( A.nnz, plan, queue ));
+
+    #pragma omp parallel for
+    for( magma_int_t k=0; k < A.nnz; k++ ){
+        magma_index_t i = A.rowidx[k];
+        magma_index_t j = A.col[k];
+        magma_int_t il = L.row[i];
+        magma_int_t iu = U.row[j];
+        magma_int_t jold;
+        plan->ptr[k+1] = magma_zsweep_plan_merge(
+            L.col, il, L.row[i+1], U.col, iu, U.row[j+1], jold, NULL, NULL );
+    }
+    CHECK( magma_zsweep_plan_products( plan, queue ));
+
+    #pragma omp parallel for
+    for( magma_int_t k=0; k < A.nnz; k++ ){
+        magma_index_t i = A.rowidx[k];
+        magma_index_t j = A.col[k];
+        magma_int_t il = L.row[i];
+        magma_int_t iu = U.row[j];
+        magma_int_t jold;
+        magma_zsweep_plan_merge( L.col, il, L.row[i+1], U.col, iu, U.row[j+1],
+            jold, plan->lidx + plan->ptr[k], plan->ridx + plan->ptr[k] );
+        plan->aidx[k] = k;
+        if ( i > j ) {    // l entry
+            plan->target[k] = il-1;
+            plan->didx[k] = U.row[j+1]-1;
+        } else {          // u entry
+            plan->target[k] = iu-1;
+            plan->didx[k] = -1;
+        }
+    }
+
+cleanup:
+    if( info != 0 ){
+        magma_zsweep_plan_free( plan, queue );
+    }
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Creates the plan for magma_zparilu_sweep_plan. The plan stays valid as
+    long as the nonzero patterns of A, L and U do not change.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                System matrix in COO.
+
+    @param[in]
+    L           magma_z_matrix
+                Lower triangular factor in sorted CSR.
+
+    @param[in]
+    U           magma_z_matrix
+                Upper triangular factor in sorted CSC (U^T in CSR).
+
+    @param[in,out]
+    plan        magma_sweep_plan*
+                Sweep plan. Any previous content is freed.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zparilu_plan_create(
+    magma_z_matrix A,
+    magma_z_matrix L,
+    magma_z_matrix U,
+    magma_sweep_plan *plan,
+    magma_queue_t queue )
+{
+    return magma_zsweep_plan_ilu( A, L, U, plan, queue );
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Creates the plan for magma_zparic_sweep_plan. The plan stays valid as
+    long as the nonzero patterns of A and L do not change.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                System matrix in COO.
+
+    @param[in]
+    L           magma_z_matrix
+                Lower triangular factor in sorted CSR.
+
+    @param[in,out]
+    plan        magma_sweep_plan*
+                Sweep plan. Any previous content is freed.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zparic_plan_create(
+    magma_z_matrix A,
+    magma_z_matrix L,
+    magma_sweep_plan *plan,
+    magma_queue_t queue )
+{
+    return magma_zsweep_plan_ilu( A, L, L, plan, queue );
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Frees the arrays of a sweep plan.
+
+    Arguments
+    ---------
+
+    @param[in,out]
+    plan        magma_sweep_plan*
+                Sweep plan.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zsweep_plan_free(
+    magma_sweep_plan *plan,
+    magma_queue_t queue )
+{
+    magma_free_cpu( plan->target );
+    magma_free_cpu( plan->aidx );
+    magma_free_cpu( plan->didx );
+    magma_free_cpu( plan->ptr );
+    magma_free_cpu( plan->lidx );
+    magma_free_cpu( plan->ridx );
+    plan->target = NULL;
+    plan->aidx = NULL;
+    plan->didx = NULL;
+    plan->ptr = NULL;
+    plan->lidx = NULL;
+    plan->ridx = NULL;
+    plan->num_entries = 0;
+    plan->num_products = 0;
+    return MAGMA_SUCCESS;
+}
@@ -0,0 +1,188 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include "magmasparse_internal.h"
+
+
+/***************************************************************************//**
+    Triangular solve plans.
+
+    Row i of a lower triangular matrix can be solved as soon as all rows j < i
+    with an entry (i,j) are solved, for an upper triangular matrix the same
+    holds for j > i. The level of a row is one more than the highest level of
+    the rows it depends on, rows without dependencies are on level 0. All rows
+    of one level can be solved at the same time.
+
+    The plan lists the rows sorted by level, so order[] is also a valid
+    sequential order of the solve. Entries on the other side of the diagonal
+    are ignored, so the plan can be created for the triangle of a general
+    matrix.
+*******************************************************************************/
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Creates the level sets of the lower or upper triangle of T for the host
+    triangular solves magma_ztrisolve_cpu and magma_ztrisolve_syncfree_cpu.
+    The plan stays valid as long as the nonzero pattern of T does not change.
+
+    Arguments
+    ---------
+
+    @param[in]
+    uplo        magma_uplo_t
+                MagmaLower or MagmaUpper: triangle of T used in the solve.
+
+    @param[in]
+    diag        magma_diag_t
+                MagmaUnit: the diagonal is one and stored diagonal entries are
+                ignored. MagmaNonUnit: every row needs a diagonal entry.
+
+    @param[in]
+    T           magma_z_matrix
+                Triangular matrix in CSR located on the host.
+
+    @param[in,out]
+    plan        magma_trisolve_plan*
+                Triangular solve plan. Any previous content is freed.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_ztrisolve_plan_create(
+    magma_uplo_t uplo,
+    magma_diag_t diag,
+    magma_z_matrix T,
+    magma_trisolve_plan *plan,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+
+    magma_int_t n = T.num_rows;
+    magma_int_t num_levels = 0, max_width = 0;
+    magma_int_t missing = 0;
+    magma_index_t *level = NULL;
+
+    CHECK( magma_ztrisolve_plan_free( plan, queue ));
+    if ( T.memory_location != Magma_CPU || T.num_rows != T.num_cols ||
+         ( T.storage_type != Magma_CSR    &&
+           T.storage_type != Magma_CSRL   &&
+           T.storage_type != Magma_CSRU   &&
+           T.storage_type != Magma_CUCSR  &&
+           T.storage_type != Magma_CSRCOO ) ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    plan->num_rows = n;
+    plan->uplo = uplo;
+    plan->diag = diag;
+    CHECK( magma_index_malloc_cpu( &level, max( n, 1 )));
+    CHECK( magma_index_malloc_cpu( &plan->order, max( n, 1 )));
+    CHECK( magma_index_malloc_cpu( &plan->diag_pos, max( n, 1 )));
+
+    // the level recurrence runs in the order of the solve
+    for( magma_int_t r=0; r < n; r++ ) {
+        magma_index_t i = ( uplo == MagmaLower ) ? r : n-1-r;
+        magma_index_t lev = 0;
+        plan->diag_pos[i] = -1;
+        for( magma_index_t k=T.row[i]; k < T.row[i+1]; k++ ) {
+            magma_index_t j = T.col[k];
+            if ( j == i ) {
+                plan->diag_pos[i] = k;
+            } else if ( ( uplo == MagmaLower ) ? j < i : j > i ) {
+                lev = max( lev, level[j]+1 );
+            }
+        }
+        level[i] = lev;
+        num_levels = max( num_levels, lev+1 );
+        if ( plan->diag_pos[i] < 0 ) {
+            missing++;
+        }
+    }
+    if ( diag == MagmaNonUnit && missing > 0 ) {
+        printf("%% error: %d rows without diagonal entry.\n", int(missing) );
+        info = MAGMA_ERR_BADPRECOND;
+        goto cleanup;
+    }
+
+    // counting sort of the rows by level, stable inside a level
+    plan->num_levels = num_levels;
+    CHECK( magma_index_malloc_cpu( &plan->level_ptr, num_levels+1 ));
+    for( magma_int_t l=0; l <= num_levels; l++ ) {
+        plan->level_ptr[l] = 0;
+    }
+    for( magma_int_t i=0; i < n; i++ ) {
+        plan->level_ptr[ level[i]+1 ]++;
+    }
+    for( magma_int_t l=0; l < num_levels; l++ ) {
+        max_width = max( max_width, plan->level_ptr[l+1] );
+        plan->level_ptr[l+1] += plan->level_ptr[l];
+    }
+    plan->max_width = max_width;
+    for( magma_int_t r=0; r < n; r++ ) {
+        magma_index_t i = ( uplo == MagmaLower ) ? r : n-1-r;
+        plan->order[ plan->level_ptr[ level[i] ]++ ] = i;
+    }
+    // the scatter moved every pointer to the start of the next level
+    for( magma_int_t l=num_levels; l > 0; l-- ) {
+        plan->level_ptr[l] = plan->level_ptr[l-1];
+    }
+    plan->level_ptr[0] = 0;
+
+cleanup:
+    magma_free_cpu( level );
+    if( info != 0 ){
+        magma_ztrisolve_plan_free( plan, queue );
+    }
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    Frees the arrays of a triangular solve plan.
+
+    Arguments
+    ---------
+
+    @param[in,out]
+    plan        magma_trisolve_plan*
+                Triangular solve plan.
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_ztrisolve_plan_free(
+    magma_trisolve_plan *plan,
+    magma_queue_t queue )
+{
+    magma_free_cpu( plan->level_ptr );
+    magma_free_cpu( plan->order );
+    magma_free_cpu( plan->diag_pos );
+    plan->level_ptr = NULL;
+    plan->order = NULL;
+    plan->diag_pos = NULL;
+    plan->num_rows = 0;
+    plan->num_levels = 0;
+    plan->max_width = 0;
+    return MAGMA_SUCCESS;
+}
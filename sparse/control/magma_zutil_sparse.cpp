@@ -36,12 +36,19 @@ static const char *usage_sparse =
 " --maxiter x   Set an upper limit for the iteration count.\n"
 " --rtol x      Set a relative residual stopping criterion.\n"
 " --format      Possibility to choose a format for the sparse matrix:\n"
-"               CSR, ELL, SELLP, CUSPARSECSR, CSR5.\n"
+"               CSR, ELL, SELLP, CUSPARSECSR, CSR5, CSRSYM (host),\n"
+"               CSRMP (host, values in --mpformat).\n"
+" --mpformat    Precision of the CSRMP values: FLOAT (default), HALF, BFLOAT16.\n"
 " --blocksize x Set a specific blocksize for SELL-P format.\n"
 " --alignment x Set a specific alignment for SELL-P format.\n"
 " --mscale      Possibility to scale the original matrix:\n"
 "               NOSCALE   no scaling\n"
 "               UNITDIAG   symmetric scaling to unit diagonal\n"
+" --reorder     Possibility to reorder the original matrix symmetrically:\n"
+"               NONE   no reordering\n"
+"               RCM    reverse Cuthill-McKee (bandwidth)\n"
+"               AMD    approximate minimum degree (fill)\n"
+"               ND     nested dissection (graph partitioning)\n"
 " --precond x   Possibility to choose a preconditioner:\n"
 "               CG, BICGSTAB, GMRES, LOBPCG, JACOBI,\n"
 "               BAITER, IDR, CGS, TFQMR, QMR, BICG\n"
@@ -111,9 +118,11 @@ magma_zparse_opts(
     opts->blocksize = 32;
     opts->alignment = 1;
     opts->output_format = Magma_CSR;
+    opts->mp_format = Magma_FLOAT;
     opts->input_location = Magma_CPU;
     opts->output_location = Magma_CPU;
     opts->scaling = Magma_NOSCALE;
+    opts->reorder = Magma_NOREORDER;
     #if defined(PRECISION_z) | defined(PRECISION_d)
         opts->solver_par.atol = 1e-16;
         opts->solver_par.rtol = 1e-10;
@@ -163,6 +172,10 @@ magma_zparse_opts(
                 opts->output_format = Magma_CUCSR;
             } else if ( strcmp("CSR5", argv[i]) == 0 ) {
                 opts->output_format = Magma_CSR5;
+            } else if ( strcmp("CSRSYM", argv[i]) == 0 ) {
+                opts->output_format = Magma_CSRSYM;
+            } else if ( strcmp("CSRMP", argv[i]) == 0 ) {
+                opts->output_format = Magma_CSRMP;
             } else {
                 printf( "%%error: invalid format, use default (CSR).\n" );
             }
@@ -189,6 +202,23 @@ magma_zparse_opts(
             else {
                 printf( "%%error: invalid scaling, use default.\n" );
             }
+        } else if ( strcmp("--reorder", argv[i]) == 0 && i+1 < argc ) {
+            i++;
+            if ( strcmp("NONE", argv[i]) == 0 ) {
+                opts->reorder = Magma_NOREORDER;
+            }
+            else if ( strcmp("RCM", argv[i]) == 0 ) {
+                opts->reorder = Magma_RCM;
+            }
+            else if ( strcmp("AMD", argv[i]) == 0 ) {
+                opts->reorder = Magma_AMD;
+            }
+            else if ( strcmp("ND", argv[i]) == 0 ) {
+                opts->reorder = Magma_ND;
+            }
+            else {
+                printf( "%%error: invalid reordering, use default.\n" );
+            }
         } else if ( strcmp("--solver", argv[i]) == 0 && i+1 < argc ) {
             i++;
             if ( strcmp("CG", argv[i]) == 0 ) {
@@ -427,6 +457,17 @@ magma_zparse_opts(
             opts->blocksize = atoi( argv[++i] );
         } else if ( strcmp("--alignment", argv[i]) == 0 && i+1 < argc ) {
             opts->alignment = atoi( argv[++i] );
+        } else if ( strcmp("--mpformat", argv[i]) == 0 && i+1 < argc ) {
+            i++;
+            if ( strcmp("FLOAT", argv[i]) == 0 ) {
+                opts->mp_format = Magma_FLOAT;
+            } else if ( strcmp("HALF", argv[i]) == 0 ) {
+                opts->mp_format = Magma_HALF;
+            } else if ( strcmp("BFLOAT16", argv[i]) == 0 ) {
+                opts->mp_format = Magma_BFLOAT;
+            } else {
+                printf( "%%error: invalid CSRMP precision, use default (FLOAT).\n" );
+            }
         } else if ( strcmp("--verbose", argv[i]) == 0 && i+1 < argc ) {
             opts->solver_par.verbose = atoi( argv[++i] );
         }  else if ( strcmp("--maxiter", argv[i]) == 0 && i+1 < argc ) {
@@ -5,9 +5,16 @@
 *
 *
 */
+#include <limits.h>
+
 #include "magmasparse_internal.h"
 #include "magmasparse_mmio.h"
 
+#if ! defined( _WIN32 ) && ! defined( _WIN64 )
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 int mm_read_unsymmetric_sparse(
     const char *fname, 
     magma_index_t *M_, 
@@ -541,3 +548,315 @@ void mm_snprintf_typecode( char *buffer, size_t buflen, MM_typecode matcode )
 
     snprintf( buffer, buflen, "%s %s %s %s", types[0], types[1], types[2], types[3] );
 }
+
+
+/******************************************************************/
+/* block-wise access to the data section, used by the parallel    */
+/* readers instead of one fscanf per entry                        */
+/******************************************************************/
+
+/*  Maps everything behind the current position of f into memory.
+    f must have been opened for reading and positioned after the size
+    line, e.g., by mm_read_mtx_crd_size. Falls back to reading the data
+    section into a buffer if the file cannot be mapped.                  */
+int mm_map_data(FILE *f, mm_data *d)
+{
+    long offset;
+    size_t total;
+
+    d->data = NULL;
+    d->size = 0;
+    d->map = NULL;
+    d->map_size = 0;
+
+    offset = ftell(f);
+    if (offset < 0)
+        return MM_COULD_NOT_READ_FILE;
+
+#if ! defined( _WIN32 ) && ! defined( _WIN64 )
+    struct stat st;
+    if (fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode)) {
+        total = (size_t) st.st_size;
+        if ((size_t) offset >= total)
+            return 0;
+        void *map = mmap(NULL, total, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+        if (map != MAP_FAILED) {
+            madvise(map, total, MADV_SEQUENTIAL);
+            d->map = map;
+            d->map_size = total;
+            d->data = (const char*) map + offset;
+            d->size = total - offset;
+            return 0;
+        }
+    }
+#endif
+
+    /* no mapping: read the rest of the file in large blocks */
+    size_t capacity = 1 << 24, block;
+    char *buffer = NULL, *tmp;
+    total = 0;
+    do {
+        if (total == capacity || buffer == NULL) {
+            capacity = (buffer == NULL) ? capacity : 2*capacity;
+            tmp = (char*) realloc(buffer, capacity);
+            if (tmp == NULL) {
+                free(buffer);
+                return MM_COULD_NOT_READ_FILE;
+            }
+            buffer = tmp;
+        }
+        block = fread(buffer + total, 1, capacity - total, f);
+        total += block;
+    } while (block > 0);
+
+    d->map = buffer;
+    d->data = buffer;
+    d->size = total;
+    return 0;
+}
+
+void mm_unmap_data(mm_data *d)
+{
+#if ! defined( _WIN32 ) && ! defined( _WIN64 )
+    if (d->map_size > 0)
+        munmap(d->map, d->map_size);
+    else
+#endif
+        free(d->map);
+    d->data = NULL;
+    d->size = 0;
+    d->map = NULL;
+    d->map_size = 0;
+}
+
+/*  Prepares reading the data section behind the current position of f
+    in blocks of at most capacity bytes. Lines must be shorter than
+    capacity.                                                            */
+int mm_stream_open(FILE *f, size_t capacity, mm_stream *s)
+{
+    s->f = f;
+    s->offset = ftell(f);
+    s->buffer = NULL;
+    s->capacity = capacity;
+    s->fill = 0;
+    s->used = 0;
+    s->eof = 0;
+    if (s->offset < 0 || capacity < MM_MAX_LINE_LENGTH)
+        return MM_COULD_NOT_READ_FILE;
+    s->buffer = (char*) malloc(capacity);
+    if (s->buffer == NULL)
+        return MM_COULD_NOT_READ_FILE;
+    return 0;
+}
+
+/*  Returns the next block of complete lines in data and size. At the end
+    of the data section, size is 0.                                      */
+int mm_stream_next(mm_stream *s, const char **data, size_t *size)
+{
+    size_t block;
+
+    /* keep the incomplete line of the previous block */
+    memmove(s->buffer, s->buffer + s->used, s->fill - s->used);
+    s->fill -= s->used;
+    s->used = 0;
+    while (! s->eof && s->fill < s->capacity) {
+        block = fread(s->buffer + s->fill, 1, s->capacity - s->fill, s->f);
+        s->fill += block;
+        if (block == 0)
+            s->eof = 1;
+    }
+    if (s->eof) {
+        s->used = s->fill;
+    } else {
+        const char *nl = s->buffer + s->fill;
+        while (nl > s->buffer && nl[-1] != '\n')
+            nl--;
+        if (nl == s->buffer)
+            return MM_LINE_TOO_LONG;
+        s->used = nl - s->buffer;
+    }
+    *data = s->buffer;
+    *size = s->used;
+    return 0;
+}
+
+/*  Restarts at the beginning of the data section. */
+int mm_stream_rewind(mm_stream *s)
+{
+    s->fill = 0;
+    s->used = 0;
+    s->eof = 0;
+    if (fseek(s->f, s->offset, SEEK_SET) != 0)
+        return MM_COULD_NOT_READ_FILE;
+    return 0;
+}
+
+void mm_stream_close(mm_stream *s)
+{
+    free(s->buffer);
+    s->buffer = NULL;
+    s->capacity = 0;
+    s->fill = 0;
+    s->used = 0;
+}
+
+/*  Returns the first byte after the next newline, or end. */
+const char *mm_next_line(const char *p, const char *end)
+{
+    const char *nl = (const char*) memchr(p, '\n', end - p);
+    return (nl == NULL) ? end : nl + 1;
+}
+
+/*  Splits data into parts chunks of about the same size whose borders
+    fall on line starts. Chunk k is [bounds[k], bounds[k+1]).           */
+void mm_split_lines(const char *data, size_t size, int parts, size_t bounds[])
+{
+    bounds[0] = 0;
+    for (int k = 1; k < parts; k++) {
+        size_t b = (size / parts) * k;
+        if (b <= bounds[k-1])
+            b = bounds[k-1];
+        else if (b > 0 && data[b-1] != '\n')
+            b = mm_next_line(data + b, data + size) - data;
+        bounds[k] = b;
+    }
+    bounds[parts] = size;
+}
+
+/*  Counts the non-blank lines in [begin, end), i.e., the entries. */
+size_t mm_count_entries(const char *begin, const char *end)
+{
+    size_t count = 0;
+    const char *p = begin;
+    while (p < end) {
+        const char *eol = mm_next_line(p, end);
+        for (const char *c = p; c < eol; c++) {
+            if (*c != ' ' && *c != '\t' && *c != '\r' && *c != '\n') {
+                count++;
+                break;
+            }
+        }
+        p = eol;
+    }
+    return count;
+}
+
+static inline const char *mm_skip_blanks(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p;
+}
+
+/*  Parses a decimal integer at *p, skipping leading blanks.
+    On success, advances *p behind the number and returns 0. Numbers
+    whose magnitude does not fit in magma_index_t (int) are rejected
+    with MM_INDEX_OVERFLOW instead of wrapping around.                  */
+int mm_parse_index(const char **p, const char *end, magma_index_t *v)
+{
+    const char *s = mm_skip_blanks(*p, end);
+    int64_t x = 0;
+    int neg = 0, digits = 0;
+
+    if (s < end && (*s == '+' || *s == '-')) {
+        neg = (*s == '-');
+        s++;
+    }
+    while (s < end && *s >= '0' && *s <= '9') {
+        x = 10*x + (*s - '0');
+        if (x > INT_MAX)
+            return MM_INDEX_OVERFLOW;
+        s++;
+        digits++;
+    }
+    if (digits == 0)
+        return MM_PREMATURE_EOF;
+
+    *v = (magma_index_t) (neg ? -x : x);
+    *p = s;
+    return 0;
+}
+
+/*  Parses a floating point number at *p, skipping leading blanks.
+    Numbers with at most 19 significant digits whose mantissa fits in
+    53 bits and whose decimal exponent is at most 22 in magnitude are
+    converted with a single, correctly rounded multiplication or
+    division, independent of the locale. Everything else, e.g., long
+    mantissas, large exponents, inf or nan, goes through strtod, so the
+    result is always identical to what fscanf("%lf") returns.           */
+int mm_parse_double(const char **p, const char *end, double *v)
+{
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char *s = mm_skip_blanks(*p, end);
+    const char *tok = s;
+    uint64_t mant = 0;
+    int neg = 0, digits = 0, any = 0, exp10 = 0;
+
+    if (s < end && (*s == '+' || *s == '-')) {
+        neg = (*s == '-');
+        s++;
+    }
+    for (; s < end && *s >= '0' && *s <= '9'; s++) {
+        any = 1;
+        if (mant != 0 || *s != '0')
+            digits++;
+        mant = 10*mant + (*s - '0');
+    }
+    if (s < end && *s == '.') {
+        s++;
+        for (; s < end && *s >= '0' && *s <= '9'; s++) {
+            any = 1;
+            if (mant != 0 || *s != '0')
+                digits++;
+            mant = 10*mant + (*s - '0');
+            exp10--;
+        }
+    }
+    if (any && s < end && (*s == 'e' || *s == 'E')) {
+        const char *e = s + 1;
+        int eneg = 0, edigits = 0, ex = 0;
+        if (e < end && (*e == '+' || *e == '-')) {
+            eneg = (*e == '-');
+            e++;
+        }
+        for (; e < end && *e >= '0' && *e <= '9'; e++) {
+            if (ex < 100000)
+                ex = 10*ex + (*e - '0');
+            edigits++;
+        }
+        if (edigits > 0) {
+            exp10 += eneg ? -ex : ex;
+            s = e;
+        }
+    }
+
+    int fast = any && digits <= 19 && mant <= ((uint64_t) 1 << 53)
+            && exp10 >= -22 && exp10 <= 22
+            && (s == end || *s == ' ' || *s == '\t' || *s == '\r' || *s == '\n');
+    if (fast) {
+        double x = (double) mant;
+        x = (exp10 < 0) ? x / pow10[-exp10] : x * pow10[exp10];
+        *v = neg ? -x : x;
+        *p = s;
+        return 0;
+    }
+
+    /* slow path, token copied as it may not be terminated */
+    char buf[ MM_MAX_LINE_LENGTH ];
+    size_t len = 0;
+    while (tok + len < end && len < sizeof(buf)-1
+           && tok[len] != ' ' && tok[len] != '\t'
+           && tok[len] != '\r' && tok[len] != '\n')
+        len++;
+    memcpy(buf, tok, len);
+    buf[len] = '\0';
+    char *stop;
+    *v = strtod(buf, &stop);
+    if (stop == buf)
+        return MM_PREMATURE_EOF;
+    *p = tok + (stop - buf);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       Binary container for CSR matrices.
+
+       Layout of a container file, all sections 64-byte aligned:
+
+           offset 0            magma_bio_header (128 bytes)
+           row_offset          row pointer,    (num_rows+1) * index_size bytes
+           col_offset          column indices,  nnz * index_size bytes
+           val_offset          values,          nnz * value size bytes
+
+       Integers are stored in the byte order of the writer; the endian tag
+       tells the reader whether it has to swap. Containers written with the
+       same index size, precision and byte order as the reader are mapped
+       into memory and used in place.
+*/
+#ifndef MAGMASPARSE_BIO_H
+#define MAGMASPARSE_BIO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "magma_v2.h"
+#include "magmasparse.h"
+
+#define MAGMA_BIO_MAGIC        "MAGMACSR"
+#define MAGMA_BIO_VERSION      1
+#define MAGMA_BIO_ENDIAN_TAG   0x01020304u
+#define MAGMA_BIO_ALIGN        64
+
+/* value types */
+#define MAGMA_BIO_S            0
+#define MAGMA_BIO_D            1
+#define MAGMA_BIO_C            2
+#define MAGMA_BIO_Z            3
+
+/* header flags */
+#define MAGMA_BIO_CHECKSUMS    0x1      /* section checksums are valid */
+
+typedef struct magma_bio_header
+{
+    char     magic[8];          /* MAGMA_BIO_MAGIC, not 0-terminated */
+    uint32_t version;           /* MAGMA_BIO_VERSION */
+    uint32_t endian;            /* MAGMA_BIO_ENDIAN_TAG in writer byte order */
+    uint32_t index_size;        /* 4 or 8 bytes */
+    uint32_t value_type;        /* MAGMA_BIO_S, _D, _C or _Z */
+    uint32_t flags;             /* MAGMA_BIO_CHECKSUMS */
+    int32_t  sym;               /* magma_symmetry_t of the matrix */
+    int32_t  fill_mode;         /* magma_uplo_t of the matrix */
+    uint32_t reserved0;
+    int64_t  num_rows;
+    int64_t  num_cols;
+    int64_t  nnz;
+    uint64_t row_offset;        /* byte offsets of the sections */
+    uint64_t col_offset;
+    uint64_t val_offset;
+    uint64_t row_checksum;      /* Fletcher-64 of each section */
+    uint64_t col_checksum;
+    uint64_t val_checksum;
+    uint64_t file_size;
+    uint64_t reserved1;
+} magma_bio_header;
+
+/* memory holding a whole container file */
+typedef struct magma_bio_map
+{
+    char   *base;               /* first byte of the file */
+    size_t  size;               /* bytes in the file */
+    int     mapped;             /* 1 if base is a mapping, 0 if malloc'ed */
+} magma_bio_map;
+
+size_t magma_bio_align( size_t offset );
+size_t magma_bio_value_size( uint32_t value_type );
+
+int magma_bio_is_container( const char *filename );
+int magma_bio_read_header( const void *data, size_t size,
+                           magma_bio_header *h, int *swapped );
+int magma_bio_check_header( const magma_bio_header *h, uint64_t file_size );
+
+uint64_t magma_bio_checksum( const void *data, size_t bytes );
+
+int  magma_bio_map_file( const char *filename, int writable, magma_bio_map *map );
+void magma_bio_unmap_file( magma_bio_map *map );
+
+/* zero-copy matrices keep their map in the mapping field of the matrix
+   structure. magma_bio_handle moves *map into a new handle for that
+   field (NULL if out of memory, *map is then unchanged), and
+   magma_bio_release unmaps and frees a handle; NULL is ignored.          */
+void *magma_bio_handle( magma_bio_map *map );
+void  magma_bio_release( void *handle );
+
+/* element access for containers that have to be converted */
+int64_t magma_bio_get_index( const void *section, size_t i,
+                             uint32_t index_size, int swapped );
+void    magma_bio_get_value( const void *section, size_t i,
+                             uint32_t value_type, int swapped,
+                             double *re, double *im );
+
+#endif /* MAGMASPARSE_BIO_H */
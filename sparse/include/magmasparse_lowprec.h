@@ -0,0 +1,150 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       Helpers for the host storage format Magma_CSRMP: CSR with values in
+       reduced precision and delta-encoded 16-bit column indices.
+
+       Values are stored per real component as float, as IEEE half
+       precision (fp16) or as bfloat16, see val_format of the matrix. The
+       16-bit formats are converted with plain bit manipulation, rounding
+       to nearest even, so no compiler or hardware support is needed.
+
+       Column indices are a stream of 16-bit words in mpcol, which shares
+       its storage with col, and rowidx[i] is the first word of row i. The columns of a row are sorted. The first
+       one is stored as zig-zag encoded distance to the diagonal, every
+       further one as distance to its predecessor. A word equal to
+       MAGMA_CSRMP_ESCAPE is followed by the column in two words, low
+       half first.
+*/
+#ifndef MAGMASPARSE_LOWPREC_H
+#define MAGMASPARSE_LOWPREC_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "magma_v2.h"
+#include "magmasparse.h"
+
+#define MAGMA_CSRMP_ESCAPE 0xFFFF
+
+
+/******************************************************************************/
+static inline float magma_half2float( uint16_t h )
+{
+    uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+    uint32_t exp  = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    uint32_t u;
+    float f;
+
+    if ( exp == 0x1F ) {                // inf, nan
+        u = sign | 0x7F800000 | (mant << 13);
+    } else if ( exp != 0 ) {            // normal
+        u = sign | ((exp + 112) << 23) | (mant << 13);
+    } else if ( mant == 0 ) {           // zero
+        u = sign;
+    } else {                            // subnormal, normalize
+        exp = 113;
+        while ( ! (mant & 0x400) ) {
+            mant <<= 1;
+            exp--;
+        }
+        u = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+    }
+    memcpy( &f, &u, sizeof(f) );
+    return f;
+}
+
+
+/******************************************************************************/
+static inline uint16_t magma_float2half( float f )
+{
+    uint32_t u, absu, sign, h, rem;
+    memcpy( &u, &f, sizeof(u) );
+    sign = (u >> 16) & 0x8000;
+    absu = u & 0x7FFFFFFF;
+
+    if ( absu >= 0x7F800000 ) {         // inf, nan stays nan
+        return (uint16_t) (sign | 0x7C00 | (absu > 0x7F800000 ? 0x200 : 0));
+    }
+    if ( absu >= 0x477FF000 ) {         // rounds to inf
+        return (uint16_t) (sign | 0x7C00);
+    }
+    if ( absu < 0x38800000 ) {          // subnormal or zero in half
+        if ( absu <= 0x33000000 ) {     // at most half of the smallest subnormal
+            return (uint16_t) sign;
+        }
+        uint32_t shift = 126 - (absu >> 23);
+        uint32_t m = (absu & 0x7FFFFF) | 0x800000;
+        h = m >> shift;
+        rem = m & ((1u << shift) - 1);
+        if ( rem > (1u << (shift-1)) || ( rem == (1u << (shift-1)) && (h & 1) ) ) {
+            h++;
+        }
+        return (uint16_t) (sign | h);
+    }
+    h = (absu - 0x38000000) >> 13;      // rebias the exponent
+    rem = absu & 0x1FFF;
+    if ( rem > 0x1000 || ( rem == 0x1000 && (h & 1) ) ) {
+        h++;                            // may carry into the exponent
+    }
+    return (uint16_t) (sign | h);
+}
+
+
+/******************************************************************************/
+static inline float magma_bfloat2float( uint16_t b )
+{
+    uint32_t u = (uint32_t) b << 16;
+    float f;
+    memcpy( &f, &u, sizeof(f) );
+    return f;
+}
+
+
+/******************************************************************************/
+static inline uint16_t magma_float2bfloat( float f )
+{
+    uint32_t u;
+    memcpy( &u, &f, sizeof(u) );
+    if ( (u & 0x7FFFFFFF) > 0x7F800000 ) {   // nan stays nan
+        return (uint16_t) ((u >> 16) | 0x40);
+    }
+    u += 0x7FFF + ((u >> 16) & 1);
+    return (uint16_t) (u >> 16);
+}
+
+
+/******************************************************************************/
+// Bytes of one real component of a value stored in format val_format.
+static inline magma_int_t magma_csrmp_component_size( magma_precision val_format )
+{
+    return ( val_format == Magma_HALF || val_format == Magma_BFLOAT ) ? 2 : 4;
+}
+
+
+/******************************************************************************/
+// Reads the next column of a row from the index stream at *p; prev is the
+// previous column of the row, or the row index for its first column.
+static inline magma_index_t magma_csrmp_next_col(
+    const uint16_t **p, magma_index_t prev, int first )
+{
+    uint16_t w = *(*p)++;
+    if ( w == MAGMA_CSRMP_ESCAPE ) {
+        uint32_t c = (uint32_t) (*p)[0] | ((uint32_t) (*p)[1] << 16);
+        *p += 2;
+        return (magma_index_t) c;
+    }
+    if ( first ) {
+        // zig-zag: 0, -1, 1, -2, 2, ... are stored as 0, 1, 2, 3, 4, ...
+        return prev + ( (w & 1) ? -(magma_index_t) ((w + 1) >> 1)
+                                :  (magma_index_t) (w >> 1) );
+    }
+    return prev + w;
+}
+
+#endif // MAGMASPARSE_LOWPREC_H
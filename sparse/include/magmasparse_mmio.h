@@ -89,6 +89,7 @@ int mm_is_valid(MM_typecode matcode);    /* too complex for a macro */
 #define MM_UNSUPPORTED_TYPE    15
 #define MM_LINE_TOO_LONG    16
 #define MM_COULD_NOT_WRITE_FILE  17
+#define MM_INDEX_OVERFLOW  18
 
 
 /******************** Matrix Market internal definitions ********************
@@ -141,5 +142,50 @@ int mm_read_unsymmetric_sparse(const char *fname, magma_index_t *M_,
         double **val_, magma_index_t **I_, magma_index_t **J_);
 
 
+/********************* block-wise data section access ***********************/
+
+/*  The data section of a file (everything after the size line) is mapped
+    into memory, or read into one buffer where mapping is not available,
+    and then parsed in parallel by splitting it at line boundaries.        */
+
+typedef struct mm_data
+{
+    const char *data;       /* first byte of the data section */
+    size_t      size;       /* bytes in the data section */
+    void       *map;        /* mapping or buffer backing data */
+    size_t      map_size;   /* bytes mapped, 0 if map is a malloc'ed buffer */
+} mm_data;
+
+int mm_map_data(FILE *f, mm_data *d);
+void mm_unmap_data(mm_data *d);
+
+void mm_split_lines(const char *data, size_t size, int parts, size_t bounds[]);
+size_t mm_count_entries(const char *begin, const char *end);
+const char *mm_next_line(const char *p, const char *end);
+
+int mm_parse_index(const char **p, const char *end, magma_index_t *v);
+int mm_parse_double(const char **p, const char *end, double *v);
+
+/*  For files larger than memory, the data section can instead be read in
+    blocks of bounded size. Every block ends at a line boundary, the
+    incomplete last line is carried over into the next block.             */
+
+typedef struct mm_stream
+{
+    FILE       *f;
+    long        offset;     /* file offset of the data section */
+    char       *buffer;     /* block buffer */
+    size_t      capacity;   /* bytes in buffer */
+    size_t      fill;       /* valid bytes in buffer */
+    size_t      used;       /* bytes handed out with the last block */
+    int         eof;
+} mm_stream;
+
+int mm_stream_open(FILE *f, size_t capacity, mm_stream *s);
+int mm_stream_next(mm_stream *s, const char **data, size_t *size);
+int mm_stream_rewind(mm_stream *s);
+void mm_stream_close(mm_stream *s);
+
+
 
 #endif
@@ -93,6 +93,7 @@ typedef struct magma_z_matrix
     magma_int_t        diameter;                // opt: max distance of entry from main diagonal
     magma_int_t        true_nnz;              // opt: true nnz
     magma_bool_t       ownership;               // does MAGMA own the arrays of this matrix structure
+    void               *mapping;                // opt: binary container mapping the arrays point into, released by mfree
     union {
         magmaDoubleComplex      *val;           // array containing values in CPU case
         magmaDoubleComplex_ptr  dval;           // array containing values in DEV case
@@ -112,6 +113,7 @@ typedef struct magma_z_matrix
     union {
         magma_index_t           *col;           // opt: array containing col indices CPU case
         magmaIndex_ptr          dcol;           // opt: array containing col indices DEV case
+        uint16_t                *mpcol;         // opt: CSRMP delta-encoded column stream CPU case
     };
     union {
         magma_index_t           *list;          // opt: linked list pointing to next element
@@ -150,6 +152,7 @@ typedef struct magma_z_matrix
     magma_index_t      csr5_tail_tile_start;    // opt: info for CSR5
     magma_order_t      major;                   // opt: row/col major for dense matrices
     magma_int_t        ld;                      // opt: leading dimension for dense
+    magma_precision    val_format;              // opt: precision of the values for CSRMP
 } magma_z_matrix;
 
 typedef struct magma_c_matrix
@@ -166,6 +169,7 @@ typedef struct magma_c_matrix
     magma_int_t        diameter;                // opt: max distance of entry from main diagonal
     magma_int_t        true_nnz;              // opt: true nnz
     magma_bool_t       ownership;               // does MAGMA own the arrays of this matrix structure
+    void               *mapping;                // opt: binary container mapping the arrays point into, released by mfree
     union {
         magmaFloatComplex       *val;           // array containing values in CPU case
         magmaFloatComplex_ptr   dval;           // array containing values in DEV case
@@ -185,6 +189,7 @@ typedef struct magma_c_matrix
     union {
         magma_index_t           *col;           // array containing col indices CPU case
         magmaIndex_ptr          dcol;           // array containing col indices DEV case
+        uint16_t                *mpcol;         // opt: CSRMP delta-encoded column stream CPU case
     };
     union {
         magma_index_t           *list;          // opt: linked list pointing to next element
@@ -223,6 +228,7 @@ typedef struct magma_c_matrix
     magma_index_t      csr5_tail_tile_start;    // opt: info for CSR5
     magma_order_t      major;                   // opt: row/col major for dense matrices
     magma_int_t        ld;                      // opt: leading dimension for dense
+    magma_precision    val_format;              // opt: precision of the values for CSRMP
 } magma_c_matrix;
 
 
@@ -240,6 +246,7 @@ typedef struct magma_d_matrix
     magma_int_t        diameter;                // opt: max distance of entry from main diagonal
     magma_int_t        true_nnz;              // opt: true nnz
     magma_bool_t       ownership;               // does MAGMA own the arrays of this matrix structure
+    void               *mapping;                // opt: binary container mapping the arrays point into, released by mfree
     union {
         double                  *val;           // array containing values in CPU case
         magmaDouble_ptr         dval;           // array containing values in DEV case
@@ -259,6 +266,7 @@ typedef struct magma_d_matrix
     union {
         magma_index_t           *col;           // array containing col indices CPU case
         magmaIndex_ptr          dcol;           // array containing col indices DEV case
+        uint16_t                *mpcol;         // opt: CSRMP delta-encoded column stream CPU case
     };
     union {
         magma_index_t           *list;          // opt: linked list pointing to next element
@@ -297,6 +305,7 @@ typedef struct magma_d_matrix
     magma_index_t      csr5_tail_tile_start;    // opt: info for CSR5
     magma_order_t      major;                   // opt: row/col major for dense matrices
     magma_int_t        ld;                      // opt: leading dimension for dense
+    magma_precision    val_format;              // opt: precision of the values for CSRMP
 } magma_d_matrix;
 
 
@@ -314,6 +323,7 @@ typedef struct magma_s_matrix
     magma_int_t        diameter;                // opt: max distance of entry from main diagonal
     magma_int_t        true_nnz;              // opt: true nnz
     magma_bool_t       ownership;               // does MAGMA own the arrays of this matrix structure
+    void               *mapping;                // opt: binary container mapping the arrays point into, released by mfree
     union {
         float                   *val;           // array containing values in CPU case
         magmaFloat_ptr          dval;           // array containing values in DEV case
@@ -333,6 +343,7 @@ typedef struct magma_s_matrix
     union {
         magma_index_t           *col;           // opt: array containing col indices CPU case
         magmaIndex_ptr          dcol;           // opt: array containing col indices DEV case
+        uint16_t                *mpcol;         // opt: CSRMP delta-encoded column stream CPU case
     };
     union {
         magma_index_t           *list;          // opt: linked list pointing to next element
@@ -371,6 +382,7 @@ typedef struct magma_s_matrix
     magma_index_t      csr5_tail_tile_start;    // opt: info for CSR5
     magma_order_t      major;                   // opt: row/col major for dense matrices
     magma_int_t        ld;                      // opt: leading dimension for dense
+    magma_precision    val_format;              // opt: precision of the values for CSRMP
 } magma_s_matrix;
 
 
@@ -442,6 +454,80 @@ typedef struct magma_s_vector
 */
 
 
+//*****************     sweep plans     **************************************//
+
+// Positions touched by one sweep of ParILU or ParIC for a fixed
+// nonzero pattern. Only indices are stored, so one plan type serves all
+// precisions.
+typedef struct magma_sweep_plan
+{
+    magma_int_t        num_entries;             // number of updated entries
+    magma_int_t        num_products;            // number of products of all entries
+    magma_index_t      *target;                 // position of the entry in its factor
+    magma_index_t      *aidx;                   // position of the A entry
+    magma_index_t      *didx;                   // position of the divisor, -1 if none
+    magma_index_t      *ptr;                    // products of entry e are ptr[e]..ptr[e+1]-1
+    magma_index_t      *lidx;                   // position of the left factor of a product
+    magma_index_t      *ridx;                   // position of the right factor of a product
+} magma_sweep_plan;
+
+
+// Level sets of a sparse triangular matrix for the host triangular solves.
+// Rows in one level only depend on rows in earlier levels. Only indices are
+// stored, so one plan type serves all precisions.
+typedef struct magma_trisolve_plan
+{
+    magma_int_t        num_rows;                // number of rows
+    magma_uplo_t       uplo;                    // MagmaLower or MagmaUpper
+    magma_diag_t       diag;                    // MagmaUnit ignores stored diagonal entries
+    magma_int_t        num_levels;              // number of levels
+    magma_int_t        max_width;               // rows in the widest level
+    magma_index_t      *level_ptr;              // level l is order[level_ptr[l]..level_ptr[l+1]-1]
+    magma_index_t      *order;                  // rows sorted by level
+    magma_index_t      *diag_pos;               // position of the diagonal entry, -1 if none
+} magma_trisolve_plan;
+
+
+// ParILUT candidates of the last step, kept so that the next step only
+// recomputes the rows whose inputs changed. Only indices are stored, so one
+// type serves all precisions. Zero-initialize before the first use.
+typedef struct magma_candidate_cache
+{
+    magma_int_t        num_rows;                // 0 until the first step
+    magma_int_t        l0_nnz;                  // nonzeros of L0 the cache was built for
+    magma_int_t        u0_nnz;                  // nonzeros of U0 the cache was built for
+    const magma_index_t *l0_row, *u0_row;       // row pointers of L0, U0 the cache was built for
+    uint64_t           l0_sum, u0_sum;          // checksums of the patterns of L0, U0
+    magma_index_t      *lrow, *lcol;            // pattern of L at the last step
+    magma_index_t      *urow, *ucol;            // pattern of U at the last step
+    magma_index_t      *crow_l, *ccol_l;        // candidates for L
+    magma_index_t      *crow_u, *ccol_u;        // candidates for U
+    magma_index_t      *corig_l, *corig_u;      // leading candidates of a row taken from L0, U0
+    magma_index_t      *flag;                   // scratch: rows of L and U that changed
+    magma_index_t      *owner, *offset;         // scratch: arena and position of a new row
+    magma_int_t        num_arenas;              // number of per-thread arenas
+    magma_index_t      **arena;                 // per-thread scratch, kept between steps
+    magma_int_t        *arena_size;             // capacity of every arena
+    magma_int_t        num_recomputed;          // rows recomputed in the last step
+} magma_candidate_cache;
+
+
+//*****************     fill statistics     **********************************//
+
+// Size of a symbolic ILU(k) pattern, known before L and U are allocated.
+typedef struct magma_fill_stats
+{
+    magma_int_t        levels;                  // fill level
+    magma_int_t        num_rows;                // number of rows
+    magma_int_t        nnz;                     // nonzeros of A
+    magma_int_t        nnz_l;                   // nonzeros of L, without the diagonal
+    magma_int_t        nnz_u;                   // nonzeros of U, with the diagonal
+    magma_int_t        max_row;                 // longest row of L+U
+    real_Double_t      fill_ratio;              // (nnz_l+nnz_u)/nnz
+    real_Double_t      memory;                  // bytes for L, U and the refilled A
+} magma_fill_stats;
+
+
 //*****************     solver parameters     ********************************//
 
 typedef struct magma_z_solver_par
@@ -658,6 +744,11 @@ typedef struct magma_z_preconditioner
     magma_index_t*            L_dgraphindegree_bak; // for sync-free trisolve
     magma_index_t*            U_dgraphindegree;     // for sync-free trisolve
     magma_index_t*            U_dgraphindegree_bak; // for sync-free trisolve
+    magma_z_matrix          hL;                   // host copy of L for the host trisolve
+    magma_z_matrix          hU;                   // host copy of U for the host trisolve
+    magma_trisolve_plan     Lplan;                // level sets of hL
+    magma_trisolve_plan     Uplan;                // level sets of hU
+    magma_z_matrix          hd;                   // host copy of d for the host Jacobi
     
     /* was merge conflict, assume master */
     magma_solve_info_t cuinfo;
@@ -719,6 +810,11 @@ typedef struct magma_c_preconditioner
     magma_index_t*            L_dgraphindegree_bak; // for sync-free trisolve
     magma_index_t*            U_dgraphindegree;     // for sync-free trisolve
     magma_index_t*            U_dgraphindegree_bak; // for sync-free trisolve
+    magma_c_matrix          hL;                   // host copy of L for the host trisolve
+    magma_c_matrix          hU;                   // host copy of U for the host trisolve
+    magma_trisolve_plan     Lplan;                // level sets of hL
+    magma_trisolve_plan     Uplan;                // level sets of hU
+    magma_c_matrix          hd;                   // host copy of d for the host Jacobi
     
 
     magma_solve_info_t cuinfo;
@@ -782,6 +878,11 @@ typedef struct magma_d_preconditioner
     magma_index_t*            L_dgraphindegree_bak; // for sync-free trisolve
     magma_index_t*            U_dgraphindegree;     // for sync-free trisolve
     magma_index_t*            U_dgraphindegree_bak; // for sync-free trisolve
+    magma_d_matrix          hL;                   // host copy of L for the host trisolve
+    magma_d_matrix          hU;                   // host copy of U for the host trisolve
+    magma_trisolve_plan     Lplan;                // level sets of hL
+    magma_trisolve_plan     Uplan;                // level sets of hU
+    magma_d_matrix          hd;                   // host copy of d for the host Jacobi
 
     magma_solve_info_t cuinfo;
     magma_solve_info_t cuinfoL;
@@ -843,6 +944,11 @@ typedef struct magma_s_preconditioner
     magma_index_t*            L_dgraphindegree_bak; // for sync-free trisolve
     magma_index_t*            U_dgraphindegree;     // for sync-free trisolve
     magma_index_t*            U_dgraphindegree_bak; // for sync-free trisolve
+    magma_s_matrix          hL;                   // host copy of L for the host trisolve
+    magma_s_matrix          hU;                   // host copy of U for the host trisolve
+    magma_trisolve_plan     Lplan;                // level sets of hL
+    magma_trisolve_plan     Uplan;                // level sets of hU
+    magma_s_matrix          hd;                   // host copy of d for the host Jacobi
     
     magma_solve_info_t cuinfo;
     magma_solve_info_t cuinfoL;
@@ -876,9 +982,11 @@ typedef struct magma_zopts
     magma_int_t             blocksize;
     magma_int_t             alignment;
     magma_storage_t         output_format;
+    magma_precision         mp_format;
     magma_location_t        input_location;
     magma_location_t        output_location;
     magma_scale_t           scaling;
+    magma_reorder_t         reorder;
 } magma_zopts;
 
 typedef struct magma_copts
@@ -892,9 +1000,11 @@ typedef struct magma_copts
     magma_int_t             blocksize;
     magma_int_t             alignment;
     magma_storage_t         output_format;
+    magma_precision         mp_format;
     magma_location_t        input_location;
     magma_location_t        output_location;
     magma_scale_t           scaling;
+    magma_reorder_t         reorder;
 } magma_copts;
 
 typedef struct magma_dopts
@@ -908,9 +1018,11 @@ typedef struct magma_dopts
     magma_int_t             blocksize;
     magma_int_t             alignment;
     magma_storage_t         output_format;
+    magma_precision         mp_format;
     magma_location_t        input_location;
     magma_location_t        output_location;
     magma_scale_t           scaling;
+    magma_reorder_t         reorder;
 } magma_dopts;
 
 typedef struct magma_sopts
@@ -924,9 +1036,11 @@ typedef struct magma_sopts
     magma_int_t             blocksize;
     magma_int_t             alignment;
     magma_storage_t         output_format;
+    magma_precision         mp_format;
     magma_location_t        input_location;
     magma_location_t        output_location;
     magma_scale_t           scaling;
+    magma_reorder_t         reorder;
 } magma_sopts;
 
 #ifdef __cplusplus
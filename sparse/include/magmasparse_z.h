@@ -97,6 +97,23 @@ magma_z_csr_mtx(
     const char *filename,
     magma_queue_t queue );
 
+magma_int_t
+magma_z_csr_mtx_slice(
+    magma_z_matrix *A,
+    const char *filename,
+    magma_int_t num_slices,
+    magma_int_t slice,
+    magma_int_t *start,
+    magma_int_t *end,
+    magma_queue_t queue );
+
+magma_int_t 
+magma_z_csr_bin( 
+    magma_z_matrix *A, 
+    const char *filename,
+    magma_int_t verify,
+    magma_queue_t queue );
+
 magma_int_t 
 magma_zcsrset( 
     magma_int_t m, 
@@ -173,6 +190,12 @@ magma_z_csr_mtxsymm(
     const char *filename,
     magma_queue_t queue );
 
+magma_int_t 
+magma_z_csrsym_mtx( 
+    magma_z_matrix *A, 
+    const char *filename,
+    magma_queue_t queue );
+
 magma_int_t 
 magma_z_csr_compressor( 
     magmaDoubleComplex ** val, 
@@ -254,6 +277,35 @@ magma_zmscale(
     magma_scale_t scaling,
     magma_queue_t queue );
 
+magma_int_t
+magma_zmorder(
+    magma_z_matrix A,
+    magma_reorder_t ordering,
+    magma_index_t *perm,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zmpermute(
+    magma_z_matrix A,
+    magma_index_t *perm,
+    magma_z_matrix *B,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zvpermute(
+    magma_z_matrix x,
+    magma_index_t *perm,
+    magma_trans_t trans,
+    magma_z_matrix *y,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zmreorder(
+    magma_z_matrix *A,
+    magma_reorder_t ordering,
+    magma_index_t **perm,
+    magma_queue_t queue );
+
 magma_int_t
 magma_zmscale_matrix_rhs(
     magma_z_matrix *A,
@@ -441,6 +493,13 @@ magma_zsymbilu(
     magma_z_matrix *U,
     magma_queue_t queue );
 
+magma_int_t
+magma_zsymbilu_stats( 
+    magma_z_matrix A, 
+    magma_int_t levels,
+    magma_fill_stats *stats,
+    magma_queue_t queue );
+
 
 magma_int_t 
 magma_zwrite_csr_mtx( 
@@ -461,6 +520,13 @@ magma_zwrite_csrtomtx(
     const char *filename,
     magma_queue_t queue );
 
+magma_int_t 
+magma_zwrite_csr_bin( 
+    magma_z_matrix A,
+    const char *filename,
+    magma_int_t checksum,
+    magma_queue_t queue );
+
 magma_int_t 
 magma_zprint_csr( 
     magma_int_t n_row, 
@@ -507,12 +573,20 @@ magma_zmtransposestruct_cpu(
     magma_z_matrix *B,
     magma_queue_t queue );
 
-magma_int_t 
+magma_int_t
 magma_zmtransposeconj_cpu(
-    magma_z_matrix A, 
+    magma_z_matrix A,
     magma_z_matrix *B,
     magma_queue_t queue );
 
+magma_int_t
+magma_zmtransposeop_cpu(
+    magma_z_matrix A,
+    magma_z_matrix *B,
+    magma_transop_t op,
+    magma_index_t **perm,
+    magma_queue_t queue );
+
 magma_int_t 
 magma_zmtransfer(
     magma_z_matrix A, 
@@ -529,6 +603,40 @@ magma_zmconvert(
     magma_storage_t new_format,
     magma_queue_t queue );
 
+magma_int_t
+magma_zcsr2sellcs(
+    magma_z_matrix A,
+    magma_int_t C,
+    magma_int_t sigma,
+    magma_z_matrix *B,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zsellcs2csr(
+    magma_z_matrix A,
+    magma_z_matrix *B,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zsellcs_tune(
+    magma_z_matrix A,
+    magma_int_t *C,
+    magma_int_t *sigma,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zcsr2csrmp(
+    magma_z_matrix A,
+    magma_precision val_format,
+    magma_z_matrix *B,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zcsrmp2csr(
+    magma_z_matrix A,
+    magma_z_matrix *B,
+    magma_queue_t queue );
+
 
 magma_int_t
 magma_zvinit(
@@ -1091,6 +1199,54 @@ magma_zparic_sweep_sync(
     magma_z_matrix *L,
     magma_queue_t queue );
 
+magma_int_t
+magma_zparilu_sweep_plan(
+    magma_z_matrix A,
+    magma_z_matrix *L,
+    magma_z_matrix *U,
+    magma_sweep_plan plan,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zparic_sweep_plan(
+    magma_z_matrix A,
+    magma_z_matrix *L,
+    magma_sweep_plan plan,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zparilu_plan_create(
+    magma_z_matrix A,
+    magma_z_matrix L,
+    magma_z_matrix U,
+    magma_sweep_plan *plan,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zparic_plan_create(
+    magma_z_matrix A,
+    magma_z_matrix L,
+    magma_sweep_plan *plan,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zsweep_plan_free(
+    magma_sweep_plan *plan,
+    magma_queue_t queue );
+
+magma_int_t
+magma_ztrisolve_plan_create(
+    magma_uplo_t uplo,
+    magma_diag_t diag,
+    magma_z_matrix T,
+    magma_trisolve_plan *plan,
+    magma_queue_t queue );
+
+magma_int_t
+magma_ztrisolve_plan_free(
+    magma_trisolve_plan *plan,
+    magma_queue_t queue );
+
 magma_int_t
 magma_zparict_sweep_sync(
     magma_z_matrix *A,
@@ -1332,6 +1488,22 @@ magma_zparict_candidates(
     magma_z_matrix *L_new,
     magma_queue_t queue );
 
+magma_int_t
+magma_zparilut_candidates_inc(
+    magma_z_matrix L0,
+    magma_z_matrix U0,
+    magma_z_matrix L,
+    magma_z_matrix U,
+    magma_candidate_cache *cache,
+    magma_z_matrix *L_new,
+    magma_z_matrix *U_new,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zcandidate_cache_free(
+    magma_candidate_cache *cache,
+    magma_queue_t queue );
+
 magma_int_t
 magma_zparilut_candidates_semilinked(
     magma_z_matrix L0,
@@ -1865,6 +2037,34 @@ magma_zpidr_strms(
     magma_z_preconditioner *precond_par,
     magma_queue_t queue );
 
+magma_int_t
+magma_zpcg_cpu(
+    magma_z_matrix A, magma_z_matrix b,
+    magma_z_matrix *x, magma_z_solver_par *solver_par,
+    magma_z_preconditioner *precond_par,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zpbicgstab_cpu(
+    magma_z_matrix A, magma_z_matrix b,
+    magma_z_matrix *x, magma_z_solver_par *solver_par,
+    magma_z_preconditioner *precond_par,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zfgmres_cpu(
+    magma_z_matrix A, magma_z_matrix b,
+    magma_z_matrix *x, magma_z_solver_par *solver_par,
+    magma_z_preconditioner *precond_par,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zpidr_cpu(
+    magma_z_matrix A, magma_z_matrix b,
+    magma_z_matrix *x, magma_z_solver_par *solver_par,
+    magma_z_preconditioner *precond_par,
+    magma_queue_t queue );
+
 magma_int_t
 magma_zbombard(
     magma_z_matrix A, magma_z_matrix b, 
@@ -2273,6 +2473,168 @@ magma_z_spmv(
     magma_z_matrix y,
     magma_queue_t queue );
 
+magma_int_t
+magma_zspmv_cpu(
+    magmaDoubleComplex alpha, 
+    magma_z_matrix A, 
+    magma_z_matrix x, 
+    magmaDoubleComplex beta, 
+    magma_z_matrix y,
+    magma_queue_t queue );
+
+magmaDoubleComplex
+magma_zdotc_cpu(
+    magma_int_t n,
+    const magmaDoubleComplex *x,
+    const magmaDoubleComplex *y,
+    magma_queue_t queue );
+
+double
+magma_dznrm2_cpu(
+    magma_int_t n,
+    const magmaDoubleComplex *x,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zaxpby_cpu(
+    magma_int_t n,
+    magmaDoubleComplex alpha,
+    const magmaDoubleComplex *x,
+    magmaDoubleComplex beta,
+    magmaDoubleComplex *y,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zmdotc_cpu(
+    magma_int_t n,
+    magma_int_t k,
+    const magmaDoubleComplex *V,
+    magma_int_t ldv,
+    const magmaDoubleComplex *y,
+    magmaDoubleComplex *h,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zmgemv_cpu(
+    magma_int_t n,
+    magma_int_t k,
+    magmaDoubleComplex alpha,
+    const magmaDoubleComplex *V,
+    magma_int_t ldv,
+    const magmaDoubleComplex *h,
+    magmaDoubleComplex beta,
+    magmaDoubleComplex *y,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zresidualvec_cpu(
+    magma_z_matrix A,
+    magma_z_matrix b,
+    magma_z_matrix x,
+    magma_z_matrix *r,
+    double *res,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zcgmerge_xr_cpu(
+    magma_int_t n,
+    magmaDoubleComplex alpha,
+    const magmaDoubleComplex *p,
+    const magmaDoubleComplex *q,
+    magmaDoubleComplex *x,
+    magmaDoubleComplex *r,
+    double *rr,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zbicgmerge_p_cpu(
+    magma_int_t n,
+    magmaDoubleComplex beta,
+    magmaDoubleComplex omega,
+    const magmaDoubleComplex *r,
+    const magmaDoubleComplex *v,
+    magmaDoubleComplex *p,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zbicgmerge_s_cpu(
+    magma_int_t n,
+    magmaDoubleComplex alpha,
+    const magmaDoubleComplex *r,
+    const magmaDoubleComplex *v,
+    magmaDoubleComplex *s,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zbicgmerge_ts_cpu(
+    magma_int_t n,
+    const magmaDoubleComplex *t,
+    const magmaDoubleComplex *s,
+    magmaDoubleComplex *ts,
+    double *tt,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zbicgmerge_xr_cpu(
+    magma_int_t n,
+    magmaDoubleComplex alpha,
+    magmaDoubleComplex omega,
+    const magmaDoubleComplex *rr,
+    const magmaDoubleComplex *y,
+    const magmaDoubleComplex *z,
+    const magmaDoubleComplex *s,
+    const magmaDoubleComplex *t,
+    magmaDoubleComplex *x,
+    magmaDoubleComplex *r,
+    magmaDoubleComplex *rho,
+    double *nrm2,
+    magma_queue_t queue );
+
+magma_int_t
+magma_zidrmerge_smoothing_cpu(
+    magma_int_t n,
+    const magmaDoubleComplex *r,
+    const magmaDoubleComplex *x,
+    magmaDoubleComplex *rs,
+    magmaDoubleComplex *xs,
+    double *nrm,
+    magma_queue_t queue );
+
+magma_int_t
+magma_ztrisolve_cpu(
+    magma_z_matrix T,
+    magma_trisolve_plan plan,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_queue_t queue );
+
+magma_int_t
+magma_ztrisolve_syncfree_cpu(
+    magma_z_matrix T,
+    magma_trisolve_plan plan,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_queue_t queue );
+
+magma_int_t
+magma_ztrisolve_serial_cpu(
+    magma_uplo_t uplo,
+    magma_diag_t diag,
+    magma_z_matrix T,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_queue_t queue );
+
+magma_int_t
+magma_ztrisolve_isai_cpu(
+    magma_z_matrix T,
+    magma_z_matrix M,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_z_matrix *work,
+    magma_int_t sweeps,
+    magma_queue_t queue );
+
 magma_int_t
 magma_zcustomspmv(
     magma_int_t m,
@@ -2368,6 +2730,13 @@ magma_z_applyprecond_right(
     magma_z_matrix *x, magma_z_preconditioner *precond,
     magma_queue_t queue );
 
+magma_int_t
+magma_z_applyprecond_cpu(
+    magma_z_matrix A, magma_z_matrix b, 
+    magma_z_matrix *x, magma_z_matrix *dwork,
+    magma_z_preconditioner *precond,
+    magma_queue_t queue );
+
 magma_int_t
 magma_z_initP2P(
     magma_int_t *bandwidth_benchmark,
@@ -10,6 +10,7 @@
 
 */
 #include "magmasparse_internal.h"
+#include "trace.h"
 
 
 /**
@@ -140,8 +141,26 @@ magma_z_precondsetup(
 {
     magma_int_t info = 0;
     
+    magma_trace_scope trace( "magma_z_precondsetup", A.num_rows, A.num_cols, A.nnz );
+    
     // magma_zprecondfree( precond, queue );
     
+    // the host copies of magma_z_applyprecond_cpu belong to an earlier setup
+    if ( precond->hL.val != NULL ) {
+        magma_zmfree( &precond->hL, queue );
+        precond->hL.val = NULL;
+    }
+    if ( precond->hU.val != NULL ) {
+        magma_zmfree( &precond->hU, queue );
+        precond->hU.val = NULL;
+    }
+    if ( precond->hd.val != NULL ) {
+        magma_zmfree( &precond->hd, queue );
+        precond->hd.val = NULL;
+    }
+    magma_ztrisolve_plan_free( &precond->Lplan, queue );
+    magma_ztrisolve_plan_free( &precond->Uplan, queue );
+    
     //Chronometry
     real_Double_t tempo1, tempo2;
     
@@ -703,3 +722,176 @@ magma_z_applyprecond_right(
 cleanup:
     return info;
 }
+
+
+// host CSR copy of an ILU factor. For Magma_SYNCFREESOLVE, magma_zcumilusetup
+// leaves the factors in CSC with the column pointer in drow and the row
+// indices in dcol, which read as CSR are the arrays of the transpose.
+static magma_int_t
+magma_zfactor_to_cpu(
+    magma_z_matrix F,
+    magma_z_matrix *hF,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    magma_z_matrix hFT={Magma_CSR};
+    
+    if ( F.storage_type == Magma_CSC ) {
+        F.storage_type = Magma_CSR;
+        CHECK( magma_zmtransfer( F, &hFT, F.memory_location, Magma_CPU, queue ));
+        CHECK( magma_zmtranspose( hFT, hF, queue ));
+    } else {
+        CHECK( magma_zmtransfer( F, hF, F.memory_location, Magma_CPU, queue ));
+    }
+    
+cleanup:
+    magma_zmfree( &hFT, queue );
+    return info;
+}
+
+
+/**
+    Purpose
+    -------
+
+    Applies the preconditioner to a vector located on the host,
+    x = M^{-1} b, i.e., the left and the right preconditioner one after
+    the other. This is used by the host Krylov solvers.
+
+    Magma_NONE and Magma_JACOBI are applied on the host. For Jacobi, the
+    scaling vector set up by magma_z_precondsetup is read back from
+    precond->d. ILU and ParILU with the exact triangular solves (Magma_CUSOLVE
+    or Magma_SYNCFREESOLVE) use the host triangular solves: on first use, L
+    and U are copied to precond->hL and precond->hU in CSR, also if the
+    sync-free setup stored them in CSC, and their level sets are
+    stored in precond->Lplan and precond->Uplan. These host copies are freed
+    by the next magma_z_precondsetup. Every other preconditioner
+    is applied on the device: b is
+    copied into dwork, the device preconditioner is applied and the result
+    is copied back. dwork is allocated on first use and has to be freed by
+    the caller.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                sparse matrix A
+
+    @param[in]
+    b           magma_z_matrix
+                input vector b located on the host
+
+    @param[in,out]
+    x           magma_z_matrix*
+                output vector x located on the host
+
+    @param[in,out]
+    dwork       magma_z_matrix*
+                device workspace for preconditioners without host
+                implementation
+
+    @param[in]
+    precond     magma_z_preconditioner
+                preconditioner
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zaux
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_z_applyprecond_cpu(
+    magma_z_matrix A,
+    magma_z_matrix b,
+    magma_z_matrix *x,
+    magma_z_matrix *dwork,
+    magma_z_preconditioner *precond,
+    magma_queue_t queue )
+{
+    magma_int_t info = 0;
+    
+    magma_int_t n = b.num_rows*b.num_cols;
+    magma_z_matrix db={Magma_DENSE}, dt={Magma_DENSE};
+    real_Double_t tempo1, tempo2;
+    
+    if ( precond->solver == Magma_NONE ) {
+        tempo1 = magma_wtime();
+        #pragma omp parallel for schedule(static)
+        for( magma_int_t i=0; i < n; i++ ){
+            x->val[i] = b.val[i];
+        }
+        tempo2 = magma_wtime();
+        precond->runtime += tempo2-tempo1;
+    }
+    else if ( precond->solver == Magma_JACOBI ) {
+        if ( precond->d.memory_location != Magma_CPU &&
+             precond->hd.val == NULL ) {
+            tempo1 = magma_sync_wtime( queue );
+            CHECK( magma_zmtransfer( precond->d, &precond->hd,
+                        precond->d.memory_location, Magma_CPU, queue ));
+            tempo2 = magma_sync_wtime( queue );
+            precond->setuptime += tempo2-tempo1;
+        }
+        const magmaDoubleComplex *d = ( precond->d.memory_location == Magma_CPU )
+                                      ? precond->d.val : precond->hd.val;
+        tempo1 = magma_wtime();
+        #pragma omp parallel for schedule(static)
+        for( magma_int_t i=0; i < n; i++ ){
+            x->val[i] = d[i] * b.val[i];
+        }
+        tempo2 = magma_wtime();
+        precond->runtime += tempo2-tempo1;
+    }
+    else if ( ( precond->solver == Magma_ILU ||
+                precond->solver == Magma_PARILU ) &&
+              ( precond->trisolver == Magma_CUSOLVE ||
+                precond->trisolver == 0 ||
+                precond->trisolver == Magma_SYNCFREESOLVE ) ) {
+        if ( precond->hL.val == NULL ) {
+            tempo1 = magma_sync_wtime( queue );
+            CHECK( magma_zfactor_to_cpu( precond->L, &precond->hL, queue ));
+            CHECK( magma_zfactor_to_cpu( precond->U, &precond->hU, queue ));
+            CHECK( magma_ztrisolve_plan_create( MagmaLower, MagmaUnit,
+                        precond->hL, &precond->Lplan, queue ));
+            CHECK( magma_ztrisolve_plan_create( MagmaUpper, MagmaNonUnit,
+                        precond->hU, &precond->Uplan, queue ));
+            tempo2 = magma_sync_wtime( queue );
+            precond->setuptime += tempo2-tempo1;
+        }
+        tempo1 = magma_wtime();
+        // x = L^{-1} b, then x = U^{-1} x in place
+        if ( precond->trisolver == Magma_SYNCFREESOLVE ) {
+            CHECK( magma_ztrisolve_syncfree_cpu( precond->hL, precond->Lplan, b, x, queue ));
+            CHECK( magma_ztrisolve_syncfree_cpu( precond->hU, precond->Uplan, *x, x, queue ));
+        } else {
+            CHECK( magma_ztrisolve_cpu( precond->hL, precond->Lplan, b, x, queue ));
+            CHECK( magma_ztrisolve_cpu( precond->hU, precond->Uplan, *x, x, queue ));
+        }
+        tempo2 = magma_wtime();
+        precond->runtime += tempo2-tempo1;
+    }
+    else {
+        if ( dwork->dval == NULL ) {
+            CHECK( magma_zvinit( dwork, Magma_DEV, n, 2, MAGMA_Z_ZERO, queue ));
+        }
+        // views on the two columns of dwork
+        db.memory_location = Magma_DEV;
+        db.num_rows = b.num_rows;
+        db.num_cols = b.num_cols;
+        db.nnz = n;
+        db.dval = dwork->dval;
+        dt = db;
+        dt.dval = dwork->dval + n;
+        
+        magma_zsetvector( n, b.val, 1, db.dval, 1, queue );
+        CHECK( magma_z_applyprecond_left( MagmaNoTrans, A, db, &dt, precond, queue ));
+        CHECK( magma_z_applyprecond_right( MagmaNoTrans, A, dt, &db, precond, queue ));
+        magma_zgetvector( n, db.dval, 1, x->val, 1, queue );
+    }
+    
+cleanup:
+    return info;
+}
@@ -10,6 +10,7 @@
 
 */
 #include "magmasparse_internal.h"
+#include "trace.h"
 
 
 /**
@@ -20,6 +21,9 @@
     system Ax = b. All linear algebra objects are expected to be on the device,
     the linear algebra objects are MAGMA-sparse specific structures 
     (dense matrix b, dense matrix x, sparse/dense matrix A).
+    If A, b and x are located in Magma_CPU memory instead, CG, BiCGSTAB,
+    GMRES and IDR and their preconditioned variants run on the host, see
+    magma_zpcg_cpu. The solver feedback is the same.
     The additional parameter zopts contains information about the solver
     and the preconditioner.
     * the type of solver
@@ -63,12 +67,55 @@ magma_z_solver(
 {
     magma_int_t info = 0;
     
+    magma_trace_scope trace( "magma_z_solver", A.num_rows, b.num_cols, A.nnz );
+    
     // make sure RHS is a dense matrix
     if ( b.storage_type != Magma_DENSE ) {
         printf( "error: sparse RHS not yet supported.\n" );
         return MAGMA_ERR_NOT_SUPPORTED;
     }
-    if( b.num_cols == 1 ){
+    // host backend: A, b and x in CPU memory
+    if ( A.memory_location == Magma_CPU ) {
+        if ( b.memory_location != Magma_CPU || x->memory_location != Magma_CPU ) {
+            printf( "error: A, b and x have to be in the same memory.\n" );
+            return MAGMA_ERR_NOT_SUPPORTED;
+        }
+        if ( b.num_cols != 1 ) {
+            printf( "error: only 1 RHS supported for the host solvers.\n" );
+            return MAGMA_ERR_NOT_SUPPORTED;
+        }
+        // the unpreconditioned variants run without preconditioner
+        magma_z_preconditioner noprecond;
+        noprecond = zopts->precond_par;
+        noprecond.solver = Magma_NONE;
+        switch( zopts->solver_par.solver ) {
+            case  Magma_CG:
+            case  Magma_CGMERGE:
+                    CHECK( magma_zpcg_cpu( A, b, x, &zopts->solver_par, &noprecond, queue )); break;
+            case  Magma_PCG:
+            case  Magma_PCGMERGE:
+                    CHECK( magma_zpcg_cpu( A, b, x, &zopts->solver_par, &zopts->precond_par, queue )); break;
+            case  Magma_BICGSTAB:
+            case  Magma_BICGSTABMERGE:
+                    CHECK( magma_zpbicgstab_cpu( A, b, x, &zopts->solver_par, &noprecond, queue )); break;
+            case  Magma_PBICGSTAB:
+            case  Magma_PBICGSTABMERGE:
+                    CHECK( magma_zpbicgstab_cpu( A, b, x, &zopts->solver_par, &zopts->precond_par, queue )); break;
+            case  Magma_GMRES:
+            case  Magma_PGMRES:
+                    CHECK( magma_zfgmres_cpu( A, b, x, &zopts->solver_par, &zopts->precond_par, queue )); break;
+            case  Magma_IDR:
+            case  Magma_IDRMERGE:
+                    CHECK( magma_zpidr_cpu( A, b, x, &zopts->solver_par, &noprecond, queue )); break;
+            case  Magma_PIDR:
+            case  Magma_PIDRMERGE:
+                    CHECK( magma_zpidr_cpu( A, b, x, &zopts->solver_par, &zopts->precond_par, queue )); break;
+            default:
+                    printf("error: solver class not supported on the host.\n");
+                    info = MAGMA_ERR_NOT_SUPPORTED; break;
+        }
+    }
+    else if( b.num_cols == 1 ){
         switch( zopts->solver_par.solver ) {
             case  Magma_BICG:
                     CHECK( magma_zbicg( A, b, x, &zopts->solver_par, queue )); break;
@@ -65,6 +65,7 @@ magma_zparic_cpu(
 
     magma_z_matrix hAT={Magma_CSR}, hA={Magma_CSR}, hAL={Magma_CSR}, 
     hAU={Magma_CSR}, hAUT={Magma_CSR}, hAtmp={Magma_CSR}, hACOO={Magma_CSR};
+    magma_sweep_plan plan={0};
 
     // copy original matrix as COO to device
     if (A.memory_location != Magma_CPU || A.storage_type != Magma_CSR) {
@@ -94,9 +95,12 @@ magma_zparic_cpu(
     // - the system matrix hALCOO is available in COO format on the CPU 
     // - hAL is the lower triangular in CSR on the CPU
     // The kernel is located in sparse/control/magma_zparic_kernels.cpp
+    // The pattern does not change, so the positions each sweep touches are
+    // computed once.
     //
+    CHECK(magma_zparic_plan_create(hACOO, hAL, &plan, queue));
     for (int i=0; i<precond->sweeps; i++) {
-        CHECK(magma_zparic_sweep(hACOO, &hAL, queue));
+        CHECK(magma_zparic_sweep_plan(hACOO, &hAL, plan, queue));
     }
     
 
@@ -128,6 +132,7 @@ cleanup:
     magma_zmfree(&hAUT, queue);
     magma_zmfree(&hAtmp, queue);
     magma_zmfree(&hACOO, queue);
+    magma_zsweep_plan_free(&plan, queue);
 
 #endif
     return info;
@@ -160,6 +160,8 @@ magma_zparict(
     if( precond->levels > 0 ){
         CHECK( magma_zsymbilu( &hA, precond->levels, &hL, &hU , queue ));
     }
+    // the residuals look up A by binary search
+    CHECK( magma_zcsr_sort( &hA, queue ));
     magma_zmfree(&hU, queue );
     L.diagorder_type = Magma_VALUE;
     magma_zmatrix_tril( hA, &L, queue );
@@ -103,6 +103,8 @@ magma_zparict_cpu(
         CHECK(magma_zsymbilu(&hA, precond->levels, &hL, &LT , queue));
         magma_zmfree(&LT, queue);
     }
+    // the residuals look up A by binary search
+    CHECK(magma_zcsr_sort(&hA, queue));
     
     CHECK(magma_zmatrix_tril(hA, &L, queue));
     CHECK(magma_zmtransfer(L, &L0, A.memory_location, Magma_CPU, queue));
@@ -66,6 +66,7 @@ magma_zparilu_cpu(
 
     magma_z_matrix hAT={Magma_CSR}, hA={Magma_CSR}, hAL={Magma_CSR}, 
     hAU={Magma_CSR}, hAUT={Magma_CSR}, hAtmp={Magma_CSR}, hACOO={Magma_CSR};
+    magma_sweep_plan plan={0};
 
     // copy original matrix as COO to device
     if (A.memory_location != Magma_CPU || A.storage_type != Magma_CSR) {
@@ -103,9 +104,12 @@ magma_zparilu_cpu(
     // - hAL is the lower triangular in CSR on the CPU
     // - hAU is the upper triangular in CSC on the CPU (U transpose in CSR)
     // The kernel is located in sparse/control/magma_zparilu_kernels.cpp
+    // The patterns do not change, so the positions each sweep touches are
+    // computed once.
     //
+    CHECK(magma_zparilu_plan_create(hACOO, hAL, hAU, &plan, queue));
     for (int i=0; i<precond->sweeps; i++) {
-        CHECK(magma_zparilu_sweep(hACOO, &hAL, &hAU, queue));
+        CHECK(magma_zparilu_sweep_plan(hACOO, &hAL, &hAU, plan, queue));
     }
     CHECK(magma_z_cucsrtranspose(hAU, &hAUT, queue));
 
@@ -136,6 +140,7 @@ cleanup:
     magma_zmfree(&hAUT, queue);
     magma_zmfree(&hAtmp, queue);
     magma_zmfree(&hACOO, queue);
+    magma_zsweep_plan_free(&plan, queue);
 
 #endif
     return info;
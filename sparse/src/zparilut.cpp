@@ -122,6 +122,7 @@ magma_zparilut(
                     oneL={Magma_CSR}, oneU={Magma_CSR},
                     L={Magma_CSR}, U={Magma_CSR}, L_new={Magma_CSR}, U_new={Magma_CSR}, UT={Magma_CSR};
     magma_z_matrix L0={Magma_CSR}, U0={Magma_CSR};  
+    magma_candidate_cache cand={0};
     magma_int_t num_rmL, num_rmU;
     double thrsL = 0.0;
     double thrsU = 0.0;
@@ -142,6 +143,9 @@ magma_zparilut(
     if( precond->levels > 0 ){
         CHECK( magma_zsymbilu( &hA, precond->levels, &hL, &hU , queue ));
     }
+    // the sweeps and residuals look up A by binary search
+    CHECK( magma_zcsr_sort( &hA, queue ));
+    CHECK( magma_zcsr_sort( &A0, queue ));
     magma_zmfree(&hU, queue );
     magma_zmfree(&hL, queue );
     L.diagorder_type = Magma_VALUE;
@@ -202,7 +206,7 @@ magma_zparilut(
         magma_zcsrcoo_transpose( U, &UT, queue );
         end = magma_sync_wtime( queue ); t_transpose1+=end-start;
         start = magma_sync_wtime( queue );
-        magma_zparilut_candidates( L0, U0, L, UT, &hL, &hU, queue );
+        magma_zparilut_candidates_inc( L0, U0, L, UT, &cand, &hL, &hU, queue );
         end = magma_sync_wtime( queue ); t_cand=+end-start;
         
         if( precond->rtol == 1.0 ){
@@ -541,6 +545,7 @@ magma_zparilut(
     magma_zmfree( &U, queue );
     magma_zmfree( &UT, queue );
     magma_zmfree( &U_new, queue );
+    magma_zcandidate_cache_free( &cand, queue );
     //magma_zmfree( &UT, queue );
 #endif
     return info;
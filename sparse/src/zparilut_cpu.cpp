@@ -88,6 +88,7 @@ magma_zparilut_cpu(
         hU={Magma_CSR}, oneL={Magma_CSR}, oneU={Magma_CSR},
         L={Magma_CSR}, U={Magma_CSR}, L_new={Magma_CSR}, U_new={Magma_CSR}, 
         UT={Magma_CSR}, L0={Magma_CSR}, U0={Magma_CSR};
+    magma_candidate_cache cand={0};
     magma_int_t num_rmL, num_rmU;
     double thrsL = 0.0;
     double thrsU = 0.0;
@@ -108,6 +109,8 @@ magma_zparilut_cpu(
         magma_zmfree(&hU, queue);
         magma_zmfree(&hL, queue);
     }
+    // the sweeps and residuals look up A by binary search
+    CHECK(magma_zcsr_sort(&hA, queue));
     CHECK(magma_zmatrix_tril(hA, &L0, queue));
     CHECK(magma_zmatrix_triu(hA, &U0, queue));
     magma_zmfree(&hU, queue);
@@ -142,9 +145,9 @@ magma_zparilut_cpu(
         end = magma_sync_wtime(queue); t_transpose1+=end-start;
         
         
-        // step 2: find candidates
+        // step 2: find candidates, only rows with changed inputs are recomputed
         start = magma_sync_wtime(queue);
-        CHECK(magma_zparilut_candidates(L0, U0, L, UT, &hL, &hU, queue));
+        CHECK(magma_zparilut_candidates_inc(L0, U0, L, UT, &cand, &hL, &hU, queue));
         end = magma_sync_wtime(queue); t_cand=+end-start;
         
         
@@ -281,6 +284,7 @@ cleanup:
     magma_zmfree(&U_new, queue);
     magma_zmfree(&hL, queue);
     magma_zmfree(&hU, queue);
+    magma_zcandidate_cache_free(&cand, queue);
 #endif
     return info;
 }
@@ -0,0 +1,262 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include "magmasparse_internal.h"
+
+
+#define RTOLERANCE     lapackf77_dlamch( "E" )
+#define ATOLERANCE     lapackf77_dlamch( "E" )
+
+
+/**
+    Purpose
+    -------
+
+    Solves a system of linear equations
+       A * X = B
+    where A is a general N-by-N matrix A.
+    This is a host implementation of the preconditioned Biconjugate
+    Gradient Stabelized method: A, b and x are located in Magma_CPU
+    memory. The vector updates are merged into four OpenMP kernels per
+    iteration, the dot product <rr,r> for the next iteration is computed
+    together with the residual norm.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                input matrix A
+
+    @param[in]
+    b           magma_z_matrix
+                RHS b
+
+    @param[in,out]
+    x           magma_z_matrix*
+                solution approximation
+
+    @param[in,out]
+    solver_par  magma_z_solver_par*
+                solver parameters
+
+    @param[in]
+    precond_par magma_z_preconditioner*
+                preconditioner parameters
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zgesv
+    ********************************************************************/
+
+extern "C" magma_int_t
+magma_zpbicgstab_cpu(
+    magma_z_matrix A, magma_z_matrix b, magma_z_matrix *x,
+    magma_z_solver_par *solver_par,
+    magma_z_preconditioner *precond_par,
+    magma_queue_t queue )
+{
+    magma_int_t info = MAGMA_NOTCONVERGED;
+
+    // prepare solver feedback
+    solver_par->solver = Magma_PBICGSTAB;
+    solver_par->numiter = 0;
+    solver_par->spmv_count = 0;
+
+    // some useful variables
+    magmaDoubleComplex c_zero = MAGMA_Z_ZERO;
+    magmaDoubleComplex c_one  = MAGMA_Z_ONE;
+
+    magma_int_t dofs = A.num_rows;
+    bool noprec = ( precond_par->solver == Magma_NONE );
+
+    // workspace
+    magma_z_matrix r={Magma_CSR}, rr={Magma_CSR}, p={Magma_CSR}, v={Magma_CSR}, s={Magma_CSR}, t={Magma_CSR}, y={Magma_CSR}, z={Magma_CSR};
+    magma_z_matrix dwork={Magma_CSR};
+
+    // solver variables
+    magmaDoubleComplex alpha, beta, omega, rho_old, rho_new, rho_next, ts;
+    double nom0, r0, res, nomb, tt, rnorm2;
+    real_Double_t tempo1, tempo2;
+    res=0;
+
+    if ( A.memory_location != Magma_CPU || b.memory_location != Magma_CPU ||
+         x->memory_location != Magma_CPU ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    CHECK( magma_zvinit( &r, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &rr,Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &p, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &v, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &s, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &t, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    if ( noprec ) {
+        // without preconditioner, y is p and z is s
+        y = p;
+        z = s;
+    } else {
+        CHECK( magma_zvinit( &y, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+        CHECK( magma_zvinit( &z, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    }
+
+    // solver setup
+    CHECK( magma_zresidualvec_cpu( A, b, *x, &r, &nom0, queue ));
+    magma_zaxpby_cpu( dofs, c_one, r.val, c_zero, rr.val, queue );   // rr = r
+    rho_new = omega = alpha = MAGMA_Z_MAKE( 1.0, 0. );
+    rho_next = MAGMA_Z_MAKE( nom0 * nom0, 0. );                       // <rr,r>
+    solver_par->init_res = nom0;
+
+    nomb = magma_dznrm2_cpu( dofs, b.val, queue );
+    if ( nomb == 0.0 ){
+        nomb=1.0;
+    }
+    if ( (r0 = nomb * solver_par->rtol) < ATOLERANCE ){
+        r0 = ATOLERANCE;
+    }
+
+    solver_par->final_res = solver_par->init_res;
+    solver_par->iter_res = solver_par->init_res;
+    if ( solver_par->verbose > 0 ) {
+        solver_par->res_vec[0] = nom0;
+        solver_par->timing[0] = 0.0;
+    }
+    if ( nom0 < r0 ) {
+        info = MAGMA_SUCCESS;
+        goto cleanup;
+    }
+
+    //Chronometry
+    tempo1 = magma_wtime();
+
+    // start iteration
+    do
+    {
+        solver_par->numiter++;
+        rho_old = rho_new;                                    // rho_old=rho
+        rho_new = rho_next;                                   // rho=<rr,r>
+        beta = rho_new/rho_old * alpha/omega;   // beta=rho/rho_old *alpha/omega
+        if( magma_z_isnan_inf( beta ) ){
+            info = MAGMA_DIVERGENCE;
+            break;
+        }
+        // p = r + beta * ( p - omega * v )
+        magma_zbicgmerge_p_cpu( dofs, beta, omega, r.val, v.val, p.val, queue );
+
+        // preconditioner
+        if ( ! noprec ) {
+            CHECK( magma_z_applyprecond_cpu( A, p, &y, &dwork, precond_par, queue ));
+        }
+
+        CHECK( magma_z_spmv( c_one, A, y, c_zero, v, queue ));      // v = Ay
+        solver_par->spmv_count++;
+        alpha = rho_new / magma_zdotc_cpu( dofs, rr.val, v.val, queue );
+        if( magma_z_isnan_inf( alpha ) ){
+            info = MAGMA_DIVERGENCE;
+            break;
+        }
+        magma_zbicgmerge_s_cpu( dofs, alpha, r.val, v.val, s.val, queue ); // s=r-alpha*v
+
+        // preconditioner
+        if ( ! noprec ) {
+            CHECK( magma_z_applyprecond_cpu( A, s, &z, &dwork, precond_par, queue ));
+        }
+
+        CHECK( magma_z_spmv( c_one, A, z, c_zero, t, queue ));       // t=Az
+        solver_par->spmv_count++;
+        // omega = <t,s>/<t,t>
+        magma_zbicgmerge_ts_cpu( dofs, t.val, s.val, &ts, &tt, queue );
+        omega = ts / MAGMA_Z_MAKE( tt, 0. );
+
+        if( magma_z_isnan_inf( omega ) ){
+            magma_zaxpby_cpu( dofs, alpha, y.val, c_one, x->val, queue ); // x=x+alpha*y
+            res = magma_dznrm2_cpu( dofs, r.val, queue );
+            if ( res/nomb <= solver_par->rtol || res <= solver_par->atol ){
+                info = MAGMA_SUCCESS;
+            } else {
+                info = MAGMA_DIVERGENCE;
+            }
+            break;
+        }
+        // x = x + alpha*y + omega*z, r = s - omega*t, rho_next = <rr,r>
+        magma_zbicgmerge_xr_cpu( dofs, alpha, omega, rr.val, y.val, z.val,
+                                 s.val, t.val, x->val, r.val, &rho_next, &rnorm2, queue );
+        res = sqrt( rnorm2 );
+
+        if ( solver_par->verbose > 0 ) {
+            tempo2 = magma_wtime();
+            if ( (solver_par->numiter)%solver_par->verbose==0 ) {
+                solver_par->res_vec[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) res;
+                solver_par->timing[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) tempo2-tempo1;
+            }
+        }
+
+        if ( res/nomb <= solver_par->rtol || res <= solver_par->atol ){
+            info = MAGMA_SUCCESS;
+            break;
+        }
+    }
+    while ( solver_par->numiter+1 <= solver_par->maxiter );
+
+    tempo2 = magma_wtime();
+    solver_par->runtime = (real_Double_t) tempo2-tempo1;
+    double residual;
+    CHECK( magma_zresidualvec_cpu( A, b, *x, &r, &residual, queue ));
+    solver_par->final_res = residual;
+    solver_par->iter_res = res;
+
+    if ( solver_par->numiter < solver_par->maxiter && info == MAGMA_SUCCESS ) {
+        info = MAGMA_SUCCESS;
+    } else if ( solver_par->init_res > solver_par->final_res ) {
+        if ( solver_par->verbose > 0 ) {
+            if ( (solver_par->numiter)%solver_par->verbose==0 ) {
+                solver_par->res_vec[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) res;
+                solver_par->timing[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) tempo2-tempo1;
+            }
+        }
+        info = MAGMA_SLOW_CONVERGENCE;
+        if( solver_par->iter_res < solver_par->rtol*nomb ||
+            solver_par->iter_res < solver_par->atol ) {
+            info = MAGMA_SUCCESS;
+        }
+    }
+    else {
+        if ( solver_par->verbose > 0 ) {
+            if ( (solver_par->numiter)%solver_par->verbose==0 ) {
+                solver_par->res_vec[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) res;
+                solver_par->timing[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) tempo2-tempo1;
+            }
+        }
+        info = MAGMA_DIVERGENCE;
+    }
+
+cleanup:
+    magma_zmfree(&r, queue );
+    magma_zmfree(&rr, queue );
+    magma_zmfree(&p, queue );
+    magma_zmfree(&v, queue );
+    magma_zmfree(&s, queue );
+    magma_zmfree(&t, queue );
+    if ( ! noprec ) {
+        magma_zmfree(&y, queue );
+        magma_zmfree(&z, queue );
+    }
+    magma_zmfree(&dwork, queue );
+
+    solver_par->info = info;
+    return info;
+}   /* magma_zpbicgstab_cpu */
@@ -0,0 +1,228 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+
+#include "magmasparse_internal.h"
+
+#define RTOLERANCE     lapackf77_dlamch( "E" )
+#define ATOLERANCE     lapackf77_dlamch( "E" )
+
+
+/*******************************************************************************
+    Purpose
+    -------
+
+    Solves a system of linear equations
+       A * X = B
+    where A is a complex Hermitian N-by-N positive definite matrix A.
+    This is a host implementation of the preconditioned Conjugate
+    Gradient method: A, b and x are located in Magma_CPU memory, the
+    vector operations use the merged OpenMP kernels and the SpMV is
+    magma_zspmv_cpu. Without preconditioner, the residual is used as
+    preconditioned residual and the dot product <r,h> comes for free with
+    the residual norm.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                input matrix A
+
+    @param[in]
+    b           magma_z_matrix
+                RHS b
+
+    @param[in,out]
+    x           magma_z_matrix*
+                solution approximation
+
+    @param[in,out]
+    solver_par  magma_z_solver_par*
+                solver parameters
+
+    @param[in]
+    precond_par magma_z_preconditioner*
+                preconditioner
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zposv
+*******************************************************************************/
+
+extern "C" magma_int_t
+magma_zpcg_cpu(
+    magma_z_matrix A, magma_z_matrix b, magma_z_matrix *x,
+    magma_z_solver_par *solver_par,
+    magma_z_preconditioner *precond_par,
+    magma_queue_t queue )
+{
+    magma_int_t info = MAGMA_NOTCONVERGED;
+
+    // prepare solver feedback
+    solver_par->solver = Magma_PCG;
+    solver_par->numiter = 0;
+    solver_par->spmv_count = 0;
+
+    // solver variables
+    magmaDoubleComplex alpha, beta;
+    double nom0, r0, res=0.0, nomb, rr;
+    magmaDoubleComplex den, gammanew, gammaold = MAGMA_Z_MAKE(1.0,0.0);
+    // local variables
+    magmaDoubleComplex c_zero = MAGMA_Z_ZERO, c_one = MAGMA_Z_ONE;
+    real_Double_t tempo1, tempo2;
+    bool noprec = ( precond_par->solver == Magma_NONE );
+    magmaDoubleComplex *hval;
+
+    magma_int_t dofs = A.num_rows;
+
+    // CPU workspace
+    magma_z_matrix r={Magma_CSR}, p={Magma_CSR}, q={Magma_CSR}, h={Magma_CSR};
+    magma_z_matrix dwork={Magma_CSR};
+
+    if ( A.memory_location != Magma_CPU || b.memory_location != Magma_CPU ||
+         x->memory_location != Magma_CPU ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    CHECK( magma_zvinit( &r, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &p, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &q, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    if ( ! noprec ) {
+        CHECK( magma_zvinit( &h, Magma_CPU, A.num_rows, 1, c_zero, queue ));
+    }
+    hval = noprec ? r.val : h.val;
+
+    // solver setup
+    CHECK( magma_zresidualvec_cpu( A, b, *x, &r, &nom0, queue ));
+    rr = nom0 * nom0;
+    solver_par->init_res = nom0;
+
+    nomb = magma_dznrm2_cpu( dofs, b.val, queue );
+    if ( nomb == 0.0 ){
+        nomb=1.0;
+    }
+    if ( (r0 = nomb * solver_par->rtol) < ATOLERANCE ){
+        r0 = ATOLERANCE;
+    }
+    solver_par->final_res = solver_par->init_res;
+    solver_par->iter_res = solver_par->init_res;
+    if ( solver_par->verbose > 0 ) {
+        solver_par->res_vec[0] = (real_Double_t)nom0;
+        solver_par->timing[0] = 0.0;
+    }
+    if ( nom0 < r0 ) {
+        info = MAGMA_SUCCESS;
+        goto cleanup;
+    }
+
+    //Chronometry
+    tempo1 = magma_wtime();
+
+    // start iteration
+    do
+    {
+        solver_par->numiter++;
+
+        // preconditioner
+        if ( noprec ) {
+            gammanew = MAGMA_Z_MAKE( rr, 0.0 );                  // gn = < r,r>
+        } else {
+            CHECK( magma_z_applyprecond_cpu( A, r, &h, &dwork, precond_par, queue ));
+            gammanew = magma_zdotc_cpu( dofs, r.val, h.val, queue ); // gn = < r,h>
+        }
+
+        if ( solver_par->numiter == 1 ) {
+            magma_zaxpby_cpu( dofs, c_one, hval, c_zero, p.val, queue );   // p = h
+        } else {
+            beta = (gammanew/gammaold);                        // beta = gn/go
+            magma_zaxpby_cpu( dofs, c_one, hval, beta, p.val, queue ); // p = h + beta*p
+        }
+
+        CHECK( magma_z_spmv( c_one, A, p, c_zero, q, queue ));   // q = A p
+        solver_par->spmv_count++;
+        den = magma_zdotc_cpu( dofs, p.val, q.val, queue );       // den = p dot q
+
+        // check positive definite
+        if ( MAGMA_Z_ABS(den) <= 0.0 || magma_z_isnan_inf( den ) ) {
+            info = MAGMA_NONSPD;
+            break;
+        }
+
+        alpha = gammanew / den;
+        // x = x + alpha p, r = r - alpha q, rr = < r,r>
+        magma_zcgmerge_xr_cpu( dofs, alpha, p.val, q.val, x->val, r.val, &rr, queue );
+        gammaold = gammanew;
+
+        res = sqrt( rr );
+        if ( solver_par->verbose > 0 ) {
+            tempo2 = magma_wtime();
+            if ( (solver_par->numiter)%solver_par->verbose == 0 ) {
+                solver_par->res_vec[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) res;
+                solver_par->timing[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) tempo2-tempo1;
+            }
+        }
+
+        if ( res/nomb <= solver_par->rtol || res <= solver_par->atol ){
+            break;
+        }
+    }
+    while ( solver_par->numiter+1 <= solver_par->maxiter );
+
+    tempo2 = magma_wtime();
+    solver_par->runtime = (real_Double_t) tempo2-tempo1;
+    double residual;
+    CHECK( magma_zresidualvec_cpu( A, b, *x, &r, &residual, queue ));
+    solver_par->iter_res = res;
+    solver_par->final_res = residual;
+
+    if ( info == MAGMA_NONSPD ) {
+        // breakdown, keep the error code
+    } else if ( solver_par->numiter < solver_par->maxiter ) {
+        info = MAGMA_SUCCESS;
+    } else if ( solver_par->init_res > solver_par->final_res ) {
+        if ( solver_par->verbose > 0 ) {
+            if ( (solver_par->numiter)%solver_par->verbose == 0 ) {
+                solver_par->res_vec[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) res;
+                solver_par->timing[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) tempo2-tempo1;
+            }
+        }
+        info = MAGMA_SLOW_CONVERGENCE;
+        if( solver_par->iter_res < solver_par->rtol*nomb ||
+            solver_par->iter_res < solver_par->atol ) {
+            info = MAGMA_SUCCESS;
+        }
+    }
+    else {
+        if ( solver_par->verbose > 0 ) {
+            if ( (solver_par->numiter)%solver_par->verbose == 0 ) {
+                solver_par->res_vec[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) res;
+                solver_par->timing[(solver_par->numiter)/solver_par->verbose]
+                        = (real_Double_t) tempo2-tempo1;
+            }
+        }
+        info = MAGMA_DIVERGENCE;
+    }
+
+cleanup:
+    magma_zmfree(&r, queue );
+    magma_zmfree(&p, queue );
+    magma_zmfree(&q, queue );
+    magma_zmfree(&h, queue );
+    magma_zmfree(&dwork, queue );
+
+    solver_par->info = info;
+    return info;
+}   /* magma_zpcg_cpu */
@@ -0,0 +1,498 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+
+#include "magmasparse_internal.h"
+
+#define RTOLERANCE     lapackf77_dlamch( "E" )
+#define ATOLERANCE     lapackf77_dlamch( "E" )
+
+
+/*******************************************************************************
+    Purpose
+    -------
+
+    Solves a system of linear equations
+       A * X = B
+    where A is a general N-by-N matrix A.
+    This is a host implementation of the preconditioned Induced Dimension
+    Reduction method IDR(s) with residual smoothing: A, b and x are
+    located in Magma_CPU memory. The products with the shadow space P and
+    the bases G and U are merged multi-vector OpenMP kernels, the smoothing
+    step is one two-pass kernel. The shadow space is orthonormalized with
+    modified Gram-Schmidt on the host.
+
+    Arguments
+    ---------
+
+    @param[in]
+    A           magma_z_matrix
+                input matrix A
+
+    @param[in]
+    b           magma_z_matrix
+                RHS b
+
+    @param[in,out]
+    x           magma_z_matrix*
+                solution approximation
+
+    @param[in,out]
+    solver_par  magma_z_solver_par*
+                solver parameters
+
+    @param[in]
+    precond_par magma_z_preconditioner*
+                preconditioner
+
+    @param[in]
+    queue       magma_queue_t
+                Queue to execute in.
+
+    @ingroup magmasparse_zgesv
+*******************************************************************************/
+
+
+extern "C" magma_int_t
+magma_zpidr_cpu(
+    magma_z_matrix A, magma_z_matrix b, magma_z_matrix *x,
+    magma_z_solver_par *solver_par,
+    magma_z_preconditioner *precond_par,
+    magma_queue_t queue )
+{
+    magma_int_t info = MAGMA_NOTCONVERGED;
+
+    // prepare solver feedback
+    solver_par->solver = Magma_PIDR;
+    solver_par->numiter = 0;
+    solver_par->spmv_count = 0;
+    solver_par->init_res = 0.0;
+    solver_par->final_res = 0.0;
+    solver_par->iter_res = 0.0;
+    solver_par->runtime = 0.0;
+
+    // constants
+    const magmaDoubleComplex c_zero = MAGMA_Z_ZERO;
+    const magmaDoubleComplex c_one = MAGMA_Z_ONE;
+    const magmaDoubleComplex c_n_one = MAGMA_Z_NEG_ONE;
+
+    // internal user parameters
+    const magma_int_t smoothing = 1;   // 0 = disable, 1 = enable
+    const double angle = 0.7;          // [0-1]
+
+    // local variables
+    magma_int_t iseed[4] = {0, 0, 0, 1};
+    magma_int_t dof;
+    magma_int_t n = A.num_rows;
+    magma_int_t s;
+    magma_int_t distr;
+    magma_int_t k, i, j, sk;
+    magma_int_t innerflag;
+    bool noprec = ( precond_par->solver == Magma_NONE );
+    double residual;
+    double nrm;
+    double nrmb;
+    double nrmr;
+    double nrmt;
+    double tt;
+    double rr;
+    double rho;
+    magmaDoubleComplex om;
+    magmaDoubleComplex tr;
+    magmaDoubleComplex alpha;
+    magmaDoubleComplex mkk;
+
+    // matrices and vectors
+    magma_z_matrix xs = {Magma_CSR};
+    magma_z_matrix r = {Magma_CSR}, rs = {Magma_CSR};
+    magma_z_matrix P = {Magma_CSR};
+    magma_z_matrix G = {Magma_CSR};
+    magma_z_matrix U = {Magma_CSR};
+    magma_z_matrix M = {Magma_CSR};
+    magma_z_matrix f = {Magma_CSR};
+    magma_z_matrix t = {Magma_CSR};
+    magma_z_matrix c = {Magma_CSR};
+    magma_z_matrix v = {Magma_CSR};
+    magma_z_matrix lu = {Magma_CSR};
+    magma_z_matrix hbeta = {Magma_CSR};
+    magma_z_matrix u_t = {Magma_CSR}, g_t = {Magma_CSR};
+    magma_z_matrix dwork = {Magma_CSR};
+
+    // chronometry
+    real_Double_t tempo1, tempo2;
+
+    // initial s space
+    // Uses the '--restart' option as the shadow space number,
+    // see magma_zpidr.
+    s = 1;
+    if ( solver_par->restart != 50 ) {
+        if ( solver_par->restart > A.num_cols ) {
+            s = A.num_cols;
+        } else {
+            s = solver_par->restart;
+        }
+    }
+    solver_par->restart = s;
+
+    // set max iterations
+    solver_par->maxiter = min( 2 * A.num_cols, solver_par->maxiter );
+
+    // check if matrix A is square and everything is on the host
+    if ( A.num_rows != A.num_cols ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    if ( A.memory_location != Magma_CPU || b.memory_location != Magma_CPU ||
+         x->memory_location != Magma_CPU ) {
+        info = MAGMA_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    // |b|
+    nrmb = magma_dznrm2_cpu( n, b.val, queue );
+    if ( nrmb == 0.0 ) {
+        magma_zaxpby_cpu( n, c_zero, x->val, c_zero, x->val, queue );
+        info = MAGMA_SUCCESS;
+        goto cleanup;
+    }
+
+    // r = b - A x
+    CHECK( magma_zvinit( &r, Magma_CPU, n, 1, c_zero, queue ));
+    CHECK( magma_zresidualvec_cpu( A, b, *x, &r, &nrmr, queue ));
+
+    // |r|
+    solver_par->init_res = nrmr;
+    solver_par->final_res = solver_par->init_res;
+    solver_par->iter_res = solver_par->init_res;
+    if ( solver_par->verbose > 0 ) {
+        solver_par->res_vec[0] = (real_Double_t)nrmr;
+    }
+
+    // check if initial is guess good enough
+    if ( nrmr <= solver_par->atol ||
+        nrmr/nrmb <= solver_par->rtol ) {
+        info = MAGMA_SUCCESS;
+        goto cleanup;
+    }
+
+    // P = randn(n, s)
+    CHECK( magma_zvinit( &P, Magma_CPU, n, s, c_zero, queue ));
+    distr = 3;        // 1 = unif (0,1), 2 = unif (-1,1), 3 = normal (0,1)
+    dof = P.num_rows * P.num_cols;
+    lapackf77_zlarnv( &distr, iseed, &dof, P.val );
+
+    // P = ortho(P), modified Gram-Schmidt
+    for ( j = 0; j < s; ++j ) {
+        for ( i = 0; i < j; ++i ) {
+            alpha = magma_zdotc_cpu( n, &P.val[i*n], &P.val[j*n], queue );
+            magma_zaxpby_cpu( n, -alpha, &P.val[i*n], c_one, &P.val[j*n], queue );
+        }
+        nrm = magma_dznrm2_cpu( n, &P.val[j*n], queue );
+        magma_zaxpby_cpu( n, MAGMA_Z_MAKE( 1.0/nrm, 0.0 ), &P.val[j*n], c_zero,
+                          &P.val[j*n], queue );
+    }
+
+    // allocate memory for the scalar products
+    CHECK( magma_zvinit( &hbeta, Magma_CPU, s, 1, c_zero, queue ));
+
+    // smoothing enabled
+    if ( smoothing > 0 ) {
+        // set smoothing solution vector
+        CHECK( magma_zmtransfer( *x, &xs, Magma_CPU, Magma_CPU, queue ));
+
+        // set smoothing residual vector
+        CHECK( magma_zmtransfer( r, &rs, Magma_CPU, Magma_CPU, queue ));
+    }
+
+    // G(n,s) = 0
+    CHECK( magma_zvinit( &G, Magma_CPU, n, s, c_zero, queue ));
+
+    // U(n,s) = 0
+    CHECK( magma_zvinit( &U, Magma_CPU, n, s, c_zero, queue ));
+
+    // M(s,s) = I
+    CHECK( magma_zvinit( &M, Magma_CPU, s, s, c_zero, queue ));
+    for ( i = 0; i < s; ++i ) {
+        M.val[i*s+i] = c_one;
+    }
+
+    // f = 0, c = 0
+    CHECK( magma_zvinit( &f, Magma_CPU, s, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &c, Magma_CPU, s, 1, c_zero, queue ));
+
+    // t = 0, v = 0, lu = 0
+    CHECK( magma_zvinit( &t, Magma_CPU, n, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &v, Magma_CPU, n, 1, c_zero, queue ));
+    CHECK( magma_zvinit( &lu, Magma_CPU, n, 1, c_zero, queue ));
+
+    // views on single columns of U and G
+    u_t.memory_location = Magma_CPU;
+    u_t.storage_type = Magma_DENSE;
+    u_t.num_rows = n;
+    u_t.num_cols = 1;
+    u_t.nnz = n;
+    g_t = u_t;
+
+    //--------------START TIME---------------
+    // chronometry
+    tempo1 = magma_wtime();
+    if ( solver_par->verbose > 0 ) {
+        solver_par->timing[0] = 0.0;
+    }
+
+    om = MAGMA_Z_ONE;
+    innerflag = 0;
+
+    // start iteration
+    do
+    {
+        solver_par->numiter++;
+
+        // new RHS for small systems
+        // f = P' r
+        magma_zmdotc_cpu( n, s, P.val, n, r.val, f.val, queue );
+
+        // shadow space loop
+        for ( k = 0; k < s; ++k ) {
+            sk = s - k;
+
+            // M(k:s,k:s) c(k:s) = f(k:s)
+            for ( i = k; i < s; ++i ) {
+                c.val[i] = f.val[i];
+                for ( j = k; j < i; ++j ) {
+                    c.val[i] -= M.val[j*s+i] * c.val[j];
+                }
+                c.val[i] = c.val[i] / M.val[i*s+i];
+            }
+
+            // v = r - G(:,k:s) c(k:s)
+            magma_zaxpby_cpu( n, c_one, r.val, c_zero, v.val, queue );
+            magma_zmgemv_cpu( n, sk, c_n_one, &G.val[k*n], n, &c.val[k], c_one, v.val, queue );
+
+            // preconditioning operation
+            // v = M \ v;
+            if ( ! noprec ) {
+                CHECK( magma_z_applyprecond_cpu( A, v, &lu, &dwork, precond_par, queue ));
+                magma_zmatrix_swap( &v, &lu, queue );
+            }
+
+            // U(:,k) = om * v + U(:,k:s) c(k:s)
+            magma_zmgemv_cpu( n, sk, c_one, &U.val[k*n], n, &c.val[k], om, v.val, queue );
+            magma_zaxpby_cpu( n, c_one, v.val, c_zero, &U.val[k*n], queue );
+
+            // G(:,k) = A U(:,k)
+            u_t.val = &U.val[k*n];
+            g_t.val = &G.val[k*n];
+            CHECK( magma_z_spmv( c_one, A, u_t, c_zero, g_t, queue ));
+            solver_par->spmv_count++;
+
+            // bi-orthogonalize the new basis vectors
+            for ( i = 0; i < k; ++i ) {
+                // alpha = P(:,i)' G(:,k) / M(i,i)
+                alpha = magma_zdotc_cpu( n, &P.val[i*n], &G.val[k*n], queue );
+                alpha = alpha / M.val[i*s+i];
+
+                // G(:,k) = G(:,k) - alpha * G(:,i)
+                magma_zaxpby_cpu( n, -alpha, &G.val[i*n], c_one, &G.val[k*n], queue );
+
+                // U(:,k) = U(:,k) - alpha * U(:,i)
+                magma_zaxpby_cpu( n, -alpha, &U.val[i*n], c_one, &U.val[k*n], queue );
+            }
+
+            // new column of M = P'G, first k-1 entries are zero
+            // M(k:s,k) = P(:,k:s)' G(:,k)
+            magma_zmdotc_cpu( n, sk, &P.val[k*n], n, &G.val[k*n], &M.val[k*s+k], queue );
+
+            // check M(k,k) == 0
+            mkk = M.val[k*s+k];
+            if ( MAGMA_Z_EQUAL(mkk, MAGMA_Z_ZERO) ) {
+                innerflag = 1;
+                info = MAGMA_DIVERGENCE;
+                break;
+            }
+
+            // beta = f(k) / M(k,k)
+            hbeta.val[k] = f.val[k] / mkk;
+
+            // check for nan
+            if ( magma_z_isnan( hbeta.val[k] ) || magma_z_isinf( hbeta.val[k] )) {
+                innerflag = 1;
+                info = MAGMA_DIVERGENCE;
+                break;
+            }
+
+            // smoothing disabled
+            if ( smoothing <= 0 ) {
+                // r = r - beta * G(:,k), |r|
+                magma_zaxpby_cpu( n, -hbeta.val[k], &G.val[k*n], c_one, r.val, queue );
+                nrmr = magma_dznrm2_cpu( n, r.val, queue );
+
+            // smoothing enabled
+            } else {
+                // x = x + beta * U(:,k), r = r - beta * G(:,k)
+                magma_zcgmerge_xr_cpu( n, hbeta.val[k], &U.val[k*n], &G.val[k*n],
+                                       x->val, r.val, &rr, queue );
+
+                // smoothing operation, |rs|
+                magma_zidrmerge_smoothing_cpu( n, r.val, x->val, rs.val, xs.val, &nrmr, queue );
+            }
+
+            // store current timing and residual
+            if ( solver_par->verbose > 0 ) {
+                tempo2 = magma_wtime();
+                if ( (solver_par->numiter) % solver_par->verbose == 0 ) {
+                    solver_par->res_vec[(solver_par->numiter) / solver_par->verbose]
+                            = (real_Double_t)nrmr;
+                    solver_par->timing[(solver_par->numiter) / solver_par->verbose]
+                            = (real_Double_t)tempo2 - tempo1;
+                }
+            }
+
+            // check convergence
+            if ( nrmr <= solver_par->atol ||
+                nrmr/nrmb <= solver_par->rtol ) {
+                s = k + 1; // for the x-update outside the loop
+                innerflag = 2;
+                info = MAGMA_SUCCESS;
+                break;
+            }
+
+            // non-last s iteration
+            if ( (k + 1) < s ) {
+                // f(k+1:s) = f(k+1:s) - beta * M(k+1:s,k)
+                for ( i = k+1; i < s; ++i ) {
+                    f.val[i] -= hbeta.val[k] * M.val[k*s+i];
+                }
+            }
+        }
+
+        // smoothing disabled
+        if ( smoothing <= 0 && innerflag != 1 ) {
+            // update solution approximation x
+            // x = x + U(:,1:s) * beta(1:s)
+            magma_zmgemv_cpu( n, s, c_one, U.val, n, hbeta.val, c_one, x->val, queue );
+        }
+
+        // check convergence or iteration limit or invalid result of inner loop
+        if ( innerflag > 0 ) {
+            break;
+        }
+
+        // v = M \ r
+        if ( noprec ) {
+            magma_zaxpby_cpu( n, c_one, r.val, c_zero, v.val, queue );
+        } else {
+            CHECK( magma_z_applyprecond_cpu( A, r, &v, &dwork, precond_par, queue ));
+        }
+
+        // t = A v
+        CHECK( magma_z_spmv( c_one, A, v, c_zero, t, queue ));
+        solver_par->spmv_count++;
+
+        // computation of a new omega
+//---------------------------------------
+        // t'r, |t|
+        magma_zbicgmerge_ts_cpu( n, t.val, r.val, &tr, &tt, queue );
+        nrmt = sqrt( tt );
+
+        // rho = abs(t' * r) / (|t| * |r|))
+        rho = MAGMA_D_ABS( MAGMA_Z_REAL(tr) / (nrmt * nrmr) );
+
+        // om = (t' * r) / (|t| * |t|)
+        om = tr / (nrmt * nrmt);
+        if ( rho < angle ) {
+            om = (om * angle) / rho;
+        }
+//---------------------------------------
+        if ( MAGMA_Z_EQUAL(om, MAGMA_Z_ZERO) ) {
+            info = MAGMA_DIVERGENCE;
+            break;
+        }
+
+        // update approximation vector and residual vector
+        // x = x + om * v, r = r - om * t
+        magma_zcgmerge_xr_cpu( n, om, v.val, t.val, x->val, r.val, &rr, queue );
+
+        // smoothing disabled
+        if ( smoothing <= 0 ) {
+            // residual norm
+            nrmr = sqrt( rr );
+
+        // smoothing enabled
+        } else {
+            // smoothing operation, |rs|
+            magma_zidrmerge_smoothing_cpu( n, r.val, x->val, rs.val, xs.val, &nrmr, queue );
+        }
+
+        // store current timing and residual
+        if ( solver_par->verbose > 0 ) {
+            tempo2 = magma_wtime();
+            if ( (solver_par->numiter) % solver_par->verbose == 0 ) {
+                solver_par->res_vec[(solver_par->numiter) / solver_par->verbose]
+                        = (real_Double_t)nrmr;
+                solver_par->timing[(solver_par->numiter) / solver_par->verbose]
+                        = (real_Double_t)tempo2 - tempo1;
+            }
+        }
+
+        // check convergence
+        if ( nrmr <= solver_par->atol ||
+            nrmr/nrmb <= solver_par->rtol ) {
+            info = MAGMA_SUCCESS;
+            break;
+        }
+    }
+    while ( solver_par->numiter + 1 <= solver_par->maxiter );
+
+    // smoothing enabled
+    if ( smoothing > 0 ) {
+        // x = xs, r = rs
+        magma_zaxpby_cpu( n, c_one, xs.val, c_zero, x->val, queue );
+        magma_zaxpby_cpu( n, c_one, rs.val, c_zero, r.val, queue );
+    }
+
+    // get last iteration timing
+    tempo2 = magma_wtime();
+    solver_par->runtime = (real_Double_t)tempo2 - tempo1;
+//--------------STOP TIME----------------
+
+    // get final stats
+    solver_par->iter_res = nrmr;
+    CHECK( magma_zresidualvec_cpu( A, b, *x, &r, &residual, queue ));
+    solver_par->final_res = residual;
+
+    // set solver conclusion
+    if ( info != MAGMA_SUCCESS && info != MAGMA_DIVERGENCE ) {
+        if ( solver_par->init_res > solver_par->final_res ) {
+            info = MAGMA_SLOW_CONVERGENCE;
+        }
+    }
+
+
+cleanup:
+    // free resources
+    magma_zmfree( &xs, queue );
+    magma_zmfree( &rs, queue );
+    magma_zmfree( &r, queue );
+    magma_zmfree( &P, queue );
+    magma_zmfree( &G, queue );
+    magma_zmfree( &U, queue );
+    magma_zmfree( &M, queue );
+    magma_zmfree( &f, queue );
+    magma_zmfree( &t, queue );
+    magma_zmfree( &c, queue );
+    magma_zmfree( &v, queue );
+    magma_zmfree( &lu, queue );
+    magma_zmfree( &hbeta, queue );
+    magma_zmfree( &dwork, queue );
+
+    solver_par->info = info;
+    return info;
+    /* magma_zpidr_cpu */
+}
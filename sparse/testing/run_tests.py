@@ -293,7 +293,7 @@ if (     not opts.jacobi_prec
      and not opts.ilu_bjac_prec
      and not opts.ilu_isai_prec ):
     opts.jacobi_prec      = True
-    opts.ilu_prec         = True
+    opts.ilu_exact_prec   = True
     opts.ilu_jac_prec     = True
     opts.ilu_isai_prec    = True
     opts.ilu_bjac_prec    = True
@@ -416,6 +416,21 @@ if ( opts.lsqr ):
 
 
 
+# looping over host solvers
+cpusolvers = []
+if ( opts.pcg ):
+    cpusolvers += ['--solver PCG ']
+# end
+if ( opts.pbicgstab ):
+    cpusolvers += ['--solver PBICGSTAB ']
+# end
+if ( opts.pgmres ):
+    cpusolvers += ['--solver PGMRES ']
+# end
+if ( opts.pidr ):
+    cpusolvers += ['--solver PIDR ']
+# end
+
 # looping over eigensolvers
 IR = []
 if ( opts.iterref ):
@@ -446,6 +461,16 @@ if ( opts.ilu_isai_prec ):
 # end
 
 
+# looping over preconditioners of the host solvers
+cpuprecs = ['--precond NONE ']
+if ( opts.jacobi_prec ):
+    cpuprecs += ['--precond JACOBI ']
+# end
+if ( opts.ilu_exact_prec ):
+    cpuprecs += ['--precond ILU ']
+    cpuprecs += ['--precond ILU --trisolver SYNCFREESOLVE ']
+# end
+
 # looping over preconditioners for Iter-Ref
 IRprecs = []
 if ( opts.iterref ):
@@ -574,6 +599,22 @@ if ( opts.control):
             cmd = substitute( 'testing_zmcompressor', 'z', precision )
             tests.append( [cmd, '', size, ''] )
 
+# ----------------------------------------------------------------------
+if ( opts.control):
+    for precision in opts.precisions:
+        for size in sizes:
+            # precision generation
+            cmd = substitute( 'testing_zmreorder', 'z', precision )
+            tests.append( [cmd, '', size, ''] )
+
+# ----------------------------------------------------------------------
+if ( opts.control):
+    for precision in opts.precisions:
+        for size in sizes:
+            # precision generation
+            cmd = substitute( 'testing_zparilut_candidates', 'z', precision )
+            tests.append( [cmd, '', size, ''] )
+
 # ----------------------------------------------------------------------
 if ( opts.control):
     for precision in opts.precisions:
@@ -624,6 +665,16 @@ for solver in precsolvers:
                 tests.append( [cmd, solver + ' ' + precond, size, ''] )
 
 
+# ----------------------------------------------------------------------
+# host solvers; all sizes in one run, so each setup replaces the last one
+for solver in cpusolvers:
+    for precond in cpuprecs:
+        for precision in opts.precisions:
+            # precision generation
+            cmd = substitute( 'testing_zsolver_cpu', 'z', precision )
+            tests.append( [cmd, solver + ' ' + precond, ' '.join( sizes ), ''] )
+
+
 # ----------------------------------------------------------------------
 for solver in IR:
     for precond in IRprecs:
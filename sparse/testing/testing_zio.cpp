@@ -41,17 +41,20 @@ int main(  int argc, char** argv )
     
     real_Double_t res;
     magma_z_matrix A={Magma_CSR}, A2={Magma_CSR}, 
-    A3={Magma_CSR}, A4={Magma_CSR}, A5={Magma_CSR};
+    A3={Magma_CSR}, A4={Magma_CSR}, A5={Magma_CSR}, A6={Magma_CSR},
+    A7={Magma_CSR};
     
     int i=1;
     TESTING_CHECK( magma_zparse_opts( argc, argv, &zopts, &i, queue ));
 
     while( i < argc ) {
+        const char *mtxname = NULL;
         if ( strcmp("LAPLACE2D", argv[i]) == 0 && i+1 < argc ) {   // Laplace test
             i++;
             magma_int_t laplace_size = atoi( argv[i] );
             TESTING_CHECK( magma_zm_5stencil(  laplace_size, &A, queue ));
         } else {                        // file-matrix test
+            mtxname = argv[i];
             TESTING_CHECK( magma_z_csr_mtx( &A,  argv[i], queue ));
         }
 
@@ -66,8 +69,41 @@ int main(  int argc, char** argv )
         // read from file
         TESTING_CHECK( magma_z_csr_mtx( &A2, filename, queue ));
 
+        // stream the file in three row slices and compare with A2
+        magma_int_t slice_errors = 0;
+        for( magma_int_t s=0; s < 3; s++ ) {
+            magma_int_t start, end;
+            TESTING_CHECK( magma_z_csr_mtx_slice( &A7, filename, 3, s, &start, &end, queue ));
+            for( magma_int_t r=start; r < end; r++ ) {
+                magma_index_t len = A2.row[r+1] - A2.row[r];
+                if ( A7.row[r-start+1] - A7.row[r-start] != len ) {
+                    slice_errors++;
+                    continue;
+                }
+                for( magma_index_t k=0; k < len; k++ ) {
+                    if ( A7.col[ A7.row[r-start]+k ] != A2.col[ A2.row[r]+k ] ||
+                         ! MAGMA_Z_EQUAL( A7.val[ A7.row[r-start]+k ],
+                                          A2.val[ A2.row[r]+k ] ) ) {
+                        slice_errors++;
+                    }
+                }
+            }
+            magma_zmfree( &A7, queue );
+        }
+        if ( slice_errors == 0 )
+            printf("%% tester streaming IO:  ok\n");
+        else
+            printf("%% tester streaming IO:  failed\n");
+
         // delete temporary matrix
         unlink( filename );
+
+        // write to and read from binary container
+        const char *binname = "testmatrix.bin";
+        TESTING_CHECK( magma_zwrite_csr_bin( A, binname, 1, queue ));
+        TESTING_CHECK( magma_z_csr_bin( &A6, binname, 1, queue ));
+        TESTING_CHECK( magma_z_csr_mtx( &A7, binname, queue ));
+        unlink( binname );
                 
         //visualize
         printf("A2:\n");
@@ -102,10 +138,48 @@ int main(  int argc, char** argv )
         else
             printf("%% tester matrix interface:  failed\n");
 
+        TESTING_CHECK( magma_zmdiff( A, A6, &res, queue ));
+        printf("%% ||A-B||_F = %8.2e\n", res);
+        if ( res < .000001 )
+            printf("%% tester binary IO:  ok\n");
+        else
+            printf("%% tester binary IO:  failed\n");
+
+        // the generic reader maps the container as well, and freeing a
+        // view of the zero-copy matrix keeps the mapping
+        TESTING_CHECK( magma_zmdiff( A, A7, &res, queue ));
+        if ( A7.mapping == NULL || A7.ownership )
+            res = 1.0;
+        magma_zmfree(&A7, queue );
+        TESTING_CHECK( magma_zcsrget( A6, &m, &n, &row, &col, &val, queue ));
+        TESTING_CHECK( magma_zcsrset( m, n, row, col, val, &A7, queue ));
+        magma_zmfree(&A7, queue );
+        if ( res < .000001 )
+            TESTING_CHECK( magma_zmdiff( A, A6, &res, queue ));
+        printf("%% ||A-B||_F = %8.2e\n", res);
+        if ( res < .000001 )
+            printf("%% tester binary IO copy and view:  ok\n");
+        else
+            printf("%% tester binary IO copy and view:  failed\n");
+
+        // a symmetric file read as its lower triangle expands to A again
+        if ( mtxname != NULL && A.sym == Magma_SYMMETRIC ) {
+            TESTING_CHECK( magma_z_csrsym_mtx( &A4, mtxname, queue ));
+            magma_zmfree(&A5, queue );
+            TESTING_CHECK( magma_zmconvert( A4, &A5, Magma_CSRSYM, Magma_CSR, queue ));
+            TESTING_CHECK( magma_zmdiff( A, A5, &res, queue ));
+            printf("%% ||A-B||_F = %8.2e\n", res);
+            if ( A4.storage_type == Magma_CSRSYM && A5.nnz == A.nnz && res < .000001 )
+                printf("%% tester CSRSYM IO:  ok\n");
+            else
+                printf("%% tester CSRSYM IO:  failed\n");
+        }
+
         magma_zmfree(&A, queue );
         magma_zmfree(&A2, queue );
         magma_zmfree(&A4, queue );
         magma_zmfree(&A5, queue );
+        magma_zmfree(&A6, queue );
 
         i++;
     }
@@ -112,6 +112,7 @@ int main(  int argc, char** argv )
 
         // convert, copy back and forth to check everything works
 
+        B.val_format = zopts.mp_format;
         TESTING_CHECK( magma_zmconvert( AT, &B, Magma_CSR, zopts.output_format, queue ));
         magma_zmfree(&AT, queue );
         TESTING_CHECK( magma_zmtransfer( B, &dB, Magma_CPU, Magma_DEV, queue ));
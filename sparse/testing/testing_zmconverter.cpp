@@ -36,7 +36,9 @@ int main(  int argc, char** argv )
 
     real_Double_t res;
     magma_z_matrix Z={Magma_CSR}, Z2={Magma_CSR}, A={Magma_CSR}, A2={Magma_CSR}, 
-    AT={Magma_CSR}, AT2={Magma_CSR}, B={Magma_CSR};
+    AT={Magma_CSR}, AT2={Magma_CSR}, B={Magma_CSR}, C={Magma_COO};
+    magma_index_t *perm=NULL;
+    magma_int_t okay;
     int i=1;
     TESTING_CHECK( magma_zparse_opts( argc, argv, &zopts, &i, queue ));
 
@@ -127,6 +129,101 @@ int main(  int argc, char** argv )
         else
             printf("%% LUmerge tester:  failed\n");
 
+        // fused transpose, then only the values with the kept permutation
+        magma_zmfree(&AT, queue );
+        magma_zmfree(&A2, queue );
+        TESTING_CHECK( magma_zmtransposeop_cpu( A, &AT, Magma_TRANSCONJ, &perm, queue ));
+        TESTING_CHECK( magma_zmtransposeop_cpu( A, &AT, Magma_TRANSVAL, &perm, queue ));
+        TESTING_CHECK( magma_zmtranspose( AT, &A2, queue ));
+        TESTING_CHECK( magma_zmdiff( A, A2, &res, queue));
+        printf("%% ||A-A2||_F = %8.2e\n", res);
+        if ( res < .000001 )
+            printf("%% transpose permutation tester:  ok\n");
+        else
+            printf("%% transpose permutation tester:  failed\n");
+        magma_free_cpu( perm );
+        perm = NULL;
+        magma_zmfree(&AT, queue );
+        magma_zmfree(&A2, queue );
+
+        // host round trips: CSC, BCSR with a partial last block, COO
+        TESTING_CHECK( magma_zmconvert( Z, &AT, Magma_CSR, Magma_CSC, queue ));
+        TESTING_CHECK( magma_zmconvert( AT, &Z2, Magma_CSC, Magma_CSR, queue ));
+        TESTING_CHECK( magma_zmdiff( Z, Z2, &res, queue));
+        printf("%% CSC conversion tester:  %s\n", (res < .000001 ? "ok" : "failed") );
+        magma_zmfree(&AT, queue );
+        magma_zmfree(&Z2, queue );
+
+        AT.blocksize = 3;
+        TESTING_CHECK( magma_zmconvert( Z, &AT, Magma_CSR, Magma_BCSR, queue ));
+        TESTING_CHECK( magma_zmconvert( AT, &Z2, Magma_BCSR, Magma_CSR, queue ));
+        TESTING_CHECK( magma_zmdiff( Z, Z2, &res, queue));
+        printf("%% BCSR conversion tester:  %s\n", (res < .000001 ? "ok" : "failed") );
+        magma_zmfree(&AT, queue );
+        magma_zmfree(&Z2, queue );
+
+        // CSR to COO puts the row index of every entry in row
+        TESTING_CHECK( magma_zmconvert( A, &AT, Magma_CSR, Magma_COO, queue ));
+        okay = ( AT.row != NULL && AT.nnz == A.nnz );
+        for( magma_int_t r=0; okay && r < A.num_rows; r++ ) {
+            for( magma_int_t k=A.row[r]; k < A.row[r+1]; k++ ) {
+                if ( AT.row[k] != r || AT.col[k] != A.col[k] ) {
+                    okay = 0;
+                }
+            }
+        }
+        TESTING_CHECK( magma_zmconvert( AT, &A2, Magma_COO, Magma_CSR, queue ));
+        TESTING_CHECK( magma_zmdiff( A, A2, &res, queue));
+        printf("%% COO conversion tester:  %s\n", (okay && res < .000001 ? "ok" : "failed") );
+        magma_zmfree(&AT, queue );
+        magma_zmfree(&A2, queue );
+
+        // COO to CSR from entries in reverse order, with every third entry
+        // repeated at the end; the value of an entry is its input position,
+        // so duplicates have to come out in input order
+        C.memory_location = Magma_CPU;
+        C.ownership = MagmaTrue;
+        C.num_rows = A.num_rows;
+        C.num_cols = A.num_cols;
+        C.nnz = A.nnz + (A.nnz+2)/3;
+        TESTING_CHECK( magma_zmalloc_cpu( &C.val, C.nnz ));
+        TESTING_CHECK( magma_index_malloc_cpu( &C.col, C.nnz ));
+        TESTING_CHECK( magma_index_malloc_cpu( &C.row, C.nnz ));
+        for( magma_int_t r=0; r < A.num_rows; r++ ) {
+            for( magma_int_t k=A.row[r]; k < A.row[r+1]; k++ ) {
+                C.row[ A.nnz-1-k ] = r;
+                C.col[ A.nnz-1-k ] = A.col[k];
+                if ( k % 3 == 0 ) {
+                    C.row[ A.nnz + k/3 ] = r;
+                    C.col[ A.nnz + k/3 ] = A.col[k];
+                }
+            }
+        }
+        for( magma_int_t k=0; k < C.nnz; k++ ) {
+            C.val[k] = MAGMA_Z_MAKE( (double) k, 0. );
+        }
+        TESTING_CHECK( magma_zmconvert( C, &A2, Magma_COO, Magma_CSR, queue ));
+        okay = ( A2.nnz == C.nnz );
+        for( magma_int_t r=0; okay && r < A.num_rows; r++ ) {
+            magma_int_t dup = 0;
+            for( magma_int_t k=A.row[r]; k < A.row[r+1]; k++ ) {
+                dup += ( k % 3 == 0 );
+            }
+            if ( A2.row[r+1] - A2.row[r] != A.row[r+1] - A.row[r] + dup ) {
+                okay = 0;
+            }
+            for( magma_int_t k=A2.row[r]+1; okay && k < A2.row[r+1]; k++ ) {
+                if ( A2.col[k] < A2.col[k-1] ||
+                     ( A2.col[k] == A2.col[k-1] &&
+                       MAGMA_Z_REAL( A2.val[k] ) <= MAGMA_Z_REAL( A2.val[k-1] ))) {
+                    okay = 0;
+                }
+            }
+        }
+        printf("%% COO duplicate order tester:  %s\n", (okay ? "ok" : "failed") );
+        magma_zmfree(&C, queue );
+        magma_zmfree(&A2, queue );
+
         magma_zmfree(&A, queue );
         magma_zmfree(&A2, queue );
         magma_zmfree(&AT, queue );
@@ -0,0 +1,158 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> c d s
+*/
+
+// includes, system
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// includes, project
+#include "magma_v2.h"
+#include "magmasparse.h"
+#include "testings.h"
+
+
+// largest |i-j| over the nonzeros of a CSR matrix
+static magma_int_t
+bandwidth( magma_z_matrix A )
+{
+    magma_int_t bw = 0;
+    for( magma_int_t i=0; i < A.num_rows; i++ ) {
+        for( magma_int_t k=A.row[i]; k < A.row[i+1]; k++ ) {
+            magma_int_t d = ( A.col[k] > i ) ? A.col[k] - i : i - A.col[k];
+            if ( d > bw ) {
+                bw = d;
+            }
+        }
+    }
+    return bw;
+}
+
+
+/* ////////////////////////////////////////////////////////////////////////////
+   -- testing the reorderings
+*/
+int main(  int argc, char** argv )
+{
+    magma_int_t info = 0;
+    TESTING_CHECK( magma_init() );
+    magma_print_environment();
+
+    magma_zopts zopts;
+    magma_queue_t queue=NULL;
+    magma_queue_create( 0, &queue );
+
+    real_Double_t res;
+    magma_z_matrix A={Magma_CSR}, PA={Magma_CSR}, A2={Magma_CSR};
+    magma_z_matrix x={Magma_DENSE}, y={Magma_DENSE}, x2={Magma_DENSE};
+    magma_fill_stats stats;
+    magma_index_t *perm=NULL, *invp=NULL;
+    magma_reorder_t orderings[4] = { Magma_NOREORDER, Magma_RCM, Magma_AMD, Magma_ND };
+    const char *names[4] = { "NONE", "RCM", "AMD", "ND" };
+
+    int i=1;
+    TESTING_CHECK( magma_zparse_opts( argc, argv, &zopts, &i, queue ));
+
+    while( i < argc ) {
+        if ( strcmp("LAPLACE2D", argv[i]) == 0 && i+1 < argc ) {   // Laplace test
+            i++;
+            magma_int_t laplace_size = atoi( argv[i] );
+            TESTING_CHECK( magma_zm_5stencil(  laplace_size, &A, queue ));
+        } else {                        // file-matrix test
+            TESTING_CHECK( magma_z_csr_mtx( &A,  argv[i], queue ));
+        }
+
+        printf("%% matrix info: %lld-by-%lld with %lld nonzeros\n",
+                (long long) A.num_rows, (long long) A.num_cols, (long long) A.nnz );
+
+        TESTING_CHECK( magma_index_malloc_cpu( &perm, A.num_rows ));
+        TESTING_CHECK( magma_index_malloc_cpu( &invp, A.num_rows ));
+        TESTING_CHECK( magma_zvinit_rand( &x, Magma_CPU, A.num_rows, 1, queue ));
+
+        printf("%%   ordering   bandwidth   nnz(L+U) complete factorization\n");
+        for( int o=0; o < 4; o++ ) {
+            TESTING_CHECK( magma_zmorder( A, orderings[o], perm, queue ));
+
+            // perm must be a permutation
+            magma_int_t valid = 1;
+            for( magma_int_t k=0; k < A.num_rows; k++ ) {
+                invp[k] = -1;
+            }
+            for( magma_int_t k=0; k < A.num_rows; k++ ) {
+                if ( perm[k] < 0 || perm[k] >= A.num_rows || invp[ perm[k] ] != -1 ) {
+                    valid = 0;
+                    break;
+                }
+                invp[ perm[k] ] = k;
+            }
+            if ( ! valid ) {
+                printf("%% %s permutation tester:  failed\n", names[o] );
+                continue;
+            }
+
+            TESTING_CHECK( magma_zmpermute( A, perm, &PA, queue ));
+            TESTING_CHECK( magma_zsymbilu_stats( PA, PA.num_rows, &stats, queue ));
+            printf("    %8s  %10lld  %10lld\n", names[o],
+                    (long long) bandwidth( PA ), (long long) (stats.nnz_l + stats.nnz_u) );
+
+            // the inverse permutation restores A and x
+            TESTING_CHECK( magma_zmpermute( PA, invp, &A2, queue ));
+            TESTING_CHECK( magma_zmdiff( A, A2, &res, queue ));
+            TESTING_CHECK( magma_zvpermute( x, perm, MagmaNoTrans, &y, queue ));
+            TESTING_CHECK( magma_zvpermute( y, perm, MagmaTrans, &x2, queue ));
+            for( magma_int_t k=0; k < A.num_rows; k++ ) {
+                if ( ! MAGMA_Z_EQUAL( x.val[k], x2.val[k] ) ||
+                     ! MAGMA_Z_EQUAL( y.val[k], x.val[ perm[k] ] )) {
+                    res = 1.0;
+                }
+            }
+            if ( res < .000001 )
+                printf("%% %s permutation tester:  ok\n", names[o] );
+            else
+                printf("%% %s permutation tester:  failed\n", names[o] );
+
+            magma_zmfree(&PA, queue );
+            magma_zmfree(&A2, queue );
+            magma_zmfree(&y, queue );
+            magma_zmfree(&x2, queue );
+        }
+
+        magma_free_cpu( perm );
+        magma_free_cpu( invp );
+        perm = NULL;
+        invp = NULL;
+
+        // a non-square matrix falls back to the identity, unchanged
+        A.num_cols++;
+        TESTING_CHECK( magma_zmreorder( &A, Magma_RCM, &perm, queue ));
+        res = 0.0;
+        for( magma_int_t k=0; k < A.num_rows; k++ ) {
+            if ( perm[k] != k ) {
+                res = 1.0;
+            }
+        }
+        if ( res == 0.0 )
+            printf("%% non-square fallback tester:  ok\n");
+        else
+            printf("%% non-square fallback tester:  failed\n");
+        A.num_cols--;
+        magma_free_cpu( perm );
+        perm = NULL;
+        magma_zmfree(&x, queue );
+        magma_zmfree(&A, queue );
+
+        i++;
+    }
+
+    magma_queue_destroy( queue );
+    TESTING_CHECK( magma_finalize() );
+    return info;
+}
@@ -0,0 +1,167 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> c d s
+*/
+
+// includes, system
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// includes, project
+#include "magma_v2.h"
+#include "magmasparse.h"
+#include "testings.h"
+
+
+// whether the CSR patterns of A and B are the same and the entries carry the
+// same marking (3 for entries of L0, U0, 1 for fill-in), rows sorted in place
+static magma_int_t
+same_candidates( magma_z_matrix *A, magma_z_matrix *B, magma_queue_t queue )
+{
+    if ( A->num_rows != B->num_rows || A->nnz != B->nnz ) {
+        return 0;
+    }
+    TESTING_CHECK( magma_zcsr_sort( A, queue ));
+    TESTING_CHECK( magma_zcsr_sort( B, queue ));
+    for( magma_int_t k=0; k <= A->num_rows; k++ ) {
+        if ( A->row[k] != B->row[k] ) {
+            return 0;
+        }
+    }
+    for( magma_int_t k=0; k < A->nnz; k++ ) {
+        if ( A->col[k] != B->col[k] || ! MAGMA_Z_EQUAL( A->val[k], B->val[k] )) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/* ////////////////////////////////////////////////////////////////////////////
+   -- testing the incremental ParILUT candidates against
+      magma_zparilut_candidates over several ParILUT steps
+*/
+int main(  int argc, char** argv )
+{
+    magma_int_t info = 0;
+    TESTING_CHECK( magma_init() );
+    magma_print_environment();
+
+    magma_zopts zopts;
+    magma_queue_t queue=NULL;
+    magma_queue_create( 0, &queue );
+
+    magma_z_matrix A={Magma_CSR}, AT={Magma_CSR}, L0={Magma_CSR}, U0={Magma_CSR},
+        L={Magma_CSR}, U={Magma_CSR}, UT={Magma_CSR},
+        hL={Magma_CSR}, hU={Magma_CSR}, iL={Magma_CSR}, iU={Magma_CSR},
+        oneL={Magma_CSR}, oneU={Magma_CSR}, L_new={Magma_CSR}, U_new={Magma_CSR};
+    // kept across the matrices, so a new L0, U0 has to reset it
+    magma_candidate_cache cand={0};
+    magma_int_t steps = 5, L0nnz, U0nnz, num_rmL, num_rmU;
+    double fill = 2.0, thrsL, thrsU;
+
+    int i=1;
+    TESTING_CHECK( magma_zparse_opts( argc, argv, &zopts, &i, queue ));
+
+    while( i < argc ) {
+        if ( strcmp("LAPLACE2D", argv[i]) == 0 && i+1 < argc ) {   // Laplace test
+            i++;
+            magma_int_t laplace_size = atoi( argv[i] );
+            TESTING_CHECK( magma_zm_5stencil(  laplace_size, &A, queue ));
+        } else {                        // file-matrix test
+            TESTING_CHECK( magma_z_csr_mtx( &A,  argv[i], queue ));
+        }
+
+        printf("%% matrix info: %lld-by-%lld with %lld nonzeros\n",
+                (long long) A.num_rows, (long long) A.num_cols, (long long) A.nnz );
+
+        TESTING_CHECK( magma_zcsr_sort( &A, queue ));
+        TESTING_CHECK( magma_zmatrix_tril( A, &L0, queue ));
+        TESTING_CHECK( magma_zmatrix_triu( A, &U0, queue ));
+        TESTING_CHECK( magma_zmatrix_tril( A, &L, queue ));
+        TESTING_CHECK( magma_zmtranspose( A, &AT, queue ));
+        TESTING_CHECK( magma_zmatrix_tril( AT, &U, queue ));
+        TESTING_CHECK( magma_zmatrix_addrowindex( &L, queue ));
+        TESTING_CHECK( magma_zmatrix_addrowindex( &U, queue ));
+        L0nnz = L.nnz;
+        U0nnz = U.nnz;
+        oneL.memory_location = Magma_CPU;
+        oneU.memory_location = Magma_CPU;
+
+        printf("%%   step      L.nnz      U.nnz   candidates  recomputed rows\n");
+        for( magma_int_t s=0; s < steps; s++ ) {
+            TESTING_CHECK( magma_zcsrcoo_transpose( U, &UT, queue ));
+            TESTING_CHECK( magma_zparilut_candidates( L0, U0, L, UT, &hL, &hU, queue ));
+            TESTING_CHECK( magma_zparilut_candidates_inc( L0, U0, L, UT, &cand, &iL, &iU, queue ));
+            printf("    %5lld %10lld %10lld   %10lld  %10lld\n",
+                    (long long) s, (long long) L.nnz, (long long) U.nnz,
+                    (long long) (iL.nnz + iU.nnz), (long long) cand.num_recomputed );
+            if ( ! same_candidates( &hL, &iL, queue ) || ! same_candidates( &hU, &iU, queue )) {
+                printf("%% candidates step %lld tester:  failed\n", (long long) s );
+                info = -1;
+            }
+            magma_zmfree( &UT, queue );
+            magma_zmfree( &iL, queue );
+            magma_zmfree( &iU, queue );
+
+            // one ParILUT step: add all candidates, sweep, remove the smallest
+            TESTING_CHECK( magma_zparilut_residuals( A, L, U, &hL, queue ));
+            TESTING_CHECK( magma_zparilut_residuals( A, L, U, &hU, queue ));
+            TESTING_CHECK( magma_zmatrix_swap( &hL, &oneL, queue ));
+            magma_zmfree( &hL, queue );
+            TESTING_CHECK( magma_zcsrcoo_transpose( hU, &oneU, queue ));
+            magma_zmfree( &hU, queue );
+            TESTING_CHECK( magma_zmatrix_cup( L, oneL, &L_new, queue ));
+            TESTING_CHECK( magma_zmatrix_cup( U, oneU, &U_new, queue ));
+            magma_zmfree( &oneL, queue );
+            magma_zmfree( &oneU, queue );
+            TESTING_CHECK( magma_zparilut_sweep_sync( &A, &L_new, &U_new, queue ));
+            num_rmL = max( (L_new.nnz - L0nnz*(1 + (fill-1.)*(s+1)/steps)), 0 );
+            num_rmU = max( (U_new.nnz - U0nnz*(1 + (fill-1.)*(s+1)/steps)), 0 );
+            TESTING_CHECK( magma_zparilut_preselect( 0, &L_new, &oneL, queue ));
+            TESTING_CHECK( magma_zparilut_preselect( 0, &U_new, &oneU, queue ));
+            thrsL = 0.0;
+            thrsU = 0.0;
+            if ( num_rmL > 0 ) {
+                TESTING_CHECK( magma_zparilut_set_thrs_randomselect_approx( num_rmL, &oneL, 0, &thrsL, queue ));
+            }
+            if ( num_rmU > 0 ) {
+                TESTING_CHECK( magma_zparilut_set_thrs_randomselect_approx( num_rmU, &oneU, 0, &thrsU, queue ));
+            }
+            magma_zmfree( &oneL, queue );
+            magma_zmfree( &oneU, queue );
+            TESTING_CHECK( magma_zparilut_thrsrm( 1, &L_new, &thrsL, queue ));
+            TESTING_CHECK( magma_zparilut_thrsrm( 1, &U_new, &thrsU, queue ));
+            TESTING_CHECK( magma_zmatrix_swap( &L_new, &L, queue ));
+            TESTING_CHECK( magma_zmatrix_swap( &U_new, &U, queue ));
+            magma_zmfree( &L_new, queue );
+            magma_zmfree( &U_new, queue );
+            TESTING_CHECK( magma_zparilut_sweep_sync( &A, &L, &U, queue ));
+        }
+        if ( info == 0 )
+            printf("%% candidates tester:  ok\n");
+        else
+            printf("%% candidates tester:  failed\n");
+
+        magma_zmfree( &L0, queue );
+        magma_zmfree( &U0, queue );
+        magma_zmfree( &L, queue );
+        magma_zmfree( &U, queue );
+        magma_zmfree( &AT, queue );
+        magma_zmfree( &A, queue );
+
+        i++;
+    }
+
+    magma_zcandidate_cache_free( &cand, queue );
+    magma_queue_destroy( queue );
+    TESTING_CHECK( magma_finalize() );
+    return info;
+}
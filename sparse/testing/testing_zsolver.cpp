@@ -61,6 +61,9 @@ int main(  int argc, char** argv )
         // scale matrix
         TESTING_CHECK( magma_zmscale( &A, zopts.scaling, queue ));
         
+        // reorder matrix
+        TESTING_CHECK( magma_zmreorder( &A, zopts.reorder, NULL, queue ));
+        
         // preconditioner
         if ( zopts.solver_par.solver != Magma_ITERREF ) {
             TESTING_CHECK( magma_z_precondsetup( A, b, &zopts.solver_par, &zopts.precond_par, queue ) );
@@ -0,0 +1,114 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> c d s
+*/
+
+// includes, system
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// includes, project
+#include "magma_v2.h"
+#include "magmasparse.h"
+#include "testings.h"
+
+
+/* ////////////////////////////////////////////////////////////////////////////
+   -- testing the host solvers: A, b and x stay in CPU memory
+*/
+int main(  int argc, char** argv )
+{
+    magma_int_t info = 0;
+    TESTING_CHECK( magma_init() );
+    magma_print_environment();
+
+    magma_zopts zopts;
+    magma_queue_t queue;
+    magma_queue_create( 0, &queue );
+    
+    magma_z_matrix A={Magma_CSR}, B={Magma_CSR};
+    magma_z_matrix x={Magma_CSR}, b={Magma_CSR};
+    
+    int i=1;
+    TESTING_CHECK( magma_zparse_opts( argc, argv, &zopts, &i, queue ));
+    B.blocksize = zopts.blocksize;
+    B.alignment = zopts.alignment;
+
+    TESTING_CHECK( magma_zsolverinfo_init( &zopts.solver_par, &zopts.precond_par, queue ));
+
+    while( i < argc ) {
+        if ( strcmp("LAPLACE2D", argv[i]) == 0 && i+1 < argc ) {   // Laplace test
+            i++;
+            magma_int_t laplace_size = atoi( argv[i] );
+            TESTING_CHECK( magma_zm_5stencil(  laplace_size, &A, queue ));
+        } else {                        // file-matrix test
+            TESTING_CHECK( magma_z_csr_mtx( &A,  argv[i], queue ));
+        }
+
+        // scale matrix
+        TESTING_CHECK( magma_zmscale( &A, zopts.scaling, queue ));
+        
+        // reorder matrix
+        TESTING_CHECK( magma_zmreorder( &A, zopts.reorder, NULL, queue ));
+        
+        // preconditioner
+        TESTING_CHECK( magma_z_precondsetup( A, b, &zopts.solver_par, &zopts.precond_par, queue ) );
+
+        B.val_format = zopts.mp_format;
+        TESTING_CHECK( magma_zmconvert( A, &B, Magma_CSR, zopts.output_format, queue ));
+        
+        printf( "\n%% matrix info: %lld-by-%lld with %lld nonzeros\n\n",
+                            (long long) A.num_rows, (long long) A.num_cols, (long long) A.nnz );
+
+        // vectors and initial guess on the host
+        TESTING_CHECK( magma_zvinit_rand( &b, Magma_CPU, A.num_rows, 1, queue ));
+        TESTING_CHECK( magma_zvinit_rand( &x, Magma_CPU, A.num_cols, 1, queue ));
+        
+        double nrmb = magma_cblas_dznrm2( b.num_rows, b.val, 1 );
+        
+        info = magma_z_solver( B, b, &x, &zopts, queue );
+        if( info != 0 ) {
+            printf("%%error: solver returned: %s (%lld).\n",
+                    magma_strerror( info ), (long long) info );
+        }
+        printf("convergence = [\n");
+        magma_zsolverinfo( &zopts.solver_par, &zopts.precond_par, queue );
+        printf("];\n\n");
+        
+        // the true residual may lag the iterated one by a small factor
+        double tol = 10. * max( zopts.solver_par.rtol * nrmb,
+                                zopts.solver_par.atol );
+        if ( info == MAGMA_SUCCESS &&
+             zopts.solver_par.final_res <= tol )
+            printf("%% host solver tester:  ok\n");
+        else
+            printf("%% host solver tester:  failed\n");
+        
+        zopts.solver_par.verbose = 0;
+        printf("solverinfo = [\n");
+        magma_zsolverinfo( &zopts.solver_par, &zopts.precond_par, queue );
+        printf("];\n\n");
+        
+        printf("precondinfo = [\n");
+        printf("%%   setup  runtime\n");        
+        printf("  %.6f  %.6f\n",
+           zopts.precond_par.setuptime, zopts.precond_par.runtime );
+        printf("];\n\n");
+        magma_zmfree(&B, queue );
+        magma_zmfree(&A, queue );
+        magma_zmfree(&x, queue );
+        magma_zmfree(&b, queue );
+        i++;
+    }
+
+    magma_queue_destroy( queue );
+    TESTING_CHECK( magma_finalize() );
+    return info;
+}
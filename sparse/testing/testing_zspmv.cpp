@@ -87,7 +87,8 @@ int main(  int argc, char** argv )
     magma_queue_create( 0, &queue );
     magma_z_matrix hA={Magma_CSR}, hA_SELLP={Magma_CSR}, hA_ELL={Magma_CSR}, 
     dA={Magma_CSR}, dA_SELLP={Magma_CSR}, dA_ELL={Magma_CSR},
-    hA_CSR5={Magma_CSR}, dA_CSR5={Magma_CSR};
+    hA_CSR5={Magma_CSR}, dA_CSR5={Magma_CSR}, hA_SELLCS={Magma_CSR},
+    hA_CSRSYM={Magma_CSR}, hA_FULL={Magma_CSR}, hA_CSRMP={Magma_CSR};
     
     magma_z_matrix hx={Magma_CSR}, hy={Magma_CSR}, dx={Magma_CSR}, 
     dy={Magma_CSR}, hrefvec={Magma_CSR}, hcheck={Magma_CSR};
@@ -332,6 +333,121 @@ int main(  int argc, char** argv )
 
         magma_zmfree(&dA_CSR5, queue );
 
+        // SpMV on CPU (CSR and SELL-C-sigma with tuned C and sigma)
+        magma_zmfree( &hx, queue );
+        magma_zmfree( &hy, queue );
+        TESTING_CHECK( magma_zvinit( &hx, Magma_CPU, hA.num_cols, 1, c_one, queue ));
+        TESTING_CHECK( magma_zvinit( &hy, Magma_CPU, hA.num_rows, 1, c_zero, queue ));
+        start = magma_wtime();
+        for (j=0; j < 200; j++) {
+            TESTING_CHECK( magma_zspmv_cpu( c_one, hA, hx, c_zero, hy, queue ));
+        }
+        end = magma_wtime();
+        printf( "%% > host : %.2e seconds %.2e GFLOP/s    (CSR).\n",
+            (end-start)/200, FLOPS*200/(end-start) );
+        hA_SELLCS.blocksize = 0;
+        start = magma_wtime();
+        TESTING_CHECK( magma_zmconvert(  hA, &hA_SELLCS, Magma_CSR, Magma_SELLCS, queue ));
+        end = magma_wtime();
+        printf( "%% > host : SELL-C-sigma with C = %lld, sigma = %lld, "
+                "%.2e seconds to tune and convert.\n",
+                (long long) hA_SELLCS.blocksize, (long long) hA_SELLCS.alignment,
+                end-start );
+        magma_zmfree( &hy, queue );
+        TESTING_CHECK( magma_zvinit( &hy, Magma_CPU, hA.num_rows, 1, c_zero, queue ));
+        start = magma_wtime();
+        for (j=0; j < 200; j++) {
+            TESTING_CHECK( magma_zspmv_cpu( c_one, hA_SELLCS, hx, c_zero, hy, queue ));
+        }
+        end = magma_wtime();
+        res = 0.0;
+        for(magma_int_t k=0; k < hA.num_rows; k++ ){
+            res = res + MAGMA_Z_ABS(hy.val[k] - hrefvec.val[k]);
+        }
+        res = ref == 0 ? res : res / ref;
+        printf( "%% > host : %.2e seconds %.2e GFLOP/s    (SELL-C-sigma).\n",
+            (end-start)/200, FLOPS*200/(end-start) );
+        if ( res < accuracy ) {
+            printf("%% |x-y|_F/|y| = %8.2e Tester spmv SELL-C-sigma (host):  ok\n", res);
+        } else {
+            printf("%% |x-y|_F/|y| = %8.2e Tester spmv SELL-C-sigma (host):  failed\n", res);
+        }
+        magma_zmfree( &hA_SELLCS, queue );
+
+        // SpMV on CPU with the lower triangle only, if A is symmetric
+        TESTING_CHECK( magma_zmconvert(  hA, &hA_CSRSYM, Magma_CSR, Magma_CSRSYM, queue ));
+        TESTING_CHECK( magma_zmconvert(  hA_CSRSYM, &hA_FULL, Magma_CSRSYM, Magma_CSR, queue ));
+        // A is symmetric if mirroring its lower triangle gives A again
+        magma_int_t symmetric = ( hA_FULL.nnz == hA.nnz );
+        for(magma_int_t k=0; symmetric && k < hA.num_rows+1; k++ ){
+            symmetric = ( hA_FULL.row[k] == hA.row[k] );
+        }
+        for(magma_int_t k=0; symmetric && k < hA.nnz; k++ ){
+            symmetric = ( hA_FULL.col[k] == hA.col[k] &&
+                          MAGMA_Z_EQUAL( hA_FULL.val[k], hA.val[k] ));
+        }
+        if ( symmetric ) {
+            magma_zmfree( &hy, queue );
+            TESTING_CHECK( magma_zvinit( &hy, Magma_CPU, hA.num_rows, 1, c_zero, queue ));
+            start = magma_wtime();
+            for (j=0; j < 200; j++) {
+                TESTING_CHECK( magma_zspmv_cpu( c_one, hA_CSRSYM, hx, c_zero, hy, queue ));
+            }
+            end = magma_wtime();
+            res = 0.0;
+            for(magma_int_t k=0; k < hA.num_rows; k++ ){
+                res = res + MAGMA_Z_ABS(hy.val[k] - hrefvec.val[k]);
+            }
+            res = ref == 0 ? res : res / ref;
+            printf( "%% > host : %.2e seconds %.2e GFLOP/s    (CSRSYM).\n",
+                (end-start)/200, FLOPS*200/(end-start) );
+            if ( res < accuracy ) {
+                printf("%% |x-y|_F/|y| = %8.2e Tester spmv CSRSYM (host):  ok\n", res);
+            } else {
+                printf("%% |x-y|_F/|y| = %8.2e Tester spmv CSRSYM (host):  failed\n", res);
+            }
+        } else {
+            printf("%% matrix not symmetric, CSRSYM skipped.\n");
+        }
+        magma_zmfree( &hA_CSRSYM, queue );
+        magma_zmfree( &hA_FULL, queue );
+
+        // SpMV on CPU with values in float, fp16 and bfloat16; the error of
+        // every row is measured against sum_k |a_ik| |x_k| (x is all ones)
+        magma_precision mp_formats[3] = { Magma_FLOAT, Magma_HALF, Magma_BFLOAT };
+        const char *mp_names[3] = { "float", "fp16", "bfloat16" };
+        double mp_tol[3] = { 1e-5, 2e-3, 2e-2 };
+        for(magma_int_t f=0; f < 3; f++ ){
+            TESTING_CHECK( magma_zcsr2csrmp(  hA, mp_formats[f], &hA_CSRMP, queue ));
+            start = magma_wtime();
+            for (j=0; j < 200; j++) {
+                TESTING_CHECK( magma_zspmv_cpu( c_one, hA_CSRMP, hx, c_zero, hy, queue ));
+            }
+            end = magma_wtime();
+            res = 0.0;
+            for(magma_int_t i=0; i < hA.num_rows; i++ ){
+                double bound = 0.0;
+                for(magma_index_t k=hA.row[i]; k < hA.row[i+1]; k++ ){
+                    bound = bound + MAGMA_Z_ABS(hA.val[k]);
+                }
+                double err = MAGMA_Z_ABS(hy.val[i] - hrefvec.val[i]);
+                res = max( res, bound == 0.0 ? err : err / bound );
+            }
+            double bytes_csr = hA.nnz * ( sizeof(magmaDoubleComplex) + sizeof(magma_index_t) );
+            double bytes_mp = hA.nnz * ( sizeof(magmaDoubleComplex) / sizeof(double) )
+                            * ( mp_formats[f] == Magma_FLOAT ? 4 : 2 )
+                            + hA_CSRMP.rowidx[hA.num_rows] * 2.0;
+            printf( "%% > host : %.2e seconds %.2e GFLOP/s    (CSRMP %s, %.2f of CSR bytes).\n",
+                (end-start)/200, FLOPS*200/(end-start), mp_names[f],
+                bytes_csr == 0 ? 1.0 : bytes_mp / bytes_csr );
+            if ( res < mp_tol[f] ) {
+                printf("%% max row error = %8.2e Tester spmv CSRMP %s (host):  ok\n", res, mp_names[f]);
+            } else {
+                printf("%% max row error = %8.2e Tester spmv CSRMP %s (host):  failed\n", res, mp_names[f]);
+            }
+            magma_zmfree( &hA_CSRMP, queue );
+        }
+
 
         // SpMV on GPU (CUSPARSE - CSR)
         // CUSPARSE context
@@ -37,6 +37,7 @@ int main(  int argc, char** argv )
     magmaDoubleComplex zero = MAGMA_Z_MAKE(0.0, 0.0);
     magma_z_matrix A={Magma_CSR}, dB={Magma_CSR};
     magma_z_matrix x={Magma_CSR}, b={Magma_CSR};
+    magma_z_matrix hx={Magma_CSR}, hb={Magma_CSR}, hb2={Magma_CSR};
 
     int i=1;
     while( i < argc ) {
@@ -80,6 +81,20 @@ int main(  int argc, char** argv )
         TESTING_CHECK( magma_zresidual( dB, x, b, &res, queue ));
         printf("res: %f\n", res);
 
+        // host SpMV, compared against the device result
+        TESTING_CHECK( magma_zvinit( &hb, Magma_CPU, A.num_rows, 1, zero, queue ));
+        TESTING_CHECK( magma_zvinit( &hx, Magma_CPU, A.num_cols, 1, one, queue ));
+        TESTING_CHECK( magma_z_spmv( one, A, hx, zero, hb, queue ));     // hb = A hx
+        TESTING_CHECK( magma_zmtransfer( b, &hb2, Magma_DEV, Magma_CPU, queue ));
+        res = 0.0;
+        for( magma_int_t k=0; k < n; k++ ) {
+            res = max( res, MAGMA_Z_ABS( MAGMA_Z_SUB( hb.val[k], hb2.val[k] )) );
+        }
+        printf("cpu-gpu max diff: %e\n", res);
+        magma_zmfree(&hx, queue );
+        magma_zmfree(&hb, queue );
+        magma_zmfree(&hb2, queue );
+
 
         magma_zmfree(&dB, queue );
 
@@ -22,6 +22,19 @@
 #include "magmasparse.h"
 #include "testings.h"
 
+// largest difference between x and xref, relative to the largest entry of xref
+static double
+host_diff( magma_z_matrix x, magma_z_matrix xref )
+{
+    double diff = 0.0, nref = 0.0;
+    for( magma_int_t k=0; k < xref.num_rows*xref.num_cols; k++ ) {
+        diff = max( diff, MAGMA_Z_ABS( x.val[k] - xref.val[k] ));
+        nref = max( nref, MAGMA_Z_ABS( xref.val[k] ));
+    }
+    return ( nref > 0.0 ) ? diff / nref : diff;
+}
+
+
 /* ////////////////////////////////////////////////////////////////////////////
    -- testing any solver
 */
@@ -40,8 +53,14 @@ int main(  int argc, char** argv )
     magmaDoubleComplex mone = MAGMA_Z_MAKE(-1.0, 0.0);
     magma_z_matrix A={Magma_CSR}, a={Magma_CSR}, b={Magma_CSR};
     magma_z_matrix c={Magma_CSR}, d={Magma_CSR};
+    magma_z_matrix hL={Magma_CSR}, hU={Magma_CSR}, hLD={Magma_CSR}, hUD={Magma_CSR};
+    magma_z_matrix ha={Magma_CSR}, hx={Magma_CSR}, hxref={Magma_CSR}, hwork={Magma_CSR};
+    magma_trisolve_plan Lplan={0}, Uplan={0};
     magma_int_t dofs;
     double res;
+    double tol = 100 * lapackf77_dlamch( "E" );
+    real_Double_t tsetup;
+    int host_failed = 0;
     
     //Chronometry
     real_Double_t tempo1, tempo2;
@@ -738,6 +757,145 @@ int main(  int argc, char** argv )
         if(debug)printf("%% --- completed ---");
         else printf("];\n");
         
+        
+        // host triangular solves of the ILU factors, compared to the serial
+        // solve; the level-set and sync-free solves compute every row the
+        // same way as the serial solve
+        if(debug)printf("%% --- host trisolves ---\n");
+        else { printf("host_info = [\n");
+               printf("%% row-wise: level-set, sync-free, level-set 4 rhs, sync-free 4 rhs, ISAI(1)-0, ISAI(1)-3\n");
+               printf("%% col-wise: plan-setup diff_L time_L diff_U time_U serial_L serial_U\n");
+        }
+        zopts.precond_par.solver = Magma_ILU;
+        zopts.precond_par.trisolver = Magma_CUSOLVE;
+        TESTING_CHECK( magma_z_precondsetup( A, b, &zopts.solver_par, &zopts.precond_par, queue ) );
+        TESTING_CHECK( magma_zmtransfer( zopts.precond_par.L, &hL, Magma_DEV, Magma_CPU, queue ));
+        TESTING_CHECK( magma_zmtransfer( zopts.precond_par.U, &hU, Magma_DEV, Magma_CPU, queue ));
+        magma_zprecondfree( &zopts.precond_par , queue );
+        tempo1 = magma_wtime();
+        TESTING_CHECK( magma_ztrisolve_plan_create( MagmaLower, MagmaUnit, hL, &Lplan, queue ));
+        TESTING_CHECK( magma_ztrisolve_plan_create( MagmaUpper, MagmaNonUnit, hU, &Uplan, queue ));
+        tsetup = magma_wtime() - tempo1;
+        if(debug)printf("%% levels: L %lld U %lld\n",
+                        (long long) Lplan.num_levels, (long long) Uplan.num_levels );
+        
+        for( magma_int_t nrhs=1; nrhs <= 4; nrhs += 3 ) {
+            TESTING_CHECK( magma_zvinit( &ha, Magma_CPU, A.num_rows, nrhs, one, queue ));
+            TESTING_CHECK( magma_zvinit( &hx, Magma_CPU, A.num_rows, nrhs, zero, queue ));
+            TESTING_CHECK( magma_zvinit( &hxref, Magma_CPU, A.num_rows, nrhs, zero, queue ));
+            for( magma_int_t k=0; k < A.num_rows*nrhs; k++ ) {
+                ha.val[k] = MAGMA_Z_MAKE( 1.0 + (k % 7), (k % 3) );
+            }
+            for( int sync=0; sync < 2; sync++ ) {
+                real_Double_t tserial_L, tserial_U;
+                if(debug)printf("%% %s, %lld rhs\n", sync ? "sync-free" : "level-set", (long long) nrhs );
+                else printf("%.6e\t", tsetup );
+                
+                // L
+                tempo1 = magma_wtime();
+                TESTING_CHECK( magma_ztrisolve_serial_cpu( MagmaLower, MagmaUnit, hL, ha, &hxref, queue ));
+                tserial_L = magma_wtime() - tempo1;
+                tempo1 = magma_wtime();
+                if ( sync ) {
+                    TESTING_CHECK( magma_ztrisolve_syncfree_cpu( hL, Lplan, ha, &hx, queue ));
+                } else {
+                    TESTING_CHECK( magma_ztrisolve_cpu( hL, Lplan, ha, &hx, queue ));
+                }
+                tempo2 = magma_wtime();
+                res = host_diff( hx, hxref );
+                host_failed += ( res > tol );
+                if(debug)printf("%% diff_L = %.6e\n%% time_L = %.6e\n", res, tempo2-tempo1 );
+                else printf("%.6e\t%.6e\t", res, tempo2-tempo1 );
+                
+                // U
+                tempo1 = magma_wtime();
+                TESTING_CHECK( magma_ztrisolve_serial_cpu( MagmaUpper, MagmaNonUnit, hU, ha, &hxref, queue ));
+                tserial_U = magma_wtime() - tempo1;
+                tempo1 = magma_wtime();
+                if ( sync ) {
+                    TESTING_CHECK( magma_ztrisolve_syncfree_cpu( hU, Uplan, ha, &hx, queue ));
+                } else {
+                    TESTING_CHECK( magma_ztrisolve_cpu( hU, Uplan, ha, &hx, queue ));
+                }
+                tempo2 = magma_wtime();
+                res = host_diff( hx, hxref );
+                host_failed += ( res > tol );
+                if(debug)printf("%% diff_U = %.6e\n%% time_U = %.6e\n", res, tempo2-tempo1 );
+                else printf("%.6e\t%.6e\t", res, tempo2-tempo1 );
+                if(debug)printf("%% time_serial_L = %.6e\n%% time_serial_U = %.6e\n", tserial_L, tserial_U );
+                else printf("%.6e\t%.6e\n", tserial_L, tserial_U );
+            }
+            magma_zmfree(&ha, queue );
+            magma_zmfree(&hx, queue );
+            magma_zmfree(&hxref, queue );
+        }
+        magma_zmfree(&hL, queue );
+        magma_zmfree(&hU, queue );
+        magma_ztrisolve_plan_free( &Lplan, queue );
+        magma_ztrisolve_plan_free( &Uplan, queue );
+        
+        // ISAI on the host: x = M b, plus relaxation steps
+        zopts.precond_par.solver = Magma_ILU;
+        zopts.precond_par.trisolver = Magma_ISAI;
+        zopts.precond_par.pattern = 1;
+        zopts.precond_par.maxiter = 0;
+        TESTING_CHECK( magma_z_precondsetup( A, b, &zopts.solver_par, &zopts.precond_par, queue ) );
+        if( zopts.precond_par.trisolver == Magma_ISAI ){
+            TESTING_CHECK( magma_zmtransfer( zopts.precond_par.L, &hL, Magma_DEV, Magma_CPU, queue ));
+            TESTING_CHECK( magma_zmtransfer( zopts.precond_par.U, &hU, Magma_DEV, Magma_CPU, queue ));
+            TESTING_CHECK( magma_zmtransfer( zopts.precond_par.LD, &hLD, Magma_DEV, Magma_CPU, queue ));
+            TESTING_CHECK( magma_zmtransfer( zopts.precond_par.UD, &hUD, Magma_DEV, Magma_CPU, queue ));
+            TESTING_CHECK( magma_zvinit( &ha, Magma_CPU, A.num_rows, 1, one, queue ));
+            TESTING_CHECK( magma_zvinit( &hx, Magma_CPU, A.num_rows, 1, zero, queue ));
+            TESTING_CHECK( magma_zvinit( &hxref, Magma_CPU, A.num_rows, 1, zero, queue ));
+            for( magma_int_t sweeps=0; sweeps <= 3; sweeps += 3 ) {
+                real_Double_t tserial_L, tserial_U;
+                if(debug)printf("%% ISAI(1)-%lld\n", (long long) sweeps );
+                else printf("%.6e\t", zopts.precond_par.setuptime );
+                
+                tempo1 = magma_wtime();
+                TESTING_CHECK( magma_ztrisolve_serial_cpu( MagmaLower, MagmaUnit, hL, ha, &hxref, queue ));
+                tserial_L = magma_wtime() - tempo1;
+                tempo1 = magma_wtime();
+                TESTING_CHECK( magma_ztrisolve_isai_cpu( hL, hLD, ha, &hx, &hwork, sweeps, queue ));
+                tempo2 = magma_wtime();
+                res = host_diff( hx, hxref );
+                if(debug)printf("%% diff_L = %.6e\n%% time_L = %.6e\n", res, tempo2-tempo1 );
+                else printf("%.6e\t%.6e\t", res, tempo2-tempo1 );
+                
+                tempo1 = magma_wtime();
+                TESTING_CHECK( magma_ztrisolve_serial_cpu( MagmaUpper, MagmaNonUnit, hU, ha, &hxref, queue ));
+                tserial_U = magma_wtime() - tempo1;
+                tempo1 = magma_wtime();
+                TESTING_CHECK( magma_ztrisolve_isai_cpu( hU, hUD, ha, &hx, &hwork, sweeps, queue ));
+                tempo2 = magma_wtime();
+                res = host_diff( hx, hxref );
+                if(debug)printf("%% diff_U = %.6e\n%% time_U = %.6e\n", res, tempo2-tempo1 );
+                else printf("%.6e\t%.6e\t", res, tempo2-tempo1 );
+                if(debug)printf("%% time_serial_L = %.6e\n%% time_serial_U = %.6e\n", tserial_L, tserial_U );
+                else printf("%.6e\t%.6e\n", tserial_L, tserial_U );
+            }
+            magma_zmfree(&ha, queue );
+            magma_zmfree(&hx, queue );
+            magma_zmfree(&hxref, queue );
+            magma_zmfree(&hwork, queue );
+            magma_zmfree(&hL, queue );
+            magma_zmfree(&hU, queue );
+            magma_zmfree(&hLD, queue );
+            magma_zmfree(&hUD, queue );
+        } else {
+            printf("NaN\tNaN\tNaN\tNaN\tNaN\tNaN\tNaN\n" );
+            printf("NaN\tNaN\tNaN\tNaN\tNaN\tNaN\tNaN\n" );
+        }
+        magma_zprecondfree( &zopts.precond_par , queue );
+        if(debug)printf("%% --- completed ---\n");
+        else printf("];\n");
+        if ( host_failed == 0 ) {
+            printf("%% host trisolve tester:  ok\n");
+        } else {
+            printf("%% host trisolve tester:  failed\n");
+        }
+        
         magma_zmfree(&A, queue );
         magma_zmfree(&b, queue );
         magma_zmfree(&c, queue );
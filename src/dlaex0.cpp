@@ -9,14 +9,268 @@
        
        @precisions normal d -> s
 */
-#include "magma_internal.h"
+#include <mutex>
+#include <vector>
+
+#include "thread_queue.hpp"
 #include "magma_timer.h"
 
+#include "magma_internal.h"  // after thread_queue.hpp, so max, min are defined
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef MAGMA_NOAFFINITY
+#include "affinity.h"
+#endif
+
+
+#define Q(i_,j_) (Q + (i_) + (j_)*ldq)
+
+/******************************************************************************/
+// Node of the divide and conquer tree of a split block. It covers rows and
+// columns [start, start+size) of Q. Leaves are solved with dsteqr; other nodes
+// merge the eigensystems of their children [start, start+cut) and
+// [start+cut, start+size).
+struct magma_dlaex0_node
+{
+    magma_int_t start, size, cut;
+    magma_int_t left, right;    // children, -1 for leaves
+    magma_int_t block;
+    magma_int_t info;
+};
+
+
+/******************************************************************************/
+// Trees of all split blocks, in post order, with the arguments they share.
+// Every node works on slices of work, iwork and dwork that are given by its
+// rows, so nodes without common rows can run concurrently.
+struct magma_dlaex0_tree
+{
+    magma_int_t n;
+    const magma_int_t *bstart, *bsize;
+    double *d, *e, *Q;
+    magma_int_t ldq;
+    double *work;
+    magma_int_t *iwork;
+    magmaDouble_ptr dwork;
+    magma_range_t range;
+    double vl, vu;
+    magma_int_t il, iu;
+
+    std::vector< magma_dlaex0_node > nodes;
+    std::vector< magma_int_t > root;        // root node of each block
+
+    // queues for the merges, each used by one merge at a time
+    magma_device_t cdev;
+    std::mutex mutex;
+    std::vector< magma_queue_t > queues;
+};
+
+
+/******************************************************************************/
+static magma_queue_t
+magma_dlaex0_get_queue( magma_dlaex0_tree *t )
+{
+    std::lock_guard< std::mutex > lock( t->mutex );
+    magma_queue_t queue;
+    if ( t->queues.empty() ) {
+        magma_queue_create( t->cdev, &queue );
+    }
+    else {
+        queue = t->queues.back();
+        t->queues.pop_back();
+    }
+    return queue;
+}
+
+
+/******************************************************************************/
+static void
+magma_dlaex0_put_queue( magma_dlaex0_tree *t, magma_queue_t queue )
+{
+    std::lock_guard< std::mutex > lock( t->mutex );
+    t->queues.push_back( queue );
+}
+
+
+/******************************************************************************/
+// Adds the tree of rows [start, start+size) of block b with lvls levels below
+// its root, and applies the rank-1 cuts. Returns the index of the root.
+static magma_int_t
+magma_dlaex0_split(
+    magma_dlaex0_tree *t, magma_int_t start, magma_int_t size,
+    magma_int_t lvls, magma_int_t b )
+{
+    magma_dlaex0_node node = { start, size, 0, -1, -1, b, 0 };
+    if (lvls > 0) {
+        // as in LAPACK, the left half gets size/2 rows
+        node.cut   = size/2;
+        node.left  = magma_dlaex0_split( t, start, node.cut, lvls-1, b );
+        node.right = magma_dlaex0_split( t, start + node.cut, size - node.cut, lvls-1, b );
+
+        magma_int_t submat = start + node.cut;
+        t->d[submat-1] -= MAGMA_D_ABS(t->e[submat-1]);
+        t->d[submat]   -= MAGMA_D_ABS(t->e[submat-1]);
+    }
+    t->nodes.push_back( node );
+    return t->nodes.size() - 1;
+}
+
+
+/******************************************************************************/
+// Solves the leaf k, or merges the eigensystems of its children.
+// On failure, the node's info is set relative to its block, as in magma_dlaex0.
+static void
+magma_dlaex0_solve( magma_dlaex0_tree *t, magma_int_t k, magma_queue_t queue )
+{
+    magma_dlaex0_node& node = t->nodes[k];
+
+    magma_int_t n = t->n;
+    magma_int_t ldq = t->ldq;
+    magma_int_t bn = t->bsize[ node.block ];
+    magma_int_t start = node.start;
+    magma_int_t size = node.size;
+    magma_int_t submat = start - t->bstart[ node.block ];
+    magma_int_t *indxq = &t->iwork[ 4*n + 3 + start ];
+    double *Q = t->Q + start + start*ldq;
+    double *work = &t->work[ start*(n + 4) ];
+    magma_int_t iinfo = 0;
+
+    if (node.left < 0) {
+        lapackf77_dsteqr("I", &size, &t->d[start], &t->e[start],
+                         Q, &ldq, work, &iinfo);  // change to edc?
+        for (magma_int_t j = 0; j < size; ++j) {
+            indxq[j] = j + 1;
+        }
+    }
+    else {
+        // skip if a child failed
+        node.info = t->nodes[ node.left ].info;
+        if (node.info == 0)
+            node.info = t->nodes[ node.right ].info;
+        if (node.info != 0)
+            return;
+
+        // Merge lower order eigensystems (of size CUT and SIZE - CUT)
+        // into an eigensystem of size SIZE.
+        // We need all the eigenvectors if it is not last step
+        magma_range_t range2 = (size == n ? t->range : MagmaRangeAll);
+        magma_dlaex1(size, &t->d[start], Q, ldq, indxq,
+                     t->e[start + node.cut - 1], node.cut,
+                     work, &t->iwork[ 4*start ], &t->dwork[ 3*start*(n/2 + 1) ],
+                     queue, range2, t->vl, t->vu, t->il, t->iu, &iinfo);
+    }
+    if (iinfo != 0) {
+        node.info = (submat+1)*(bn+1) + submat + size;
+    }
+}
+
+
+/******************************************************************************/
+// Re-merges the eigenvalues/vectors of block b which were deflated at its
+// final merge step.
+static void
+magma_dlaex0_finish( magma_dlaex0_tree *t, magma_int_t b )
+{
+    if (t->nodes[ t->root[b] ].info != 0)
+        return;
+
+    magma_int_t ione = 1;
+    magma_int_t ldq = t->ldq;
+    magma_int_t start = t->bstart[b];
+    magma_int_t m = t->bsize[b];
+    magma_int_t *indxq = &t->iwork[ 4*t->n + 3 + start ];
+    double *d = &t->d[start];
+    double *Q = t->Q + start + start*ldq;
+    double *work = &t->work[ start*(t->n + 4) ];
+
+    for (magma_int_t i = 0; i < m; ++i) {
+        magma_int_t j = indxq[i] - 1;
+        work[i] = d[j];
+        blasf77_dcopy(&m, Q(0, j), &ione, &work[ m*(i+1) ], &ione);
+    }
+    blasf77_dcopy(&m, work, &ione, d, &ione);
+    lapackf77_dlacpy( "A", &m, &m, &work[m], &m, Q, &ldq );
+}
+
+
+/******************************************************************************/
+// solves or merges one node, using nthread OpenMP threads in dlaex3
+class magma_dlaex0_solve_task: public magma_task
+{
+public:
+    magma_dlaex0_solve_task(
+        magma_dlaex0_tree *in_t, magma_int_t in_k, magma_int_t in_nthread
+    ):
+        // merges first, so finished subtrees are merged while they are in cache
+        magma_task( in_t->nodes[in_k].left < 0 ? 0 : 1 ),
+        t      ( in_t       ),
+        k      ( in_k       ),
+        nthread( in_nthread )
+    {}
+
+    virtual void run()
+    {
+        #ifdef _OPENMP
+        // no more threads than cpus this worker may run on, else the
+        // OpenMP team in dlaex3 shares them, e.g., if $MAGMA_AFFINITY pins it
+        int nt = int(nthread);
+        #ifndef MAGMA_NOAFFINITY
+        affinity_set set;
+        if (set.get_affinity() == 0)
+            nt = max( 1, min( nt, set.count() ));
+        #endif
+        omp_set_num_threads( nt );
+        #endif
+        if (t->nodes[k].left < 0) {
+            magma_dlaex0_solve( t, k, NULL );
+        }
+        else {
+            // queues and dwork belong to the caller's device
+            magma_setdevice( t->cdev );
+            magma_queue_t queue = magma_dlaex0_get_queue( t );
+            magma_dlaex0_solve( t, k, queue );
+            magma_dlaex0_put_queue( t, queue );
+        }
+    }
+
+private:
+    magma_dlaex0_tree *t;
+    magma_int_t k;
+    magma_int_t nthread;
+};
+
+
+/******************************************************************************/
+// re-merges one block
+class magma_dlaex0_finish_task: public magma_task
+{
+public:
+    magma_dlaex0_finish_task( magma_dlaex0_tree *in_t, magma_int_t in_b ):
+        magma_task( 2 ),
+        t( in_t ),
+        b( in_b )
+    {}
+
+    virtual void run()
+    {
+        magma_dlaex0_finish( t, b );
+    }
+
+private:
+    magma_dlaex0_tree *t;
+    magma_int_t b;
+};
+
+
 /***************************************************************************//**
     Purpose
     -------
     DLAEX0 computes all eigenvalues and the choosen eigenvectors of a
     symmetric tridiagonal matrix using the divide and conquer method.
+    Independent subproblems are solved concurrently, see magma_dlaex0_blocks.
 
     Arguments
     ---------
@@ -107,15 +361,6 @@ magma_dlaex0(
     magma_int_t il, magma_int_t iu,
     magma_int_t *info)
 {
-#define Q(i_,j_) (Q + (i_) + (j_)*ldq)
-
-    magma_int_t ione = 1;
-    magma_range_t range2;
-    magma_int_t curlvl, i, indxq;
-    magma_int_t j, k, matsiz, msd2, smlsiz;
-    magma_int_t submat, subpbs, tlvls;
-
-
     // Test the input parameters.
     *info = 0;
 
@@ -132,126 +377,237 @@ magma_dlaex0(
     if (n == 0)
         return *info;
 
-    magma_queue_t queue;
-    magma_device_t cdev;
-    magma_getdevice( &cdev );
-    magma_queue_create( cdev, &queue );
-
-    smlsiz = magma_get_smlsize_divideconquer();
-
-    // Determine the size and placement of the submatrices, and save in
-    // the leading elements of IWORK.
-    iwork[0] = n;
-    subpbs= 1;
-    tlvls = 0;
-    while (iwork[subpbs - 1] > smlsiz) {
-        for (j = subpbs; j > 0; --j) {
-            iwork[2*j - 1] = (iwork[j-1]+1)/2;
-            iwork[2*j - 2] = iwork[j-1]/2;
-        }
-        ++tlvls;
-        subpbs *= 2;
+    magma_int_t bstart = 0;
+    magma_dlaex0_blocks( n, 1, &bstart, &n, d, e, Q, ldq, work, iwork, dwork,
+                         range, vl, vu, il, iu, info );
+    return *info;
+} /* magma_dlaex0 */
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    DLAEX0_BLOCKS computes all eigenvalues and the choosen eigenvectors of
+    the independent diagonal blocks of a symmetric tridiagonal matrix using
+    the divide and conquer method, as magma_dlaex0 does for each block.
+
+    The leaf eigensolves, the merges of sibling subproblems and the blocks
+    are tasks of a dependency-driven thread queue, so they run concurrently.
+    The merges of more than half of the matrix run afterwards, one at a time,
+    with all threads.
+
+    Arguments
+    ---------
+    @param[in]
+    n       INTEGER
+            The dimension of the symmetric tridiagonal matrix.  N >= 0.
+
+    @param[in]
+    nblock  INTEGER
+            The number of blocks.  NBLOCK >= 0.
+
+    @param[in]
+    bstart  INTEGER array, dimension (NBLOCK)
+            Block i consists of the rows and columns
+            BSTART(i) through BSTART(i) + BSIZE(i) - 1, counting from 0.
+            The blocks must not overlap.
+
+    @param[in]
+    bsize   INTEGER array, dimension (NBLOCK)
+            The sizes of the blocks.  BSIZE(i) >= 1.
+
+    @param[in,out]
+    d       DOUBLE PRECISION array, dimension (N)
+            On entry, the main diagonal of the tridiagonal matrix.
+            On exit, its eigenvalues within each block.
+
+    @param[in]
+    e       DOUBLE PRECISION array, dimension (N-1)
+            The off-diagonal elements of the tridiagonal matrix.
+            The elements between blocks are not referenced.
+            On exit, E has been destroyed.
+
+    @param[in,out]
+    Q       DOUBLE PRECISION array, dimension (LDQ, N)
+            On entry, the diagonal blocks of Q will be the identity matrix.
+            On exit, they contain the eigenvectors of the blocks.
+            Elements outside of the blocks are not referenced.
+
+    @param[in]
+    ldq     INTEGER
+            The leading dimension of the array Q.  LDQ >= max(1,N).
+
+    @param
+    work    (workspace) DOUBLE PRECISION array,
+            the dimension of WORK >= 4*N + N**2.
+
+    @param
+    iwork   (workspace) INTEGER array,
+            the dimension of IWORK >= 3 + 5*N.
+
+    @param
+    dwork   (workspace) DOUBLE PRECISION array, dimension (3*N*N/2+3*N)
+
+    @param[in]
+    range   magma_range_t
+            Selects the eigenvectors as in magma_dlaex0. It applies only to
+            a block of size N; smaller blocks get all eigenvectors.
+
+    @param[in]
+    vl      DOUBLE PRECISION
+    @param[in]
+    vu      DOUBLE PRECISION
+    @param[in]
+    il      INTEGER
+    @param[in]
+    iu      INTEGER
+            See magma_dlaex0.
+
+    @param[out]
+    info    INTEGER
+      -     = 0:  successful exit.
+      -     < 0:  if INFO = -i, the i-th argument had an illegal value.
+      -     > 0:  The algorithm failed to compute an eigenvalue of a block,
+                  the first such block is reported as by magma_dlaex0,
+                  relative to the block.
+
+    @ingroup magma_laex0
+*******************************************************************************/
+extern "C" magma_int_t
+magma_dlaex0_blocks(
+    magma_int_t n, magma_int_t nblock,
+    const magma_int_t *bstart, const magma_int_t *bsize,
+    double *d, double *e,
+    double *Q, magma_int_t ldq,
+    double *work, magma_int_t *iwork,
+    magmaDouble_ptr dwork,
+    magma_range_t range, double vl, double vu,
+    magma_int_t il, magma_int_t iu,
+    magma_int_t *info)
+{
+    magma_int_t b, k, lvls, x;
+
+    // Test the input parameters.
+    *info = 0;
+
+    if ( n < 0 )
+        *info = -1;
+    else if ( nblock < 0 )
+        *info = -2;
+    else if ( ldq < max(1, n) )
+        *info = -8;
+    if ( *info != 0 ) {
+        magma_xerbla( __func__, -(*info) );
+        return *info;
     }
-    for (j=1; j < subpbs; ++j)
-        iwork[j] += iwork[j-1];
-
-    // Divide the matrix into SUBPBS submatrices of size at most SMLSIZ+1
-    // using rank-1 modifications (cuts).
-    for (i=0; i < subpbs-1; ++i) {
-        submat = iwork[i];
-        d[submat-1] -= MAGMA_D_ABS(e[submat-1]);
-        d[submat] -= MAGMA_D_ABS(e[submat-1]);
+
+    // Quick return if possible
+    if (n == 0 || nblock == 0)
+        return *info;
+
+    magma_dlaex0_tree t;
+    t.n      = n;
+    t.bstart = bstart;
+    t.bsize  = bsize;
+    t.d      = d;
+    t.e      = e;
+    t.Q      = Q;
+    t.ldq    = ldq;
+    t.work   = work;
+    t.iwork  = iwork;
+    t.dwork  = dwork;
+    t.range  = range;
+    t.vl     = vl;
+    t.vu     = vu;
+    t.il     = il;
+    t.iu     = iu;
+    magma_getdevice( &t.cdev );
+
+    magma_int_t smlsiz = magma_get_smlsize_divideconquer();
+
+    // Divide each block into submatrices of size at most SMLSIZ+1
+    // using rank-1 modifications (cuts). All leaves of a block are on the
+    // same level, as in LAPACK.
+    t.root.resize( nblock );
+    for (b = 0; b < nblock; ++b) {
+        lvls = 0;
+        for (x = bsize[b]; x > smlsiz; x = (x+1)/2)
+            ++lvls;
+        t.root[b] = magma_dlaex0_split( &t, bstart[b], bsize[b], lvls, b );
     }
 
-    indxq = 4*n + 3;
+    // Nodes of at most half of the matrix are tasks, with a share of the
+    // threads proportional to their size.
+    magma_int_t nthread = magma_get_parallel_numthreads();
+    magma_int_t nnode = t.nodes.size();
+    std::vector< bool > is_task( nnode, false );
+    if (nthread > 1) {
+        for (k = 0; k < nnode; ++k)
+            is_task[k] = (2*t.nodes[k].size <= n + 1);
+    }
 
-    // Solve each submatrix eigenproblem at the bottom of the divide and
-    // conquer tree.
-    //magma_timer_t time=0;
-    //timer_start( time );
+    if (nthread > 1) {
+        // launch threads -- each single-threaded MKL
+        magma_int_t lapack_nthread = magma_get_lapack_numthreads();
+        magma_set_lapack_numthreads( 1 );
+        magma_thread_queue tq;
+        tq.launch( nthread );
 
-    for (i = 0; i < subpbs; ++i) {
-        if (i == 0) {
-            submat = 0;
-            matsiz = iwork[0];
-        } else {
-            submat = iwork[i-1];
-            matsiz = iwork[i] - iwork[i-1];
+        // dependencies must be set before the tasks are pushed
+        std::vector< magma_task* > tasks( nnode, NULL );
+        std::vector< magma_task* > finish;
+        for (k = 0; k < nnode; ++k) {
+            if (is_task[k]) {
+                x = max( 1, nthread * t.nodes[k].size / n );
+                tasks[k] = new magma_dlaex0_solve_task( &t, k, x );
+                if (t.nodes[k].left >= 0) {
+                    tasks[k]->depends_on( tasks[ t.nodes[k].left  ] );
+                    tasks[k]->depends_on( tasks[ t.nodes[k].right ] );
+                }
+            }
         }
-        lapackf77_dsteqr("I", &matsiz, &d[submat], &e[submat],
-                         Q(submat, submat), &ldq, work, info);  // change to edc?
-        if (*info != 0) {
-            printf("info: %lld\n, submat: %lld\n", (long long) *info, (long long) submat );
-            *info = (submat+1)*(n+1) + submat + matsiz;
-            printf("info: %lld\n", (long long) *info );
-            return *info;
+        for (b = 0; b < nblock; ++b) {
+            if (is_task[ t.root[b] ]) {
+                magma_task* task = new magma_dlaex0_finish_task( &t, b );
+                task->depends_on( tasks[ t.root[b] ] );
+                finish.push_back( task );
+            }
         }
-        k = 1;
-        for (j = submat; j < iwork[i]; ++j) {
-            iwork[indxq+j] = k;
-            ++k;
+        for (k = 0; k < nnode; ++k) {
+            if (is_task[k])
+                tq.push_task( tasks[k] );
         }
+        for (size_t i = 0; i < finish.size(); ++i) {
+            tq.push_task( finish[i] );
+        }
+        tq.sync();
+        tq.quit();
+        magma_set_lapack_numthreads( lapack_nthread );
     }
 
-    //timer_stop( time );
-    //timer_printf( "  for: dsteqr = %6.2f\n", time );
-    
-    // Successively merge eigensystems of adjacent submatrices
-    // into eigensystem for the corresponding larger matrix.
-    curlvl = 1;
-    while (subpbs > 1) {
-        //timer_start( time );
-        
-        for (i=0; i < subpbs-1; i += 2) {
-            if (i == 0) {
-                submat = 0;
-                matsiz = iwork[1];
-                msd2 = iwork[0];
-            } else {
-                submat = iwork[i-1];
-                matsiz = iwork[i+1] - iwork[i-1];
-                msd2 = matsiz / 2;
-            }
-
-            // Merge lower order eigensystems (of size MSD2 and MATSIZ - MSD2)
-            // into an eigensystem of size MATSIZ.
-            // DLAEX1 is used only for the full eigensystem of a tridiagonal
-            // matrix.
-            if (matsiz == n)
-                range2 = range;
-            else
-                // We need all the eigenvectors if it is not last step
-                range2 = MagmaRangeAll;
-
-            magma_dlaex1(matsiz, &d[submat], Q(submat, submat), ldq,
-                         &iwork[indxq+submat], e[submat+msd2-1], msd2,
-                         work, &iwork[subpbs], dwork, queue,
-                         range2, vl, vu, il, iu, info);
-
-            if (*info != 0) {
-                *info = (submat+1)*(n+1) + submat + matsiz;
-                return *info;
-            }
-            iwork[i/2]= iwork[i+1];
-        }
-        subpbs /= 2;
-        ++curlvl;
-        
-        //timer_stop( time );
-        //timer_printf("%lld: time: %6.2f\n", (long long) curlvl, time );
+    // Successively merge the remaining, large eigensystems.
+    // Nodes are in post order, so children are done before their parents.
+    magma_queue_t queue = magma_dlaex0_get_queue( &t );
+    for (k = 0; k < nnode; ++k) {
+        if (! is_task[k])
+            magma_dlaex0_solve( &t, k, queue );
+    }
+    magma_dlaex0_put_queue( &t, queue );
+    for (b = 0; b < nblock; ++b) {
+        if (! is_task[ t.root[b] ])
+            magma_dlaex0_finish( &t, b );
     }
 
-    // Re-merge the eigenvalues/vectors which were deflated at the final
-    // merge step.
-    for (i = 0; i < n; ++i) {
-        j = iwork[indxq+i] - 1;
-        work[i] = d[j];
-        blasf77_dcopy(&n, Q(0, j), &ione, &work[ n*(i+1) ], &ione);
+    for (size_t i = 0; i < t.queues.size(); ++i) {
+        magma_queue_destroy( t.queues[i] );
     }
-    blasf77_dcopy(&n, work, &ione, d, &ione);
-    lapackf77_dlacpy( "A", &n, &n, &work[n], &n, Q, &ldq );
 
-    magma_queue_destroy( queue );
+    for (b = 0; b < nblock; ++b) {
+        if (t.nodes[ t.root[b] ].info != 0) {
+            *info = t.nodes[ t.root[b] ].info;
+            break;
+        }
+    }
 
     return *info;
-} /* magma_dlaex0 */
+} /* magma_dlaex0_blocks */
@@ -9,6 +9,8 @@
        
        @precisions normal d -> s
 */
+#include <vector>
+
 #include "magma_internal.h"
 
 /***************************************************************************//**
@@ -246,6 +248,12 @@ magma_dstedx(
         eps = lapackf77_dlamch( "Epsilon" );
 
         if (alleig) {
+            // Blocks larger than SMLSIZ are scaled and solved together by
+            // magma_dlaex0_blocks, so independent blocks run concurrently.
+            std::vector< magma_int_t > bstart, bsize;
+            std::vector< double > bnrm;
+            magma_int_t iinfo;
+
             start = 0;
             while ( start < n ) {
                 // Let FINISH be the position of the next subdiagonal entry
@@ -270,18 +278,13 @@ magma_dstedx(
                 if (m > smlsiz) {
                     // Scale
                     orgnrm = lapackf77_dlanst("M", &m, &d[start], &e[start]);
-                    lapackf77_dlascl("G", &izero, &izero, &orgnrm, &d_one, &m, &ione, &d[start], &m, info);
+                    lapackf77_dlascl("G", &izero, &izero, &orgnrm, &d_one, &m, &ione, &d[start], &m, &iinfo);
                     magma_int_t mm = m-1;
-                    lapackf77_dlascl("G", &izero, &izero, &orgnrm, &d_one, &mm, &ione, &e[start], &mm, info);
-
-                    magma_dlaex0( m, &d[start], &e[start], Z(start, start), ldz, work, iwork, dwork, MagmaRangeAll, vl, vu, il, iu, info);
+                    lapackf77_dlascl("G", &izero, &izero, &orgnrm, &d_one, &mm, &ione, &e[start], &mm, &iinfo);
 
-                    if ( *info != 0) {
-                        return *info;
-                    }
-
-                    // Scale Back
-                    lapackf77_dlascl("G", &izero, &izero, &d_one, &orgnrm, &m, &ione, &d[start], &m, info);
+                    bstart.push_back( start );
+                    bsize.push_back( m );
+                    bnrm.push_back( orgnrm );
                 } else {
                     lapackf77_dsteqr( "I", &m, &d[start], &e[start], Z(start, start), &ldz, work, info);
                     if (*info != 0) {
@@ -292,6 +295,20 @@ magma_dstedx(
                 start = end;
             }
 
+            if (! bstart.empty()) {
+                magma_dlaex0_blocks( n, bstart.size(), &bstart[0], &bsize[0], d, e, Z, ldz, work, iwork, dwork, MagmaRangeAll, vl, vu, il, iu, &iinfo);
+
+                if ( iinfo != 0) {
+                    *info = iinfo;
+                    return *info;
+                }
+
+                // Scale Back
+                for (i = 0; i < (magma_int_t) bstart.size(); ++i) {
+                    lapackf77_dlascl("G", &izero, &izero, &d_one, &bnrm[i], &bsize[i], &ione, &d[ bstart[i] ], &bsize[i], &iinfo);
+                }
+            }
+
 
             // If the problem split any number of times, then the eigenvalues
             // will not be properly ordered.  Here we permute the eigenvalues
@@ -16,6 +16,10 @@
 #include "magma_bulge.h"
 #include "magma_zbulge.h"
 
+#ifndef MAGMA_NOAFFINITY
+#include "affinity.h"
+#endif
+
 #define COMPLEX
 
 static void *magma_zapplyQ_parallel_section(void *arg);
@@ -269,16 +273,20 @@ static void *magma_zapplyQ_parallel_section(void *arg)
     affinity_set print_set;
     print_set.print_affinity(my_core_id, "starting affinity");
 #endif
-    cpu_set_t old_set, new_set;
-
-    //store current affinity
-    CPU_ZERO(&old_set);
-    sched_getaffinity( 0, sizeof(old_set), &old_set);
-    //set new affinity
-    // bind threads
-    CPU_ZERO(&new_set);
-    CPU_SET(my_core_id, &new_set);
-    sched_setaffinity( 0, sizeof(new_set), &new_set);
+    affinity_set original_set;
+    affinity_set new_set;
+    magma_int_t check = -1;
+    // bind threads, placed according to $MAGMA_AFFINITY
+    if (new_set.add_thread(my_core_id)) {
+        check = original_set.get_affinity();
+        if (check == 0) {
+            if (new_set.set_affinity() != 0)
+                printf("Error in sched_setaffinity (single cpu)\n");
+        }
+        else {
+            printf("Error in sched_getaffinity\n");
+        }
+    }
 #ifdef PRINTAFFINITY
     print_set.print_affinity(my_core_id, "set affinity");
 #endif
@@ -333,7 +341,10 @@ static void *magma_zapplyQ_parallel_section(void *arg)
 
 #ifndef MAGMA_NOAFFINITY
     //restore old affinity
-    sched_setaffinity(0, sizeof(old_set), &old_set);
+    if (check == 0) {
+        if (original_set.set_affinity() != 0)
+            printf("Error in sched_setaffinity (restore cpu list)\n");
+    }
 #ifdef PRINTAFFINITY
     print_set.print_affinity(my_core_id, "restored_affinity");
 #endif
@@ -255,18 +255,20 @@ static void *magma_zapplyQ_m_parallel_section(void *arg)
     print_set.print_affinity(my_core_id, "starting affinity");
 #endif
     affinity_set original_set;
-    affinity_set new_set(my_core_id);
-    magma_int_t check  = 0;
+    affinity_set new_set;
+    magma_int_t check  = -1;
     magma_int_t check2 = 0;
-    // bind threads
-    check = original_set.get_affinity();
-    if (check == 0) {
-        check2 = new_set.set_affinity();
-        if (check2 != 0)
-            printf("Error in sched_setaffinity (single cpu)\n");
-    }
-    else {
-        printf("Error in sched_getaffinity\n");
+    // bind threads, placed according to $MAGMA_AFFINITY
+    if (new_set.add_thread(my_core_id)) {
+        check = original_set.get_affinity();
+        if (check == 0) {
+            check2 = new_set.set_affinity();
+            if (check2 != 0)
+                printf("Error in sched_setaffinity (single cpu)\n");
+        }
+        else {
+            printf("Error in sched_getaffinity\n");
+        }
     }
 #ifdef PRINTAFFINITY
     print_set.print_affinity(my_core_id, "set affinity");
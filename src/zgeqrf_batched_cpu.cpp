@@ -0,0 +1,141 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include <vector>
+
+#include "magma_internal.h"
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZGEQRF computes a QR factorization of a complex M-by-N matrix A:
+    A = Q * R.
+
+    This is a batched version for the CPU host that factors batchCount
+    M-by-N matrices in parallel, with OpenMP across the batch and LAPACK
+    for each matrix. The workspace is queried once and allocated once per
+    thread. It has the same interface as magma_zgeqrf_batched, with the
+    arrays on the host.
+
+    Arguments
+    ---------
+    @param[in]
+    m       INTEGER
+            The number of rows of the matrix A.  M >= 0.
+
+    @param[in]
+    n       INTEGER
+            The number of columns of the matrix A.  N >= 0.
+
+    @param[in,out]
+    A_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDA,N)
+            On entry, the M-by-N matrix A.
+            On exit, the elements on and above the diagonal of the array
+            contain the min(M,N)-by-N upper trapezoidal matrix R (R is
+            upper triangular if m >= n); the elements below the diagonal,
+            with the array TAU, represent the orthogonal matrix Q as a
+            product of min(m,n) elementary reflectors (see Further
+            Details).
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of the array A.  LDA >= max(1,M).
+
+    @param[out]
+    tau_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array, dimension (min(M,N))
+            The scalar factors of the elementary reflectors (see Further
+            Details).
+
+    @param[out]
+    info_array  Array of INTEGERs, dimension (batchCount), for corresponding matrices.
+      -     = 0:  successful exit
+
+    @param[in]
+    batchCount  INTEGER
+                The number of matrices to operate on.
+
+    @return
+      -     = 0:  successful exit
+      -     < 0:  if INFO = -i, the i-th argument had an illegal value.
+
+    Further Details
+    ---------------
+    The matrix Q is represented as a product of elementary reflectors
+
+       Q = H(1) H(2) . . . H(k), where k = min(m,n).
+
+    Each H(i) has the form
+
+       H(i) = I - tau * v * v'
+
+    where tau is a complex scalar, and v is a complex vector with
+    v(1:i-1) = 0 and v(i) = 1; v(i+1:m) is stored on exit in A(i+1:m,i),
+    and tau in TAU(i).
+
+    @ingroup magma_geqrf_batched
+*******************************************************************************/
+extern "C" magma_int_t
+magma_zgeqrf_batched_cpu(
+    magma_int_t m, magma_int_t n,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magmaDoubleComplex **tau_array,
+    magma_int_t *info_array,
+    magma_int_t batchCount )
+{
+    /* Check arguments */
+    magma_int_t arginfo = 0;
+    if (m < 0)
+        arginfo = -1;
+    else if (n < 0)
+        arginfo = -2;
+    else if (lda < max(1,m))
+        arginfo = -4;
+    else if (batchCount < 0)
+        arginfo = -7;
+
+    if (arginfo != 0) {
+        magma_xerbla( __func__, -(arginfo) );
+        return arginfo;
+    }
+
+    for (magma_int_t s = 0; s < batchCount; ++s)
+        info_array[s] = 0;
+
+    /* Quick return if possible */
+    if (m == 0 || n == 0 || batchCount == 0) {
+        return arginfo;
+    }
+
+    // workspace query
+    magma_int_t info, lwork = -1;
+    magmaDoubleComplex query;
+    lapackf77_zgeqrf( &m, &n, A_array[0], &lda, tau_array[0], &query, &lwork, &info );
+    lwork = max( 1, magma_int_t( MAGMA_Z_REAL( query )));
+
+    // one thread per matrix
+    magma_int_t nthreads = magma_get_lapack_numthreads();
+    magma_set_lapack_numthreads( 1 );
+    magma_set_omp_numthreads( nthreads );
+
+    #pragma omp parallel
+    {
+        std::vector< magmaDoubleComplex > work( lwork );
+        #pragma omp for schedule(dynamic)
+        for (magma_int_t s = 0; s < batchCount; ++s) {
+            lapackf77_zgeqrf( &m, &n, A_array[s], &lda, tau_array[s],
+                              work.data(), &lwork, &info_array[s] );
+        }
+    }
+
+    magma_set_lapack_numthreads( nthreads );
+
+    return arginfo;
+}
@@ -0,0 +1,138 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include <vector>
+
+#include "magma_internal.h"
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZGESV solves a system of linear equations
+       A * X = B
+    where A is a general N-by-N matrix and X and B are N-by-NRHS matrices.
+    The LU decomposition with partial pivoting and row interchanges is
+    used to factor A as
+       A = P * L * U,
+    where P is a permutation matrix, L is unit lower triangular, and U is
+    upper triangular.  The factored form of A is then used to solve the
+    system of equations A * X = B.
+
+    This is a batched version for the CPU host that solves batchCount
+    systems in parallel; see magma_zgetrf_batched_cpu and
+    magma_zgetrs_batched_cpu. It has the same interface as
+    magma_zgesv_batched, with the arrays on the host.
+    As in LAPACK, B is not changed for a matrix with a zero pivot.
+
+    Arguments
+    ---------
+    @param[in]
+    n       INTEGER
+            The order of the matrix A.  N >= 0.
+
+    @param[in]
+    nrhs    INTEGER
+            The number of right hand sides, i.e., the number of columns
+            of the matrix B.  NRHS >= 0.
+
+    @param[in,out]
+    A_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDA,N).
+            On entry, each pointer is an N-by-N matrix to be factored.
+            On exit, the factors L and U from the factorization
+            A = P*L*U; the unit diagonal elements of L are not stored.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of each array A.  LDA >= max(1,N).
+
+    @param[out]
+    ipiv_array  Array of pointers, dimension (batchCount), for corresponding matrices.
+            Each is an INTEGER array, dimension (N)
+            The pivot indices; for 1 <= i <= N, row i of the
+            matrix was interchanged with row IPIV(i).
+
+    @param[in,out]
+    B_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDB,NRHS).
+            On entry, each pointer is a right hand side matrix B.
+            On exit, each pointer is the solution matrix X.
+
+    @param[in]
+    ldb     INTEGER
+            The leading dimension of each array B.  LDB >= max(1,N).
+
+    @param[out]
+    info_array  Array of INTEGERs, dimension (batchCount), for corresponding matrices.
+      -     = 0:  successful exit
+      -     > 0:  if INFO = i, U(i,i) is exactly zero. The factorization
+                  has been completed, but the factor U is exactly
+                  singular, so the solution could not be computed.
+
+    @param[in]
+    batchCount  INTEGER
+                The number of matrices to operate on.
+
+    @return
+      -     = 0:  successful exit
+      -     < 0:  if INFO = -i, the i-th argument had an illegal value.
+
+    @ingroup magma_gesv_batched
+*******************************************************************************/
+extern "C" magma_int_t
+magma_zgesv_batched_cpu(
+    magma_int_t n, magma_int_t nrhs,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t **ipiv_array,
+    magmaDoubleComplex **B_array, magma_int_t ldb,
+    magma_int_t *info_array,
+    magma_int_t batchCount )
+{
+    /* Check arguments */
+    magma_int_t arginfo = 0;
+    if (n < 0)
+        arginfo = -1;
+    else if (nrhs < 0)
+        arginfo = -2;
+    else if (lda < max(1,n))
+        arginfo = -4;
+    else if (ldb < max(1,n))
+        arginfo = -7;
+    else if (batchCount < 0)
+        arginfo = -9;
+
+    if (arginfo != 0) {
+        magma_xerbla( __func__, -(arginfo) );
+        return arginfo;
+    }
+
+    arginfo = magma_zgetrf_batched_cpu( n, n, A_array, lda, ipiv_array, info_array, batchCount );
+    if (arginfo != 0 || n == 0 || nrhs == 0) {
+        return arginfo;
+    }
+
+    // solve only the systems whose factorization succeeded
+    std::vector< magmaDoubleComplex* > A_ok, B_ok;
+    std::vector< magma_int_t* > ipiv_ok;
+    A_ok.reserve( batchCount );
+    B_ok.reserve( batchCount );
+    ipiv_ok.reserve( batchCount );
+    for (magma_int_t s = 0; s < batchCount; ++s) {
+        if (info_array[s] == 0) {
+            A_ok.push_back( A_array[s] );
+            B_ok.push_back( B_array[s] );
+            ipiv_ok.push_back( ipiv_array[s] );
+        }
+    }
+
+    arginfo = magma_zgetrs_batched_cpu( MagmaNoTrans, n, nrhs,
+                                        A_ok.data(), lda, ipiv_ok.data(),
+                                        B_ok.data(), ldb, A_ok.size() );
+    return arginfo;
+}
@@ -11,6 +11,26 @@
        @precisions normal z -> s d c
 */
 #include "magma_internal.h"
+#include "trace.h"
+
+#define COMPLEX
+
+
+/******************************************************************************/
+// flops of an m-by-n LU factorization, for the trace; same as FLOPS_ZGETRF
+// in testing/flops.h
+static double zgetrf_flops( magma_int_t m, magma_int_t n )
+{
+    double k = double( min( m, n ));
+    double l = double( max( m, n ));
+    double fmuls = 0.5 * k * (k * (l - (1./3.) * k - 1.) + l) + (2./3.) * k;
+    double fadds = 0.5 * k * (k * (l - (1./3.) * k     ) - l) + (1./6.) * k;
+    #ifdef COMPLEX
+    return 6. * fmuls + 2. * fadds;
+    #else
+    return fmuls + fadds;
+    #endif
+}
 
 
 /***************************************************************************//**
@@ -115,6 +135,8 @@ magma_zgetrf(
     if (m == 0 || n == 0)
         return *info;
 
+    magma_trace_scope trace( "magma_zgetrf", m, n, 0, zgetrf_flops( m, n ) );
+
     /* Function Body */
     nb = magma_get_zgetrf_nb( m, n );
 
@@ -209,7 +231,9 @@ magma_zgetrf(
             magmablas_ztranspose( m, n, dA(0,0), ldda, dAT(0,0), lddat, queues[0] );
         }
         
+        magma_trace_begin( "zgetrf panel", m, nb, 0, zgetrf_flops( m, nb ) );
         lapackf77_zgetrf( &m, &nb, work, &lda, ipiv, &iinfo );
+        magma_trace_end();
 
         for( j = 0; j < s; j++ ) {
             // get j-th panel from device
@@ -233,8 +257,12 @@ magma_zgetrf(
                 
                 // do the cpu part
                 rows = m - j*nb;
+                magma_trace_begin( "sync" );
                 magma_queue_sync( queues[1] );
+                magma_trace_end();
+                magma_trace_begin( "zgetrf panel", rows, nb, 0, zgetrf_flops( rows, nb ) );
                 lapackf77_zgetrf( &rows, &nb, work, &lda, ipiv+j*nb, &iinfo );
+                magma_trace_end();
             }
             if (*info == 0 && iinfo > 0)
                 *info = iinfo + j*nb;
@@ -247,7 +275,9 @@ magma_zgetrf(
             }
             magmablas_zlaswp( n, dAT(0,0), lddat, j*nb + 1, j*nb + nb, ipiv, 1, queues[0] );
 
+            magma_trace_begin( "sync" );
             magma_queue_sync( queues[1] );
+            magma_trace_end();
             
             magmablas_ztranspose( cols, nb, dwork(0), cols, dAT(j,j), lddat, queues[0] );
 
@@ -286,7 +316,9 @@ magma_zgetrf(
             magma_queue_sync( queues[0] );
             
             // do the cpu part
+            magma_trace_begin( "zgetrf panel", rows, nb0, 0, zgetrf_flops( rows, nb0 ) );
             lapackf77_zgetrf( &rows, &nb0, work, &lda, ipiv+s*nb, &iinfo );
+            magma_trace_end();
             if (*info == 0 && iinfo > 0)
                 *info = iinfo + s*nb;
             
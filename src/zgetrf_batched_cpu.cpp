@@ -0,0 +1,356 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include "magma_internal.h"
+#include "batched_kernel_param.h"
+
+#define LANES BATCHED_CPU_LANES
+
+
+/******************************************************************************/
+// LU with partial pivoting of one n-by-n matrix, n = N known at compile
+// time, so the matrix is factored in a local copy with fixed loop bounds.
+// Follows zgetf2: a zero pivot sets info, but the factorization continues.
+template< int N >
+static void zgetrf_batched_cpu_sq(
+    magmaDoubleComplex *A, magma_int_t lda,
+    magma_int_t *ipiv, magma_int_t *info, double sfmin )
+{
+    magmaDoubleComplex rA[N][N];  // rA[j][i] = A(i,j)
+
+    for (int j = 0; j < N; ++j)
+        for (int i = 0; i < N; ++i)
+            rA[j][i] = A[ i + j*lda ];
+
+    *info = 0;
+    for (int k = 0; k < N; ++k) {
+        int p = k;
+        double amax = MAGMA_Z_ABS1( rA[k][k] );
+        for (int i = k+1; i < N; ++i) {
+            double a = MAGMA_Z_ABS1( rA[k][i] );
+            if (a > amax) {
+                amax = a;
+                p = i;
+            }
+        }
+        ipiv[k] = p + 1;
+
+        if (amax != 0) {
+            if (p != k) {
+                for (int j = 0; j < N; ++j) {
+                    magmaDoubleComplex t = rA[j][k];
+                    rA[j][k] = rA[j][p];
+                    rA[j][p] = t;
+                }
+            }
+            magmaDoubleComplex pivot = rA[k][k];
+            if (MAGMA_Z_ABS( pivot ) >= sfmin) {
+                magmaDoubleComplex r = MAGMA_Z_ONE / pivot;
+                for (int i = k+1; i < N; ++i)
+                    rA[k][i] *= r;
+            }
+            else {
+                for (int i = k+1; i < N; ++i)
+                    rA[k][i] = rA[k][i] / pivot;
+            }
+        }
+        else if (*info == 0) {
+            *info = k + 1;
+        }
+
+        for (int j = k+1; j < N; ++j)
+            for (int i = k+1; i < N; ++i)
+                rA[j][i] -= rA[k][i] * rA[j][k];
+    }
+
+    for (int j = 0; j < N; ++j)
+        for (int i = 0; i < N; ++i)
+            A[ i + j*lda ] = rA[j][i];
+}
+
+
+/******************************************************************************/
+// Same as zgetrf_batched_cpu_sq for nlanes <= LANES matrices at once.
+// The matrices are interleaved, element (i,j) of all of them being
+// contiguous, so every operation vectorizes across the matrices; each
+// matrix still has its own pivots. Unused lanes hold the identity.
+template< int N >
+static void zgetrf_batched_cpu_interleaved(
+    magma_int_t nlanes,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t **ipiv_array, magma_int_t *info_array, double sfmin )
+{
+    #define B(i_, j_, l_) buf[ ((i_) + (j_)*N)*LANES + (l_) ]
+
+    magmaDoubleComplex buf[ N*N*LANES ];
+    magmaDoubleComplex r[ LANES ], pivot[ LANES ];
+    double amax[ LANES ];
+    int p[ LANES ];
+    bool tiny[ LANES ];
+
+    for (int j = 0; j < N; ++j) {
+        for (int i = 0; i < N; ++i) {
+            for (int l = 0; l < LANES; ++l) {
+                B(i, j, l) = (l < nlanes) ? A_array[l][ i + j*lda ]
+                           : (i == j ? MAGMA_Z_ONE : MAGMA_Z_ZERO);
+            }
+        }
+    }
+    for (int l = 0; l < nlanes; ++l)
+        info_array[l] = 0;
+
+    for (int k = 0; k < N; ++k) {
+        for (int l = 0; l < LANES; ++l) {
+            amax[l] = MAGMA_Z_ABS1( B(k, k, l) );
+            p[l] = k;
+        }
+        for (int i = k+1; i < N; ++i) {
+            #pragma omp simd
+            for (int l = 0; l < LANES; ++l) {
+                double a = MAGMA_Z_ABS1( B(i, k, l) );
+                bool larger = a > amax[l];
+                amax[l] = larger ? a : amax[l];
+                p[l]    = larger ? i : p[l];
+            }
+        }
+        for (int l = 0; l < nlanes; ++l) {
+            ipiv_array[l][k] = p[l] + 1;
+            if (amax[l] == 0 && info_array[l] == 0)
+                info_array[l] = k + 1;
+        }
+
+        // the row swap is a no-op for a zero pivot column, as p = k
+        for (int j = 0; j < N; ++j) {
+            for (int l = 0; l < LANES; ++l) {
+                magmaDoubleComplex t = B(k, j, l);
+                B(k, j, l) = B(p[l], j, l);
+                B(p[l], j, l) = t;
+            }
+        }
+
+        for (int l = 0; l < LANES; ++l) {
+            pivot[l] = B(k, k, l);
+            tiny[l]  = amax[l] != 0 && MAGMA_Z_ABS( pivot[l] ) < sfmin;
+            r[l]     = (amax[l] != 0 && ! tiny[l]) ? MAGMA_Z_ONE / pivot[l]
+                                                   : MAGMA_Z_ONE;
+        }
+        for (int i = k+1; i < N; ++i) {
+            #pragma omp simd
+            for (int l = 0; l < LANES; ++l) {
+                B(i, k, l) = tiny[l] ? B(i, k, l) / pivot[l]
+                                     : B(i, k, l) * r[l];
+            }
+        }
+
+        for (int j = k+1; j < N; ++j) {
+            for (int i = k+1; i < N; ++i) {
+                #pragma omp simd
+                for (int l = 0; l < LANES; ++l) {
+                    B(i, j, l) -= B(i, k, l) * B(k, j, l);
+                }
+            }
+        }
+    }
+
+    for (int l = 0; l < nlanes; ++l)
+        for (int j = 0; j < N; ++j)
+            for (int i = 0; i < N; ++i)
+                A_array[l][ i + j*lda ] = B(i, j, l);
+
+    #undef B
+}
+
+
+/******************************************************************************/
+typedef void (*zgetrf_batched_cpu_sq_t)(
+    magmaDoubleComplex *A, magma_int_t lda,
+    magma_int_t *ipiv, magma_int_t *info, double sfmin );
+
+typedef void (*zgetrf_batched_cpu_interleaved_t)(
+    magma_int_t nlanes,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t **ipiv_array, magma_int_t *info_array, double sfmin );
+
+// @return the kernel specialized on n, or NULL if there is none.
+static zgetrf_batched_cpu_sq_t zgetrf_batched_cpu_sq_kernel( magma_int_t n )
+{
+    switch (n) {
+        case  1: return zgetrf_batched_cpu_sq<  1 >;
+        case  2: return zgetrf_batched_cpu_sq<  2 >;
+        case  3: return zgetrf_batched_cpu_sq<  3 >;
+        case  4: return zgetrf_batched_cpu_sq<  4 >;
+        case  5: return zgetrf_batched_cpu_sq<  5 >;
+        case  6: return zgetrf_batched_cpu_sq<  6 >;
+        case  7: return zgetrf_batched_cpu_sq<  7 >;
+        case  8: return zgetrf_batched_cpu_sq<  8 >;
+        case  9: return zgetrf_batched_cpu_sq<  9 >;
+        case 10: return zgetrf_batched_cpu_sq< 10 >;
+        case 11: return zgetrf_batched_cpu_sq< 11 >;
+        case 12: return zgetrf_batched_cpu_sq< 12 >;
+        case 13: return zgetrf_batched_cpu_sq< 13 >;
+        case 14: return zgetrf_batched_cpu_sq< 14 >;
+        case 15: return zgetrf_batched_cpu_sq< 15 >;
+        case 16: return zgetrf_batched_cpu_sq< 16 >;
+        default: return NULL;
+    }
+}
+
+// @return the interleaved kernel for n, or NULL if there is none.
+static zgetrf_batched_cpu_interleaved_t zgetrf_batched_cpu_interleaved_kernel( magma_int_t n )
+{
+    switch (n) {
+        case  1: return zgetrf_batched_cpu_interleaved<  1 >;
+        case  2: return zgetrf_batched_cpu_interleaved<  2 >;
+        case  3: return zgetrf_batched_cpu_interleaved<  3 >;
+        case  4: return zgetrf_batched_cpu_interleaved<  4 >;
+        case  5: return zgetrf_batched_cpu_interleaved<  5 >;
+        case  6: return zgetrf_batched_cpu_interleaved<  6 >;
+        case  7: return zgetrf_batched_cpu_interleaved<  7 >;
+        case  8: return zgetrf_batched_cpu_interleaved<  8 >;
+        default: return NULL;
+    }
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZGETRF computes an LU factorization of a general M-by-N matrix A
+    using partial pivoting with row interchanges.
+
+    The factorization has the form
+        A = P * L * U
+    where P is a permutation matrix, L is lower triangular with unit
+    diagonal elements (lower trapezoidal if m > n), and U is upper
+    triangular (upper trapezoidal if m < n).
+
+    This is a batched version for the CPU host that factors batchCount
+    M-by-N matrices in parallel, with OpenMP across the batch. It has the
+    same interface as magma_zgetrf_batched, with the arrays on the host.
+    Small square matrices use kernels specialized on n
+    (see magma_get_zbatched_cpu_crossover); the smallest ones are factored
+    several at a time in an interleaved layout
+    (see magma_get_zbatched_cpu_interleave). Other matrices use LAPACK.
+
+    Arguments
+    ---------
+    @param[in]
+    m       INTEGER
+            The number of rows of each matrix A.  M >= 0.
+
+    @param[in]
+    n       INTEGER
+            The number of columns of each matrix A.  N >= 0.
+
+    @param[in,out]
+    A_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDA,N).
+            On entry, each pointer is an M-by-N matrix to be factored.
+            On exit, the factors L and U from the factorization
+            A = P*L*U; the unit diagonal elements of L are not stored.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of each array A.  LDA >= max(1,M).
+
+    @param[out]
+    ipiv_array  Array of pointers, dimension (batchCount), for corresponding matrices.
+            Each is an INTEGER array, dimension (min(M,N))
+            The pivot indices; for 1 <= i <= min(M,N), row i of the
+            matrix was interchanged with row IPIV(i).
+
+    @param[out]
+    info_array  Array of INTEGERs, dimension (batchCount), for corresponding matrices.
+      -     = 0:  successful exit
+      -     > 0:  if INFO = i, U(i,i) is exactly zero. The factorization
+                  has been completed, but the factor U is exactly
+                  singular, and division by zero will occur if it is used
+                  to solve a system of equations.
+
+    @param[in]
+    batchCount  INTEGER
+                The number of matrices to operate on.
+
+    @return
+      -     = 0:  successful exit
+      -     < 0:  if INFO = -i, the i-th argument had an illegal value.
+
+    @ingroup magma_getrf_batched
+*******************************************************************************/
+extern "C" magma_int_t
+magma_zgetrf_batched_cpu(
+    magma_int_t m, magma_int_t n,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t **ipiv_array, magma_int_t *info_array,
+    magma_int_t batchCount )
+{
+    /* Check arguments */
+    magma_int_t arginfo = 0;
+    if (m < 0)
+        arginfo = -1;
+    else if (n < 0)
+        arginfo = -2;
+    else if (lda < max(1,m))
+        arginfo = -4;
+    else if (batchCount < 0)
+        arginfo = -7;
+
+    if (arginfo != 0) {
+        magma_xerbla( __func__, -(arginfo) );
+        return arginfo;
+    }
+
+    /* Quick return if possible */
+    if (m == 0 || n == 0) {
+        for (magma_int_t s = 0; s < batchCount; ++s)
+            info_array[s] = 0;
+        return arginfo;
+    }
+
+    double sfmin = lapackf77_dlamch("S");
+
+    zgetrf_batched_cpu_sq_t sq = NULL;
+    zgetrf_batched_cpu_interleaved_t interleaved = NULL;
+    if (m == n && n <= magma_get_zbatched_cpu_crossover()) {
+        sq = zgetrf_batched_cpu_sq_kernel( n );
+        if (n <= magma_get_zbatched_cpu_interleave())
+            interleaved = zgetrf_batched_cpu_interleaved_kernel( n );
+    }
+
+    // one thread per matrix
+    magma_int_t nthreads = magma_get_lapack_numthreads();
+    magma_set_lapack_numthreads( 1 );
+    magma_set_omp_numthreads( nthreads );
+
+    if (interleaved != NULL) {
+        magma_int_t ngroup = magma_ceildiv( batchCount, LANES );
+        #pragma omp parallel for schedule(dynamic, 4)
+        for (magma_int_t g = 0; g < ngroup; ++g) {
+            magma_int_t s = g*LANES;
+            interleaved( min( LANES, batchCount - s ), &A_array[s], lda,
+                         &ipiv_array[s], &info_array[s], sfmin );
+        }
+    }
+    else if (sq != NULL) {
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (magma_int_t s = 0; s < batchCount; ++s) {
+            sq( A_array[s], lda, ipiv_array[s], &info_array[s], sfmin );
+        }
+    }
+    else {
+        #pragma omp parallel for schedule(dynamic)
+        for (magma_int_t s = 0; s < batchCount; ++s) {
+            lapackf77_zgetrf( &m, &n, A_array[s], &lda, ipiv_array[s], &info_array[s] );
+        }
+    }
+
+    magma_set_lapack_numthreads( nthreads );
+
+    return arginfo;
+}
@@ -0,0 +1,216 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include "magma_internal.h"
+#include "batched_kernel_param.h"
+
+
+/******************************************************************************/
+// Solves A*X = B with the LU factors of one n-by-n matrix, n = N known at
+// compile time, one right hand side at a time in a local vector.
+template< int N >
+static void zgetrs_batched_cpu_sq(
+    magma_int_t nrhs,
+    const magmaDoubleComplex *A, magma_int_t lda,
+    const magma_int_t *ipiv,
+    magmaDoubleComplex *B, magma_int_t ldb )
+{
+    #define A(i_, j_) A[ (i_) + (j_)*lda ]
+
+    for (magma_int_t c = 0; c < nrhs; ++c) {
+        magmaDoubleComplex x[N];
+        for (int i = 0; i < N; ++i)
+            x[i] = B[ i + c*ldb ];
+
+        // apply the row interchanges, then solve L*y = P*b and U*x = y
+        for (int k = 0; k < N; ++k) {
+            int p = ipiv[k] - 1;
+            magmaDoubleComplex t = x[k];
+            x[k] = x[p];
+            x[p] = t;
+        }
+        for (int k = 0; k < N; ++k)
+            for (int i = k+1; i < N; ++i)
+                x[i] -= A(i, k) * x[k];
+        for (int k = N-1; k >= 0; --k) {
+            x[k] = x[k] / A(k, k);
+            for (int i = 0; i < k; ++i)
+                x[i] -= A(i, k) * x[k];
+        }
+
+        for (int i = 0; i < N; ++i)
+            B[ i + c*ldb ] = x[i];
+    }
+
+    #undef A
+}
+
+
+/******************************************************************************/
+typedef void (*zgetrs_batched_cpu_sq_t)(
+    magma_int_t nrhs,
+    const magmaDoubleComplex *A, magma_int_t lda,
+    const magma_int_t *ipiv,
+    magmaDoubleComplex *B, magma_int_t ldb );
+
+// @return the kernel specialized on n, or NULL if there is none.
+static zgetrs_batched_cpu_sq_t zgetrs_batched_cpu_sq_kernel( magma_int_t n )
+{
+    switch (n) {
+        case  1: return zgetrs_batched_cpu_sq<  1 >;
+        case  2: return zgetrs_batched_cpu_sq<  2 >;
+        case  3: return zgetrs_batched_cpu_sq<  3 >;
+        case  4: return zgetrs_batched_cpu_sq<  4 >;
+        case  5: return zgetrs_batched_cpu_sq<  5 >;
+        case  6: return zgetrs_batched_cpu_sq<  6 >;
+        case  7: return zgetrs_batched_cpu_sq<  7 >;
+        case  8: return zgetrs_batched_cpu_sq<  8 >;
+        case  9: return zgetrs_batched_cpu_sq<  9 >;
+        case 10: return zgetrs_batched_cpu_sq< 10 >;
+        case 11: return zgetrs_batched_cpu_sq< 11 >;
+        case 12: return zgetrs_batched_cpu_sq< 12 >;
+        case 13: return zgetrs_batched_cpu_sq< 13 >;
+        case 14: return zgetrs_batched_cpu_sq< 14 >;
+        case 15: return zgetrs_batched_cpu_sq< 15 >;
+        case 16: return zgetrs_batched_cpu_sq< 16 >;
+        default: return NULL;
+    }
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZGETRS solves a system of linear equations
+        A * X = B,  A**T * X = B,  or  A**H * X = B
+    with a general N-by-N matrix A using the LU factorization computed
+    by magma_zgetrf_batched_cpu.
+
+    This is a batched version for the CPU host that solves batchCount
+    systems in parallel, with OpenMP across the batch. It has the same
+    interface as magma_zgetrs_batched, with the arrays on the host.
+    For trans = MagmaNoTrans, small matrices use kernels specialized on n
+    (see magma_get_zbatched_cpu_crossover); other cases use LAPACK.
+
+    Arguments
+    ---------
+    @param[in]
+    trans   magma_trans_t
+            Specifies the form of the system of equations:
+      -     = MagmaNoTrans:    A    * X = B  (No transpose)
+      -     = MagmaTrans:      A**T * X = B  (Transpose)
+      -     = MagmaConjTrans:  A**H * X = B  (Conjugate transpose)
+
+    @param[in]
+    n       INTEGER
+            The order of the matrix A.  N >= 0.
+
+    @param[in]
+    nrhs    INTEGER
+            The number of right hand sides, i.e., the number of columns
+            of the matrix B.  NRHS >= 0.
+
+    @param[in]
+    A_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDA,N).
+            The factors L and U from the factorization A = P*L*U
+            as computed by magma_zgetrf_batched_cpu.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of each array A.  LDA >= max(1,N).
+
+    @param[in]
+    ipiv_array  Array of pointers, dimension (batchCount), for corresponding matrices.
+            Each is an INTEGER array, dimension (N)
+            The pivot indices from magma_zgetrf_batched_cpu.
+
+    @param[in,out]
+    B_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDB,NRHS).
+            On entry, each pointer is a right hand side matrix B.
+            On exit, each pointer is the solution matrix X.
+
+    @param[in]
+    ldb     INTEGER
+            The leading dimension of each array B.  LDB >= max(1,N).
+
+    @param[in]
+    batchCount  INTEGER
+                The number of matrices to operate on.
+
+    @return
+      -     = 0:  successful exit
+      -     < 0:  if INFO = -i, the i-th argument had an illegal value.
+
+    @ingroup magma_getrs_batched
+*******************************************************************************/
+extern "C" magma_int_t
+magma_zgetrs_batched_cpu(
+    magma_trans_t trans, magma_int_t n, magma_int_t nrhs,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t **ipiv_array,
+    magmaDoubleComplex **B_array, magma_int_t ldb,
+    magma_int_t batchCount )
+{
+    /* Check arguments */
+    magma_int_t arginfo = 0;
+    if ( (trans != MagmaNoTrans) && (trans != MagmaTrans) && (trans != MagmaConjTrans) )
+        arginfo = -1;
+    else if (n < 0)
+        arginfo = -2;
+    else if (nrhs < 0)
+        arginfo = -3;
+    else if (lda < max(1,n))
+        arginfo = -5;
+    else if (ldb < max(1,n))
+        arginfo = -8;
+    else if (batchCount < 0)
+        arginfo = -9;
+
+    if (arginfo != 0) {
+        magma_xerbla( __func__, -(arginfo) );
+        return arginfo;
+    }
+
+    /* Quick return if possible */
+    if (n == 0 || nrhs == 0) {
+        return arginfo;
+    }
+
+    zgetrs_batched_cpu_sq_t sq = NULL;
+    if (trans == MagmaNoTrans && n <= magma_get_zbatched_cpu_crossover()) {
+        sq = zgetrs_batched_cpu_sq_kernel( n );
+    }
+
+    // one thread per matrix
+    magma_int_t nthreads = magma_get_lapack_numthreads();
+    magma_set_lapack_numthreads( 1 );
+    magma_set_omp_numthreads( nthreads );
+
+    if (sq != NULL) {
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (magma_int_t s = 0; s < batchCount; ++s) {
+            sq( nrhs, A_array[s], lda, ipiv_array[s], B_array[s], ldb );
+        }
+    }
+    else {
+        const char* trans_ = lapack_trans_const( trans );
+        #pragma omp parallel for schedule(dynamic)
+        for (magma_int_t s = 0; s < batchCount; ++s) {
+            magma_int_t info;
+            lapackf77_zgetrs( trans_, &n, &nrhs, A_array[s], &lda, ipiv_array[s],
+                              B_array[s], &ldb, &info );
+        }
+    }
+
+    magma_set_lapack_numthreads( nthreads );
+
+    return arginfo;
+}
@@ -14,6 +14,7 @@
 */
 #include "magma_internal.h"
 #include "magma_timer.h"
+#include "trace.h"
 
 #define COMPLEX
 
@@ -341,6 +342,7 @@ magma_zheevdx_2stage(
         return *info;
     }
 
+    magma_trace_scope trace( "magma_zheevdx_2stage", n );
 
     timer_printf("using %lld parallel_threads\n", (long long) parallel_threads );
 
@@ -442,7 +444,9 @@ magma_zheevdx_2stage(
         *info = MAGMA_ERR_DEVICE_ALLOC;
         return *info;
     }
+    magma_trace_begin( "zhetrd_he2hb", n, n, nb );
     magma_zhetrd_he2hb(uplo, n, nb, A, lda, TAU1, Wstg1, lwstg1, dT1, info);
+    magma_trace_end();
 
     timer_stop( time );
     timer_printf( "  N= %10lld  nb= %5lld time zhetrd_he2hb= %6.2f\n", (long long) n, (long long) nb, time );
@@ -467,7 +471,9 @@ magma_zheevdx_2stage(
     timer_printf( "  N= %10lld  nb= %5lld time zhetrd_convert = %6.2f\n", (long long) n, (long long) nb, time );
     timer_start( time );
 
+    magma_trace_begin( "zhetrd_hb2st", n, n, nb );
     magma_zhetrd_hb2st(uplo, n, nb, Vblksiz, A2, lda2, W, E, V2, ldv, TAU2, wantz, T2, ldt);
+    magma_trace_end();
 
     timer_stop( time );
     timer_stop( time_total );
@@ -481,7 +487,9 @@ magma_zheevdx_2stage(
     if (! wantz) {
         timer_start( time );
 
+        magma_trace_begin( "dsterf", n );
         lapackf77_dsterf(&n, W, E, info);
+        magma_trace_end();
         magma_dmove_eig(range, n, W, &il, &iu, vl, vu, m);
 
         timer_stop( time );
@@ -499,9 +507,11 @@ magma_zheevdx_2stage(
 
         timer_start( time );
 
+        magma_trace_begin( "zstedx", n );
         magma_zstedx(range, n, vl, vu, il, iu, W, E,
                      Z, ldz, Wedc, lwedc,
                      iwork, liwork, dwedc, info);
+        magma_trace_end();
 
 
         timer_stop( time );
@@ -520,8 +530,10 @@ magma_zheevdx_2stage(
 
         timer_start( time );
 
+        magma_trace_begin( "zbulge_back", n, *m, nb );
         magma_zbulge_back(uplo, n, nb, *m, Vblksiz, Z +ldz*(il-1), ldz, dZ, lddz,
                           V2, ldv, TAU2, T2, ldt, info);
+        magma_trace_end();
 
         timer_stop( time );
         timer_printf( "  N= %10lld  nb= %5lld time zbulge_back = %6.2f\n", (long long) n, (long long) nb, time );
@@ -541,6 +553,7 @@ magma_zheevdx_2stage(
         magma_getdevice( &cdev );
         magma_queue_create( cdev, &queue );
 
+        magma_trace_begin( "zunmqr_2stage", n, *m, nb );
         magma_zsetmatrix( n, n, A, lda, dA, ldda, queue );
 
         magma_zunmqr_2stage_gpu( MagmaLeft, MagmaNoTrans, n-nb, *m, n-nb, dA+nb, ldda,
@@ -550,6 +563,7 @@ magma_zheevdx_2stage(
 
         magma_queue_sync( queue );
         magma_queue_destroy( queue );
+        magma_trace_end();
 
         timer_stop( time );
         timer_printf( "  N= %10lld  nb= %5lld time zunmqr + copy = %6.2f\n", 
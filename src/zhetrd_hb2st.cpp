@@ -12,6 +12,7 @@
        @precisions normal z -> s d c
 
 */
+#include "progress_table.hpp"
 #include "magma_internal.h"
 #include "magma_bulge.h"
 #include "magma_zbulge.h"
@@ -30,7 +31,7 @@ static void magma_ztile_bulge_parallel(
     magmaDoubleComplex *V, magma_int_t ldv,
     magmaDoubleComplex *TAU, magma_int_t n, magma_int_t nb, magma_int_t nbtiles,
     magma_int_t grsiz, magma_int_t Vblksiz, magma_int_t wantz, 
-    volatile magma_int_t *prog, pthread_barrier_t* myptbarrier);
+    magma_progress_table *prog, pthread_barrier_t* myptbarrier);
 
 static void magma_ztile_bulge_computeT_parallel(
     magma_int_t my_core_id, magma_int_t cores_num,
@@ -55,7 +56,7 @@ typedef struct magma_zbulge_data_s {
     magmaDoubleComplex* TAU;
     magmaDoubleComplex* T;
     magma_int_t ldt;
-    volatile magma_int_t *prog;
+    magma_progress_table *prog;
     pthread_barrier_t myptbarrier;
 } magma_zbulge_data;
 
@@ -68,7 +69,7 @@ void magma_zbulge_data_init(
     magmaDoubleComplex *A, magma_int_t lda,
     magmaDoubleComplex *V, magma_int_t ldv, magmaDoubleComplex *TAU,
     magmaDoubleComplex *T, magma_int_t ldt,
-    volatile magma_int_t* prog)
+    magma_progress_table* prog)
 {
     zbulge_data_S->threads_num = threads_num;
     zbulge_data_S->n = n;
@@ -213,9 +214,7 @@ magma_zhetrd_hb2st(
 
     magma_int_t INgrsiz=1;
     magma_int_t nbtiles = magma_ceildiv(n, nb);
-    volatile magma_int_t* prog;
-    magma_malloc_cpu((void**) &prog, (2*nbtiles+parallel_threads+10)*sizeof(magma_int_t));
-    memset((void *) prog, 0, (2*nbtiles+parallel_threads+10)*sizeof(magma_int_t));
+    magma_progress_table* prog = new magma_progress_table( 2*nbtiles+parallel_threads+10 );
 
     magma_zbulge_id_data* arg;
     magma_malloc_cpu((void**) &arg, parallel_threads*sizeof(magma_zbulge_id_data));
@@ -260,7 +259,14 @@ magma_zhetrd_hb2st(
 
     magma_free_cpu(thread_id);
     magma_free_cpu(arg);
-    magma_free_cpu((void *) prog);
+    #ifdef ENABLE_TIMER
+    double spin_time, park_time;
+    magma_int_t nparks;
+    prog->get_stats( &spin_time, &park_time, &nparks );
+    printf("  progress waits: spin %f  parked %f (%lld times)\n",
+           spin_time, park_time, (long long) nparks );
+    #endif
+    delete prog;
     magma_zbulge_data_destroy(&data_bulge);
 
     magma_set_omp_numthreads(ompth);
@@ -336,7 +342,7 @@ static void *magma_zhetrd_hb2st_parallel_section(void *arg)
     magmaDoubleComplex *TAU    = data -> TAU;
     magmaDoubleComplex *T      = data -> T;
     magma_int_t ldt            = data -> ldt;
-    volatile magma_int_t* prog = data -> prog;
+    magma_progress_table* prog = data -> prog;
 
     pthread_barrier_t* myptbarrier = &(data -> myptbarrier);
 
@@ -372,18 +378,20 @@ static void *magma_zhetrd_hb2st_parallel_section(void *arg)
     print_set.print_affinity(my_core_id, "starting affinity");
 #endif
     affinity_set original_set;
-    affinity_set new_set(my_core_id);
-    magma_int_t check  = 0;
+    affinity_set new_set;
+    magma_int_t check  = -1;
     magma_int_t check2 = 0;
-    // bind threads
-    check = original_set.get_affinity();
-    if (check == 0) {
-        check2 = new_set.set_affinity();
-        if (check2 != 0)
-            printf("Error in sched_setaffinity (single cpu)\n");
-    }
-    else {
-        printf("Error in sched_getaffinity\n");
+    // bind threads, placed according to $MAGMA_AFFINITY
+    if (new_set.add_thread(my_core_id)) {
+        check = original_set.get_affinity();
+        if (check == 0) {
+            check2 = new_set.set_affinity();
+            if (check2 != 0)
+                printf("Error in sched_setaffinity (single cpu)\n");
+        }
+        else {
+            printf("Error in sched_getaffinity\n");
+        }
     }
 #ifdef PRINTAFFINITY
     print_set.print_affinity(my_core_id, "set affinity");
@@ -450,78 +458,10 @@ static void *magma_zhetrd_hb2st_parallel_section(void *arg)
 
 
 /******************************************************************************/
-#define expertmyss_cond_wait(m, n, val) \
-do { \
-    while (prog[(m)] != (val)) { \
-        magma_yield(); \
-    } \
-    for (kk=0; kk < 100; kk++) { \
-        __asm__ volatile ("nop;" :::); \
-    } \
-} while(0)
-
-// __asm__ volatile ("" ::: "memory") is a compiler fence (but not a hardware memory fence),
-// to prohibit load/store reordering across that point.
-// However, inline assemble (asm) isn't available on Microsoft VS x64.
-#define expertmyss_cond_set(m, n, val) \
-do { \
-    prog[(m)*(64/sizeof(magma_int_t))] = (val); \
-    __asm__ volatile ("" ::: "memory"); \
-} while(0)
-
-#define expertmyss_init(m, n, init_val) \
-do { \
-    if (my_core_id == 0) { \
-        magma_malloc_cpu((void**) &prog, ( (m)*(64/sizeof(int)) ) * sizeof(magma_int_t)); \
-        memset((magma_int_t*)prog, 0, (m)*(64/sizeof(magma_int_t))); \
-    } \
-    pthread_barrier_init(&myptbarrier, NULL, cores_num); \
-    pthread_barrier_wait(&myptbarrier); \
-    barrier(my_core_id, cores_num); \
-} while(0)
-
-#define expertmyss_finalize() \
-do { \
-    pthread_barrier_wait(&myptbarrier); \
-    pthread_barrier_destroy(&myptbarrier); \
-    barrier(my_core_id, cores_num); \
-    if (my_core_id == 0) { \
-        magma_free_cpu((void *) prog); \
-    } \
-} while(0)
-
-
-
-// see also __asm__ volatile ("" ::: "memory") in expertmyss_cond_set above
-#define myss_cond_set(m, n, val) \
-do { \
-    prog[(m)] = (val); \
-} while(0)
-
-#define myss_cond_wait(m, n, val) \
-do { \
-    while (prog[(m)] != (val)) \
-    { \
-        magma_yield(); \
-    } \
-} while(0)
-
-#define myss_init(m, n, init_val) \
-do { \
-    if (my_core_id == 0) { \
-        magma_malloc_cpu((void**) &prog,  (m) * sizeof(magma_int_t)); \
-        memset((magma_int_t*)prog, 0, (m)); \
-    } \
-    pthread_barrier_wait(myptbarrier); \
-} while(0)
-
-#define myss_finalize() \
-do { \
-    pthread_barrier_wait(myptbarrier); \
-    if (my_core_id == 0) { \
-        magma_free_cpu((void *) prog); \
-    } \
-} while(0)
+// the progress table orders the tasks of consecutive sweeps, see progress_table.cpp
+#define myss_cond_set(m, n, val)  prog->set( (m), (val) )
+
+#define myss_cond_wait(m, n, val) prog->wait( (m), (val) )
 
 
 /******************************************************************************/
@@ -531,7 +471,7 @@ static void magma_ztile_bulge_parallel(
     magmaDoubleComplex *V, magma_int_t ldv,
     magmaDoubleComplex *TAU, magma_int_t n, magma_int_t nb, magma_int_t nbtiles,
     magma_int_t grsiz, magma_int_t Vblksiz, magma_int_t wantz, 
-    volatile magma_int_t *prog, pthread_barrier_t* myptbarrier)
+    magma_progress_table *prog, pthread_barrier_t* myptbarrier)
 {
     magma_int_t sweepid, myid, shift, stt, st, ed, stind, edind;
     magma_int_t blklastind, colpt;
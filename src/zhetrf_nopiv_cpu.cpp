@@ -8,161 +8,73 @@
        @precisions normal z -> s d c
  
 */
-#include "magma_internal.h"
+#include <atomic>
+#include <vector>
+
+#include "thread_queue.hpp"
+
+#include "magma_internal.h"  // after thread_queue.hpp, so max, min are defined
 
 #define COMPLEX
 
 // TODO convert to usual (A + (i) + (j)*lda), i.e., returns pointer?
 #define  A(i, j) ( A[(j)*lda  + (i)])
-#define  C(i, j) ( C[(j)*ldc  + (i)])
-#define  D(i)    ( D[(i)*incD] )
+#define  W(i, j) ( W[(j)*ldw  + (i)])
 
 
 /******************************************************************************/
-// TODO: change alpha and beta to be double, per BLAS, instead of double-complex
-// trailing submatrix update with inner-blocking
-magma_int_t zherk_d(
+// fused copy and scale of a block of L*D (uplo = Lower) or D*U (uplo = Upper):
+// W = A^H, then A = A*inv(D) or A = inv(D)*A, where D is the diagonal of
+// the factored block Akk. Rows of A are processed in blocks, so W is
+// written with a small stride.
+static void zhetrf_scal_copy_nopiv(
     magma_uplo_t uplo, magma_int_t m, magma_int_t n,
-    magmaDoubleComplex alpha, magmaDoubleComplex *A, magma_int_t lda,
-    magmaDoubleComplex beta,  magmaDoubleComplex *C, magma_int_t ldc,
-    magmaDoubleComplex *D, magma_int_t incD)
+    magmaDoubleComplex *A, magma_int_t lda,
+    const magmaDoubleComplex *Akk, magma_int_t ldakk,
+    magmaDoubleComplex *W, magma_int_t ldw)
 {
-    magma_int_t i, j, k;
-    magmaDoubleComplex *Aik;
-    magmaDoubleComplex *Dkk;
-    magmaDoubleComplex *Akj;
-
-    /* Check input arguments */
-    magma_int_t info = 0;
-    if ((uplo != MagmaLower) && (uplo != MagmaUpper)) {
-        info = -1;
-    }
-    if (m < 0) {
-        info = -3;
-    }
-    if (n < 0) {
-        info = -4;
-    }
-    if ((lda < max(1, m)) && (m > 0)) {
-        info = -7;
-    }
-    if ((ldc < max(1, m)) && (m > 0)) {
-        info = -10;
-    }
-    if ( incD < 0 ) {
-        info = -12;
-    }
-    if (info != 0) {
-        magma_xerbla( __func__, -(info) );
-        return info;
-    }
-
-    /* Quick return */
-    if (m == 0 || n == 0 ||
-        ((alpha == 0.0 || m == 0) && beta == 1.0) ) {
-        return info;
-    }
-
-    if ( uplo == MagmaLower ) {
-        for (j=0; j < m; j++) {
-            for (i=j; i < m; i++) {
-                magmaDoubleComplex tmp = MAGMA_Z_ZERO;
-                Aik = A+i;
-                Dkk = D;
-                Akj = A+j;
-                for (k=0; k < n; k++) {
-                    tmp = tmp + (*Aik) * (*Dkk) * conj( *Akj );
-                    Aik += lda;
-                    Dkk += incD;
-                    Akj += lda;
+    const magma_int_t bs = 32;
+    double dinv[ bs ];
+
+    for (magma_int_t i0 = 0; i0 < m; i0 += bs) {
+        magma_int_t i1 = min( i0 + bs, m );
+        if ( uplo == MagmaUpper ) {
+            for (magma_int_t i = i0; i < i1; i++) {
+                dinv[i-i0] = 1.0 / MAGMA_Z_REAL( Akk[ i*(ldakk+1) ] );
+            }
+            for (magma_int_t j = 0; j < n; j++) {
+                for (magma_int_t i = i0; i < i1; i++) {
+                    magmaDoubleComplex v = A(i, j);
+                    W(j, i) = MAGMA_Z_CONJ( v );
+                    A(i, j) = v * dinv[i-i0];
                 }
-                C(i, j) = beta * C(i, j) + alpha * tmp;
             }
         }
-    }
-    else {
-        for (j=0; j < m; j++) {
-            for (i=0; i <= j; i++) {
-                magmaDoubleComplex tmp = MAGMA_Z_ZERO;
-                for (k=0; k < n; k++) {
-                    tmp = tmp + A(i, k) * D( k ) * conj( A(k, j) );
+        else {
+            for (magma_int_t j = 0; j < n; j++) {
+                double s = 1.0 / MAGMA_Z_REAL( Akk[ j*(ldakk+1) ] );
+                for (magma_int_t i = i0; i < i1; i++) {
+                    magmaDoubleComplex v = A(i, j);
+                    W(j, i) = MAGMA_Z_CONJ( v );
+                    A(i, j) = v * s;
                 }
-                C(i, j) = beta * C(i, j) + alpha * tmp;
             }
         }
     }
-    return info;
-}
-
-
-/******************************************************************************/
-// TODO: change alpha and beta to be double, per BLAS, instead of double-complex
-// trailing submatrix update with inner-blocking, using workshpace that
-// stores D*L'
-magma_int_t zherk_d_workspace(
-    magma_uplo_t uplo, magma_int_t n, magma_int_t k,
-    magmaDoubleComplex alpha, magmaDoubleComplex *A, magma_int_t lda,
-    magmaDoubleComplex beta,  magmaDoubleComplex *C, magma_int_t ldc,
-    magmaDoubleComplex *work, magma_int_t ldw)
-{
-    magmaDoubleComplex c_one     = MAGMA_Z_ONE;
-    magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
-
-    /* Check input arguments */
-    magma_int_t info = 0;
-    if ((uplo != MagmaLower) && (uplo != MagmaUpper)) {
-        info = -1;
-    }
-    if (n < 0) {
-        info = -2;
-    }
-    if (k < 0) {
-        info = -3;
-    }
-    if ((lda < max(1,n)) && (n > 0)) {
-        info = -6;
-    }
-    if ((ldc < max(1,n)) && (n > 0)) {
-        info = -9;
-    }
-    if (info != 0) {
-        magma_xerbla( __func__, -(info) );
-        return info;
-    }
-
-    /* Quick return */
-    if (n == 0 || k == 0 ||
-        ((alpha == 0.0 || k == 0) && beta == 1.0) ) {
-        return info;
-    }
-
-    if ( uplo == MagmaLower ) {
-        blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr,
-                       &n, &n, &k,
-                       &c_neg_one, A,    &lda,
-                                   work, &ldw,
-                       &c_one,     C,    &ldc );
-    }
-    else {
-        blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr,
-                       &n, &n, &k,
-                       &c_neg_one, work, &ldw,
-                                   A,    &lda,
-                       &c_one,     C,    &ldc );
-    }
-    return info;
 }
 
 
 /******************************************************************************/
-// diagonal factorization with inner-block
+// unblocked diagonal factorization
+// returns the index (1-based) of the first pivot below epsilon
 magma_int_t zhetrf_diag_nopiv(
     magma_uplo_t uplo, magma_int_t n,
     magmaDoubleComplex *A, magma_int_t lda)
 {
     const magma_int_t ione = 1;
     const double d_one = 1.0;
-    
+    const double eps = lapackf77_dlamch("Epsilon");
+
     /* Check input arguments */
     magma_int_t info = 0;
     if (lda < n) {
@@ -173,82 +85,46 @@ magma_int_t zhetrf_diag_nopiv(
         return info;
     }
 
-    /* Quick return */
-    if (n == 1)
-        return info;
-
-    magmaDoubleComplex *Ak1k = NULL;
-    magmaDoubleComplex *Akk = NULL;
     double alpha;
 
-    if ( uplo == MagmaLower ) {
+    for (magma_int_t k=0; k < n; k++) {
         /* Diagonal element */
-        Akk  = A;
-
-        /* Pointer on first extra diagonal element */
-        Ak1k = A + 1;
+        alpha = MAGMA_Z_REAL( A(k, k) );
+        if ( fabs(alpha) < eps ) {
+            info = k+1;
+            return info;
+        }
+        A(k, k) = MAGMA_Z_MAKE(alpha, 0.0);
 
-        for (magma_int_t k=n-1; k > 0; k--) {
-            alpha = MAGMA_Z_REAL( *Akk );
-            if ( fabs(alpha) < lapackf77_dlamch("Epsilon") ) {
-                info = k;
-                return info;
-            }
-            *Akk = MAGMA_Z_MAKE(alpha, 0.0);
+        magma_int_t m = n-k-1;
+        if (m == 0)
+            break;
 
+        if ( uplo == MagmaLower ) {
             // scale off-diagonals
             alpha = d_one / alpha;
-            blasf77_zdscal(&k, &alpha, Ak1k, &ione);
+            blasf77_zdscal(&m, &alpha, &A(k+1, k), &ione);
 
             // update remaining
-            alpha = - MAGMA_Z_REAL( *Akk );
-            blasf77_zher(MagmaLowerStr, &k,
-                         &alpha, Ak1k, &ione, Ak1k + lda, &lda);
-
-            /* Move to next diagonal element */
-            if (k > 1) { 
-                Ak1k += lda;
-                Akk = Ak1k;
-                Ak1k++;
-            }
-        }
-    } else {
-        /* Diagonal element */
-        Akk  = A;
-
-        /* Pointer on first extra diagonal element */
-        Ak1k = A + lda;
-
-        for (magma_int_t k=n-1; k > 0; k--) {
-            alpha = MAGMA_Z_REAL( *Akk );
-            if ( fabs(alpha) < lapackf77_dlamch("Epsilon") ) {
-                info = k;
-                return info;
-            }
-            *Akk = MAGMA_Z_MAKE(alpha, 0.0);
-
+            alpha = - MAGMA_Z_REAL( A(k, k) );
+            blasf77_zher(MagmaLowerStr, &m,
+                         &alpha, &A(k+1, k), &ione, &A(k+1, k+1), &lda);
+        } else {
             // scale off-diagonals
             alpha = d_one / alpha;
-            blasf77_zdscal(&k, &alpha, Ak1k, &lda);
+            blasf77_zdscal(&m, &alpha, &A(k, k+1), &lda);
 
             // update remaining
-            alpha = - MAGMA_Z_REAL( *Akk );
+            alpha = - MAGMA_Z_REAL( A(k, k) );
 
             #ifdef COMPLEX
-            lapackf77_zlacgv(&k, Ak1k, &lda);
+            lapackf77_zlacgv(&m, &A(k, k+1), &lda);
             #endif
-            blasf77_zher(MagmaUpperStr, &k,
-                         &alpha, Ak1k, &lda, Ak1k + 1, &lda);
+            blasf77_zher(MagmaUpperStr, &m,
+                         &alpha, &A(k, k+1), &lda, &A(k+1, k+1), &lda);
             #ifdef COMPLEX
-            lapackf77_zlacgv(&k, Ak1k, &lda);
+            lapackf77_zlacgv(&m, &A(k, k+1), &lda);
             #endif
-
-            /* Move to next diagonal element */
-            if (k > 1) {
-                Ak1k ++;
-                Akk = Ak1k;
-                Ak1k += lda;
-            }
         }
     }
     return info;
@@ -256,19 +132,282 @@ magma_int_t zhetrf_diag_nopiv(
 
 
 /******************************************************************************/
-// main routine
+// recursive diagonal factorization, with zhetrf_diag_nopiv below ib.
+// The other triangle is used as workspace.
+static magma_int_t zhetrf_rec_nopiv(
+    magma_uplo_t uplo, magma_int_t n, magma_int_t ib,
+    magmaDoubleComplex *A, magma_int_t lda)
+{
+    const magmaDoubleComplex c_one     = MAGMA_Z_ONE;
+    const magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
+
+    if (n <= ib) {
+        return zhetrf_diag_nopiv( uplo, n, A, lda );
+    }
+
+    magma_int_t n1 = n/2;
+    magma_int_t n2 = n - n1;
+
+    magma_int_t info = zhetrf_rec_nopiv( uplo, n1, ib, A, lda );
+    if (info != 0)
+        return info;
+
+    if ( uplo == MagmaLower ) {
+        /* L21*D11 */
+        blasf77_ztrsm( MagmaRightStr, MagmaLowerStr,
+                       MagmaConjTransStr, MagmaUnitStr,
+                       &n2, &n1,
+                       &c_one, &A(0, 0),  &lda,
+                               &A(n1, 0), &lda );
+        zhetrf_scal_copy_nopiv( uplo, n2, n1, &A(n1, 0), lda, &A(0, 0), lda,
+                                &A(0, n1), lda );
+    }
+    else {
+        /* D11*U12 */
+        blasf77_ztrsm( MagmaLeftStr, MagmaUpperStr,
+                       MagmaConjTransStr, MagmaUnitStr,
+                       &n1, &n2,
+                       &c_one, &A(0, 0),  &lda,
+                               &A(0, n1), &lda );
+        zhetrf_scal_copy_nopiv( uplo, n1, n2, &A(0, n1), lda, &A(0, 0), lda,
+                                &A(n1, 0), lda );
+    }
+
+    /* A22 = A22 - A21 * A12, one of them holding the copy of L*D or D*U */
+    blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr,
+                   &n2, &n2, &n1,
+                   &c_neg_one, &A(n1, 0),  &lda,
+                               &A(0, n1),  &lda,
+                   &c_one,     &A(n1, n1), &lda );
+
+    info = zhetrf_rec_nopiv( uplo, n2, ib, &A(n1, n1), lda );
+    if (info != 0)
+        info += n1;
+    return info;
+}
+
+
+/******************************************************************************/
+// arguments shared by the tile tasks
+struct zhetrf_nopiv_tiles
+{
+    magma_uplo_t uplo;
+    magma_int_t n, nb, ib;
+    magmaDoubleComplex *A;
+    magma_int_t lda;
+    std::vector< magma_int_t > info;    // info of each diagonal tile
+    std::atomic< bool > failed;
+};
+
+
+/******************************************************************************/
+// factors diagonal tile k
+static void zhetrf_nopiv_diag_tile( zhetrf_nopiv_tiles *t, magma_int_t k )
+{
+    if (t->failed)
+        return;
+
+    magmaDoubleComplex *A = t->A;
+    magma_int_t lda = t->lda;
+    magma_int_t k0 = k*t->nb;
+    magma_int_t kb = min( t->nb, t->n - k0 );
+
+    t->info[k] = zhetrf_rec_nopiv( t->uplo, kb, t->ib, &A(k0, k0), lda );
+    if (t->info[k] != 0) {
+        t->info[k] += k0;
+        t->failed = true;
+    }
+}
+
+
+/******************************************************************************/
+// solves off-diagonal tile (i, k) for uplo = Lower, (k, i) for Upper,
+// and copies its transpose into the other triangle
+static void zhetrf_nopiv_trsm_tile( zhetrf_nopiv_tiles *t, magma_int_t i, magma_int_t k )
+{
+    if (t->failed)
+        return;
+
+    const magmaDoubleComplex c_one = MAGMA_Z_ONE;
+    magmaDoubleComplex *A = t->A;
+    magma_int_t lda = t->lda;
+    magma_int_t k0 = k*t->nb;
+    magma_int_t kb = min( t->nb, t->n - k0 );
+    magma_int_t i0 = i*t->nb;
+    magma_int_t mb = min( t->nb, t->n - i0 );
+
+    if ( t->uplo == MagmaLower ) {
+        blasf77_ztrsm( MagmaRightStr, MagmaLowerStr,
+                       MagmaConjTransStr, MagmaUnitStr,
+                       &mb, &kb,
+                       &c_one, &A(k0, k0), &lda,
+                               &A(i0, k0), &lda );
+        zhetrf_scal_copy_nopiv( t->uplo, mb, kb, &A(i0, k0), lda, &A(k0, k0), lda,
+                                &A(k0, i0), lda );
+    }
+    else {
+        blasf77_ztrsm( MagmaLeftStr, MagmaUpperStr,
+                       MagmaConjTransStr, MagmaUnitStr,
+                       &kb, &mb,
+                       &c_one, &A(k0, k0), &lda,
+                               &A(k0, i0), &lda );
+        zhetrf_scal_copy_nopiv( t->uplo, kb, mb, &A(k0, i0), lda, &A(k0, k0), lda,
+                                &A(i0, k0), lda );
+    }
+}
+
+
+/******************************************************************************/
+// updates tile (i, j), i >= j, for uplo = Lower, or (j, i) for Upper,
+// with the tiles of column (row) k
+static void zhetrf_nopiv_update_tile( zhetrf_nopiv_tiles *t, magma_int_t i, magma_int_t j, magma_int_t k )
+{
+    if (t->failed)
+        return;
+
+    const magmaDoubleComplex c_one     = MAGMA_Z_ONE;
+    const magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
+    magmaDoubleComplex *A = t->A;
+    magma_int_t lda = t->lda;
+    magma_int_t k0 = k*t->nb;
+    magma_int_t kb = min( t->nb, t->n - k0 );
+    magma_int_t i0 = i*t->nb;
+    magma_int_t mb = min( t->nb, t->n - i0 );
+    magma_int_t j0 = j*t->nb;
+    magma_int_t jb = min( t->nb, t->n - j0 );
+
+    if ( t->uplo == MagmaLower ) {
+        blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr,
+                       &mb, &jb, &kb,
+                       &c_neg_one, &A(i0, k0), &lda,
+                                   &A(k0, j0), &lda,
+                       &c_one,     &A(i0, j0), &lda );
+    }
+    else {
+        blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr,
+                       &jb, &mb, &kb,
+                       &c_neg_one, &A(j0, k0), &lda,
+                                   &A(k0, i0), &lda,
+                       &c_one,     &A(j0, i0), &lda );
+    }
+}
+
+
+/******************************************************************************/
+class zhetrf_nopiv_diag_task: public magma_task
+{
+public:
+    zhetrf_nopiv_diag_task( zhetrf_nopiv_tiles *in_t, magma_int_t in_k ):
+        magma_task( 2 ),
+        t( in_t ),
+        k( in_k )
+    {}
+
+    virtual void run() { zhetrf_nopiv_diag_tile( t, k ); }
+
+private:
+    zhetrf_nopiv_tiles *t;
+    magma_int_t k;
+};
+
+
+/******************************************************************************/
+class zhetrf_nopiv_trsm_task: public magma_task
+{
+public:
+    zhetrf_nopiv_trsm_task( zhetrf_nopiv_tiles *in_t, magma_int_t in_i, magma_int_t in_k ):
+        magma_task( 2 ),
+        t( in_t ),
+        i( in_i ),
+        k( in_k )
+    {}
+
+    virtual void run() { zhetrf_nopiv_trsm_tile( t, i, k ); }
+
+private:
+    zhetrf_nopiv_tiles *t;
+    magma_int_t i, k;
+};
+
+
+/******************************************************************************/
+// updates of the next tile column are the look-ahead, they get priority 1
+class zhetrf_nopiv_update_task: public magma_task
+{
+public:
+    zhetrf_nopiv_update_task( zhetrf_nopiv_tiles *in_t, magma_int_t in_i, magma_int_t in_j, magma_int_t in_k ):
+        magma_task( in_j == in_k+1 ? 1 : 0 ),
+        t( in_t ),
+        i( in_i ),
+        j( in_j ),
+        k( in_k )
+    {}
+
+    virtual void run() { zhetrf_nopiv_update_tile( t, i, j, k ); }
+
+private:
+    zhetrf_nopiv_tiles *t;
+    magma_int_t i, j, k;
+};
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZHETRF_NOPIV_CPU computes the LDL^H factorization of a Hermitian
+    matrix A on the CPU, without pivoting:
+        A = L * D * L^H  if uplo = MagmaLower, or
+        A = U^H * D * U  if uplo = MagmaUpper,
+    where L (U) is unit lower (upper) triangular and D is diagonal.
+
+    The matrix is divided into square tiles. The factorization of the
+    diagonal tiles, the triangular solves and the updates of the other
+    tiles are tasks of a dependency-driven thread queue; the next tile
+    column (row) is updated first, as look-ahead. Diagonal tiles are
+    factored recursively, with an unblocked factorization below ib.
+    Matrices of at most one panel of the hybrid factorization, as given by
+    magma_get_zhetrf_nopiv_nb, are factored recursively without launching
+    threads, so calling this routine once per panel is cheap.
+
+    Arguments
+    ---------
+    @param[in]
+    uplo    magma_uplo_t
+      -     = MagmaUpper:  Upper triangle of A is stored;
+      -     = MagmaLower:  Lower triangle of A is stored.
+
+    @param[in]
+    n       INTEGER
+            The order of the matrix A.  N >= 0.
+
+    @param[in]
+    ib      INTEGER
+            The block size of the unblocked factorization.  IB >= 1.
+
+    @param[in,out]
+    A       COMPLEX_16 array, dimension (LDA,N)
+            On entry, the Hermitian matrix A in the triangle given by uplo.
+            On exit, the factors L (U) and D. The diagonal of A holds D.
+            The other triangle is used as workspace and is destroyed.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of the array A.  LDA >= max(1,N).
+
+    @param[out]
+    info    INTEGER
+      -     = 0:  successful exit
+      -     > 0:  if INFO = i, D(i,i) is below epsilon in magnitude, and the
+                  factorization could not be completed.
+
+    @ingroup magma_hetrf_nopiv
+*******************************************************************************/
 extern "C" magma_int_t
 magma_zhetrf_nopiv_cpu(
     magma_uplo_t uplo, magma_int_t n, magma_int_t ib,
     magmaDoubleComplex *A, magma_int_t lda,
     magma_int_t *info)
 {
-    magma_int_t ione = 1;
-    double alpha;
-    double d_one = 1.0;
-    magmaDoubleComplex c_one     = MAGMA_Z_ONE;
-    magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
-
     /* Check input arguments */
     *info = 0;
     if (lda < n) {
@@ -277,102 +416,100 @@ magma_zhetrf_nopiv_cpu(
     }
 
     /* Quick return */
-    if (n == 1) {
+    if (n == 0) {
+        return *info;
+    }
+    ib = max( 1, ib );
+
+    // about one tile column per thread, in multiples of ib
+    magma_int_t nthread = magma_get_parallel_numthreads();
+    magma_int_t nb = max( ib, min( 256, magma_roundup( magma_ceildiv( n, nthread ), ib )));
+    magma_int_t nt = magma_ceildiv( n, nb );
+
+    // the hybrid factorizations call this once per panel; launching the
+    // thread queue for each panel costs more than it gains, so panels and
+    // single tiles are factored recursively, with multithreaded BLAS
+    if (nt == 1 || n <= magma_get_zhetrf_nopiv_nb( n )) {
+        *info = zhetrf_rec_nopiv( uplo, n, ib, A, lda );
         return *info;
     }
 
-    if ( uplo == MagmaLower ) {
-        for (magma_int_t i = 0; i < n; i += ib) {
-            magma_int_t sb = min(n-i, ib);
-
-            /* Factorize the diagonal block */
-            *info = zhetrf_diag_nopiv(uplo, sb, &A(i, i), lda);
-            if (*info != 0) return *info;
-
-            if ( i + sb < n ) {
-                magma_int_t height = n - i - sb;
-
-                /* Solve the lower panel ( L21*D11 )*/
-                blasf77_ztrsm(
-                    MagmaRightStr, MagmaLowerStr,
-                    MagmaConjTransStr, MagmaUnitStr,
-                    &height, &sb,
-                    &c_one, &A(i, i),    &lda,
-                            &A(i+sb, i), &lda);
-
-                /* Scale the block to divide by D */
-                for (magma_int_t k=0; k < sb; k++) {
-                    #define ZHERK_D_WORKSPACE
-                    #ifdef ZHERK_D_WORKSPACE
-                    for (magma_int_t ii=i+sb; ii < n; ii++) {
-                        A(i+k, ii) = MAGMA_Z_CONJ( A(ii, i+k) );
-                    }
-                    #endif
-                    alpha = d_one / MAGMA_Z_REAL(A(i+k, i+k));
-                    blasf77_zdscal(&height, &alpha, &A(i+sb, i+k), &ione);
-                    A(i+k, i+k) = MAGMA_Z_MAKE(MAGMA_Z_REAL(A(i+k, i+k)), 0.0);
+    zhetrf_nopiv_tiles t;
+    t.uplo   = uplo;
+    t.n      = n;
+    t.nb     = nb;
+    t.ib     = ib;
+    t.A      = A;
+    t.lda    = lda;
+    t.info.assign( nt, 0 );
+    t.failed = false;
+
+    if (nthread == 1) {
+        // right-looking, tile by tile
+        for (magma_int_t k = 0; k < nt; ++k) {
+            zhetrf_nopiv_diag_tile( &t, k );
+            for (magma_int_t i = k+1; i < nt; ++i) {
+                zhetrf_nopiv_trsm_tile( &t, i, k );
+            }
+            for (magma_int_t j = k+1; j < nt; ++j) {
+                for (magma_int_t i = j; i < nt; ++i) {
+                    zhetrf_nopiv_update_tile( &t, i, j, k );
                 }
-
-                /* Update the trailing submatrix A22 = A22 - A21 * D11 * A21' */
-                #ifdef ZHERK_D_WORKSPACE
-                zherk_d_workspace( MagmaLower, height, sb,
-                                   c_neg_one, &A(i+sb, i),    lda,    // A21
-                                   c_one,     &A(i+sb, i+sb), lda,    // A22
-                                              &A(i, i+sb),    lda );  // workspace, I am writing on upper part :)
-                #else
-                zherk_d( MagmaLower, height, sb,
-                         c_neg_one, &A(i+sb, i),    lda,      // A21
-                         c_one,     &A(i+sb, i+sb), lda,      // A22
-                                    &A(i, i),       lda+1 );  // D11
-                #endif
             }
         }
-    } else {
-        for (magma_int_t i = 0; i < n; i += ib) {
-            magma_int_t sb = min(n-i, ib);
-
-            /* Factorize the diagonal block */
-            *info = zhetrf_diag_nopiv(uplo, sb, &A(i, i), lda);
-            if (*info != 0) return *info;
-
-            if ( i + sb < n ) {
-                magma_int_t height = n - i - sb;
-
-                /* Solve the lower panel ( L21*D11 )*/
-                blasf77_ztrsm(
-                    MagmaLeftStr, MagmaUpperStr,
-                    MagmaConjTransStr, MagmaUnitStr,
-                    &sb, &height,
-                    &c_one, &A(i, i),    &lda,
-                            &A(i, i+sb), &lda);
-
-                /* Scale the block to divide by D */
-                for (magma_int_t k=0; k < sb; k++) {
-                    #define ZHERK_D_WORKSPACE
-                    #ifdef ZHERK_D_WORKSPACE
-                    for (magma_int_t ii=i+sb; ii < n; ii++) {
-                        A(ii, i+k) = MAGMA_Z_CONJ( A(i+k, ii) );
-                    }
-                    #endif
-                    alpha = d_one / MAGMA_Z_REAL(A(i+k, i+k));
-                    blasf77_zdscal(&height, &alpha, &A(i+k, i+sb), &lda);
-                    A(i+k, i+k) = MAGMA_Z_MAKE(MAGMA_Z_REAL(A(i+k, i+k)), 0.0);
+    }
+    else {
+        // launch threads -- each single-threaded MKL
+        magma_int_t lapack_nthread = magma_get_lapack_numthreads();
+        magma_set_lapack_numthreads( 1 );
+        magma_thread_queue queue;
+        queue.launch( nthread );
+
+        // The whole graph is built before any task is pushed, since dependencies
+        // must be set before their predecessors are pushed.
+        // last[ i + j*nt ] is the last task writing tile (i, j), i >= j.
+        std::vector< magma_task* > tasks;
+        std::vector< magma_task* > last( nt*nt, NULL );
+        std::vector< magma_task* > trsm( nt, NULL );
+        for (magma_int_t k = 0; k < nt; ++k) {
+            magma_task* diag = new zhetrf_nopiv_diag_task( &t, k );
+            if (last[ k + k*nt ])
+                diag->depends_on( last[ k + k*nt ] );
+            tasks.push_back( diag );
+
+            for (magma_int_t i = k+1; i < nt; ++i) {
+                trsm[i] = new zhetrf_nopiv_trsm_task( &t, i, k );
+                trsm[i]->depends_on( diag );
+                if (last[ i + k*nt ])
+                    trsm[i]->depends_on( last[ i + k*nt ] );
+                tasks.push_back( trsm[i] );
+            }
+            for (magma_int_t j = k+1; j < nt; ++j) {
+                for (magma_int_t i = j; i < nt; ++i) {
+                    magma_task* update = new zhetrf_nopiv_update_task( &t, i, j, k );
+                    update->depends_on( trsm[i] );
+                    if (i != j)
+                        update->depends_on( trsm[j] );
+                    if (last[ i + j*nt ])
+                        update->depends_on( last[ i + j*nt ] );
+                    last[ i + j*nt ] = update;
+                    tasks.push_back( update );
                 }
-
-                /* Update the trailing submatrix A22 = A22 - A21 * D11 * A21' */
-                #ifdef ZHERK_D_WORKSPACE
-                zherk_d_workspace( MagmaUpper, height, sb,
-                                   c_neg_one, &A(i, i+sb),    lda,    // A21
-                                   c_one,     &A(i+sb, i+sb), lda,    // A22
-                                              &A(i+sb, i),    lda );  // workspace, I am writing on upper part :)
-                #else
-                zherk_d( MagmaUpper, height, sb,
-                         c_neg_one, &A(i, i+sb),    lda,      // A21
-                         c_one,     &A(i+sb, i+sb), lda,      // A22
-                                    &A(i, i),       lda+1 );  // D11
-                #endif
             }
         }
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            queue.push_task( tasks[i] );
+        }
+        queue.sync();
+        queue.quit();
+        magma_set_lapack_numthreads( lapack_nthread );
+    }
+
+    for (magma_int_t k = 0; k < nt; ++k) {
+        if (t.info[k] != 0) {
+            *info = t.info[k];
+            break;
+        }
     }
 
     return *info;
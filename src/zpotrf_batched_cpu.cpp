@@ -0,0 +1,395 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include "magma_internal.h"
+#include "batched_kernel_param.h"
+
+#define LANES BATCHED_CPU_LANES
+
+
+/******************************************************************************/
+// Cholesky factorization of one n-by-n matrix, n = N known at compile time,
+// in a local copy holding the lower triangle; for uplo = MagmaUpper it holds
+// U^H. A is written only on success, so on failure the caller can hand the
+// unchanged matrix to LAPACK, which defines what is left in A.
+// @return true on success.
+template< int N >
+static bool zpotrf_batched_cpu_sq(
+    magma_uplo_t uplo, magmaDoubleComplex *A, magma_int_t lda )
+{
+    magmaDoubleComplex rA[N][N];  // rA[j][i] = L(i,j)
+
+    if (uplo == MagmaLower) {
+        for (int j = 0; j < N; ++j)
+            for (int i = j; i < N; ++i)
+                rA[j][i] = A[ i + j*lda ];
+    }
+    else {
+        for (int j = 0; j < N; ++j)
+            for (int i = j; i < N; ++i)
+                rA[j][i] = MAGMA_Z_CONJ( A[ j + i*lda ] );
+    }
+
+    for (int k = 0; k < N; ++k) {
+        double d = MAGMA_Z_REAL( rA[k][k] );
+        if (! (d > 0)) {  // also for NAN
+            return false;
+        }
+        d = sqrt( d );
+        rA[k][k] = MAGMA_Z_MAKE( d, 0 );
+        double r = 1 / d;
+        for (int i = k+1; i < N; ++i)
+            rA[k][i] *= r;
+        for (int j = k+1; j < N; ++j)
+            for (int i = j; i < N; ++i)
+                rA[j][i] -= rA[k][i] * MAGMA_Z_CONJ( rA[k][j] );
+    }
+
+    if (uplo == MagmaLower) {
+        for (int j = 0; j < N; ++j)
+            for (int i = j; i < N; ++i)
+                A[ i + j*lda ] = rA[j][i];
+    }
+    else {
+        for (int j = 0; j < N; ++j)
+            for (int i = j; i < N; ++i)
+                A[ j + i*lda ] = MAGMA_Z_CONJ( rA[j][i] );
+    }
+    return true;
+}
+
+
+/******************************************************************************/
+// Same as zpotrf_batched_cpu_sq for nlanes <= LANES matrices at once,
+// interleaved so that every operation vectorizes across the matrices.
+// Unused lanes hold the identity. Only matrices that succeed are written;
+// ok[l] tells which.
+template< int N >
+static void zpotrf_batched_cpu_interleaved(
+    magma_uplo_t uplo, magma_int_t nlanes,
+    magmaDoubleComplex **A_array, magma_int_t lda, bool *ok )
+{
+    #define B(i_, j_, l_) buf[ ((i_) + (j_)*N)*LANES + (l_) ]
+
+    magmaDoubleComplex buf[ N*N*LANES ];
+    double r[ LANES ];
+
+    for (int j = 0; j < N; ++j) {
+        for (int i = j; i < N; ++i) {
+            for (int l = 0; l < LANES; ++l) {
+                if (l >= nlanes)
+                    B(i, j, l) = (i == j ? MAGMA_Z_ONE : MAGMA_Z_ZERO);
+                else if (uplo == MagmaLower)
+                    B(i, j, l) = A_array[l][ i + j*lda ];
+                else
+                    B(i, j, l) = MAGMA_Z_CONJ( A_array[l][ j + i*lda ] );
+            }
+        }
+    }
+    for (int l = 0; l < LANES; ++l)
+        ok[l] = true;
+
+    for (int k = 0; k < N; ++k) {
+        #pragma omp simd
+        for (int l = 0; l < LANES; ++l) {
+            double d = MAGMA_Z_REAL( B(k, k, l) );
+            ok[l] = ok[l] && d > 0;
+            d = sqrt( ok[l] ? d : 1 );
+            B(k, k, l) = MAGMA_Z_MAKE( d, 0 );
+            r[l] = 1 / d;
+        }
+        for (int i = k+1; i < N; ++i) {
+            #pragma omp simd
+            for (int l = 0; l < LANES; ++l) {
+                B(i, k, l) *= r[l];
+            }
+        }
+        for (int j = k+1; j < N; ++j) {
+            for (int i = j; i < N; ++i) {
+                #pragma omp simd
+                for (int l = 0; l < LANES; ++l) {
+                    B(i, j, l) -= B(i, k, l) * MAGMA_Z_CONJ( B(j, k, l) );
+                }
+            }
+        }
+    }
+
+    for (int l = 0; l < nlanes; ++l) {
+        if (! ok[l])
+            continue;
+        for (int j = 0; j < N; ++j) {
+            for (int i = j; i < N; ++i) {
+                if (uplo == MagmaLower)
+                    A_array[l][ i + j*lda ] = B(i, j, l);
+                else
+                    A_array[l][ j + i*lda ] = MAGMA_Z_CONJ( B(i, j, l) );
+            }
+        }
+    }
+
+    #undef B
+}
+
+
+/******************************************************************************/
+typedef bool (*zpotrf_batched_cpu_sq_t)(
+    magma_uplo_t uplo, magmaDoubleComplex *A, magma_int_t lda );
+
+typedef void (*zpotrf_batched_cpu_interleaved_t)(
+    magma_uplo_t uplo, magma_int_t nlanes,
+    magmaDoubleComplex **A_array, magma_int_t lda, bool *ok );
+
+// @return the kernel specialized on n, or NULL if there is none.
+static zpotrf_batched_cpu_sq_t zpotrf_batched_cpu_sq_kernel( magma_int_t n )
+{
+    switch (n) {
+        case  1: return zpotrf_batched_cpu_sq<  1 >;
+        case  2: return zpotrf_batched_cpu_sq<  2 >;
+        case  3: return zpotrf_batched_cpu_sq<  3 >;
+        case  4: return zpotrf_batched_cpu_sq<  4 >;
+        case  5: return zpotrf_batched_cpu_sq<  5 >;
+        case  6: return zpotrf_batched_cpu_sq<  6 >;
+        case  7: return zpotrf_batched_cpu_sq<  7 >;
+        case  8: return zpotrf_batched_cpu_sq<  8 >;
+        case  9: return zpotrf_batched_cpu_sq<  9 >;
+        case 10: return zpotrf_batched_cpu_sq< 10 >;
+        case 11: return zpotrf_batched_cpu_sq< 11 >;
+        case 12: return zpotrf_batched_cpu_sq< 12 >;
+        case 13: return zpotrf_batched_cpu_sq< 13 >;
+        case 14: return zpotrf_batched_cpu_sq< 14 >;
+        case 15: return zpotrf_batched_cpu_sq< 15 >;
+        case 16: return zpotrf_batched_cpu_sq< 16 >;
+        default: return NULL;
+    }
+}
+
+// @return the interleaved kernel for n, or NULL if there is none.
+static zpotrf_batched_cpu_interleaved_t zpotrf_batched_cpu_interleaved_kernel( magma_int_t n )
+{
+    switch (n) {
+        case  1: return zpotrf_batched_cpu_interleaved<  1 >;
+        case  2: return zpotrf_batched_cpu_interleaved<  2 >;
+        case  3: return zpotrf_batched_cpu_interleaved<  3 >;
+        case  4: return zpotrf_batched_cpu_interleaved<  4 >;
+        case  5: return zpotrf_batched_cpu_interleaved<  5 >;
+        case  6: return zpotrf_batched_cpu_interleaved<  6 >;
+        case  7: return zpotrf_batched_cpu_interleaved<  7 >;
+        case  8: return zpotrf_batched_cpu_interleaved<  8 >;
+        default: return NULL;
+    }
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZPOTRF_BATCHED_CPU_ONE computes the Cholesky factorization of one
+    complex Hermitian positive definite matrix A in the calling thread,
+        A = U**H * U,   if UPLO = MagmaUpper, or
+        A = L  * L**H,  if UPLO = MagmaLower.
+
+    It is the per-matrix kernel of the CPU vbatched Cholesky routines
+    (magma_zpotrf_vbatched_cpu, magma_zposv_vbatched_cpu), which call it
+    from inside their own parallel region. It uses the kernel specialized
+    on n when n <= magma_get_zbatched_cpu_crossover(), and LAPACK otherwise
+    or if the matrix is not positive definite; LAPACK then starts again
+    from the original matrix. It does not check its arguments and does not
+    change the number of LAPACK threads, which the caller should set to 1.
+
+    Arguments
+    ---------
+    @param[in]
+    uplo    magma_uplo_t
+      -     = MagmaUpper:  Upper triangle of A is stored;
+      -     = MagmaLower:  Lower triangle of A is stored.
+
+    @param[in]
+    n       INTEGER
+            The order of the matrix A.  N >= 0.
+
+    @param[in,out]
+    A       COMPLEX_16 array, dimension (LDA,N)
+            On entry, the Hermitian matrix A, as in magma_zpotrf.
+            On exit, if the return value is 0, the factor U or L from the
+            Cholesky factorization.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of the array A.  LDA >= max(1,N).
+
+    @return the LAPACK info of the factorization:
+      -     = 0:  successful exit
+      -     > 0:  the leading minor of this order is not positive
+                  definite, and the factorization could not be completed.
+
+    @ingroup magma_potrf_batched
+*******************************************************************************/
+extern "C" magma_int_t
+magma_zpotrf_batched_cpu_one(
+    magma_uplo_t uplo, magma_int_t n,
+    magmaDoubleComplex *A, magma_int_t lda )
+{
+    magma_int_t info = 0;
+    zpotrf_batched_cpu_sq_t sq = NULL;
+    if (n <= magma_get_zbatched_cpu_crossover()) {
+        sq = zpotrf_batched_cpu_sq_kernel( n );
+    }
+    if (sq == NULL || ! sq( uplo, A, lda )) {
+        lapackf77_zpotrf( lapack_uplo_const( uplo ), &n, A, &lda, &info );
+    }
+    return info;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZPOTRF computes the Cholesky factorization of a complex Hermitian
+    positive definite matrix A.
+
+    The factorization has the form
+        A = U**H * U,   if UPLO = MagmaUpper, or
+        A = L  * L**H,  if UPLO = MagmaLower,
+    where U is an upper triangular matrix and L is lower triangular.
+
+    This is a batched version for the CPU host that factors batchCount
+    N-by-N matrices in parallel, with OpenMP across the batch. It has the
+    same interface as magma_zpotrf_batched, with the arrays on the host.
+    Small matrices use kernels specialized on n
+    (see magma_get_zbatched_cpu_crossover);
+    the smallest ones are factored several at a time in an interleaved layout
+    (see magma_get_zbatched_cpu_interleave). Other matrices, and matrices
+    that are not positive definite, use LAPACK.
+
+    Arguments
+    ---------
+    @param[in]
+    uplo    magma_uplo_t
+      -     = MagmaUpper:  Upper triangle of A is stored;
+      -     = MagmaLower:  Lower triangle of A is stored.
+
+    @param[in]
+    n       INTEGER
+            The order of the matrix A.  N >= 0.
+
+    @param[in,out]
+    A_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDA,N).
+            On entry, each pointer is a Hermitian matrix A.
+            If UPLO = MagmaUpper, the leading N-by-N upper triangular part
+            of A contains the upper triangular part of the matrix A, and
+            the strictly lower triangular part of A is not referenced.
+            If UPLO = MagmaLower, the leading N-by-N lower triangular part
+            of A contains the lower triangular part of the matrix A, and
+            the strictly upper triangular part of A is not referenced.
+    \n
+            On exit, if corresponding entry in info_array = 0,
+            each pointer is the factor U or L from the Cholesky
+            factorization A = U**H * U or A = L * L**H.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of each array A.  LDA >= max(1,N).
+
+    @param[out]
+    info_array  Array of INTEGERs, dimension (batchCount), for corresponding matrices.
+      -     = 0:  successful exit
+      -     > 0:  if INFO = i, the leading minor of order i is not
+                  positive definite, and the factorization could not be
+                  completed.
+
+    @param[in]
+    batchCount  INTEGER
+                The number of matrices to operate on.
+
+    @return
+      -     = 0:  successful exit
+      -     < 0:  if INFO = -i, the i-th argument had an illegal value.
+
+    @ingroup magma_potrf_batched
+*******************************************************************************/
+extern "C" magma_int_t
+magma_zpotrf_batched_cpu(
+    magma_uplo_t uplo, magma_int_t n,
+    magmaDoubleComplex **A_array, magma_int_t lda,
+    magma_int_t *info_array,
+    magma_int_t batchCount )
+{
+    /* Check arguments */
+    magma_int_t arginfo = 0;
+    if (uplo != MagmaUpper && uplo != MagmaLower)
+        arginfo = -1;
+    else if (n < 0)
+        arginfo = -2;
+    else if (lda < max(1,n))
+        arginfo = -4;
+    else if (batchCount < 0)
+        arginfo = -6;
+
+    if (arginfo != 0) {
+        magma_xerbla( __func__, -(arginfo) );
+        return arginfo;
+    }
+
+    for (magma_int_t s = 0; s < batchCount; ++s)
+        info_array[s] = 0;
+
+    /* Quick return if possible */
+    if (n == 0) {
+        return arginfo;
+    }
+
+    zpotrf_batched_cpu_sq_t sq = NULL;
+    zpotrf_batched_cpu_interleaved_t interleaved = NULL;
+    if (n <= magma_get_zbatched_cpu_crossover()) {
+        sq = zpotrf_batched_cpu_sq_kernel( n );
+        if (n <= magma_get_zbatched_cpu_interleave())
+            interleaved = zpotrf_batched_cpu_interleaved_kernel( n );
+    }
+
+    const char* uplo_ = lapack_uplo_const( uplo );
+    // one thread per matrix
+    magma_int_t nthreads = magma_get_lapack_numthreads();
+    magma_set_lapack_numthreads( 1 );
+    magma_set_omp_numthreads( nthreads );
+
+    if (interleaved != NULL) {
+        magma_int_t ngroup = magma_ceildiv( batchCount, LANES );
+        #pragma omp parallel for schedule(dynamic, 4)
+        for (magma_int_t g = 0; g < ngroup; ++g) {
+            magma_int_t s = g*LANES;
+            magma_int_t nlanes = min( LANES, batchCount - s );
+            bool ok[ LANES ];
+            interleaved( uplo, nlanes, &A_array[s], lda, ok );
+            for (magma_int_t l = 0; l < nlanes; ++l) {
+                if (! ok[l]) {
+                    lapackf77_zpotrf( uplo_, &n, A_array[s+l], &lda, &info_array[s+l] );
+                }
+            }
+        }
+    }
+    else if (sq != NULL) {
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (magma_int_t s = 0; s < batchCount; ++s) {
+            if (! sq( uplo, A_array[s], lda )) {
+                lapackf77_zpotrf( uplo_, &n, A_array[s], &lda, &info_array[s] );
+            }
+        }
+    }
+    else {
+        #pragma omp parallel for schedule(dynamic)
+        for (magma_int_t s = 0; s < batchCount; ++s) {
+            lapackf77_zpotrf( uplo_, &n, A_array[s], &lda, &info_array[s] );
+        }
+    }
+
+    magma_set_lapack_numthreads( nthreads );
+
+    return arginfo;
+}
@@ -0,0 +1,437 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> s d c
+*/
+#include <vector>
+
+#include "magma_internal.h"
+#include "batched_kernel_param.h"
+
+#define COMPLEX
+
+
+/******************************************************************************/
+// @return flops of the Cholesky factorization of order n and of the solve
+// with nrhs right hand sides; same as FLOPS_ZPOTRF + FLOPS_ZPOTRS in
+// testing/flops.h.
+static double zposv_vbatched_cpu_flops( magma_int_t n, magma_int_t nrhs )
+{
+    double dn = double( n ), dr = double( nrhs );
+    double fmuls = dn * (((1./6.) * dn + 0.5) * dn + (1./3.)) + dr * dn * (dn + 1.);
+    double fadds = dn * (((1./6.) * dn      ) * dn - (1./6.)) + dr * dn * (dn - 1.);
+    #ifdef COMPLEX
+    return 6. * fmuls + 2. * fadds;
+    #else
+    return fmuls + fadds;
+    #endif
+}
+
+
+/******************************************************************************/
+// @return the bin of magma_vbatched_cpu_stats that holds order n.
+static magma_int_t zvbatched_cpu_bin( magma_int_t n )
+{
+    magma_int_t b = 0;
+    while (b < MAGMA_VBATCHED_CPU_NBINS-1 && n > (4 << b))
+        ++b;
+    return b;
+}
+
+
+/******************************************************************************/
+// Solves A*X = B with the Cholesky factor of one small n-by-n matrix,
+// one right hand side at a time, working on columns of the factor.
+static void zpotrs_vbatched_cpu_small(
+    magma_uplo_t uplo, magma_int_t n, magma_int_t nrhs,
+    const magmaDoubleComplex *A, magma_int_t lda,
+    magmaDoubleComplex *B, magma_int_t ldb )
+{
+    #define A(i_, j_) A[ (i_) + (j_)*lda ]
+
+    for (magma_int_t c = 0; c < nrhs; ++c) {
+        magmaDoubleComplex *x = &B[ c*ldb ];
+        if (uplo == MagmaLower) {
+            // L*y = b, then L^H*x = y
+            for (magma_int_t k = 0; k < n; ++k) {
+                x[k] = x[k] * (1 / MAGMA_Z_REAL( A(k, k) ));
+                for (magma_int_t i = k+1; i < n; ++i)
+                    x[i] -= A(i, k) * x[k];
+            }
+            for (magma_int_t k = n-1; k >= 0; --k) {
+                magmaDoubleComplex t = x[k];
+                for (magma_int_t i = k+1; i < n; ++i)
+                    t -= MAGMA_Z_CONJ( A(i, k) ) * x[i];
+                x[k] = t * (1 / MAGMA_Z_REAL( A(k, k) ));
+            }
+        }
+        else {
+            // U^H*y = b, then U*x = y
+            for (magma_int_t k = 0; k < n; ++k) {
+                magmaDoubleComplex t = x[k];
+                for (magma_int_t i = 0; i < k; ++i)
+                    t -= MAGMA_Z_CONJ( A(i, k) ) * x[i];
+                x[k] = t * (1 / MAGMA_Z_REAL( A(k, k) ));
+            }
+            for (magma_int_t k = n-1; k >= 0; --k) {
+                x[k] = x[k] * (1 / MAGMA_Z_REAL( A(k, k) ));
+                for (magma_int_t i = 0; i < k; ++i)
+                    x[i] -= A(i, k) * x[k];
+            }
+        }
+    }
+
+    #undef A
+}
+
+
+/******************************************************************************/
+// Common driver of magma_zpotrf_vbatched_cpu and magma_zposv_vbatched_cpu;
+// solves only if B_array != NULL. Arguments are already checked.
+//
+// Matrices are counting-sorted by decreasing order n, then cut into tasks of
+// equal n and about BATCHED_CPU_TASK_FLOPS flops each, so each task uses a
+// single kernel. Threads take tasks dynamically, largest first, so the long
+// factorizations start early and the many small ones fill in the tail
+// instead of leaving threads idle behind a late large matrix.
+static void zpotrf_vbatched_cpu_driver(
+    magma_uplo_t uplo, magma_int_t *n_array, magma_int_t *nrhs_array,
+    magmaDoubleComplex **A_array, magma_int_t *lda_array,
+    magmaDoubleComplex **B_array, magma_int_t *ldb_array,
+    magma_int_t *info_array, magma_int_t batchCount,
+    magma_vbatched_cpu_stats *stats )
+{
+    real_Double_t wall_time = magma_wtime();
+
+    if (stats != NULL) {
+        for (magma_int_t b = 0; b < MAGMA_VBATCHED_CPU_NBINS; ++b) {
+            stats->count[b] = 0;
+            stats->flops[b] = 0;
+            stats->time[b]  = 0;
+        }
+    }
+
+    // counting sort by decreasing n; n = 0 needs no work
+    magma_int_t max_n = 0;
+    for (magma_int_t s = 0; s < batchCount; ++s) {
+        info_array[s] = 0;
+        max_n = max( max_n, n_array[s] );
+    }
+    std::vector< magma_int_t > start( max_n + 2, 0 );
+    for (magma_int_t s = 0; s < batchCount; ++s) {
+        if (n_array[s] > 0)
+            start[ max_n - n_array[s] + 1 ] += 1;
+    }
+    for (magma_int_t i = 1; i <= max_n + 1; ++i) {
+        start[i] += start[i-1];
+    }
+    magma_int_t nwork = start[ max_n + 1 ];
+    std::vector< magma_int_t > order( nwork );
+    for (magma_int_t s = 0; s < batchCount; ++s) {
+        if (n_array[s] > 0)
+            order[ start[ max_n - n_array[s] ]++ ] = s;
+    }
+
+    // cut into tasks; task t is order[ task[t] : task[t+1] )
+    std::vector< magma_int_t > task;
+    task.reserve( nwork / 64 + max_n + 2 );
+    double task_flops = 0;
+    for (magma_int_t k = 0; k < nwork; ++k) {
+        magma_int_t s = order[k];
+        magma_int_t n = n_array[s];
+        double flops = zposv_vbatched_cpu_flops( n, B_array != NULL ? nrhs_array[s] : 0 );
+
+        if (k == 0 || n != n_array[ order[k-1] ] || task_flops >= BATCHED_CPU_TASK_FLOPS) {
+            task.push_back( k );
+            task_flops = 0;
+        }
+        task_flops += flops;
+
+        if (stats != NULL) {
+            magma_int_t b = zvbatched_cpu_bin( n );
+            stats->count[b] += 1;
+            stats->flops[b] += flops;
+        }
+    }
+    magma_int_t ntask = task.size();
+    task.push_back( nwork );
+
+    // one thread per task
+    magma_int_t nthreads = magma_get_lapack_numthreads();
+    magma_set_lapack_numthreads( 1 );
+    magma_set_omp_numthreads( nthreads );
+
+    const char* uplo_ = lapack_uplo_const( uplo );
+    const magma_int_t nsmall = magma_get_zbatched_cpu_crossover();
+
+    #pragma omp parallel
+    {
+        double time[ MAGMA_VBATCHED_CPU_NBINS ] = { 0 };
+
+        #pragma omp for schedule(dynamic, 1) nowait
+        for (magma_int_t t = 0; t < ntask; ++t) {
+            real_Double_t task_time = (stats != NULL ? magma_wtime() : 0);
+            magma_int_t n = n_array[ order[ task[t] ] ];
+            for (magma_int_t k = task[t]; k < task[t+1]; ++k) {
+                magma_int_t s = order[k];
+                info_array[s] = magma_zpotrf_batched_cpu_one( uplo, n, A_array[s], lda_array[s] );
+                if (B_array == NULL || info_array[s] != 0 || nrhs_array[s] == 0)
+                    continue;
+                if (n <= nsmall) {
+                    zpotrs_vbatched_cpu_small( uplo, n, nrhs_array[s],
+                                               A_array[s], lda_array[s],
+                                               B_array[s], ldb_array[s] );
+                }
+                else {
+                    magma_int_t info;
+                    lapackf77_zpotrs( uplo_, &n, &nrhs_array[s],
+                                      A_array[s], &lda_array[s],
+                                      B_array[s], &ldb_array[s], &info );
+                }
+            }
+            if (stats != NULL) {
+                time[ zvbatched_cpu_bin( n ) ] += magma_wtime() - task_time;
+            }
+        }
+
+        if (stats != NULL) {
+            #pragma omp critical
+            for (magma_int_t b = 0; b < MAGMA_VBATCHED_CPU_NBINS; ++b) {
+                stats->time[b] += time[b];
+            }
+        }
+    }
+
+    magma_set_lapack_numthreads( nthreads );
+
+    if (stats != NULL) {
+        stats->wall_time = magma_wtime() - wall_time;
+    }
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZPOTRF computes the Cholesky factorization of a complex Hermitian
+    positive definite matrix A.
+
+    The factorization has the form
+        A = U**H * U,   if UPLO = MagmaUpper, or
+        A = L  * L**H,  if UPLO = MagmaLower,
+    where U is an upper triangular matrix and L is lower triangular.
+
+    This is the variable size batched version for the CPU host, with the
+    same interface as magma_zpotrf_vbatched, with the arrays on the host.
+    Matrices are sorted by order and factored in tasks of equal order,
+    largest first, with OpenMP across tasks. Small matrices use kernels
+    specialized on n (see magma_get_zbatched_cpu_crossover); others use
+    LAPACK.
+
+    Arguments
+    ---------
+    @param[in]
+    uplo    magma_uplo_t
+      -     = MagmaUpper:  Upper triangle of A is stored;
+      -     = MagmaLower:  Lower triangle of A is stored.
+
+    @param[in]
+    n_array INTEGER array, dimension (batchCount).
+            Each is the order of the corresponding matrix A.  N >= 0.
+
+    @param[in,out]
+    A_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDA,N).
+            On entry, each pointer is a Hermitian matrix A.
+            If UPLO = MagmaUpper, the leading N-by-N upper triangular part
+            of A contains the upper triangular part of the matrix A, and
+            the strictly lower triangular part of A is not referenced.
+            If UPLO = MagmaLower, the leading N-by-N lower triangular part
+            of A contains the lower triangular part of the matrix A, and
+            the strictly upper triangular part of A is not referenced.
+    \n
+            On exit, if corresponding entry in info_array = 0,
+            each pointer is the factor U or L from the Cholesky
+            factorization A = U**H * U or A = L * L**H.
+
+    @param[in]
+    lda_array   INTEGER array, dimension (batchCount).
+            Each is the leading dimension of the corresponding array A.
+            LDA >= max(1,N).
+
+    @param[out]
+    info_array  Array of INTEGERs, dimension (batchCount), for corresponding matrices.
+      -     = 0:  successful exit
+      -     > 0:  if INFO = i, the leading minor of order i is not
+                  positive definite, and the factorization could not be
+                  completed.
+
+    @param[in]
+    batchCount  INTEGER
+                The number of matrices to operate on.
+
+    @param[out]
+    stats   Optional; if not NULL, on exit the number of matrices, flops and
+            thread-seconds per size bin, and the wall time of the batch.
+            stats->flops[b] / stats->time[b] is the throughput per thread
+            of bin b.
+
+    @return
+      -     = 0:  successful exit
+      -     < 0:  if INFO = -i, the i-th argument had an illegal value.
+
+    @ingroup magma_potrf_batched
+*******************************************************************************/
+extern "C" magma_int_t
+magma_zpotrf_vbatched_cpu(
+    magma_uplo_t uplo, magma_int_t *n_array,
+    magmaDoubleComplex **A_array, magma_int_t *lda_array,
+    magma_int_t *info_array, magma_int_t batchCount,
+    magma_vbatched_cpu_stats *stats )
+{
+    /* Check arguments */
+    magma_int_t arginfo = 0;
+    if (uplo != MagmaUpper && uplo != MagmaLower)
+        arginfo = -1;
+    else if (batchCount < 0)
+        arginfo = -6;
+    for (magma_int_t s = 0; s < batchCount && arginfo == 0; ++s) {
+        if (n_array[s] < 0)
+            arginfo = -2;
+        else if (lda_array[s] < max(1,n_array[s]))
+            arginfo = -4;
+    }
+
+    if (arginfo != 0) {
+        magma_xerbla( __func__, -(arginfo) );
+        return arginfo;
+    }
+
+    zpotrf_vbatched_cpu_driver( uplo, n_array, NULL, A_array, lda_array,
+                                NULL, NULL, info_array, batchCount, stats );
+
+    return arginfo;
+}
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZPOSV computes the solution to a complex system of linear equations
+        A * X = B,
+    where A is an N-by-N Hermitian positive definite matrix and X and B
+    are N-by-NRHS matrices.
+    The Cholesky decomposition is used to factor A as
+        A = U**H * U,   if UPLO = MagmaUpper, or
+        A = L  * L**H,  if UPLO = MagmaLower,
+    where U is an upper triangular matrix and L is lower triangular.
+    The factored form of A is then used to solve the system of equations
+    A * X = B.
+
+    This is the variable size batched version for the CPU host; see
+    magma_zpotrf_vbatched_cpu. Each system is solved right after its
+    factorization, while the factor is still in cache.
+    As in LAPACK, B is not changed for a matrix that is not positive
+    definite.
+
+    Arguments
+    ---------
+    @param[in]
+    uplo    magma_uplo_t
+      -     = MagmaUpper:  Upper triangle of A is stored;
+      -     = MagmaLower:  Lower triangle of A is stored.
+
+    @param[in]
+    n_array INTEGER array, dimension (batchCount).
+            Each is the order of the corresponding matrix A.  N >= 0.
+
+    @param[in]
+    nrhs_array  INTEGER array, dimension (batchCount).
+            Each is the number of right hand sides, i.e., the number of
+            columns of the corresponding matrix B.  NRHS >= 0.
+
+    @param[in,out]
+    A_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDA,N).
+            On entry, each pointer is a Hermitian matrix A, as in
+            magma_zpotrf_vbatched_cpu.
+            On exit, if corresponding entry in info_array = 0,
+            each pointer is the factor U or L from the Cholesky
+            factorization A = U**H * U or A = L * L**H.
+
+    @param[in]
+    lda_array   INTEGER array, dimension (batchCount).
+            Each is the leading dimension of the corresponding array A.
+            LDA >= max(1,N).
+
+    @param[in,out]
+    B_array Array of pointers, dimension (batchCount).
+            Each is a COMPLEX_16 array on the CPU host, dimension (LDB,NRHS).
+            On entry, each pointer is a right hand side matrix B.
+            On exit, each pointer is the solution matrix X.
+
+    @param[in]
+    ldb_array   INTEGER array, dimension (batchCount).
+            Each is the leading dimension of the corresponding array B.
+            LDB >= max(1,N).
+
+    @param[out]
+    info_array  Array of INTEGERs, dimension (batchCount), for corresponding matrices.
+      -     = 0:  successful exit
+      -     > 0:  if INFO = i, the leading minor of order i is not
+                  positive definite, and the solution has not been
+                  computed.
+
+    @param[in]
+    batchCount  INTEGER
+                The number of matrices to operate on.
+
+    @param[out]
+    stats   Optional; if not NULL, statistics per size bin as in
+            magma_zpotrf_vbatched_cpu; flops include the solves.
+
+    @return
+      -     = 0:  successful exit
+      -     < 0:  if INFO = -i, the i-th argument had an illegal value.
+
+    @ingroup magma_posv_batched
+*******************************************************************************/
+extern "C" magma_int_t
+magma_zposv_vbatched_cpu(
+    magma_uplo_t uplo, magma_int_t *n_array, magma_int_t *nrhs_array,
+    magmaDoubleComplex **A_array, magma_int_t *lda_array,
+    magmaDoubleComplex **B_array, magma_int_t *ldb_array,
+    magma_int_t *info_array, magma_int_t batchCount,
+    magma_vbatched_cpu_stats *stats )
+{
+    /* Check arguments */
+    magma_int_t arginfo = 0;
+    if (uplo != MagmaUpper && uplo != MagmaLower)
+        arginfo = -1;
+    else if (batchCount < 0)
+        arginfo = -9;
+    for (magma_int_t s = 0; s < batchCount && arginfo == 0; ++s) {
+        if (n_array[s] < 0)
+            arginfo = -2;
+        else if (nrhs_array[s] < 0)
+            arginfo = -3;
+        else if (lda_array[s] < max(1,n_array[s]))
+            arginfo = -5;
+        else if (ldb_array[s] < max(1,n_array[s]))
+            arginfo = -7;
+    }
+
+    if (arginfo != 0) {
+        magma_xerbla( __func__, -(arginfo) );
+        return arginfo;
+    }
+
+    zpotrf_vbatched_cpu_driver( uplo, n_array, nrhs_array, A_array, lda_array,
+                                B_array, ldb_array, info_array, batchCount, stats );
+
+    return arginfo;
+}
@@ -12,358 +12,509 @@
        
  
 */
-#include "magma_internal.h"
+#include <atomic>
+#include <vector>
 
-#define  A(i, j) ( A[(j)*lda  + (i)])
-#define  C(i, j) ( C[(j)*ldc  + (i)])
-#define  D(i)    ( D[(i)*incD] )
+#include "thread_queue.hpp"
 
-// trailing submatrix update with inner-blocking 
-magma_int_t zsyrk_d(
-    magma_uplo_t uplo, magma_int_t m, magma_int_t n,
-    magmaDoubleComplex alpha, magmaDoubleComplex *A, magma_int_t lda,
-    magmaDoubleComplex beta,  magmaDoubleComplex *C, magma_int_t ldc,
-    magmaDoubleComplex *D, magma_int_t incD)
-{
-    magmaDoubleComplex *Aik;
-    magmaDoubleComplex *Dkk;
-    magmaDoubleComplex *Akj;
+#include "magma_internal.h"  // after thread_queue.hpp, so max, min are defined
 
-    /* Check input arguments */
-    magma_int_t i, j, k;
-    magma_int_t info = 0;
-    if ((uplo != MagmaLower) && (uplo != MagmaUpper)) {
-        info = -1;
-    }
-    else if (m < 0) {
-        info = -3;
-    }
-    else if (n < 0) {
-        info = -4;
-    }
-    else if ((lda < max(1, m)) && (m > 0)) {
-        info = -7;
-    }
-    else if ((ldc < max(1, m)) && (m > 0)) {
-        info = -10;
-    }
-    else if ( incD < 0 ) {
-        info = -12;
-    }
-    
-    if (info != 0) {
-        magma_xerbla( __func__, -(info) );
-        return info;        
-    }
+// TODO convert to usual (A + (i) + (j)*lda), i.e., returns pointer?
+#define  A(i, j) ( A[(j)*lda  + (i)])
+#define  W(i, j) ( W[(j)*ldw  + (i)])
 
-    /* Quick return */
-    if (m == 0 || n == 0 ||
-        ((alpha == 0.0 || m == 0) && beta == 1.0) ) {
-        return info;
-    }
 
-    if ( uplo == MagmaLower ) {
-        for (j=0; j < m; j++) {
-            for (i=j; i < m; i++) {
-                magmaDoubleComplex tmp = MAGMA_Z_ZERO;
-                Aik = A+i;
-                Dkk = D;
-                Akj = A+j;
-                for (k=0; k < n; k++) {
-                    tmp = tmp + (*Aik) * (*Dkk) * ( *Akj );
-                    Aik += lda; 
-                    Dkk += incD; 
-                    Akj += lda;
+/******************************************************************************/
+// fused copy and scale of a block of L*D (uplo = Lower) or D*U (uplo = Upper):
+// W = A^T, then A = A*inv(D) or A = inv(D)*A, where D is the diagonal of
+// the factored block Akk. Rows of A are processed in blocks, so W is
+// written with a small stride.
+static void zsytrf_scal_copy_nopiv(
+    magma_uplo_t uplo, magma_int_t m, magma_int_t n,
+    magmaDoubleComplex *A, magma_int_t lda,
+    const magmaDoubleComplex *Akk, magma_int_t ldakk,
+    magmaDoubleComplex *W, magma_int_t ldw)
+{
+    const magmaDoubleComplex c_one = MAGMA_Z_ONE;
+    const magma_int_t bs = 32;
+    magmaDoubleComplex dinv[ bs ];
+
+    for (magma_int_t i0 = 0; i0 < m; i0 += bs) {
+        magma_int_t i1 = min( i0 + bs, m );
+        if ( uplo == MagmaUpper ) {
+            for (magma_int_t i = i0; i < i1; i++) {
+                dinv[i-i0] = MAGMA_Z_DIV( c_one, Akk[ i*(ldakk+1) ] );
+            }
+            for (magma_int_t j = 0; j < n; j++) {
+                for (magma_int_t i = i0; i < i1; i++) {
+                    magmaDoubleComplex v = A(i, j);
+                    W(j, i) = v;
+                    A(i, j) = v * dinv[i-i0];
                 }
-                C(i, j) = beta * C(i, j) + alpha * tmp;
             }
         }
-    }
-    else {
-        for (j=0; j < m; j++) {
-            for (i=0; i <= j; i++) {
-                magmaDoubleComplex tmp = MAGMA_Z_ZERO;
-                for (k=0; k < n; k++) {
-                    tmp = tmp + A(i, k) * D( k ) * A(k, j);
+        else {
+            for (magma_int_t j = 0; j < n; j++) {
+                magmaDoubleComplex s = MAGMA_Z_DIV( c_one, Akk[ j*(ldakk+1) ] );
+                for (magma_int_t i = i0; i < i1; i++) {
+                    magmaDoubleComplex v = A(i, j);
+                    W(j, i) = v;
+                    A(i, j) = v * s;
                 }
-                C(i, j) = beta * C(i, j) + alpha * tmp;
             }
         }
     }
-    return info;
-}
-
-
-// trailing submatrix update with inner-blocking, using workshpace that
-// stores D*L'
-magma_int_t zsyrk_d_workspace(
-    magma_uplo_t uplo, magma_int_t n, magma_int_t k,
-    magmaDoubleComplex alpha, magmaDoubleComplex *A, magma_int_t lda,
-    magmaDoubleComplex beta,  magmaDoubleComplex *C, magma_int_t ldc,
-    magmaDoubleComplex *work, magma_int_t ldw)
-{
-    const magmaDoubleComplex c_one     = MAGMA_Z_ONE;
-    const magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
-
-    /* Check input arguments */
-    magma_int_t info = 0;
-    if ((uplo != MagmaLower) && (uplo != MagmaUpper)) {
-        info = -1;
-    }
-    else if (n < 0) {
-        info = -2;
-    }
-    else if (k < 0) {
-        info = -3;
-    }
-    else if ((lda < max(1,n)) && (n > 0)) {
-        info = -6;
-    }
-    else if ((ldc < max(1,n)) && (n > 0)) {
-        info = -9;
-    }
-    
-    if (info != 0) {
-        magma_xerbla( __func__, -(info) );
-        return info;        
-    }
-
-    /* Quick return */
-    if (n == 0 || k == 0 ||
-        ((alpha == 0.0 || k == 0) && beta == 1.0) ) {
-        return info;
-    }
-
-    if ( uplo == MagmaLower ) {
-        blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr, 
-                       &n, &n, &k,
-                       &c_neg_one, A,    &lda,
-                                   work, &ldw,
-                       &c_one,     C,    &ldc );
-    }
-    else {
-        blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr, 
-                       &n, &n, &k,
-                       &c_neg_one, work, &ldw,
-                                   A,    &lda,
-                       &c_one,     C,    &ldc );
-    }
-    return info;
 }
 
 
-// diagonal factorization with inner-block
+/******************************************************************************/
+// unblocked diagonal factorization
+// returns the index (1-based) of the first pivot below epsilon
 magma_int_t zsytrf_diag_nopiv(
-    magma_uplo_t uplo, magma_int_t n, 
+    magma_uplo_t uplo, magma_int_t n,
     magmaDoubleComplex *A, magma_int_t lda)
 {
     /* Constants */
     const magma_int_t ione = 1;
     const magmaDoubleComplex c_one = MAGMA_Z_ONE;
-    
+    const double eps = lapackf77_dlamch("Epsilon");
+
     /* Local variables */
-    magmaDoubleComplex *Ak1k = NULL;
     magmaDoubleComplex Akk;
     magmaDoubleComplex alpha;
-    
+
     /* Check input arguments */
     magma_int_t info = 0;
     if (lda < n) {
         info = -4;
     }
     /* TODO: need to check all other arguments */
-    
+
     if (info != 0) {
         magma_xerbla( __func__, -(info) );
-        return info;        
-    }
-    
-    /* Quick return */
-    if (n <= 1)
         return info;
+    }
 
-    if ( uplo == MagmaLower ) {
+    for (magma_int_t k=0; k < n; k++) {
         /* Diagonal element */
-        Akk  = *A;
+        Akk = A(k, k);
+        if ( MAGMA_Z_ABS(Akk) < eps ) {
+            info = k+1;
+            return info;
+        }
 
-        /* Pointer on first extra diagonal element */
-        Ak1k = A + 1;
-
-        for (magma_int_t k=n-1; k > 0; k--) {
-            if ( MAGMA_Z_ABS(Akk) < lapackf77_dlamch("Epsilon") ) {
-                info = k;
-                return info;
-            }
+        magma_int_t m = n-k-1;
+        if (m == 0)
+            break;
 
+        if ( uplo == MagmaLower ) {
             // scale off-diagonals
             alpha = MAGMA_Z_DIV( c_one, Akk );
-            blasf77_zscal(&k, &alpha, Ak1k, &ione);
+            blasf77_zscal(&m, &alpha, &A(k+1, k), &ione);
 
             // update remaining
             alpha = -( Akk );
-            lapackf77_zsyr(MagmaLowerStr, &k, 
-                           &alpha, Ak1k, &ione, Ak1k + lda, &lda);
+            lapackf77_zsyr(MagmaLowerStr, &m,
+                           &alpha, &A(k+1, k), &ione, &A(k+1, k+1), &lda);
+        } else {
+            // scale off-diagonals
+            alpha = MAGMA_Z_DIV( c_one, Akk );
+            blasf77_zscal(&m, &alpha, &A(k, k+1), &lda);
 
-            /* Move to next diagonal element */
-            Ak1k += lda;
-            Akk = *Ak1k;
-            Ak1k++;
+            // update remaining
+            alpha = - ( Akk );
+            lapackf77_zsyr(MagmaUpperStr, &m,
+                           &alpha, &A(k, k+1), &lda, &A(k+1, k+1), &lda);
         }
-    } else {
-        /* Diagonal element */
-        Akk  = *A;
+    }
+    return info;
+}
 
-        /* Pointer on first extra diagonal element */
-        Ak1k = A + lda;
 
-        for (magma_int_t k=n-1; k > 0; k--) {
-            if ( MAGMA_Z_ABS(Akk) < lapackf77_dlamch("Epsilon") ) {
-                info = k;
-                return info;
-            }
+/******************************************************************************/
+// recursive diagonal factorization, with zsytrf_diag_nopiv below ib.
+// The other triangle is used as workspace.
+static magma_int_t zsytrf_rec_nopiv(
+    magma_uplo_t uplo, magma_int_t n, magma_int_t ib,
+    magmaDoubleComplex *A, magma_int_t lda)
+{
+    const magmaDoubleComplex c_one     = MAGMA_Z_ONE;
+    const magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
 
-            // scale off-diagonals
-            alpha = MAGMA_Z_DIV( c_one, Akk );
-            blasf77_zscal(&k, &alpha, Ak1k, &lda);
+    if (n <= ib) {
+        return zsytrf_diag_nopiv( uplo, n, A, lda );
+    }
 
-            // update remaining
-            alpha = - ( Akk );
+    magma_int_t n1 = n/2;
+    magma_int_t n2 = n - n1;
 
-            lapackf77_zsyr(MagmaUpperStr, &k, 
-                         &alpha, Ak1k, &lda, Ak1k + 1, &lda);
+    magma_int_t info = zsytrf_rec_nopiv( uplo, n1, ib, A, lda );
+    if (info != 0)
+        return info;
 
-            /* Move to next diagonal element */
-            Ak1k ++;
-            Akk = *Ak1k;
-            Ak1k += lda;
-        }
+    if ( uplo == MagmaLower ) {
+        /* L21*D11 */
+        blasf77_ztrsm( MagmaRightStr, MagmaLowerStr,
+                       MagmaTransStr, MagmaUnitStr,
+                       &n2, &n1,
+                       &c_one, &A(0, 0),  &lda,
+                               &A(n1, 0), &lda );
+        zsytrf_scal_copy_nopiv( uplo, n2, n1, &A(n1, 0), lda, &A(0, 0), lda,
+                                &A(0, n1), lda );
     }
+    else {
+        /* D11*U12 */
+        blasf77_ztrsm( MagmaLeftStr, MagmaUpperStr,
+                       MagmaTransStr, MagmaUnitStr,
+                       &n1, &n2,
+                       &c_one, &A(0, 0),  &lda,
+                               &A(0, n1), &lda );
+        zsytrf_scal_copy_nopiv( uplo, n1, n2, &A(0, n1), lda, &A(0, 0), lda,
+                                &A(n1, 0), lda );
+    }
+
+    /* A22 = A22 - A21 * A12, one of them holding the copy of L*D or D*U */
+    blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr,
+                   &n2, &n2, &n1,
+                   &c_neg_one, &A(n1, 0),  &lda,
+                               &A(0, n1),  &lda,
+                   &c_one,     &A(n1, n1), &lda );
+
+    info = zsytrf_rec_nopiv( uplo, n2, ib, &A(n1, n1), lda );
+    if (info != 0)
+        info += n1;
     return info;
 }
 
 
-// main routine
+/******************************************************************************/
+// arguments shared by the tile tasks
+struct zsytrf_nopiv_tiles
+{
+    magma_uplo_t uplo;
+    magma_int_t n, nb, ib;
+    magmaDoubleComplex *A;
+    magma_int_t lda;
+    std::vector< magma_int_t > info;    // info of each diagonal tile
+    std::atomic< bool > failed;
+};
+
+
+/******************************************************************************/
+// factors diagonal tile k
+static void zsytrf_nopiv_diag_tile( zsytrf_nopiv_tiles *t, magma_int_t k )
+{
+    if (t->failed)
+        return;
+
+    magmaDoubleComplex *A = t->A;
+    magma_int_t lda = t->lda;
+    magma_int_t k0 = k*t->nb;
+    magma_int_t kb = min( t->nb, t->n - k0 );
+
+    t->info[k] = zsytrf_rec_nopiv( t->uplo, kb, t->ib, &A(k0, k0), lda );
+    if (t->info[k] != 0) {
+        t->info[k] += k0;
+        t->failed = true;
+    }
+}
+
+
+/******************************************************************************/
+// solves off-diagonal tile (i, k) for uplo = Lower, (k, i) for Upper,
+// and copies its transpose into the other triangle
+static void zsytrf_nopiv_trsm_tile( zsytrf_nopiv_tiles *t, magma_int_t i, magma_int_t k )
+{
+    if (t->failed)
+        return;
+
+    const magmaDoubleComplex c_one = MAGMA_Z_ONE;
+    magmaDoubleComplex *A = t->A;
+    magma_int_t lda = t->lda;
+    magma_int_t k0 = k*t->nb;
+    magma_int_t kb = min( t->nb, t->n - k0 );
+    magma_int_t i0 = i*t->nb;
+    magma_int_t mb = min( t->nb, t->n - i0 );
+
+    if ( t->uplo == MagmaLower ) {
+        blasf77_ztrsm( MagmaRightStr, MagmaLowerStr,
+                       MagmaTransStr, MagmaUnitStr,
+                       &mb, &kb,
+                       &c_one, &A(k0, k0), &lda,
+                               &A(i0, k0), &lda );
+        zsytrf_scal_copy_nopiv( t->uplo, mb, kb, &A(i0, k0), lda, &A(k0, k0), lda,
+                                &A(k0, i0), lda );
+    }
+    else {
+        blasf77_ztrsm( MagmaLeftStr, MagmaUpperStr,
+                       MagmaTransStr, MagmaUnitStr,
+                       &kb, &mb,
+                       &c_one, &A(k0, k0), &lda,
+                               &A(k0, i0), &lda );
+        zsytrf_scal_copy_nopiv( t->uplo, kb, mb, &A(k0, i0), lda, &A(k0, k0), lda,
+                                &A(i0, k0), lda );
+    }
+}
+
+
+/******************************************************************************/
+// updates tile (i, j), i >= j, for uplo = Lower, or (j, i) for Upper,
+// with the tiles of column (row) k
+static void zsytrf_nopiv_update_tile( zsytrf_nopiv_tiles *t, magma_int_t i, magma_int_t j, magma_int_t k )
+{
+    if (t->failed)
+        return;
+
+    const magmaDoubleComplex c_one     = MAGMA_Z_ONE;
+    const magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
+    magmaDoubleComplex *A = t->A;
+    magma_int_t lda = t->lda;
+    magma_int_t k0 = k*t->nb;
+    magma_int_t kb = min( t->nb, t->n - k0 );
+    magma_int_t i0 = i*t->nb;
+    magma_int_t mb = min( t->nb, t->n - i0 );
+    magma_int_t j0 = j*t->nb;
+    magma_int_t jb = min( t->nb, t->n - j0 );
+
+    if ( t->uplo == MagmaLower ) {
+        blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr,
+                       &mb, &jb, &kb,
+                       &c_neg_one, &A(i0, k0), &lda,
+                                   &A(k0, j0), &lda,
+                       &c_one,     &A(i0, j0), &lda );
+    }
+    else {
+        blasf77_zgemm( MagmaNoTransStr, MagmaNoTransStr,
+                       &jb, &mb, &kb,
+                       &c_neg_one, &A(j0, k0), &lda,
+                                   &A(k0, i0), &lda,
+                       &c_one,     &A(j0, i0), &lda );
+    }
+}
+
+
+/******************************************************************************/
+class zsytrf_nopiv_diag_task: public magma_task
+{
+public:
+    zsytrf_nopiv_diag_task( zsytrf_nopiv_tiles *in_t, magma_int_t in_k ):
+        magma_task( 2 ),
+        t( in_t ),
+        k( in_k )
+    {}
+
+    virtual void run() { zsytrf_nopiv_diag_tile( t, k ); }
+
+private:
+    zsytrf_nopiv_tiles *t;
+    magma_int_t k;
+};
+
+
+/******************************************************************************/
+class zsytrf_nopiv_trsm_task: public magma_task
+{
+public:
+    zsytrf_nopiv_trsm_task( zsytrf_nopiv_tiles *in_t, magma_int_t in_i, magma_int_t in_k ):
+        magma_task( 2 ),
+        t( in_t ),
+        i( in_i ),
+        k( in_k )
+    {}
+
+    virtual void run() { zsytrf_nopiv_trsm_tile( t, i, k ); }
+
+private:
+    zsytrf_nopiv_tiles *t;
+    magma_int_t i, k;
+};
+
+
+/******************************************************************************/
+// updates of the next tile column are the look-ahead, they get priority 1
+class zsytrf_nopiv_update_task: public magma_task
+{
+public:
+    zsytrf_nopiv_update_task( zsytrf_nopiv_tiles *in_t, magma_int_t in_i, magma_int_t in_j, magma_int_t in_k ):
+        magma_task( in_j == in_k+1 ? 1 : 0 ),
+        t( in_t ),
+        i( in_i ),
+        j( in_j ),
+        k( in_k )
+    {}
+
+    virtual void run() { zsytrf_nopiv_update_tile( t, i, j, k ); }
+
+private:
+    zsytrf_nopiv_tiles *t;
+    magma_int_t i, j, k;
+};
+
+
+/***************************************************************************//**
+    Purpose
+    -------
+    ZSYTRF_NOPIV_CPU computes the LDL^T factorization of a complex
+    symmetric matrix A on the CPU, without pivoting:
+        A = L * D * L^T  if uplo = MagmaLower, or
+        A = U^T * D * U  if uplo = MagmaUpper,
+    where L (U) is unit lower (upper) triangular and D is diagonal.
+
+    The matrix is divided into square tiles. The factorization of the
+    diagonal tiles, the triangular solves and the updates of the other
+    tiles are tasks of a dependency-driven thread queue; the next tile
+    column (row) is updated first, as look-ahead. Diagonal tiles are
+    factored recursively, with an unblocked factorization below ib.
+    Matrices of at most one panel of the hybrid factorization, as given by
+    magma_get_zhetrf_nopiv_nb, are factored recursively without launching
+    threads, so calling this routine once per panel is cheap.
+
+    Arguments
+    ---------
+    @param[in]
+    uplo    magma_uplo_t
+      -     = MagmaUpper:  Upper triangle of A is stored;
+      -     = MagmaLower:  Lower triangle of A is stored.
+
+    @param[in]
+    n       INTEGER
+            The order of the matrix A.  N >= 0.
+
+    @param[in]
+    ib      INTEGER
+            The block size of the unblocked factorization.  IB >= 1.
+
+    @param[in,out]
+    A       COMPLEX_16 array, dimension (LDA,N)
+            On entry, the symmetric matrix A in the triangle given by uplo.
+            On exit, the factors L (U) and D. The diagonal of A holds D.
+            The other triangle is used as workspace and is destroyed.
+
+    @param[in]
+    lda     INTEGER
+            The leading dimension of the array A.  LDA >= max(1,N).
+
+    @param[out]
+    info    INTEGER
+      -     = 0:  successful exit
+      -     > 0:  if INFO = i, D(i,i) is below epsilon in magnitude, and the
+                  factorization could not be completed.
+
+    @ingroup magma_sytrf_nopiv
+*******************************************************************************/
 extern "C" magma_int_t
 magma_zsytrf_nopiv_cpu(
     magma_uplo_t uplo, magma_int_t n, magma_int_t ib,
     magmaDoubleComplex *A, magma_int_t lda,
     magma_int_t *info)
 {
-    /* Constants */
-    const magma_int_t ione = 1;
-    const magmaDoubleComplex c_one     = MAGMA_Z_ONE;
-    const magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
-
-    /* Local variables */
-    magmaDoubleComplex alpha;
-    
     /* Check input arguments */
     *info = 0;
     if (lda < n) {
         *info = -5;
     }
     /* TODO: need to check all other arguments */
-    
+
     if (*info != 0) {
         magma_xerbla( __func__, -(*info) );
-        return *info;        
+        return *info;
     }
 
     /* Quick return */
-    if (n == 1) {
+    if (n == 0) {
+        return *info;
+    }
+    ib = max( 1, ib );
+
+    // about one tile column per thread, in multiples of ib
+    magma_int_t nthread = magma_get_parallel_numthreads();
+    magma_int_t nb = max( ib, min( 256, magma_roundup( magma_ceildiv( n, nthread ), ib )));
+    magma_int_t nt = magma_ceildiv( n, nb );
+
+    // the hybrid factorizations call this once per panel; launching the
+    // thread queue for each panel costs more than it gains, so panels and
+    // single tiles are factored recursively, with multithreaded BLAS
+    if (nt == 1 || n <= magma_get_zhetrf_nopiv_nb( n )) {
+        *info = zsytrf_rec_nopiv( uplo, n, ib, A, lda );
         return *info;
     }
 
-    if ( uplo == MagmaLower ) {
-        for (magma_int_t i = 0; i < n; i += ib) {
-            magma_int_t sb = min(n-i, ib);
-
-            /* Factorize the diagonal block */
-            *info = zsytrf_diag_nopiv(uplo, sb, &A(i, i), lda);
-            if (*info != 0) return *info;
-
-            if ( i + sb < n ) {
-                magma_int_t height = n - i - sb;
-
-                /* Solve the lower panel ( L21*D11 )*/
-                blasf77_ztrsm(
-                    MagmaRightStr, MagmaLowerStr, 
-                    MagmaTransStr, MagmaUnitStr,
-                    &height, &sb, 
-                    &c_one, &A(i, i),    &lda,
-                            &A(i+sb, i), &lda);
-
-                /* Scale the block to divide by D */
-                for (magma_int_t k=0; k < sb; k++) {
-                    #define ZSYRK_D_WORKSPACE
-                    #ifdef ZSYRK_D_WORKSPACE
-                    for (magma_int_t ii=i+sb; ii < n; ii++) {
-                        A(i+k, ii) = A(ii, i+k);
-                    }
-                    #endif
-                    alpha = MAGMA_Z_DIV( c_one, A(i+k, i+k));
-                    blasf77_zscal(&height, &alpha, &A(i+sb, i+k), &ione);
+    zsytrf_nopiv_tiles t;
+    t.uplo   = uplo;
+    t.n      = n;
+    t.nb     = nb;
+    t.ib     = ib;
+    t.A      = A;
+    t.lda    = lda;
+    t.info.assign( nt, 0 );
+    t.failed = false;
+
+    if (nthread == 1) {
+        // right-looking, tile by tile
+        for (magma_int_t k = 0; k < nt; ++k) {
+            zsytrf_nopiv_diag_tile( &t, k );
+            for (magma_int_t i = k+1; i < nt; ++i) {
+                zsytrf_nopiv_trsm_tile( &t, i, k );
+            }
+            for (magma_int_t j = k+1; j < nt; ++j) {
+                for (magma_int_t i = j; i < nt; ++i) {
+                    zsytrf_nopiv_update_tile( &t, i, j, k );
                 }
-
-                /* Update the trailing submatrix A22 = A22 - A21 * D11 * A21' */
-                #ifdef ZSYRK_D_WORKSPACE
-                zsyrk_d_workspace( MagmaLower, height, sb,
-                                   c_neg_one, &A(i+sb, i),    lda,    // A21
-                                   c_one,     &A(i+sb, i+sb), lda,    // A22
-                                              &A(i, i+sb),    lda );  // workspace, I am writing on upper part :)
-                #else
-                zsyrk_d( MagmaLower, height, sb,
-                         c_neg_one, &A(i+sb, i),    lda,      // A21
-                         c_one,     &A(i+sb, i+sb), lda,      // A22
-                                    &A(i, i),       lda+1 );  // D11
-                #endif
             }
         }
-    } else {
-        for (magma_int_t i = 0; i < n; i += ib) {
-            magma_int_t sb = min(n-i, ib);
-
-            /* Factorize the diagonal block */
-            *info = zsytrf_diag_nopiv(uplo, sb, &A(i, i), lda);
-            if (*info != 0) return *info;
-
-            if ( i + sb < n ) {
-                magma_int_t height = n - i - sb;
-
-                /* Solve the lower panel ( L21*D11 )*/
-                blasf77_ztrsm(
-                    MagmaLeftStr, MagmaUpperStr, 
-                    MagmaTransStr, MagmaUnitStr,
-                    &sb, &height, 
-                    &c_one, &A(i, i),    &lda,
-                            &A(i, i+sb), &lda);
-
-                /* Scale the block to divide by D */
-                for (magma_int_t k=0; k < sb; k++) {
-                    #define ZSYRK_D_WORKSPACE
-                    #ifdef ZSYRK_D_WORKSPACE
-                    for (magma_int_t ii=i+sb; ii < n; ii++) {
-                        A(ii, i+k) = A(i+k, ii);
-                    }
-                    #endif
-                    alpha = MAGMA_Z_DIV( c_one, A(i+k, i+k) );
-                    blasf77_zscal(&height, &alpha, &A(i+k, i+sb), &lda);
+    }
+    else {
+        // launch threads -- each single-threaded MKL
+        magma_int_t lapack_nthread = magma_get_lapack_numthreads();
+        magma_set_lapack_numthreads( 1 );
+        magma_thread_queue queue;
+        queue.launch( nthread );
+
+        // The whole graph is built before any task is pushed, since dependencies
+        // must be set before their predecessors are pushed.
+        // last[ i + j*nt ] is the last task writing tile (i, j), i >= j.
+        std::vector< magma_task* > tasks;
+        std::vector< magma_task* > last( nt*nt, NULL );
+        std::vector< magma_task* > trsm( nt, NULL );
+        for (magma_int_t k = 0; k < nt; ++k) {
+            magma_task* diag = new zsytrf_nopiv_diag_task( &t, k );
+            if (last[ k + k*nt ])
+                diag->depends_on( last[ k + k*nt ] );
+            tasks.push_back( diag );
+
+            for (magma_int_t i = k+1; i < nt; ++i) {
+                trsm[i] = new zsytrf_nopiv_trsm_task( &t, i, k );
+                trsm[i]->depends_on( diag );
+                if (last[ i + k*nt ])
+                    trsm[i]->depends_on( last[ i + k*nt ] );
+                tasks.push_back( trsm[i] );
+            }
+            for (magma_int_t j = k+1; j < nt; ++j) {
+                for (magma_int_t i = j; i < nt; ++i) {
+                    magma_task* update = new zsytrf_nopiv_update_task( &t, i, j, k );
+                    update->depends_on( trsm[i] );
+                    if (i != j)
+                        update->depends_on( trsm[j] );
+                    if (last[ i + j*nt ])
+                        update->depends_on( last[ i + j*nt ] );
+                    last[ i + j*nt ] = update;
+                    tasks.push_back( update );
                 }
-
-                /* Update the trailing submatrix A22 = A22 - A21 * D11 * A21' */
-                #ifdef ZSYRK_D_WORKSPACE
-                zsyrk_d_workspace( MagmaUpper, height, sb,
-                                   c_neg_one, &A(i, i+sb),    lda,    // A21
-                                   c_one,     &A(i+sb, i+sb), lda,    // A22
-                                              &A(i+sb, i),    lda );  // workspace, I am writing on upper part :)
-                #else
-                zsyrk_d( MagmaUpper, height, sb,
-                         c_neg_one, &A(i, i+sb),    lda,      // A21
-                         c_one,     &A(i+sb, i+sb), lda,      // A22
-                                    &A(i, i),       lda+1 );  // D11
-                #endif
             }
         }
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            queue.push_task( tasks[i] );
+        }
+        queue.sync();
+        queue.quit();
+        magma_set_lapack_numthreads( lapack_nthread );
+    }
+
+    for (magma_int_t k = 0; k < nt; ++k) {
+        if (t.info[k] != 0) {
+            *info = t.info[k];
+            break;
+        }
     }
 
     return *info;
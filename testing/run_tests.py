@@ -1311,6 +1311,7 @@ batched = (
 	('testing_zgesv_batched',         batch + '           -c',  mn,   ''),
 	('testing_zgesv_nopiv_batched',   batch + '           -c',  mn,   ''),
 	('testing_zgetrf_batched',        batch + '          -c2',  mn,   ''),
+	('testing_zgetrf_batched_cpu',    batch + '          -c2',  mn,   ''),
 	('testing_zgetrf_nopiv_batched',  batch + '          -c2',  mn,   ''),
 	('testing_zgetri_batched',        batch + '           -c',  n,    ''),
 	
@@ -1320,6 +1321,9 @@ batched = (
 	
 	('testing_zpotrf_batched',    batch + '         -L    -c2', n,    ''),
 	('#testing_zpotrf_batched',   batch + '         -U    -c2', n,    'upper not implemented'),
+	
+	('testing_zpotrf_batched_cpu', batch + '         -L    -c2', n,    ''),
+	('testing_zpotrf_batched_cpu', batch + '         -U    -c2', n,    ''),
 )
 if (opts.batched):
 	tests += batched
@@ -1474,6 +1478,8 @@ vbatched = (
 	
 	# ----- Cholesky
 	('testing_zpotrf_vbatched',    batch + '         -L    -c2', n,    ''),	
+	('testing_zpotrf_vbatched_cpu', batch + '         -L    -c2', n,    ''),
+	('testing_zpotrf_vbatched_cpu', batch + '         -U    -c2', n,    ''),
 	('#testing_zposv_vbatched',    batch + '         -U    -c2', n,    'upper not implemented'),
 )
 if (opts.vbatched):
@@ -212,6 +212,36 @@ int main( int argc, char** argv)
             magma_int_t c_cpu2 = magma_znan_inf    ( uplo[iuplo], M, N, hA, lda,  NULL, NULL );
             magma_int_t c_gpu2 = magma_znan_inf_gpu( uplo[iuplo], M, N, dA, ldda, NULL, NULL, opts.queue );
             
+            magma_int_t c_any = magma_znan_inf_any( uplo[iuplo], M, N, hA, lda );
+            
+            magma_int_t c_norm_nan=-1, c_norm_inf=-1;
+            double norm_max=-1, norm_fro=-1;
+            magma_int_t c_norm = magma_znan_inf_norm( uplo[iuplo], M, N, hA, lda,
+                                                      &c_norm_nan, &c_norm_inf,
+                                                      &norm_max, &norm_fro );
+            
+            // norms of A with NAN and INF replaced by zero
+            for( j=0; j < N; ++j ) {
+                for( i=0; i < M; ++i ) {
+                    if ( magma_z_isnan_inf( *hA(i,j) )) {
+                        *hA(i,j) = MAGMA_Z_ZERO;
+                    }
+                }
+            }
+            double work[1];
+            double lapack_max, lapack_fro;
+            if ( uplo[iuplo] == MagmaFull ) {
+                lapack_max = lapackf77_zlange( "M", &M, &N, hA, &lda, work );
+                lapack_fro = lapackf77_zlange( "F", &M, &N, hA, &lda, work );
+            }
+            else {
+                lapack_max = lapackf77_zlantr( "M", lapack_uplo_const( uplo[iuplo] ), "N",
+                                               &M, &N, hA, &lda, work );
+                lapack_fro = lapackf77_zlantr( "F", lapack_uplo_const( uplo[iuplo] ), "N",
+                                               &M, &N, hA, &lda, work );
+            }
+            double tol = opts.tolerance * lapackf77_dlamch("E");
+            
             /* =====================================================================
                Check the result
                =================================================================== */
@@ -223,7 +253,13 @@ int main( int argc, char** argv)
                      && ( c_cpu_nan == cnt_nan )
                      && ( c_cpu_inf == cnt_inf )
                      && ( c_gpu_nan == cnt_nan )
-                     && ( c_gpu_inf == cnt_inf );
+                     && ( c_gpu_inf == cnt_inf )
+                     && ( c_any == (total > 0) )
+                     && ( c_norm == c_cpu )
+                     && ( c_norm_nan == cnt_nan )
+                     && ( c_norm_inf == cnt_inf )
+                     && ( fabs( norm_max - lapack_max ) <= tol * lapack_max )
+                     && ( fabs( norm_fro - lapack_fro ) <= tol * lapack_fro );
             
             printf( "%4c %5lld %5lld   %10lld + %-10lld   %10lld + %-10lld   %10lld + %-10lld  %s\n",
                     lapacke_uplo_const( uplo[iuplo] ), (long long) M, (long long) N,
@@ -0,0 +1,206 @@
+/*
+   -- MAGMA (version 2.0) --
+   Univ. of Tennessee, Knoxville
+   Univ. of California, Berkeley
+   Univ. of Colorado, Denver
+   @date
+
+   @precisions normal z -> s d c
+*/
+// includes, system
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// includes, project
+#include "flops.h"
+#include "magma_v2.h"
+#include "magma_lapack.h"
+#include "testings.h"
+
+#if defined(_OPENMP)
+#include <omp.h>
+#include "../control/magma_threadsetting.h"  // internal header
+#endif
+
+/* ////////////////////////////////////////////////////////////////////////////
+   -- Testing zpotrf_vbatched_cpu
+      Compares the CPU vbatched Cholesky against a loop over LAPACK zpotrf.
+      With -v, prints the statistics per size bin.
+*/
+int main( int argc, char** argv)
+{
+    TESTING_CHECK( magma_init() );
+    magma_print_environment();
+
+    real_Double_t   gflops, magma_perf, magma_time, cpu_perf, cpu_time;
+    magmaDoubleComplex *h_A, *h_R, *h_A_tmp, *h_R_tmp;
+    magma_int_t N, total_size, info;
+    magmaDoubleComplex c_neg_one = MAGMA_Z_NEG_ONE;
+    magma_int_t ione     = 1;
+    magma_int_t ISEED[4] = {0,0,0,1};
+    double      work[1], Anorm, error, magma_error;
+    int status = 0;
+    magmaDoubleComplex **hA_array = NULL, **hR_array = NULL;
+    magma_int_t *h_N, *h_lda, *info_magma;
+    magma_int_t max_N, batchCount;
+    magma_vbatched_cpu_stats stats;
+
+    magma_opts opts( MagmaOptsBatched );
+    opts.parse_opts( argc, argv );
+    opts.lapack |= opts.check;  // check (-c) implies lapack (-l)
+    batchCount = opts.batchcount;
+    double tol = opts.tolerance * lapackf77_dlamch("E");
+
+    TESTING_CHECK( magma_imalloc_cpu( &h_N,        batchCount ));
+    TESTING_CHECK( magma_imalloc_cpu( &info_magma, batchCount ));
+    TESTING_CHECK( magma_malloc_cpu( (void**) &hA_array, batchCount * sizeof(magmaDoubleComplex*) ));
+    TESTING_CHECK( magma_malloc_cpu( (void**) &hR_array, batchCount * sizeof(magmaDoubleComplex*) ));
+    h_lda = h_N;
+
+    printf("%% uplo = %s\n", lapack_uplo_const(opts.uplo) );
+    printf("%%              max\n");
+    printf("%% BatchCount     N   CPU Gflop/s (ms)   MAGMA CPU Gflop/s (ms)   ||R_magma - R_lapack||_F / ||R_lapack||_F\n");
+    printf("%%=========================================================================================================\n");
+    for( int itest = 0; itest < opts.ntest; ++itest ) {
+        for( int iter = 0; iter < opts.niter; ++iter ) {
+            srand(1000); // guarantee reproducible sizes
+            N = opts.nsize[itest];
+            total_size = 0;
+            gflops = 0;
+            max_N = 0;
+            for (int k = 0; k < batchCount; k++) {
+                h_N[k] = 1 + (rand() % N);
+                max_N = max( max_N, h_N[k] );
+                total_size += h_N[k] * h_lda[k];
+                gflops += FLOPS_ZPOTRF( h_N[k] ) / 1e9;
+            }
+
+            TESTING_CHECK( magma_zmalloc_cpu( &h_A, total_size ));
+            TESTING_CHECK( magma_zmalloc_cpu( &h_R, total_size ));
+
+            /* Initialize the matrix */
+            lapackf77_zlarnv( &ione, ISEED, &total_size, h_A );
+            h_A_tmp = h_A;
+            h_R_tmp = h_R;
+            for (int s=0; s < batchCount; s++) {
+                magma_zmake_hpd( h_N[s], h_A_tmp, h_lda[s] );
+                lapackf77_zlacpy( MagmaFullStr, &h_N[s], &h_N[s], h_A_tmp, &h_lda[s], h_R_tmp, &h_lda[s] );
+                hA_array[s] = h_A_tmp;
+                hR_array[s] = h_R_tmp;
+                h_A_tmp += h_N[s] * h_lda[s];
+                h_R_tmp += h_N[s] * h_lda[s];
+            }
+
+            /* ====================================================================
+               Performs operation using MAGMA
+               =================================================================== */
+            magma_time = magma_wtime();
+            info = magma_zpotrf_vbatched_cpu( opts.uplo, h_N, hR_array, h_lda,
+                                              info_magma, batchCount, &stats );
+            magma_time = magma_wtime() - magma_time;
+            magma_perf = gflops / magma_time;
+            for (int s=0; s < batchCount; s++) {
+                if (info_magma[s] != 0 ) {
+                    printf("magma_zpotrf_vbatched_cpu matrix %lld returned diag error %lld\n",
+                            (long long) s, (long long) info_magma[s] );
+                    status = -1;
+                }
+            }
+            if (info != 0) {
+                printf("magma_zpotrf_vbatched_cpu returned argument error %lld: %s.\n",
+                        (long long) info, magma_strerror( info ));
+                status = -1;
+            }
+            if (status == -1)
+                goto cleanup;
+
+            /* =====================================================================
+               Performs operation using LAPACK
+               =================================================================== */
+            if ( opts.lapack ) {
+                cpu_time = magma_wtime();
+                #if defined(_OPENMP)
+                magma_int_t nthreads = magma_get_lapack_numthreads();
+                magma_set_lapack_numthreads(1);
+                magma_set_omp_numthreads(nthreads);
+                #pragma omp parallel for schedule(dynamic)
+                #endif
+                for (magma_int_t s=0; s < batchCount; s++) {
+                    magma_int_t locinfo;
+                    lapackf77_zpotrf( lapack_uplo_const(opts.uplo), &h_N[s], hA_array[s], &h_lda[s], &locinfo );
+                    if (locinfo != 0) {
+                        printf("lapackf77_zpotrf matrix %lld returned error %lld: %s.\n",
+                               (long long) s, (long long) locinfo, magma_strerror( locinfo ));
+                    }
+                }
+                #if defined(_OPENMP)
+                magma_set_lapack_numthreads(nthreads);
+                #endif
+                cpu_time = magma_wtime() - cpu_time;
+                cpu_perf = gflops / cpu_time;
+
+                /* =====================================================================
+                   Check the result compared to LAPACK
+                   =================================================================== */
+                const char* uplo = lapack_uplo_const(opts.uplo);
+                magma_error = 0.0;
+                for (int s=0; s < batchCount; s++) {
+                    magma_int_t Asize = h_lda[s] * h_N[s];
+                    Anorm = safe_lapackf77_zlanhe("f", uplo, &h_N[s], hA_array[s], &h_lda[s], work);
+                    blasf77_zaxpy(&Asize, &c_neg_one, hA_array[s], &ione, hR_array[s], &ione);
+                    error = safe_lapackf77_zlanhe("f", uplo, &h_N[s], hR_array[s], &h_lda[s], work) / Anorm;
+                    magma_error = magma_max_nan( magma_error, error );
+                }
+                bool okay = (magma_error < tol);
+                status += ! okay;
+
+                printf("  %10lld %5lld   %7.2f (%7.2f)     %7.2f (%7.2f)      %8.2e   %s\n",
+                       (long long) batchCount, (long long) max_N,
+                       cpu_perf, cpu_time*1000., magma_perf, magma_time*1000.,
+                       magma_error, (okay ? "ok" : "failed"));
+            }
+            else {
+                printf("  %10lld %5lld     ---   (  ---  )     %7.2f (%7.2f)        ---\n",
+                       (long long) batchCount, (long long) max_N,
+                       magma_perf, magma_time*1000. );
+            }
+
+            if ( opts.verbose ) {
+                printf("%%   bin     n <=   count   Gflop/s per thread\n");
+                for (int b=0; b < MAGMA_VBATCHED_CPU_NBINS; b++) {
+                    if (stats.count[b] == 0)
+                        continue;
+                    if (b < MAGMA_VBATCHED_CPU_NBINS-1)
+                        printf("%%  %4d   %6lld", b, (long long) (4 << b) );
+                    else
+                        printf("%%  %4d      ---", b );
+                    printf(" %7lld   %7.2f\n", (long long) stats.count[b],
+                           stats.flops[b] / stats.time[b] / 1e9 );
+                }
+            }
+cleanup:
+            magma_free_cpu( h_A );
+            magma_free_cpu( h_R );
+            if (status == -1)
+                break;
+            fflush( stdout );
+        }
+        if (status == -1)
+            break;
+
+        if ( opts.niter > 1 ) {
+            printf( "\n" );
+        }
+    }
+
+    magma_free_cpu( h_N );
+    magma_free_cpu( info_magma );
+    magma_free_cpu( hA_array );
+    magma_free_cpu( hR_array );
+
+    opts.cleanup();
+    TESTING_CHECK( magma_finalize() );
+    return status;
+}
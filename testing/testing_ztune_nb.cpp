@@ -0,0 +1,186 @@
+/*
+    -- MAGMA (version 2.0) --
+       Univ. of Tennessee, Knoxville
+       Univ. of California, Berkeley
+       Univ. of Colorado, Denver
+       @date
+
+       @precisions normal z -> c d s
+*/
+// includes, system
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// includes, project
+#include "flops.h"
+#include "magma_v2.h"
+#include "magma_lapack.h"
+#include "testings.h"
+
+
+// candidate block sizes; each routine uses its CPU code for 2*nb >= n
+static const magma_int_t candidates[] = { 32, 64, 96, 128, 192, 256, 320, 384, 512, 768, 1024 };
+static const int ncandidates = sizeof(candidates) / sizeof(*candidates);
+
+enum { TUNE_POTRF, TUNE_GETRF, TUNE_GEQRF, NROUTINES };
+
+static const char* routine_names[ NROUTINES ] = { "zpotrf", "zgetrf", "zgeqrf" };
+
+
+// Returns best time of niter runs of routine on the N-by-N matrix h_A,
+// or -1 if the routine fails.
+static double time_routine(
+    int routine, magma_int_t N, magma_int_t nb, magma_int_t niter,
+    const magmaDoubleComplex *h_A, magmaDoubleComplex *h_R, magma_int_t lda,
+    magma_int_t *ipiv, magmaDoubleComplex *tau )
+{
+    magma_int_t info, lwork;
+    magmaDoubleComplex *h_work = NULL, tmp[1];
+    double time, best = -1;
+
+    if ( routine == TUNE_GEQRF ) {
+        lwork = -1;
+        lapackf77_zgeqrf( &N, &N, h_R, &lda, tau, tmp, &lwork, &info );
+        lwork = max( (magma_int_t) MAGMA_Z_REAL( tmp[0] ), N*nb );
+        TESTING_CHECK( magma_zmalloc_cpu( &h_work, lwork ));
+    }
+    for( magma_int_t iter = 0; iter < niter; ++iter ) {
+        lapackf77_zlacpy( MagmaFullStr, &N, &N, h_A, &lda, h_R, &lda );
+        time = magma_wtime();
+        switch ( routine ) {
+            case TUNE_POTRF: magma_zpotrf( MagmaLower, N, h_R, lda, &info ); break;
+            case TUNE_GETRF: magma_zgetrf( N, N, h_R, lda, ipiv, &info ); break;
+            case TUNE_GEQRF: magma_zgeqrf( N, N, h_R, lda, tau, h_work, lwork, &info ); break;
+        }
+        time = magma_wtime() - time;
+        if ( info != 0 ) {
+            printf( "magma_%s returned error %lld: %s.\n", routine_names[ routine ],
+                    (long long) info, magma_strerror( info ));
+            best = -1;
+            break;
+        }
+        if ( best < 0 || time < best ) {
+            best = time;
+        }
+    }
+    magma_free_cpu( h_work );
+    return best;
+}
+
+
+/* ////////////////////////////////////////////////////////////////////////////
+   -- Tunes block sizes of zpotrf, zgetrf, and zgeqrf for sizes N
+      and writes them to the tuning file; see magma_tuning_load.
+      The file is $MAGMA_TUNING_FILE, or magma_tuning.txt if that is not set.
+      Existing entries of other routines in the file are kept.
+*/
+int main( int argc, char** argv)
+{
+    TESTING_CHECK( magma_init() );
+    magma_print_environment();
+
+    real_Double_t gflops, time;
+    magmaDoubleComplex *h_A, *h_R, *tau;
+    magma_int_t *ipiv;
+    magma_int_t N, lda, n2, nb;
+    int status = 0;
+
+    magma_opts opts;
+    opts.parse_opts( argc, argv );
+
+    const char* filename = getenv( "MAGMA_TUNING_FILE" );
+    if ( filename == NULL || filename[0] == '\0' ) {
+        filename = "magma_tuning.txt";
+    }
+
+    printf( "%% routine      N     nb   Gflop/s (sec)\n" );
+    printf( "%%=======================================================\n" );
+    for( int routine = 0; routine < NROUTINES; ++routine ) {
+        const char* name = routine_names[ routine ];
+        opts.matrix = (routine == TUNE_POTRF ? "rand_dominant" : "rand");
+
+        // (size, best nb) pairs
+        std::vector< std::pair< magma_int_t, magma_int_t > > tuned;
+        for( int itest = 0; itest < opts.ntest; ++itest ) {
+            N   = opts.nsize[itest];
+            lda = N;
+            n2  = lda*N;
+            switch ( routine ) {
+                case TUNE_POTRF: gflops = FLOPS_ZPOTRF( N ) / 1e9;    break;
+                case TUNE_GETRF: gflops = FLOPS_ZGETRF( N, N ) / 1e9; break;
+                default:         gflops = FLOPS_ZGEQRF( N, N ) / 1e9; break;
+            }
+
+            TESTING_CHECK( magma_zmalloc_cpu( &h_A, n2 ));
+            TESTING_CHECK( magma_zmalloc_cpu( &tau, N ));
+            TESTING_CHECK( magma_imalloc_cpu( &ipiv, N ));
+            TESTING_CHECK( magma_zmalloc_pinned( &h_R, n2 ));
+            magma_generate_matrix( opts, N, N, h_A, lda );
+
+            double best_time = -1;
+            magma_int_t best = 0;
+            for( int c = 0; c < ncandidates; ++c ) {
+                nb = candidates[c];
+                if ( c > 0 && 2*nb >= N ) {
+                    break;  // CPU code for all larger nb
+                }
+                // force nb for all sizes
+                magma_tuning_clear( name );
+                magma_tuning_set_nb( name, -1, nb );
+                time = time_routine( routine, N, nb, opts.niter, h_A, h_R, lda, ipiv, tau );
+                if ( time < 0 ) {
+                    status += 1;
+                    continue;
+                }
+                printf( "  %-8s %6lld %6lld   %7.2f (%7.4f)\n",
+                        name, (long long) N, (long long) nb, gflops / time, time );
+                if ( best_time < 0 || time < best_time ) {
+                    best_time = time;
+                    best      = nb;
+                }
+            }
+            magma_tuning_clear( name );
+            if ( best > 0 ) {
+                printf( "%% %-8s %6lld %6lld   %7.2f (%7.4f)   best\n",
+                        name, (long long) N, (long long) best, gflops / best_time, best_time );
+                tuned.push_back( std::make_pair( N, best ));
+            }
+            fflush( stdout );
+
+            magma_free_cpu( h_A );
+            magma_free_cpu( tau );
+            magma_free_cpu( ipiv );
+            magma_free_pinned( h_R );
+        }
+
+        // sizes from tuned[i] up to tuned[i+1] use the nb of tuned[i];
+        // merge neighboring bands with the same nb
+        std::sort( tuned.begin(), tuned.end() );
+        for( size_t i = 0; i < tuned.size(); ++i ) {
+            bool last = (i+1 == tuned.size());
+            if ( ! last && tuned[i+1].second == tuned[i].second ) {
+                continue;
+            }
+            magma_tuning_set_nb( name, (last ? -1 : tuned[i+1].first), tuned[i].second );
+        }
+        printf( "\n" );
+    }
+
+    if ( magma_tuning_save( filename ) != MAGMA_SUCCESS ) {
+        printf( "Can't write tuning file '%s'\n", filename );
+        status += 1;
+    }
+    else {
+        printf( "%% wrote block sizes to '%s'\n", filename );
+    }
+
+    opts.cleanup();
+    TESTING_CHECK( magma_finalize() );
+    return status;
+}